@@ -0,0 +1,200 @@
+/**
+ * @file anomaly.c
+ * @brief Implementation of the streaming anomaly detectors.
+ *
+ * All detectors keep a handful of floats per channel and are updated in
+ * constant time per sample. Variances are compared squared against the
+ * threshold, so no square roots are needed.
+ */
+
+#include "anomaly.h"
+#include <string.h>
+#include <zephyr/sys/printk.h>
+
+/* ---------------------------------------------------------------------------
+ * Helper functions
+ * ---------------------------------------------------------------------------*/
+
+/**
+ * @brief Update an EWMA detector and test the sample against it.
+ *
+ * The sample is tested against the state *before* the update, then the
+ * incremental EWMA mean/variance recurrences are applied.
+ *
+ * @param d Pointer to the EWMA detector.
+ * @param x New sample.
+ * @param cfg Pointer to the detector configuration.
+ * @retval true If the sample deviates more than @c z_threshold deviations.
+ * @retval false If the sample is routine or the detector is still warming up.
+ */
+static bool ewma_update(struct ewma_detector *d, float x, const struct anomaly_config *cfg)
+{
+    if (d->samples == 0) {
+        d->mean = x;
+        d->var = 0.0f;
+        d->samples = 1;
+        return false;
+    }
+
+    float diff = x - d->mean;
+    float var_floor = cfg->min_std * cfg->min_std;
+    float var = (d->var > var_floor) ? d->var : var_floor;
+
+    bool anomalous = (d->samples >= cfg->warmup) &&
+                     (diff * diff > cfg->z_threshold * cfg->z_threshold * var);
+
+    float incr = cfg->alpha * diff;
+    d->mean += incr;
+    d->var = (1.0f - cfg->alpha) * (d->var + diff * incr);
+
+    if (d->samples < cfg->warmup) {
+        d->samples++;
+    }
+
+    return anomalous;
+}
+
+/**
+ * @brief Compute the residual of a sample against its hourly baseline.
+ *
+ * The hourly bin is learned on first use and then tracked with an EWMA.
+ *
+ * @param b Pointer to the seasonal baseline.
+ * @param x New sample.
+ * @param hour Hour of day (0–23).
+ * @param alpha EWMA smoothing factor of the hourly bin.
+ * @return Difference between the sample and the expected value for this hour.
+ */
+static float seasonal_residual(struct seasonal_baseline *b, float x, int hour, float alpha)
+{
+    if (!(b->seen_mask & (1UL << hour))) {
+        b->hour_mean[hour] = x;
+        b->seen_mask |= (1UL << hour);
+        return 0.0f;
+    }
+
+    float residual = x - b->hour_mean[hour];
+    b->hour_mean[hour] += alpha * residual;
+    return residual;
+}
+
+/**
+ * @brief Update the CUSUM detector with a new soil moisture sample.
+ *
+ * When a change-point is detected the reference level is re-anchored to the
+ * current sample, so a single watering event is reported only once.
+ *
+ * @param c Pointer to the CUSUM detector.
+ * @param x New sample.
+ * @param cfg Pointer to the detector configuration.
+ * @return @ref ANOMALY_WATERING, @ref ANOMALY_MOISTURE or 0.
+ */
+static uint32_t cusum_update(struct cusum_detector *c, float x, const struct anomaly_config *cfg)
+{
+    if (c->samples == 0) {
+        c->mean = x;
+        c->pos = 0.0f;
+        c->neg = 0.0f;
+        c->samples = 1;
+        return 0;
+    }
+
+    float diff = x - c->mean;
+
+    c->pos += diff - cfg->cusum_drift;
+    if (c->pos < 0.0f) c->pos = 0.0f;
+
+    c->neg += -diff - cfg->cusum_drift;
+    if (c->neg < 0.0f) c->neg = 0.0f;
+
+    uint32_t flags = 0;
+    if (c->pos > cfg->cusum_threshold) {
+        flags = ANOMALY_WATERING;
+    } else if (c->neg > cfg->cusum_threshold) {
+        flags = ANOMALY_MOISTURE;
+    }
+
+    if (flags) {
+        c->mean = x;
+        c->pos = 0.0f;
+        c->neg = 0.0f;
+        c->samples = 1;
+    } else {
+        /* Follow slow drying without accumulating it as a change */
+        c->mean += cfg->alpha * diff;
+        c->samples++;
+    }
+
+    return flags;
+}
+
+/* ---------------------------------------------------------------------------
+ * Public API
+ * ---------------------------------------------------------------------------*/
+
+/**
+ * @brief Initialize the detector with the given configuration.
+ *
+ * Clears all learned state; detectors start learning from the next sample.
+ *
+ * @param det Pointer to the detector state.
+ * @param cfg Pointer to the tuning parameters (copied).
+ */
+void anomaly_init(struct anomaly_detector *det, const struct anomaly_config *cfg)
+{
+    memset(det, 0, sizeof(*det));
+    det->cfg = *cfg;
+}
+
+/**
+ * @brief Feed one measurement cycle to all detectors.
+ *
+ * Light and temperature always update a z-score of their level, which
+ * decides while the time of day is unknown (no fix yet, or none for a
+ * while in the energy saving tiers). When it is known, their residual
+ * against the hourly baseline decides instead, so the day/night cycle is
+ * not reported. Humidity uses a plain EWMA z-score and soil moisture the
+ * CUSUM change-point detector.
+ *
+ * @param det Pointer to the detector state.
+ * @param sample Pointer to the latest measurements.
+ * @return Bitmask of @c ANOMALY_* flags.
+ */
+uint32_t anomaly_update(struct anomaly_detector *det, const struct anomaly_sample *sample)
+{
+    const struct anomaly_config *cfg = &det->cfg;
+    uint32_t flags = 0;
+    bool temp_out = ewma_update(&det->temp_level, sample->temp, cfg);
+    bool light_out = ewma_update(&det->light_level, sample->light, cfg);
+
+    if (sample->hour >= 0 && sample->hour < ANOMALY_HOURS) {
+        float temp_res = seasonal_residual(&det->temp_day, sample->temp, sample->hour, cfg->seasonal_alpha);
+        float light_res = seasonal_residual(&det->light_day, sample->light, sample->hour, cfg->seasonal_alpha);
+
+        temp_out = ewma_update(&det->temp, temp_res, cfg);
+        light_out = ewma_update(&det->light, light_res, cfg);
+    }
+
+    if (temp_out)  flags |= ANOMALY_TEMP;
+    if (light_out) flags |= ANOMALY_LIGHT;
+
+    if (ewma_update(&det->hum, sample->hum, cfg)) flags |= ANOMALY_HUM;
+
+    flags |= cusum_update(&det->moisture, sample->moisture, cfg);
+
+    return flags;
+}
+
+/**
+ * @brief Print a human-readable description of an anomaly bitmask.
+ *
+ * @param flags Bitmask of @c ANOMALY_* flags.
+ */
+void anomaly_print(uint32_t flags)
+{
+    if (flags & ANOMALY_TEMP)     printk("[ANOMALY] - Temperature out of daily profile\n");
+    if (flags & ANOMALY_HUM)      printk("[ANOMALY] - Humidity deviates from running mean\n");
+    if (flags & ANOMALY_LIGHT)    printk("[ANOMALY] - Light out of daily profile\n");
+    if (flags & ANOMALY_MOISTURE) printk("[ANOMALY] - Sudden soil moisture drop\n");
+    if (flags & ANOMALY_WATERING) printk("[ANOMALY] - Watering event detected\n");
+}
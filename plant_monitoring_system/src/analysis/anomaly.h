@@ -0,0 +1,129 @@
+/**
+ * @file anomaly.h
+ * @brief Streaming anomaly detection for the plant monitoring channels.
+ *
+ * This module implements lightweight, constant-memory anomaly detectors
+ * that run once per measurement cycle:
+ *  - **EWMA z-score:** exponentially weighted mean/variance per channel;
+ *    a sample is anomalous when its residual exceeds a z threshold.
+ *  - **Seasonal baseline:** once the time of day is known, light and
+ *    temperature are compared against a per-hour (24 bins) daily profile
+ *    before the z-score is applied, so the normal day/night cycle is not
+ *    reported. Without a time the z-score is applied to the level itself.
+ *  - **CUSUM change-point:** soil moisture is monitored with a two-sided
+ *    cumulative sum, detecting watering events (upward steps) and sudden
+ *    drops (leaks or probe faults).
+ *
+ * Every update runs in O(1) time with no dynamic memory, so the detector can
+ * decide which samples are worth reporting instead of sending all of them.
+ */
+
+#ifndef ANOMALY_H
+#define ANOMALY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/** @brief Number of hourly bins in the seasonal daily baseline. */
+#define ANOMALY_HOURS 24
+
+/* --- Anomaly flags -------------------------------------------------------- */
+#define ANOMALY_TEMP       (1U << 0)  /**< Temperature deviates from its baseline. */
+#define ANOMALY_HUM        (1U << 1)  /**< Humidity deviates from its running mean. */
+#define ANOMALY_LIGHT      (1U << 2)  /**< Light deviates from its baseline. */
+#define ANOMALY_MOISTURE   (1U << 3)  /**< Sudden soil moisture drop detected. */
+#define ANOMALY_WATERING   (1U << 4)  /**< Watering event (moisture step up) detected. */
+
+/**
+ * @brief Exponentially weighted mean/variance detector (rolling z-score).
+ */
+struct ewma_detector {
+    float mean;        /**< Running mean of the monitored signal. */
+    float var;         /**< Running variance of the monitored signal. */
+    uint32_t samples;  /**< Number of samples seen (saturates at warm-up). */
+};
+
+/**
+ * @brief Seasonal daily baseline with one EWMA bin per hour of day.
+ */
+struct seasonal_baseline {
+    float hour_mean[ANOMALY_HOURS]; /**< Expected value for each hour of the day. */
+    uint32_t seen_mask;             /**< Bit @c h set once hour @c h has been learned. */
+};
+
+/**
+ * @brief Two-sided CUSUM change-point detector.
+ */
+struct cusum_detector {
+    float mean;        /**< Reference level the sums are computed against. */
+    float pos;         /**< Upper cumulative sum (upward changes). */
+    float neg;         /**< Lower cumulative sum (downward changes). */
+    uint32_t samples;  /**< Number of samples since the last change-point. */
+};
+
+/**
+ * @brief Tuning parameters shared by all detectors.
+ */
+struct anomaly_config {
+    float alpha;            /**< EWMA smoothing factor (0–1) for mean/variance. */
+    float seasonal_alpha;   /**< EWMA smoothing factor for each hourly bin. */
+    float z_threshold;      /**< Residual threshold in standard deviations. */
+    float min_std;          /**< Standard deviation floor, avoids alarms on flat signals. */
+    uint32_t warmup;        /**< Samples required before a detector may raise alarms. */
+    float cusum_drift;      /**< CUSUM slack (%) tolerated per sample. */
+    float cusum_threshold;  /**< CUSUM decision threshold (%). */
+};
+
+/**
+ * @brief Complete anomaly detector state for one node.
+ */
+struct anomaly_detector {
+    struct anomaly_config cfg;          /**< Active configuration. */
+    struct ewma_detector temp;          /**< Temperature residual detector. */
+    struct ewma_detector hum;           /**< Humidity detector. */
+    struct ewma_detector light;         /**< Light residual detector. */
+    struct ewma_detector temp_level;    /**< Temperature detector used while the time is unknown. */
+    struct ewma_detector light_level;   /**< Light detector used while the time is unknown. */
+    struct seasonal_baseline temp_day;  /**< Daily temperature profile. */
+    struct seasonal_baseline light_day; /**< Daily light profile. */
+    struct cusum_detector moisture;     /**< Soil moisture change-point detector. */
+};
+
+/**
+ * @brief One measurement cycle fed to the detector.
+ */
+struct anomaly_sample {
+    float temp;      /**< Temperature (°C). */
+    float hum;       /**< Relative humidity (%RH). */
+    float light;     /**< Ambient light (%). */
+    float moisture;  /**< Soil moisture (%). */
+    int hour;        /**< Local hour of day (0–23), or -1 if time is unknown. */
+};
+
+/**
+ * @brief Initialize the detector with the given configuration.
+ *
+ * @param det Pointer to the detector state.
+ * @param cfg Pointer to the tuning parameters (copied).
+ */
+void anomaly_init(struct anomaly_detector *det, const struct anomaly_config *cfg);
+
+/**
+ * @brief Feed one measurement cycle to all detectors.
+ *
+ * Updates every channel and returns the anomalies raised by this sample.
+ *
+ * @param det Pointer to the detector state.
+ * @param sample Pointer to the latest measurements.
+ * @return Bitmask of @c ANOMALY_* flags (0 if the sample is routine).
+ */
+uint32_t anomaly_update(struct anomaly_detector *det, const struct anomaly_sample *sample);
+
+/**
+ * @brief Print a human-readable description of an anomaly bitmask.
+ *
+ * @param flags Bitmask of @c ANOMALY_* flags.
+ */
+void anomaly_print(uint32_t flags);
+
+#endif /* ANOMALY_H */
@@ -0,0 +1,228 @@
+/**
+ * @file color_analysis.c
+ * @brief Implementation of the fixed-point color analysis.
+ *
+ * Ratios are computed as num × 256 / den by normalizing the denominator to
+ * an 8-bit mantissa and multiplying by its reciprocal from a 128-entry table
+ * (relative error below 0.8%). Hue follows the usual HSV sector formula.
+ */
+
+#include "color_analysis.h"
+#include <errno.h>
+#include <stdbool.h>
+#include <zephyr/sys/util.h>
+
+/**
+ * @brief Reciprocal table: round(2^22 / m) for mantissas m = 128…255.
+ */
+static const uint16_t recip_lut[128] = {
+    32768, 32514, 32264, 32018, 31775, 31536, 31301, 31069,
+    30840, 30615, 30394, 30175, 29959, 29747, 29537, 29331,
+    29127, 28926, 28728, 28533, 28340, 28150, 27962, 27777,
+    27594, 27414, 27236, 27060, 26887, 26715, 26546, 26379,
+    26214, 26052, 25891, 25732, 25575, 25420, 25267, 25116,
+    24966, 24818, 24672, 24528, 24385, 24245, 24105, 23967,
+    23831, 23697, 23564, 23432, 23302, 23173, 23046, 22920,
+    22795, 22672, 22550, 22429, 22310, 22192, 22075, 21960,
+    21845, 21732, 21620, 21509, 21400, 21291, 21183, 21077,
+    20972, 20867, 20764, 20662, 20560, 20460, 20361, 20262,
+    20165, 20068, 19973, 19878, 19784, 19692, 19600, 19508,
+    19418, 19329, 19240, 19152, 19065, 18979, 18893, 18809,
+    18725, 18641, 18559, 18477, 18396, 18316, 18236, 18157,
+    18079, 18001, 17924, 17848, 17772, 17697, 17623, 17549,
+    17476, 17404, 17332, 17261, 17190, 17120, 17050, 16981,
+    16913, 16845, 16777, 16710, 16644, 16578, 16513, 16448,
+};
+
+/* ---------------------------------------------------------------------------
+ * Helper functions
+ * ---------------------------------------------------------------------------*/
+
+/**
+ * @brief Compute num × 256 / den with the reciprocal table.
+ *
+ * @param num Numerator.
+ * @param den Denominator.
+ * @return Quotient in Q8, or 0 if @p den is 0.
+ */
+static uint32_t div_q8(uint32_t num, uint32_t den)
+{
+    if (den == 0) return 0;
+
+    int shift = (31 - __builtin_clz(den)) - 7;
+    uint32_t mantissa = (shift >= 0) ? (den >> shift) : (den << -shift);
+
+    return (uint32_t)(((uint64_t)num * recip_lut[mantissa - 128]) >> (14 + shift));
+}
+
+/**
+ * @brief Saturate a Q8 value to 8 bits.
+ *
+ * @param v Q8 value.
+ * @return Value clamped to 255.
+ */
+static uint8_t sat_u8(uint32_t v)
+{
+    return (v > 255) ? 255 : (uint8_t)v;
+}
+
+/**
+ * @brief Compute the hue of an RGB triplet.
+ *
+ * @param r Red channel.
+ * @param g Green channel.
+ * @param b Blue channel.
+ * @param max Largest channel.
+ * @param delta Difference between largest and smallest channel (non-zero).
+ * @return Hue in degrees (0–359).
+ */
+static uint16_t hue_degrees(uint32_t r, uint32_t g, uint32_t b, uint32_t max, uint32_t delta)
+{
+    int32_t base;
+    int32_t diff;
+
+    if (max == r) {
+        base = 0;
+        diff = (int32_t)g - (int32_t)b;
+    } else if (max == g) {
+        base = 120;
+        diff = (int32_t)b - (int32_t)r;
+    } else {
+        base = 240;
+        diff = (int32_t)r - (int32_t)g;
+    }
+
+    int32_t offset = (int32_t)((60 * div_q8((uint32_t)(diff < 0 ? -diff : diff), delta)) >> 8);
+    int32_t hue = base + (diff < 0 ? -offset : offset);
+
+    if (hue < 0) hue += 360;
+    if (hue >= 360) hue -= 360;
+
+    return (uint16_t)hue;
+}
+
+/**
+ * @brief Check whether a hue falls within a bin.
+ *
+ * @param bin Pointer to the bin definition.
+ * @param hue Hue in degrees.
+ * @return true if the hue belongs to the bin.
+ */
+static bool bin_contains(const struct color_bin *bin, uint16_t hue)
+{
+    if (bin->hue_min <= bin->hue_max) {
+        return hue >= bin->hue_min && hue < bin->hue_max;
+    }
+    return hue >= bin->hue_min || hue < bin->hue_max;
+}
+
+/**
+ * @brief Confidence of a hue within its bin.
+ *
+ * 100% at the bin center, 50% at its edges, scaled by saturation.
+ *
+ * @param bin Pointer to the bin definition.
+ * @param hue Hue in degrees.
+ * @param saturation Saturation (0–255).
+ * @return Confidence (0–100%).
+ */
+static uint8_t bin_confidence(const struct color_bin *bin, uint16_t hue, uint8_t saturation)
+{
+    uint32_t width = (bin->hue_min <= bin->hue_max) ? (bin->hue_max - bin->hue_min)
+                                                     : (360 - bin->hue_min + bin->hue_max);
+    uint32_t half = (width > 1) ? width / 2 : 1;
+    uint32_t center = (bin->hue_min + half) % 360;
+
+    uint32_t dist = (hue > center) ? (hue - center) : (center - hue);
+    if (dist > 180) dist = 360 - dist;
+    if (dist > half) dist = half;
+
+    uint32_t closeness = 100 - (50 * dist) / half;
+    return (uint8_t)((closeness * saturation) / 255);
+}
+
+/* ---------------------------------------------------------------------------
+ * Public API
+ * ---------------------------------------------------------------------------*/
+
+/**
+ * @brief Analyze and classify one raw color sample.
+ *
+ * @param cfg Pointer to the classification configuration.
+ * @param raw Pointer to the raw sensor channels.
+ * @param out Pointer to store the analysis result.
+ * @retval 0 On success.
+ * @retval -EINVAL If a pointer or the configuration is invalid.
+ */
+int color_analyze(const struct color_config *cfg, const ColorSensorData *raw,
+                  struct color_result *out)
+{
+    if (!cfg || !raw || !out || !cfg->bins || cfg->bin_count > COLOR_MAX_BINS) {
+        return -EINVAL;
+    }
+
+    uint32_t r = raw->red, g = raw->green, b = raw->blue;
+    uint32_t clear = raw->clear ? raw->clear : 1;
+
+    uint32_t max = r, min = r;
+    if (g > max) max = g;
+    if (b > max) max = b;
+    if (g < min) min = g;
+    if (b < min) min = b;
+    uint32_t delta = max - min;
+
+    out->norm_r = (uint16_t)MIN(div_q8(r, clear), UINT16_MAX);
+    out->norm_g = (uint16_t)MIN(div_q8(g, clear), UINT16_MAX);
+    out->norm_b = (uint16_t)MIN(div_q8(b, clear), UINT16_MAX);
+
+    uint32_t sum = r + g + b;
+    out->chroma_r = sat_u8(div_q8(r, sum));
+    out->chroma_g = sat_u8(div_q8(g, sum));
+    out->chroma_b = sat_u8(div_q8(b, sum));
+
+    out->value = sat_u8(div_q8(max, clear));
+    out->saturation = sat_u8(div_q8(delta, max));
+    out->hue = (delta == 0) ? 0 : hue_degrees(r, g, b, max, delta);
+
+    out->bin = (uint8_t)cfg->bin_count;
+    out->confidence = 0;
+
+    if (out->saturation < cfg->min_saturation) {
+        out->confidence = (uint8_t)(100 - (out->saturation * 100) / cfg->min_saturation);
+        return 0;
+    }
+
+    for (size_t i = 0; i < cfg->bin_count; i++) {
+        if (bin_contains(&cfg->bins[i], out->hue)) {
+            out->bin = (uint8_t)i;
+            out->confidence = bin_confidence(&cfg->bins[i], out->hue, out->saturation);
+            break;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Get the printable name of the bin in a result.
+ *
+ * @param cfg Pointer to the classification configuration.
+ * @param res Pointer to an analysis result.
+ * @return Bin name, or the achromatic name.
+ */
+const char *color_bin_name(const struct color_config *cfg, const struct color_result *res)
+{
+    return (res->bin < cfg->bin_count) ? cfg->bins[res->bin].name : cfg->achromatic_name;
+}
+
+/**
+ * @brief Get the RGB LED bitmask of the bin in a result.
+ *
+ * @param cfg Pointer to the classification configuration.
+ * @param res Pointer to an analysis result.
+ * @return RGB LED bitmask (bit 0 red, bit 1 green, bit 2 blue).
+ */
+uint8_t color_bin_led_mask(const struct color_config *cfg, const struct color_result *res)
+{
+    return (res->bin < cfg->bin_count) ? cfg->bins[res->bin].led_mask : cfg->achromatic_led_mask;
+}
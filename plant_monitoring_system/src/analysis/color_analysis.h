@@ -0,0 +1,98 @@
+/**
+ * @file color_analysis.h
+ * @brief Fixed-point color analysis for the TCS34725 raw channels.
+ *
+ * Converts raw clear/red/green/blue counts into normalized channels,
+ * chromaticity and HSV using integer arithmetic only. Divisions are replaced
+ * by a small reciprocal lookup table, so no floating point is needed.
+ *
+ * The hue is classified into a configurable table of hue bins, each with a
+ * confidence value and the RGB LED bitmask that represents it. Low-saturation
+ * samples are reported as achromatic.
+ */
+
+#ifndef COLOR_ANALYSIS_H
+#define COLOR_ANALYSIS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "sensors/i2c/color.h"
+
+/** @brief Maximum number of hue bins in a configuration. */
+#define COLOR_MAX_BINS 8
+
+/** @brief Fixed-point one (Q8) for normalized values. */
+#define COLOR_Q8_ONE 256
+
+/**
+ * @brief Hue bin definition.
+ *
+ * A bin covers hues in [hue_min, hue_max). If @c hue_min is greater than
+ * @c hue_max, the bin wraps around 0° (e.g. red: 330°–30°).
+ */
+struct color_bin {
+    const char *name;   /**< Printable bin name. */
+    uint16_t hue_min;   /**< First hue included (degrees, 0–359). */
+    uint16_t hue_max;   /**< First hue excluded (degrees, 1–360). */
+    uint8_t led_mask;   /**< RGB LED bitmask shown for this bin. */
+};
+
+/**
+ * @brief Color classification configuration.
+ */
+struct color_config {
+    const struct color_bin *bins;  /**< Hue bin table. */
+    size_t bin_count;              /**< Number of bins (≤ @ref COLOR_MAX_BINS). */
+    uint8_t min_saturation;        /**< Saturation (0–255) below which a sample is achromatic. */
+    const char *achromatic_name;   /**< Printable name for achromatic samples. */
+    uint8_t achromatic_led_mask;   /**< RGB LED bitmask for achromatic samples. */
+};
+
+/**
+ * @brief Result of the color analysis.
+ */
+struct color_result {
+    uint16_t norm_r;      /**< Red / clear (Q8, 256 = 100%). */
+    uint16_t norm_g;      /**< Green / clear (Q8). */
+    uint16_t norm_b;      /**< Blue / clear (Q8). */
+    uint8_t chroma_r;     /**< Red chromaticity r/(r+g+b) (Q8). */
+    uint8_t chroma_g;     /**< Green chromaticity (Q8). */
+    uint8_t chroma_b;     /**< Blue chromaticity (Q8). */
+    uint16_t hue;         /**< Hue in degrees (0–359). */
+    uint8_t saturation;   /**< Saturation (0–255). */
+    uint8_t value;        /**< Value, brightest channel / clear (0–255). */
+    uint8_t bin;          /**< Hue bin index, or @c bin_count if achromatic. */
+    uint8_t confidence;   /**< Classification confidence (0–100%). */
+};
+
+/**
+ * @brief Analyze and classify one raw color sample.
+ *
+ * @param cfg Pointer to the classification configuration.
+ * @param raw Pointer to the raw sensor channels.
+ * @param out Pointer to store the analysis result.
+ * @retval 0 On success.
+ * @retval -EINVAL If a pointer or the configuration is invalid.
+ */
+int color_analyze(const struct color_config *cfg, const ColorSensorData *raw,
+                  struct color_result *out);
+
+/**
+ * @brief Get the printable name of the bin in a result.
+ *
+ * @param cfg Pointer to the classification configuration.
+ * @param res Pointer to an analysis result.
+ * @return Bin name, or the achromatic name.
+ */
+const char *color_bin_name(const struct color_config *cfg, const struct color_result *res);
+
+/**
+ * @brief Get the RGB LED bitmask of the bin in a result.
+ *
+ * @param cfg Pointer to the classification configuration.
+ * @param res Pointer to an analysis result.
+ * @return RGB LED bitmask (bit 0 red, bit 1 green, bit 2 blue).
+ */
+uint8_t color_bin_led_mask(const struct color_config *cfg, const struct color_result *res);
+
+#endif /* COLOR_ANALYSIS_H */
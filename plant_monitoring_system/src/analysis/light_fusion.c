@@ -0,0 +1,122 @@
+/**
+ * @file light_fusion.c
+ * @brief Phototransistor / clear channel calibration and color read scheduling.
+ */
+
+#include "light_fusion.h"
+#include <zephyr/sys/printk.h>
+#include <zephyr/sys/util.h>
+#include <math.h>
+#include <string.h>
+
+#define LIGHT_FUSION_MIN_SPREAD 400.0f  /**< Brightness variance (units²) needed to fit the slope. */
+#define LIGHT_FUSION_FORGET 0.25f       /**< Weight kept by the history when the calibration restarts. */
+
+/**
+ * @brief Clear count predicted by the current fit, unclamped.
+ */
+static float light_fusion_predict(const struct light_fusion *lf, int32_t brightness)
+{
+    return lf->slope * (float)brightness + lf->offset;
+}
+
+void light_fusion_init(struct light_fusion *lf, const struct light_fusion_config *cfg)
+{
+    memset(lf, 0, sizeof(*lf));
+    lf->cfg = cfg;
+}
+
+bool light_fusion_need_color(const struct light_fusion *lf, int32_t brightness,
+                             uint32_t now_ms, uint32_t refresh_ms)
+{
+    if (refresh_ms == 0 || lf->pairs < lf->cfg->min_pairs) {
+        return true;
+    }
+    if (now_ms - lf->last_read_ms >= refresh_ms) {
+        return true;
+    }
+
+    int32_t change = brightness - lf->last_brightness;
+    int32_t limit = MAX((int32_t)lf->cfg->min_change,
+                        lf->last_brightness * lf->cfg->change_permille / 1000);
+
+    return change > limit || change < -limit;
+}
+
+/**
+ * @brief Add a pair to the calibration.
+ *
+ * Sums decay by 1 − 2^-n per pair. The slope is refitted only while the
+ * remembered brightness values are spread enough (a narrow spread, such as
+ * the noise of a dark night, gives a meaningless slope); otherwise the
+ * offset follows the pairs with the previous slope. Until a first slope is
+ * fitted the estimate holds the last clear count, which is right as long as
+ * the brightness stays within the change threshold.
+ *
+ * @param lf Fusion state.
+ * @param brightness Brightness (% × 10).
+ * @param clear Clear count.
+ * @param now_ms Uptime of the readings.
+ */
+void light_fusion_update(struct light_fusion *lf, int32_t brightness, uint16_t clear, uint32_t now_ms)
+{
+    float x = (float)brightness;
+    float y = (float)clear;
+
+    lf->reads++;
+    lf->last_brightness = brightness;
+    lf->last_read_ms = now_ms;
+
+    if (lf->fitted && lf->pairs >= lf->cfg->min_pairs) {
+        float error = fabsf(light_fusion_predict(lf, brightness) - y);
+
+        if (error * 1000.0f > (float)lf->cfg->max_error_permille * MAX(y, 1.0f)) {
+            /* Let the next pairs dominate the fit, and read until they are in */
+            lf->sw *= LIGHT_FUSION_FORGET;
+            lf->sx *= LIGHT_FUSION_FORGET;
+            lf->sy *= LIGHT_FUSION_FORGET;
+            lf->sxx *= LIGHT_FUSION_FORGET;
+            lf->sxy *= LIGHT_FUSION_FORGET;
+            lf->pairs = 0;
+            lf->recalibrations++;
+        }
+    }
+
+    float keep = 1.0f - ldexpf(1.0f, -(int)lf->cfg->weight_shift);
+
+    lf->sw = lf->sw * keep + 1.0f;
+    lf->sx = lf->sx * keep + x;
+    lf->sy = lf->sy * keep + y;
+    lf->sxx = lf->sxx * keep + x * x;
+    lf->sxy = lf->sxy * keep + x * y;
+    if (lf->pairs < UINT8_MAX) {
+        lf->pairs++;
+    }
+
+    float spread = lf->sw * lf->sxx - lf->sx * lf->sx;
+
+    if (spread > LIGHT_FUSION_MIN_SPREAD * lf->sw * lf->sw) {
+        lf->slope = (lf->sw * lf->sxy - lf->sx * lf->sy) / spread;
+        lf->offset = (lf->sy - lf->slope * lf->sx) / lf->sw;
+        lf->fitted = true;
+    } else if (lf->fitted) {
+        lf->offset = (lf->sy - lf->slope * lf->sx) / lf->sw;
+    } else {
+        lf->offset = y;
+    }
+}
+
+uint16_t light_fusion_estimate(struct light_fusion *lf, int32_t brightness)
+{
+    float y = light_fusion_predict(lf, brightness);
+
+    lf->estimates++;
+    return (uint16_t)CLAMP(y, 1.0f, (float)UINT16_MAX);
+}
+
+void light_fusion_print(const struct light_fusion *lf)
+{
+    printk("[LIGHT] - clear = %.2f x brightness %+.0f, %u color reading(s), %u estimate(s), "
+           "%u recalibration(s)\n",
+           (double)lf->slope, (double)lf->offset, lf->reads, lf->estimates, lf->recalibrations);
+}
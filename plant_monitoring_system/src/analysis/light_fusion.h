@@ -0,0 +1,104 @@
+/**
+ * @file light_fusion.h
+ * @brief Ambient light from the phototransistor, calibrated against the
+ *        color sensor's clear channel.
+ *
+ * Both sensors follow the same illuminance: the phototransistor (ADC,
+ * converted every cycle in a few microseconds) and the TCS34725 clear
+ * channel (one integration of 24–700 ms with the sensor powered). The
+ * clear count is modelled as a linear function of the brightness,
+ * @c clear = slope × brightness + offset, fitted by exponentially weighted
+ * least squares over the pairs seen when both sensors are read.
+ *
+ * Once calibrated, the color sensor only has to be read when the
+ * brightness has moved since its last reading, or when its last reading is
+ * too old; in between the clear count is estimated from the brightness.
+ * A reading that disagrees with the estimate (the sensors were moved, one
+ * of them shaded) restarts the calibration.
+ *
+ * Pure computation: no hardware access, no locking.
+ */
+
+#ifndef LIGHT_FUSION_H
+#define LIGHT_FUSION_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Thresholds of the light fusion.
+ */
+struct light_fusion_config {
+    uint16_t change_permille;     /**< Brightness change since the last color reading that triggers one (‰). */
+    uint16_t min_change;          /**< Smallest triggering change (brightness units, % × 10). */
+    uint16_t max_error_permille;  /**< Estimate error that restarts the calibration (‰ of the clear count). */
+    uint8_t min_pairs;            /**< Color readings before the estimate is used. */
+    uint8_t weight_shift;         /**< A new pair weighs 1 / 2^n of the history. */
+};
+
+/**
+ * @brief Calibration and scheduling state.
+ */
+struct light_fusion {
+    const struct light_fusion_config *cfg;  /**< Thresholds. */
+    float sw, sx, sy, sxx, sxy;             /**< Weighted sums of the pairs. */
+    float slope;                            /**< Clear counts per brightness unit. */
+    float offset;                           /**< Clear counts at zero brightness. */
+    uint8_t pairs;                          /**< Pairs since the calibration (re)started, saturating. */
+    bool fitted;                            /**< @c slope was fitted (else 0: hold the last reading). */
+    int32_t last_brightness;                /**< Brightness at the last color reading. */
+    uint32_t last_read_ms;                  /**< Uptime of the last color reading. */
+    uint32_t reads;                         /**< Color readings. */
+    uint32_t estimates;                     /**< Cycles served by the estimate. */
+    uint32_t recalibrations;                /**< Calibrations restarted by a large error. */
+};
+
+/**
+ * @brief Start an uncalibrated fusion.
+ *
+ * @param lf Fusion state.
+ * @param cfg Thresholds; must stay valid.
+ */
+void light_fusion_init(struct light_fusion *lf, const struct light_fusion_config *cfg);
+
+/**
+ * @brief Decide whether the color sensor must be read this cycle.
+ *
+ * @param lf Fusion state.
+ * @param brightness Brightness measured this cycle (% × 10).
+ * @param now_ms Current uptime.
+ * @param refresh_ms Longest time between color readings; 0 to read every cycle.
+ * @retval true If uncalibrated, the reading is older than @p refresh_ms or
+ *         the brightness changed by more than the configured threshold.
+ * @retval false If the estimate can be used.
+ */
+bool light_fusion_need_color(const struct light_fusion *lf, int32_t brightness,
+                             uint32_t now_ms, uint32_t refresh_ms);
+
+/**
+ * @brief Add a pair of simultaneous readings to the calibration.
+ *
+ * @param lf Fusion state.
+ * @param brightness Brightness (% × 10).
+ * @param clear Clear count at the reference timing.
+ * @param now_ms Uptime of the readings.
+ */
+void light_fusion_update(struct light_fusion *lf, int32_t brightness, uint16_t clear, uint32_t now_ms);
+
+/**
+ * @brief Estimate the clear count from the brightness.
+ *
+ * @param lf Calibrated fusion state.
+ * @param brightness Brightness (% × 10).
+ * @return Estimated clear count at the reference timing (1–65535).
+ */
+uint16_t light_fusion_estimate(struct light_fusion *lf, int32_t brightness);
+
+/**
+ * @brief Print the calibration and counters on one line.
+ *
+ * @param lf Fusion state.
+ */
+void light_fusion_print(const struct light_fusion *lf);
+
+#endif /* LIGHT_FUSION_H */
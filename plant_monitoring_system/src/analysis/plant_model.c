@@ -0,0 +1,211 @@
+/**
+ * @file plant_model.c
+ * @brief Int8 inference engine for the plant-health classifier.
+ *
+ * Implements quantized fully connected layers with int32 accumulation and
+ * fixed-point requantization, following the CMSIS-NN / TFLite Micro
+ * conventions: from the int8 inputs on, the layers match the training
+ * script's evaluation bit for bit. Input quantization rounds half away from
+ * zero on both sides, but in float32 here against float64 there, so an input
+ * that lands within float32 error of a .5 tie can still differ by 1 LSB.
+ */
+
+#include "plant_model.h"
+#include <errno.h>
+#include <math.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+
+#if defined(CONFIG_BOARD_NATIVE_SIM)
+#include "sim.h"
+#endif
+
+const char *plant_health_names[PLANT_MODEL_CLASSES] = {
+    "HEALTHY", "CHLOROSIS", "WATER STRESS", "LOW LIGHT"
+};
+
+/** @brief Static tensor arena holding input, hidden and output activations. */
+static int8_t arena[PLANT_MODEL_ARENA_SIZE];
+
+static int8_t *const input_tensor  = &arena[0];
+static int8_t *const hidden_tensor = &arena[PLANT_MODEL_INPUTS];
+static int8_t *const output_tensor = &arena[PLANT_MODEL_INPUTS + PLANT_MODEL_HIDDEN];
+
+/* ---------------------------------------------------------------------------
+ * Helper functions
+ * ---------------------------------------------------------------------------*/
+
+/**
+ * @brief Saturate an integer to the int8 range.
+ *
+ * @param v Value to saturate.
+ * @return Value clamped to [-128, 127].
+ */
+static int8_t sat_int8(int32_t v)
+{
+    if (v > 127) return 127;
+    if (v < -128) return -128;
+    return (int8_t)v;
+}
+
+/**
+ * @brief Rescale an int32 accumulator to int8 with a Q31 multiplier and shift.
+ *
+ * @param acc Layer accumulator.
+ * @param multiplier Q31 mantissa of the real rescale factor.
+ * @param shift Right shift of the real rescale factor (negative for left).
+ * @return Requantized int8 value.
+ */
+static int8_t requantize(int32_t acc, int32_t multiplier, int shift)
+{
+    int64_t v = acc;
+
+    if (shift < 0) {
+        v <<= -shift;
+        shift = 0;
+    }
+
+    v = (v * multiplier + (1LL << 30)) >> 31;
+
+    if (shift > 0) {
+        v = (v + (1LL << (shift - 1))) >> shift;
+    }
+
+    return sat_int8((int32_t)v);
+}
+
+/**
+ * @brief Quantized fully connected layer.
+ *
+ * @param in Input activations.
+ * @param n_in Number of inputs.
+ * @param weights Row-major weights [n_out][n_in].
+ * @param bias Int32 biases.
+ * @param n_out Number of outputs.
+ * @param multiplier Q31 requantization multiplier.
+ * @param shift Requantization shift.
+ * @param relu Apply ReLU to the outputs.
+ * @param out Output activations.
+ */
+static void fully_connected(const int8_t *in, int n_in, const int8_t *weights,
+                            const int32_t *bias, int n_out, int32_t multiplier,
+                            int shift, bool relu, int8_t *out)
+{
+    for (int o = 0; o < n_out; o++) {
+        const int8_t *w = &weights[o * n_in];
+        int32_t acc = bias[o];
+
+        for (int i = 0; i < n_in; i++) {
+            acc += (int32_t)in[i] * (int32_t)w[i];
+        }
+
+        int8_t v = requantize(acc, multiplier, shift);
+        out[o] = (relu && v < 0) ? 0 : v;
+    }
+}
+
+/**
+ * @brief Normalize and quantize the raw features into the input tensor.
+ *
+ * Color channels are converted to chromaticity (ratio to clear) so the
+ * result is independent of illumination intensity.
+ *
+ * @param in Pointer to the raw input features.
+ */
+static void quantize_input(const struct plant_features *in)
+{
+    float clear = (in->clear > 1.0f) ? in->clear : 1.0f;
+    const float values[PLANT_MODEL_INPUTS] = {
+        in->red / clear, in->green / clear, in->blue / clear, in->clear,
+        in->light, in->temp, in->hum, in->moisture,
+    };
+
+    for (int i = 0; i < PLANT_MODEL_INPUTS; i++) {
+        float q = (values[i] - plant_model.feature_offset[i]) * plant_model.feature_scale[i];
+        input_tensor[i] = sat_int8((int32_t)lroundf(q));
+    }
+}
+
+/* ---------------------------------------------------------------------------
+ * Public API
+ * ---------------------------------------------------------------------------*/
+
+/**
+ * @brief Classify the plant condition from the given features.
+ *
+ * Runs both layers in the static arena, picks the highest logit and derives
+ * a confidence from the softmax of the dequantized logits.
+ *
+ * @param in Pointer to the raw input features.
+ * @param out Pointer to store the classification result.
+ * @retval 0 On success.
+ * @retval -EINVAL If a pointer is invalid.
+ */
+int plant_model_classify(const struct plant_features *in, struct plant_result *out)
+{
+    if (!in || !out) return -EINVAL;
+
+    quantize_input(in);
+
+    fully_connected(input_tensor, PLANT_MODEL_INPUTS, plant_model.fc1_weights,
+                    plant_model.fc1_bias, PLANT_MODEL_HIDDEN,
+                    plant_model.fc1_multiplier, plant_model.fc1_shift, true, hidden_tensor);
+
+    fully_connected(hidden_tensor, PLANT_MODEL_HIDDEN, plant_model.fc2_weights,
+                    plant_model.fc2_bias, PLANT_MODEL_CLASSES,
+                    plant_model.fc2_multiplier, plant_model.fc2_shift, false, output_tensor);
+
+    int best = 0;
+    for (int c = 1; c < PLANT_MODEL_CLASSES; c++) {
+        if (output_tensor[c] > output_tensor[best]) best = c;
+    }
+
+    float sum = 0.0f;
+    for (int c = 0; c < PLANT_MODEL_CLASSES; c++) {
+        sum += expf((output_tensor[c] - output_tensor[best]) * plant_model.output_scale);
+    }
+
+    out->health = (plant_health_t)best;
+    out->confidence = (uint8_t)(100.0f / sum);
+    return 0;
+}
+
+/**
+ * @brief Measure and print inference time and memory footprint.
+ *
+ * @param iterations Number of inferences to time.
+ */
+void plant_model_benchmark(int iterations)
+{
+    const struct plant_features sample = {
+        .red = 1200.0f, .green = 1800.0f, .blue = 1000.0f, .clear = 4200.0f,
+        .light = 60.0f, .temp = 22.0f, .hum = 55.0f, .moisture = 50.0f,
+    };
+    struct plant_result result;
+
+    if (iterations <= 0) return;
+
+    /* The native_sim kernel clock is simulated and stands still while the model runs */
+#if defined(CONFIG_BOARD_NATIVE_SIM)
+    uint64_t start = sim_host_time_ns();
+#else
+    uint32_t start = k_cycle_get_32();
+#endif
+    for (int i = 0; i < iterations; i++) {
+        plant_model_classify(&sample, &result);
+    }
+#if defined(CONFIG_BOARD_NATIVE_SIM)
+    uint64_t elapsed_ns = sim_host_time_ns() - start;
+#else
+    uint64_t elapsed_ns = k_cyc_to_ns_floor64(k_cycle_get_32() - start);
+#endif
+
+    size_t params = PLANT_MODEL_HIDDEN * PLANT_MODEL_INPUTS + PLANT_MODEL_CLASSES * PLANT_MODEL_HIDDEN +
+                    (PLANT_MODEL_HIDDEN + PLANT_MODEL_CLASSES) * sizeof(int32_t) + sizeof(plant_model);
+
+    printk("[PLANT MODEL] - %d inferences: %u ns/inference, arena %u B RAM, parameters %u B flash\n",
+           iterations, (unsigned int)(elapsed_ns / (uint64_t)iterations),
+           (unsigned int)sizeof(arena), (unsigned int)params);
+    printk("[PLANT MODEL] - Benchmark sample classified as %s (%u%%)\n",
+           plant_health_names[result.health], result.confidence);
+}
@@ -0,0 +1,108 @@
+/**
+ * @file plant_model.h
+ * @brief Quantized int8 plant-health classifier.
+ *
+ * This module runs a small fully connected neural network (8 → 16 → 4) on
+ * the node to classify the plant condition from color chromaticity, clear
+ * channel, light, temperature, humidity and soil moisture features.
+ *
+ * The model uses the same arithmetic as CMSIS-NN / TFLite Micro int8 kernels:
+ * int8 weights and activations, int32 biases and accumulators, and
+ * fixed-point (Q31 multiplier + shift) requantization between layers.
+ * Activations live in a static tensor arena; no heap is used.
+ *
+ * Weights are generated by @c tools/plant_model/train.py into
+ * @c plant_model_data.c.
+ */
+
+#ifndef PLANT_MODEL_H
+#define PLANT_MODEL_H
+
+#include <stdint.h>
+
+#define PLANT_MODEL_INPUTS   8   /**< Number of input features. */
+#define PLANT_MODEL_HIDDEN   16  /**< Number of hidden neurons. */
+#define PLANT_MODEL_CLASSES  4   /**< Number of output classes. */
+
+/** @brief Size in bytes of the static activation arena. */
+#define PLANT_MODEL_ARENA_SIZE (PLANT_MODEL_INPUTS + PLANT_MODEL_HIDDEN + PLANT_MODEL_CLASSES)
+
+/**
+ * @enum plant_health_t
+ * @brief Plant condition classes predicted by the model.
+ */
+typedef enum {
+    PLANT_HEALTHY = 0,    /**< No stress detected. */
+    PLANT_CHLOROSIS,      /**< Yellowing leaves (nutrient deficiency). */
+    PLANT_WATER_STRESS,   /**< Dry soil with hot, dry air. */
+    PLANT_LOW_LIGHT       /**< Insufficient light for growth. */
+} plant_health_t;
+
+/** @brief Printable names of @ref plant_health_t values. */
+extern const char *plant_health_names[PLANT_MODEL_CLASSES];
+
+/**
+ * @brief Quantized model parameters (stored in flash).
+ */
+struct plant_model {
+    float feature_offset[PLANT_MODEL_INPUTS]; /**< Offset subtracted from each raw feature. */
+    float feature_scale[PLANT_MODEL_INPUTS];  /**< Scale mapping each feature to int8. */
+    const int8_t *fc1_weights;                /**< Hidden layer weights [HIDDEN][INPUTS]. */
+    const int32_t *fc1_bias;                  /**< Hidden layer biases. */
+    int32_t fc1_multiplier;                   /**< Hidden layer Q31 requantization multiplier. */
+    int fc1_shift;                            /**< Hidden layer requantization right shift. */
+    const int8_t *fc2_weights;                /**< Output layer weights [CLASSES][HIDDEN]. */
+    const int32_t *fc2_bias;                  /**< Output layer biases. */
+    int32_t fc2_multiplier;                   /**< Output layer Q31 requantization multiplier. */
+    int fc2_shift;                            /**< Output layer requantization right shift. */
+    float output_scale;                       /**< Scale converting int8 logits to real values. */
+};
+
+/** @brief Trained model parameters (see @c plant_model_data.c). */
+extern const struct plant_model plant_model;
+
+/**
+ * @brief Raw input features for one classification.
+ */
+struct plant_features {
+    float red;       /**< Raw red channel. */
+    float green;     /**< Raw green channel. */
+    float blue;      /**< Raw blue channel. */
+    float clear;     /**< Raw clear channel. */
+    float light;     /**< Ambient light (%). */
+    float temp;      /**< Temperature (°C). */
+    float hum;       /**< Relative humidity (%RH). */
+    float moisture;  /**< Soil moisture (%). */
+};
+
+/**
+ * @brief Classification result.
+ */
+struct plant_result {
+    plant_health_t health;  /**< Most likely class. */
+    uint8_t confidence;     /**< Softmax probability of that class (0–100%). */
+};
+
+/**
+ * @brief Classify the plant condition from the given features.
+ *
+ * @param in Pointer to the raw input features.
+ * @param out Pointer to store the classification result.
+ * @retval 0 On success.
+ * @retval -EINVAL If a pointer is invalid.
+ */
+int plant_model_classify(const struct plant_features *in, struct plant_result *out);
+
+/**
+ * @brief Measure and print inference time and memory footprint.
+ *
+ * Runs the model @p iterations times on a fixed input and prints the mean
+ * inference time, arena size (RAM) and parameter size (flash).
+ * On native_sim the time is measured with the host clock, so it is the
+ * host CPU's and says nothing of the target's.
+ *
+ * @param iterations Number of inferences to time.
+ */
+void plant_model_benchmark(int iterations);
+
+#endif /* PLANT_MODEL_H */
@@ -0,0 +1,53 @@
+/**
+ * @file plant_model_data.c
+ * @brief Quantized weights of the plant-health classifier.
+ *
+ * Generated by tools/plant_model/train.py - do not edit by hand.
+ * Int8 accuracy on the training set: 100.0%.
+ */
+
+#include "plant_model.h"
+
+static const int8_t fc1_weights[PLANT_MODEL_HIDDEN * PLANT_MODEL_INPUTS] = {
+    -11, -85, 26, -15, -11, 46, 48, 9,
+    127, -7, -94, -13, 41, -19, 20, 40,
+    -65, 42, 25, -45, 2, -14, 19, 80,
+    -16, -18, -17, 19, 22, 46, -64, -37,
+    -53, 8, -4, 18, 72, -23, 22, -20,
+    -15, -40, 1, -9, 7, -18, 28, 4,
+    44, 0, -2, -19, 18, -13, 2, -19,
+    53, 8, -27, -24, -11, -4, 7, 15,
+    26, -21, -14, 12, 25, 0, 21, 7,
+    -18, -8, 17, -76, -108, -62, 43, 9,
+    -24, -2, 5, -10, -20, 48, -57, -68,
+    -19, 3, -22, 20, 16, -20, 32, 25,
+    11, 3, -10, 32, -8, -21, -11, -11,
+    -10, -51, 23, 5, -30, -25, 27, 9,
+    -1, -8, 7, 6, -29, 10, 14, 19,
+    -28, -5, 8, -39, -36, -5, 12, -24,
+};
+
+static const int32_t fc1_bias[PLANT_MODEL_HIDDEN] = { -431, 1695, 7209, 1145, 9840, 892, -1527, -1002, 764, -5611, 1263, 1943, -2726, -511, -586, -2785 };
+
+static const int8_t fc2_weights[PLANT_MODEL_CLASSES * PLANT_MODEL_HIDDEN] = {
+    -14, -29, 65, -24, 69, 18, -9, -25, 12, -49, -41, 18, 18, 3, -9, -35,
+    -7, 127, -50, 3, -18, -4, 0, 31, 30, -10, -36, 24, -22, -7, 17, -16,
+    2, -37, -68, 69, 22, 12, -5, -3, 6, -24, 72, -5, 0, -4, -3, 3,
+    21, -38, 28, -18, -66, -3, 20, 23, 4, 108, 1, -15, 10, -16, 11, 26,
+};
+
+static const int32_t fc2_bias[PLANT_MODEL_CLASSES] = { 585, -24, 328, -889 };
+
+const struct plant_model plant_model = {
+    .feature_offset = { 0.33f, 0.33f, 0.33f, 32768.0f, 50.0f, 20.0f, 50.0f, 50.0f },
+    .feature_scale = { 635.0f, 635.0f, 635.0f, 0.00387573f, 2.54f, 4.23333f, 2.54f, 2.54f },
+    .fc1_weights = fc1_weights,
+    .fc1_bias = fc1_bias,
+    .fc1_multiplier = 1177762141,
+    .fc1_shift = 7,
+    .fc2_weights = fc2_weights,
+    .fc2_bias = fc2_bias,
+    .fc2_multiplier = 2123605450,
+    .fc2_shift = 7,
+    .output_scale = 0.161599f,
+};
@@ -0,0 +1,207 @@
+/**
+ * @file window_stats.c
+ * @brief Implementation of the sliding-window aggregates.
+ *
+ * Samples are stored in a ring buffer; the min and max deques hold ring slot
+ * indices. Because a slot is only reused after its sample has been evicted
+ * (and removed from both deques), slot indices stay unambiguous.
+ */
+
+#include "window_stats.h"
+#include <errno.h>
+#include <string.h>
+
+#define WINDOW_MASK (WINDOW_CAPACITY - 1)
+
+_Static_assert((WINDOW_CAPACITY & WINDOW_MASK) == 0 && WINDOW_CAPACITY <= 128,
+               "WINDOW_CAPACITY must be a power of two no larger than 128");
+
+/* ---------------------------------------------------------------------------
+ * Deque helpers
+ * ---------------------------------------------------------------------------*/
+
+/** @brief Ring slot at the front of the deque. */
+static inline uint8_t dq_front(const struct window_deque *dq)
+{
+    return dq->slots[dq->head];
+}
+
+/** @brief Ring slot at the back of the deque. */
+static inline uint8_t dq_back(const struct window_deque *dq)
+{
+    return dq->slots[(dq->head + dq->count - 1) & WINDOW_MASK];
+}
+
+/** @brief Remove the front element. */
+static inline void dq_pop_front(struct window_deque *dq)
+{
+    dq->head = (dq->head + 1) & WINDOW_MASK;
+    dq->count--;
+}
+
+/** @brief Append an element at the back. */
+static inline void dq_push_back(struct window_deque *dq, uint8_t slot)
+{
+    dq->slots[(dq->head + dq->count) & WINDOW_MASK] = slot;
+    dq->count++;
+}
+
+/* ---------------------------------------------------------------------------
+ * Window helpers
+ * ---------------------------------------------------------------------------*/
+
+/**
+ * @brief Remove the oldest sample from the window and both deques.
+ *
+ * @param w Pointer to the window.
+ */
+static void window_evict_oldest(struct sliding_window *w)
+{
+    uint8_t slot = w->head;
+
+    w->sum -= w->values[slot];
+
+    if (w->max_dq.count && dq_front(&w->max_dq) == slot) dq_pop_front(&w->max_dq);
+    if (w->min_dq.count && dq_front(&w->min_dq) == slot) dq_pop_front(&w->min_dq);
+
+    w->head = (w->head + 1) & WINDOW_MASK;
+    w->count--;
+}
+
+/* ---------------------------------------------------------------------------
+ * Public API
+ * ---------------------------------------------------------------------------*/
+
+/**
+ * @brief Initialize an empty window.
+ *
+ * @param w Pointer to the window.
+ * @param span_ms Window length in milliseconds.
+ */
+void window_init(struct sliding_window *w, uint32_t span_ms)
+{
+    memset(w, 0, sizeof(*w));
+    w->span_ms = span_ms;
+}
+
+/**
+ * @brief Evict samples that are older than the window span.
+ *
+ * @param w Pointer to the window.
+ * @param now_ms Current time in milliseconds.
+ */
+void window_expire(struct sliding_window *w, uint32_t now_ms)
+{
+    while (w->count && (uint32_t)(now_ms - w->times[w->head]) >= w->span_ms) {
+        window_evict_oldest(w);
+    }
+}
+
+/**
+ * @brief Shift the timestamps of every sample in the window.
+ *
+ * Only differences between timestamps are ever used, so wrapping is fine.
+ *
+ * @param w Pointer to the window.
+ * @param offset_ms Milliseconds subtracted from each timestamp.
+ */
+void window_rebase(struct sliding_window *w, uint32_t offset_ms)
+{
+    for (uint8_t i = 0; i < w->count; i++) {
+        w->times[(w->head + i) & WINDOW_MASK] -= offset_ms;
+    }
+}
+
+/**
+ * @brief Add a sample to the window.
+ *
+ * Pops dominated elements from the back of each deque before appending, so
+ * the deques stay monotonic.
+ *
+ * @param w Pointer to the window.
+ * @param now_ms Sample timestamp in milliseconds.
+ * @param value Fixed-point sample value.
+ */
+void window_push(struct sliding_window *w, uint32_t now_ms, int32_t value)
+{
+    window_expire(w, now_ms);
+
+    if (w->count == WINDOW_CAPACITY) {
+        window_evict_oldest(w);
+    }
+
+    uint8_t slot = (w->head + w->count) & WINDOW_MASK;
+    w->values[slot] = value;
+    w->times[slot] = now_ms;
+    w->count++;
+    w->sum += value;
+
+    while (w->max_dq.count && w->values[dq_back(&w->max_dq)] <= value) {
+        w->max_dq.count--;
+    }
+    dq_push_back(&w->max_dq, slot);
+
+    while (w->min_dq.count && w->values[dq_back(&w->min_dq)] >= value) {
+        w->min_dq.count--;
+    }
+    dq_push_back(&w->min_dq, slot);
+}
+
+/**
+ * @brief Get the number of samples currently in the window.
+ *
+ * @param w Pointer to the window.
+ * @return Number of samples.
+ */
+uint32_t window_count(const struct sliding_window *w)
+{
+    return w->count;
+}
+
+/**
+ * @brief Get the maximum value in the window.
+ *
+ * @param w Pointer to the window.
+ * @param out Pointer to store the maximum.
+ * @retval 0 On success.
+ * @retval -ENODATA If the window is empty.
+ */
+int window_max(const struct sliding_window *w, int32_t *out)
+{
+    if (!w->count) return -ENODATA;
+
+    *out = w->values[dq_front(&w->max_dq)];
+    return 0;
+}
+
+/**
+ * @brief Get the minimum value in the window.
+ *
+ * @param w Pointer to the window.
+ * @param out Pointer to store the minimum.
+ * @retval 0 On success.
+ * @retval -ENODATA If the window is empty.
+ */
+int window_min(const struct sliding_window *w, int32_t *out)
+{
+    if (!w->count) return -ENODATA;
+
+    *out = w->values[dq_front(&w->min_dq)];
+    return 0;
+}
+
+/**
+ * @brief Get the mean value of the window.
+ *
+ * @param w Pointer to the window.
+ * @param out Pointer to store the mean.
+ * @retval 0 On success.
+ * @retval -ENODATA If the window is empty.
+ */
+int window_mean(const struct sliding_window *w, int32_t *out)
+{
+    if (!w->count) return -ENODATA;
+
+    *out = (int32_t)(w->sum / w->count);
+    return 0;
+}
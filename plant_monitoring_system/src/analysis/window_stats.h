@@ -0,0 +1,126 @@
+/**
+ * @file window_stats.h
+ * @brief Sliding-window min/max/mean aggregates over fixed-capacity buffers.
+ *
+ * Each @ref sliding_window keeps the samples of the last @c span_ms
+ * milliseconds (bounded by @ref WINDOW_CAPACITY samples) and can be queried
+ * at any time without recomputation:
+ *  - **min/max:** monotonic deques whose front is always the extreme value;
+ *    each sample is pushed and popped at most once (amortized O(1)).
+ *  - **mean:** exact running sum of the integer samples in the window.
+ *
+ * Values are fixed-point integers (e.g. °C × 100) so the running sum never
+ * drifts. All storage is static; no dynamic memory is used.
+ */
+
+#ifndef WINDOW_STATS_H
+#define WINDOW_STATS_H
+
+#include <stdint.h>
+
+/** @brief Maximum number of samples per window (power of two, ≤ 128: counts are uint8_t). */
+#define WINDOW_CAPACITY 64
+
+/**
+ * @brief Monotonic deque of ring slot indices.
+ */
+struct window_deque {
+    uint8_t slots[WINDOW_CAPACITY];  /**< Ring slot indices, front to back. */
+    uint8_t head;                    /**< Position of the front element. */
+    uint8_t count;                   /**< Number of elements in the deque. */
+};
+
+/**
+ * @brief Sliding window over one measurement channel.
+ */
+struct sliding_window {
+    uint32_t span_ms;                   /**< Window length in milliseconds. */
+    int32_t values[WINDOW_CAPACITY];    /**< Sample ring buffer. */
+    uint32_t times[WINDOW_CAPACITY];    /**< Sample timestamps (ms, uptime). */
+    uint8_t head;                       /**< Ring slot of the oldest sample. */
+    uint8_t count;                      /**< Number of samples in the window. */
+    int64_t sum;                        /**< Running sum of the samples in the window. */
+    struct window_deque max_dq;         /**< Decreasing deque (front = max). */
+    struct window_deque min_dq;         /**< Increasing deque (front = min). */
+};
+
+/**
+ * @brief Initialize an empty window.
+ *
+ * @param w Pointer to the window.
+ * @param span_ms Window length in milliseconds.
+ */
+void window_init(struct sliding_window *w, uint32_t span_ms);
+
+/**
+ * @brief Add a sample to the window.
+ *
+ * Samples older than the window span, or the oldest sample when the buffer
+ * is full, are evicted first.
+ *
+ * @param w Pointer to the window.
+ * @param now_ms Sample timestamp in milliseconds (monotonic, may wrap).
+ * @param value Fixed-point sample value.
+ */
+void window_push(struct sliding_window *w, uint32_t now_ms, int32_t value);
+
+/**
+ * @brief Evict samples that are older than the window span.
+ *
+ * @param w Pointer to the window.
+ * @param now_ms Current time in milliseconds.
+ */
+void window_expire(struct sliding_window *w, uint32_t now_ms);
+
+/**
+ * @brief Shift the timestamps of every sample in the window.
+ *
+ * Used when samples stamped with another time base are carried over, e.g.
+ * the uptime of the previous boot after a warm reset: subtracting that
+ * boot's uptime when the samples were saved makes them exactly as old,
+ * relative to the new uptime, as they were then.
+ *
+ * @param w Pointer to the window.
+ * @param offset_ms Milliseconds subtracted from each timestamp (may wrap).
+ */
+void window_rebase(struct sliding_window *w, uint32_t offset_ms);
+
+/**
+ * @brief Get the number of samples currently in the window.
+ *
+ * @param w Pointer to the window.
+ * @return Number of samples.
+ */
+uint32_t window_count(const struct sliding_window *w);
+
+/**
+ * @brief Get the maximum value in the window.
+ *
+ * @param w Pointer to the window.
+ * @param out Pointer to store the maximum.
+ * @retval 0 On success.
+ * @retval -ENODATA If the window is empty.
+ */
+int window_max(const struct sliding_window *w, int32_t *out);
+
+/**
+ * @brief Get the minimum value in the window.
+ *
+ * @param w Pointer to the window.
+ * @param out Pointer to store the minimum.
+ * @retval 0 On success.
+ * @retval -ENODATA If the window is empty.
+ */
+int window_min(const struct sliding_window *w, int32_t *out);
+
+/**
+ * @brief Get the mean value of the window.
+ *
+ * @param w Pointer to the window.
+ * @param out Pointer to store the mean (same fixed-point scale as samples).
+ * @retval 0 On success.
+ * @retval -ENODATA If the window is empty.
+ */
+int window_mean(const struct sliding_window *w, int32_t *out);
+
+#endif /* WINDOW_STATS_H */
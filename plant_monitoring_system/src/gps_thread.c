@@ -52,7 +52,7 @@ static void read_gps_data(gps_data_t *data,
 
         /* Parse UTC time in HHMMSS format */
         if (strlen(data->utc_time) >= 6) {
-            int hh = (data->utc_time[0] - '0') * 10 + (data->utc_time[1] - '0') + 1;
+            int hh = (data->utc_time[0] - '0') * 10 + (data->utc_time[1] - '0');
             int mm = (data->utc_time[2] - '0') * 10 + (data->utc_time[3] - '0');
             int ss = (data->utc_time[4] - '0') * 10 + (data->utc_time[5] - '0');
 
@@ -10,41 +10,156 @@
  * ## Operating Modes:
  * - **TEST_MODE:** RGB LED shows the dominant color detected.
  * - **NORMAL_MODE:** Periodic measurements; RGB LED alerts if any sensor
- *   is out of range.
+ *   is out of range. Only anomalous samples and periodic summaries are reported.
+ *   Once the GPS has given the time, reports are sent in the node's uplink
+ *   slot and each measurement runs just before it (see tdma.h).
  * - **ADVANCED_MODE:** Periodic measurements; RGB LED shows real color.
  *
  * ## Button Behavior:
  * - Toggles between TEST, NORMAL, and ADVANCED modes with each press.
+ *
+ * ## Warm Restart:
+ * - The mode, statistics windows, anomaly baselines, telemetry sequence and
+ *   last GPS fix are kept in retained RAM and restored after a reset.
+ * - At boot, EPO orbit predictions stored in flash and the last position and
+ *   time are sent to the GPS to shorten its time to first fix.
+ *
+ * ## Energy Tiers:
+ * - The battery is measured periodically and, as its charge drops, GPS
+ *   fixes, LED effects, precise sensor profiles and routine reports are
+ *   cut back in steps (see power_tiers).
+ *
+ * ## History Export:
+ * - Every transmitted frame is also kept in a flash ring, which the host
+ *   reads in bulk over the console UART with @c plant_tsdb @c export (see
+ *   history.h and history_export.h).
+ *
+ * ## Firmware Update:
+ * - Delta patches against the running image arrive over the same link and
+ *   are applied into the update slot; with MCUboot the node then reboots
+ *   into the new image, which confirms itself once it has reported its
+ *   first sample (see dfu.h).
  */
 
 #include <zephyr/kernel.h>
 #include <zephyr/sys/printk.h>
 #include <math.h>
+#include <string.h>
 
 #include "main.h"
 #include "sensors_thread.h"
+#include "sensor_cache.h"
+#include "sensors/i2c/i2c_arbiter.h"
 #include "gps_thread.h"
+#include "analysis/anomaly.h"
+#include "analysis/plant_model.h"
+#include "analysis/color_analysis.h"
+#include "analysis/window_stats.h"
+#include "telemetry/uplink.h"
+#include "telemetry/tdma.h"
+#include "telemetry/history.h"
+#include "telemetry/history_export.h"
+#include "update/dfu.h"
+#include "power/energy.h"
+#include "pipeline/pipeline.h"
+#include "power/retained.h"
+#include "power/supply.h"
+#include "power/governor.h"
+#include "gps_epo.h"
+
+#if defined(CONFIG_HWINFO)
+#include <zephyr/drivers/hwinfo.h>
+#endif
+
+#if defined(CONFIG_BOARD_NATIVE_SIM)
+#include "sim/sim.h"
+#endif
 
 /* --- Main Configuration -------------------------------------------------------- */
 #define INITIAL_MODE TEST_MODE  /**< Initial operating mode at startup. */
 
 #define TEST_PERIOD 2000      /**< Test mode measurement period in milliseconds. */
 #define NORMAL_PERIOD 60000    /**< Normal mode measurement period in milliseconds. */
+#define SAMPLE_MAX_AGE_MS 0    /**< Age of the sensor values a measurement cycle accepts (0 = read anew). */
 
 #define RGB_TIMER_PERIOD 500 /**< RGB LED timer period in milliseconds. */
 #define STATS_TIMER_PERIOD 3600000 /**< Statistics reporting period (ms). */
+#define STATS_WINDOW_PERIOD 3600000 /**< Sliding window length of the statistics (ms). */
+#define STATS_SCALE 100.0f          /**< Fixed-point scale of the windowed samples. */
+#define SUMMARY_SAMPLES 15         /**< NORMAL_MODE samples between routine summary reports. */
 
 #define PWM_STEP    1              /**< PWM step in milliseconds. */
 #define PWM_PERIOD  15             /**< PWM period in milliseconds. */
 #define PWM_STEPS   (PWM_PERIOD / PWM_STEP) /**< Number of PWM steps per period. */
 
+#define PLANT_MODEL_BENCH_RUNS 1000 /**< Inferences timed by the native_sim benchmark. */
+
+/* --- Reporting pipeline ------------------------------------------------------ */
+#define LOG_QUEUE_LEN       4                  /**< Samples waiting to be printed. */
+#define LOG_QUEUE_POLICY    STAGE_DROP_OLDEST  /**< Overflow policy of the log stage. */
+#define UPLINK_QUEUE_LEN    4                  /**< Samples waiting to be transmitted. */
+#define UPLINK_QUEUE_POLICY STAGE_COALESCE     /**< Overflow policy of the uplink stage. */
+#define HISTORY_QUEUE_LEN    4                 /**< Transmitted samples waiting to be stored. */
+#define HISTORY_QUEUE_POLICY STAGE_DROP_OLDEST /**< Overflow policy of the history stage. */
+#define QUEUE_DOWNSAMPLE    2                  /**< Keep 1 in N samples with STAGE_DOWNSAMPLE. */
+/** Sample buffers: every queue slot, the uplink's coalesced sample, one per stage and the one being filled. */
+#define RECORD_POOL_BUFS    (LOG_QUEUE_LEN + UPLINK_QUEUE_LEN + HISTORY_QUEUE_LEN + 5)
+
+/* --- Energy model ----------------------------------------------------------- */
+#define ENERGY_REPORT_PERIOD 86400000 /**< Energy estimate reporting period (ms). */
+
+/* Datasheet typical values. The idle floor is the MCU in Stop 2 plus the
+ * sensors that stay enabled between samples (MMA8451Q at its awake rate in
+ * ADVANCED_MODE, Si7021 in standby); the TCS34725 is a rail of its own
+ * since it sleeps between readings outside TEST_MODE. */
+#define ENERGY_IDLE_UA      45     /**< STM32WL Stop 2 ~1 uA + MMA8451Q 44 uA. */
+#define ENERGY_CPU_UA       3000   /**< STM32WL Run mode at 48 MHz. */
+#define ENERGY_I2C_UA       1500   /**< MCU Sleep + I2C peripheral + pull-ups while the bus is busy. */
+#define ENERGY_ADC_UA       1200   /**< MCU Sleep + ADC and internal reference. */
+#define ENERGY_UART_RX_UA   1000   /**< MCU held in Sleep while a sentence is received. */
+#define ENERGY_GPS_UA       20000  /**< GPS module tracking. */
+#define ENERGY_RGB_LED_UA   10000  /**< Per RGB LED channel. */
+#define ENERGY_BOARD_LED_UA 3000   /**< Per board LED. */
+#define ENERGY_COLOR_UA     235    /**< Per TCS34725 powered with the ADC enabled (2.5 uA asleep). */
+
+/* CPU time charged per activity where it cannot be measured (native_sim) */
+#define ENERGY_CPU_SAMPLE_US 3000  /**< One measurement cycle, analysis and report. */
+#define ENERGY_CPU_WAKE_US   20    /**< One ADVANCED_MODE PWM step. */
+
+/* Energy governor (src/power/governor.c): battery described by the plant,battery node */
+#define GOVERNOR_PERIOD      300000 /**< Battery measurement period (ms). */
+#define BATTERY_VOLTAGE_SHIFT 3     /**< A measurement closes 1/8 of the gap between counter and voltage. */
+#define BATTERY_HARVEST_SHIFT 2     /**< Harvest and load averages over ~4 measurements. */
+#define TIER_HYSTERESIS      5      /**< Charge above a tier threshold needed to move up (%). */
+#define VDDA_MIN_MV          2100   /**< Supply that forces SURVIVAL (STM32WL brown-out at ~1.8 V). */
+
+/* --- Uplink slots (src/telemetry/tdma.c), NORMAL_MODE ------------------------ */
+#define UPLINK_SLOTS   true  /**< Send in GPS-timed slots; false = on the free-running timer. */
+#define UPLINK_SLOT_MS 500   /**< ~370 ms frame at SF9/125 kHz plus the guard for the time error. */
+#define UPLINK_LEAD_MS 2000  /**< Acquisition before the slot: GPS sentence wait, color integration. */
+#define UPLINK_FRAME_MS 370  /**< Time on air of a frame at SF9/125 kHz. */
+#define UPLINK_CLOCK_PPM 20  /**< MCU clock error bound between fixes (HSE/LSE crystal). */
+/** Fix age at which two nodes drifting apart may use up the slot guard: ~54 min. */
+#define UPLINK_MAX_FIX_AGE_MS \
+    ((uint32_t)((UPLINK_SLOT_MS - UPLINK_FRAME_MS) / 2 * 1000000LL / UPLINK_CLOCK_PPM))
+
 /* --- Sensors Configuration -------------------------------------------------------- */
 #define ACCEL_RANGE ACCEL_2G    /**< Accelerometer full-scale range setting. */
+#define ACCEL_SLEEP_AFTER_MS 10000 /**< ADVANCED_MODE time without motion before the accelerometer sleeps. */
+#define ACCEL_WAKE_MG        250   /**< ADVANCED_MODE motion (mg) that wakes the accelerometer. */
+
+#define GPS_EPO_MAX_SETS 4       /**< EPO sets (6 h of orbits each) sent to the GPS at boot. */
 
-#define COLOR_GAIN GAIN_4X      /**< Color sensor gain setting. */
-#define COLOR_INTEGRATION_TIME INTEGRATION_154MS /**< Color sensor integration time in milliseconds. */ 
+#define LIGHT_CHANGE_PERMILLE 150  /**< Brightness change (‰) that triggers a color reading. */
+#define LIGHT_MIN_CHANGE      20   /**< Smallest triggering brightness change (2 %). */
+#define LIGHT_MAX_ERROR       100  /**< Clear estimate error (‰) that restarts the calibration. */
+#define LIGHT_MIN_PAIRS       4    /**< Color readings before the estimate is used. */
+#define LIGHT_WEIGHT_SHIFT    4    /**< Calibration memory: a new pair weighs 1/16. */
 
-#define TEMP_HUM_RESOLUTION TH_RES_RH12_TEMP14  /**< Temperature and humidity sensor resolution setting. */
+#define COLOR_MIN_SATURATION 40  /**< Saturation (0–255) below which a color is achromatic. */
+
+/* Resolution, integration time, oversampling and power mode of each sensor
+ * are set per system mode, see sensor_profiles. */
 
 /* --- Measurement Limits --------------------------------------------------- */
 #define TEMP_MIN   -10   /**< Minimum temperature in °C. */
@@ -65,6 +180,15 @@
 #define ACCEL_MIN  -2    /**< Minimum acceleration in g. */
 #define ACCEL_MAX   2    /**< Maximum acceleration in g. */
 
+/* --- Anomaly detection ---------------------------------------------------- */
+#define ANOMALY_ALPHA           0.1f  /**< EWMA smoothing factor for running mean/variance. */
+#define ANOMALY_SEASONAL_ALPHA  0.2f  /**< EWMA smoothing factor for hourly baselines. */
+#define ANOMALY_Z_THRESHOLD     3.0f  /**< Residual threshold in standard deviations. */
+#define ANOMALY_MIN_STD         0.5f  /**< Standard deviation floor (°C, %). */
+#define ANOMALY_WARMUP          10    /**< Samples before a detector may raise alarms. */
+#define ANOMALY_CUSUM_DRIFT     1.0f  /**< Moisture change tolerated per sample (%). */
+#define ANOMALY_CUSUM_THRESHOLD 8.0f  /**< Accumulated moisture change that triggers an event (%). */
+
 /* --- Flags -------------------------------------------------------------------- */
 #define FLAG_TEMP     (1U << 0)
 #define FLAG_HUM      (1U << 1)
@@ -74,61 +198,104 @@
 #define FLAG_ACCEL    (1U << 5)
 
 /* --- Peripheral configuration ------------------------------------------------ */
-/**
- * @brief Phototransistor ADC configuration.
+/*
+ * Sensors are described in devicetree (boards/<board>.overlay, bindings in
+ * dts/bindings) and the tables below are generated from it at compile time
+ * into flash: adding a sensor is a devicetree change only.
  */
-static struct adc_config pt = {
-    .dev = DEVICE_DT_GET(DT_NODELABEL(adc1)),
-    .channel_id = 5,
-    .resolution = 12,
-    .gain = ADC_GAIN_1,
-    .ref = ADC_REF_INTERNAL,
-    .acquisition_time = ADC_ACQ_TIME_DEFAULT,
-    .vref_mv = 3300,
-};
+
+/** @brief ADC channel configuration of a plant,light-sensor or plant,soil-probe node. */
+#define ADC_CONFIG_DT(node)                                         \
+    {                                                               \
+        .dev = DEVICE_DT_GET(DT_IO_CHANNELS_CTLR(node)),            \
+        .channel_id = DT_IO_CHANNELS_INPUT(node),                   \
+        .resolution = DT_PROP(node, resolution),                    \
+        .gain = ADC_GAIN_1,                                         \
+        .ref = ADC_REF_INTERNAL,                                    \
+        .acquisition_time = ADC_ACQ_TIME_DEFAULT,                   \
+        .vref_mv = DT_PROP(node, vref_mv),                          \
+        .full_scale = BIT(DT_PROP(node, resolution)) - 1,           \
+    }
+
+/** @brief Comma-terminated @ref ADC_CONFIG_DT, for DT_FOREACH_STATUS_OKAY. */
+#define ADC_CONFIG_DT_ENTRY(node) ADC_CONFIG_DT(node),
+
+BUILD_ASSERT(DT_HAS_COMPAT_STATUS_OKAY(plant_light_sensor), "No plant,light-sensor node in devicetree");
 
 /**
- * @brief Soil moisture ADC configuration.
+ * @brief Phototransistor ADC configuration (first plant,light-sensor node).
  */
-static struct adc_config sm = {
-    .dev = DEVICE_DT_GET(DT_NODELABEL(adc1)),
-    .channel_id = 0,
-    .resolution = 12,
-    .gain = ADC_GAIN_1,
-    .ref = ADC_REF_INTERNAL,
-    .acquisition_time = ADC_ACQ_TIME_DEFAULT,
-    .vref_mv = 3300,
-};
+static const struct adc_config pt = ADC_CONFIG_DT(DT_INST(0, plant_light_sensor));
 
 /**
- * @brief Accelerometer I2C configuration.
+ * @brief Soil moisture probe ADC configurations, one per plant,soil-probe node.
+ *
+ * All probes are converted in the same scan sequence as the phototransistor,
+ * so they must share its ADC device and resolution.
  */
-static struct i2c_dt_spec accel = {
-    .bus = DEVICE_DT_GET(DT_NODELABEL(i2c2)),
-    .addr = ACCEL_I2C_ADDR,
+static const struct adc_config soil_probes[] = {
+    DT_FOREACH_STATUS_OKAY(plant_soil_probe, ADC_CONFIG_DT_ENTRY)
 };
+BUILD_ASSERT(ARRAY_SIZE(soil_probes) <= MAX_SOIL_PROBES, "Too many soil moisture probes");
+
+/** @brief Sensor slot of instance @p i of an I2C sensor compatible. */
+#define I2C_SLOT_DT(i, compat, sensor_type)                                         \
+    {                                                                               \
+        .type = (sensor_type),                                                      \
+        .instance = (i),                                                            \
+        .mux_channel = DT_PROP_OR(DT_INST(i, compat), mux_channel, I2C_MUX_NONE),   \
+        .spec = I2C_DT_SPEC_GET(DT_INST(i, compat)),                                \
+    }
+
+/** @brief Sensor slots of every enabled node of an I2C sensor compatible. */
+#define I2C_SLOTS_DT(compat, sensor_type) \
+    LISTIFY(DT_NUM_INST_STATUS_OKAY(compat), I2C_SLOT_DT, (,), compat, sensor_type)
+
+BUILD_ASSERT(DT_NUM_INST_STATUS_OKAY(plant_mma8451q) >= 1 &&
+             DT_NUM_INST_STATUS_OKAY(plant_si7021) >= 1 &&
+             DT_NUM_INST_STATUS_OKAY(plant_tcs34725) >= 1,
+             "Every I2C sensor type needs a primary instance in devicetree");
+BUILD_ASSERT(DT_NUM_INST_STATUS_OKAY(plant_mma8451q) <= MAX_SENSOR_INSTANCES &&
+             DT_NUM_INST_STATUS_OKAY(plant_si7021) <= MAX_SENSOR_INSTANCES &&
+             DT_NUM_INST_STATUS_OKAY(plant_tcs34725) <= MAX_SENSOR_INSTANCES,
+             "Too many instances of an I2C sensor type");
 
 /**
- * @brief Temperature and humidity sensor I2C configuration.
+ * @brief I2C sensor instances, from the plant,mma8451q, plant,si7021 and
+ * plant,tcs34725 nodes.
+ *
+ * Sensors sharing a fixed address must sit on different multiplexer
+ * channels (@c mux-channel). Instance 0 of each type, the first node in
+ * devicetree order, is the primary sensor used by the analysis code.
  */
-static struct i2c_dt_spec th = {
-    .bus = DEVICE_DT_GET(DT_NODELABEL(i2c2)),
-    .addr = TH_I2C_ADDR,
+static const struct i2c_sensor_slot i2c_sensors[] = {
+    I2C_SLOTS_DT(plant_mma8451q, SENSOR_ACCEL),
+    I2C_SLOTS_DT(plant_si7021, SENSOR_TEMP_HUM),
+    I2C_SLOTS_DT(plant_tcs34725, SENSOR_COLOR),
 };
+BUILD_ASSERT(ARRAY_SIZE(i2c_sensors) <= MAX_I2C_SENSORS, "Too many I2C sensors");
 
+#if DT_HAS_COMPAT_STATUS_OKAY(plant_tca9548a)
 /**
- * @brief Color sensor I2C configuration.
+ * @brief TCA9548A I2C multiplexer (first enabled plant,tca9548a node).
  */
-static struct i2c_dt_spec color = {
-    .bus = DEVICE_DT_GET(DT_NODELABEL(i2c2)),
-    .addr = COLOR_I2C_ADDR,
+static struct i2c_mux mux = {
+    .spec = I2C_DT_SPEC_GET(DT_INST(0, plant_tca9548a)),
+    .channel = I2C_MUX_NONE,
 };
+#define I2C_MUX_INSTANCE (&mux)
+#else
+#define I2C_MUX_INSTANCE NULL
+#endif
+
+/** @brief Bus client of the main thread, once the sensors thread runs. */
+static struct i2c_client main_i2c = I2C_CLIENT_INIT("main", CONFIG_MAIN_THREAD_PRIORITY);
 
 /**
- * @brief GPS UART configuration.
+ * @brief GPS UART configuration (chosen plant,gps-uart).
  */
-static struct gps_config gps = {
-    .dev = DEVICE_DT_GET(DT_NODELABEL(usart1)),
+static const struct gps_config gps = {
+    .dev = DEVICE_DT_GET(DT_CHOSEN(plant_gps_uart)),
 };
 
 /**
@@ -162,11 +329,92 @@ static struct user_button button = {
     .spec = GPIO_DT_SPEC_GET(DT_ALIAS(sw0), gpios),
 };
 
+/**
+ * @brief Current model used by the energy estimator.
+ */
+static const struct energy_model energy_model = {
+    .idle_ua = ENERGY_IDLE_UA,
+    .active_ua = {
+        [ENERGY_CPU] = ENERGY_CPU_UA,
+        [ENERGY_I2C] = ENERGY_I2C_UA,
+        [ENERGY_ADC] = ENERGY_ADC_UA,
+        [ENERGY_UART_RX] = ENERGY_UART_RX_UA,
+        [ENERGY_GPS] = ENERGY_GPS_UA,
+        [ENERGY_RGB_LED] = ENERGY_RGB_LED_UA,
+        [ENERGY_BOARD_LED] = ENERGY_BOARD_LED_UA,
+        [ENERGY_COLOR] = ENERGY_COLOR_UA,
+    },
+};
+
+#define BATTERY_NODE DT_INST(0, plant_battery)
+#define BATTERY_FITTED DT_NODE_HAS_STATUS(BATTERY_NODE, okay)
+
+#if BATTERY_FITTED
+#define BATTERY_OCV_POINT(node, prop, idx) { .mv = DT_PROP_BY_IDX(node, prop, idx), .soc = (idx) * 10 },
+
+/**
+ * @brief Open-circuit voltage of the battery, from its devicetree node.
+ */
+static const struct governor_ocv_point battery_ocv[] = {
+    DT_FOREACH_PROP_ELEM(BATTERY_NODE, ocv_mv, BATTERY_OCV_POINT)
+};
+BUILD_ASSERT(ARRAY_SIZE(battery_ocv) == 11, "ocv-mv needs 11 points, 0 to 100 %");
+BUILD_ASSERT(DT_PROP_BY_IDX(BATTERY_NODE, ocv_mv, 10) <= 3600, "The VBAT pin takes at most 3.6 V");
+#endif
+
+/**
+ * @brief Energy tiers, most generous first.
+ *
+ * FULL is the behaviour of the modes as designed. ECO keeps every feature
+ * but tracks the GPS for one fix in ten cycles (the module stays in
+ * standby in between, saving most of its 20 mA) and halves the routine
+ * summaries. SAVER also turns the LEDs off and runs every mode with the
+ * low-power sensor profile. SURVIVAL keeps the GPS in standby and only
+ * measures and reports, so the node degrades instead of browning out.
+ * Anomalies are reported in every tier.
+ */
+static const struct governor_tier power_tiers[] = {
+    { .name = "FULL",     .min_soc = 60, .gps_every = 1,  .leds = true,  .report_scale = 1 },
+    { .name = "ECO",      .min_soc = 35, .gps_every = 10, .leds = true,  .report_scale = 2 },
+    { .name = "SAVER",    .min_soc = 15, .gps_every = 60, .leds = false, .report_scale = 4,
+      .saver_profile = true },
+    { .name = "SURVIVAL", .min_soc = 0,  .gps_every = 0,  .leds = false, .report_scale = 8,
+      .saver_profile = true },
+};
+
+/**
+ * @brief Energy governor configuration.
+ */
+static const struct governor_config governor_cfg = {
+#if BATTERY_FITTED
+    .ocv = battery_ocv,
+    .ocv_count = ARRAY_SIZE(battery_ocv),
+    .capacity_mah = DT_PROP(BATTERY_NODE, capacity_mah),
+#endif
+    .voltage_shift = BATTERY_VOLTAGE_SHIFT,
+    .harvest_shift = BATTERY_HARVEST_SHIFT,
+    .hysteresis = TIER_HYSTERESIS,
+    .vdda_min_mv = VDDA_MIN_MV,
+    .tiers = power_tiers,
+    .tier_count = ARRAY_SIZE(power_tiers),
+};
+BUILD_ASSERT(ARRAY_SIZE(power_tiers) <= GOVERNOR_MAX_TIERS, "Too many energy tiers");
+
+/**
+ * @brief Uplink slots: NORMAL_MODE cycles aligned on UTC, one slot per node.
+ */
+static const struct tdma_config tdma_cfg = {
+    .cycle_ms = NORMAL_PERIOD,
+    .slot_ms = UPLINK_SLOT_MS,
+    .lead_ms = UPLINK_LEAD_MS,
+};
+BUILD_ASSERT(NORMAL_PERIOD % UPLINK_SLOT_MS == 0, "Slots must divide the NORMAL_MODE period");
+BUILD_ASSERT(UPLINK_LEAD_MS + UPLINK_SLOT_MS < NORMAL_PERIOD, "Acquisition lead longer than a cycle");
+BUILD_ASSERT(UPLINK_FRAME_MS < UPLINK_SLOT_MS, "No guard left in the uplink slot");
+
 /* --- Semaphores ----------------------------------------------------------- */
 static K_SEM_DEFINE(main_sem, 0, 1);
-static K_SEM_DEFINE(main_sensors_sem, 0, 1);
 static K_SEM_DEFINE(main_gps_sem, 0, 1);
-static K_SEM_DEFINE(sensors_sem, 0, 1);
 static K_SEM_DEFINE(gps_sem, 0, 1);
 
 /* --- Data ----------------------------------------------------------------- */
@@ -187,16 +435,138 @@ typedef enum {
 } system_mode_t;
 
 /**
- * @enum dom_color_t
- * @brief Dominant color types. 
+ * @brief Measurement precision and power settings of every sensor.
  */
-typedef enum {
-    DOM_RED,
-    DOM_GREEN,
-    DOM_BLUE
-} dom_color_t;
+struct sensor_profile {
+    const char *name;                    /**< Name used in reports. */
+    struct accel_power_config accel;     /**< Accelerometer data rate, oversampling and auto-sleep. */
+    uint8_t temp_hum_resolution;         /**< Temperature and humidity resolution (TH_RES_*). */
+    uint8_t color_gain;                  /**< Color sensor gain (GAIN_*). */
+    uint8_t color_atime;                 /**< Color sensor integration time (INTEGRATION_*). */
+    uint8_t adc_oversampling;            /**< ADC oversampling ratio exponent (2^n samples). */
+    uint32_t color_refresh_ms;           /**< Longest time between color readings; 0 = every cycle. */
+};
 
-const char* dom_color_names[] = { "RED", "GREEN", "BLUE" };
+/**
+ * @brief Sensor profile of each system mode.
+ *
+ * TEST_MODE samples every 2 s and favours short conversions: Si7021 at
+ * RH 8 / T 12 bits (~5 ms instead of ~17 ms), 24 ms color integration,
+ * single ADC conversions. NORMAL_MODE samples once a minute and takes the
+ * most precise readings: full Si7021 resolution, 700 ms color integration
+ * and 16x ADC oversampling, with the accelerometer at its slowest rate
+ * (1.56 Hz low power, ~6 uA instead of 165 uA at 800 Hz). ADVANCED_MODE
+ * keeps the reference color timing for the RGB LED and samples motion fast
+ * while the plant is handled, falling back to the NORMAL_MODE rate once it
+ * has been still for a while.
+ *
+ * Color gains and integration times keep the same full scale once rescaled
+ * to the reference timing (@ref color_rescale). TEST_MODE reads the color
+ * sensor every cycle for the RGB LED; the other modes read it when the
+ * light changes or the reading gets old, and estimate the clear channel
+ * from the phototransistor in between (@ref light_fusion.h).
+ */
+static const struct sensor_profile sensor_profiles[] = {
+    [TEST_MODE] = {
+        .name = "TEST",
+        .accel = {
+            .odr = ACCEL_ODR_50HZ,
+            .mods = ACCEL_MODS_NORMAL,
+        },
+        .temp_hum_resolution = TH_RES_RH8_TEMP12,
+        .color_gain = GAIN_4X,
+        .color_atime = INTEGRATION_24MS,
+        .adc_oversampling = 0,
+        .color_refresh_ms = 0,
+    },
+    [NORMAL_MODE] = {
+        .name = "NORMAL",
+        .accel = {
+            .odr = ACCEL_ODR_1_56HZ,
+            .mods = ACCEL_MODS_LOW_POWER,
+        },
+        .temp_hum_resolution = TH_RES_RH12_TEMP14,
+        .color_gain = GAIN_1X,
+        .color_atime = INTEGRATION_700MS,
+        .adc_oversampling = 4,
+        .color_refresh_ms = 15 * 60 * 1000,
+    },
+    [ADVANCED_MODE] = {
+        .name = "ADVANCED",
+        .accel = {
+            .odr = ACCEL_ODR_100HZ,
+            .mods = ACCEL_MODS_NORMAL,
+            .auto_sleep = true,
+            .sleep_rate = ACCEL_ASLP_1_56HZ,
+            .sleep_mods = ACCEL_MODS_LOW_POWER,
+            .sleep_after_ms = ACCEL_SLEEP_AFTER_MS,
+            .wake_mg = ACCEL_WAKE_MG,
+        },
+        .temp_hum_resolution = TH_RES_RH12_TEMP14,
+        .color_gain = COLOR_REF_GAIN,
+        .color_atime = COLOR_REF_ATIME,
+        .adc_oversampling = 2,
+        .color_refresh_ms = 5 * 60 * 1000,
+    },
+};
+
+/**
+ * @brief Sensor profile of the SAVER and SURVIVAL energy tiers, in every mode.
+ *
+ * Shortest conversions and slowest rates: Si7021 at RH 8 / T 12 bits, the
+ * TEST_MODE color timing read at most every 30 min (estimated from the
+ * phototransistor in between), single ADC conversions and the
+ * accelerometer at 1.56 Hz in low power.
+ */
+static const struct sensor_profile saver_sensor_profile = {
+    .name = "SAVER",
+    .accel = {
+        .odr = ACCEL_ODR_1_56HZ,
+        .mods = ACCEL_MODS_LOW_POWER,
+    },
+    .temp_hum_resolution = TH_RES_RH8_TEMP12,
+    .color_gain = GAIN_4X,
+    .color_atime = INTEGRATION_24MS,
+    .adc_oversampling = 0,
+    .color_refresh_ms = 30 * 60 * 1000,
+};
+
+/**
+ * @brief Hue bins used to classify the detected color.
+ */
+static const struct color_bin color_bins[] = {
+    { .name = "RED",     .hue_min = 330, .hue_max = 30,  .led_mask = 0x1 },
+    { .name = "YELLOW",  .hue_min = 30,  .hue_max = 90,  .led_mask = 0x3 },
+    { .name = "GREEN",   .hue_min = 90,  .hue_max = 150, .led_mask = 0x2 },
+    { .name = "CYAN",    .hue_min = 150, .hue_max = 210, .led_mask = 0x6 },
+    { .name = "BLUE",    .hue_min = 210, .hue_max = 270, .led_mask = 0x4 },
+    { .name = "MAGENTA", .hue_min = 270, .hue_max = 330, .led_mask = 0x5 },
+};
+
+/**
+ * @brief Color classification configuration.
+ */
+static const struct color_config color_cfg = {
+    .bins = color_bins,
+    .bin_count = ARRAY_SIZE(color_bins),
+    .min_saturation = COLOR_MIN_SATURATION,
+    .achromatic_name = "WHITE",
+    .achromatic_led_mask = 0x7,
+};
+
+/**
+ * @brief Light fusion thresholds.
+ */
+static const struct light_fusion_config light_fusion_cfg = {
+    .change_permille = LIGHT_CHANGE_PERMILLE,
+    .min_change = LIGHT_MIN_CHANGE,
+    .max_error_permille = LIGHT_MAX_ERROR,
+    .min_pairs = LIGHT_MIN_PAIRS,
+    .weight_shift = LIGHT_WEIGHT_SHIFT,
+};
+
+/** @brief Phototransistor / clear channel calibration, updated by the sensors thread. */
+static struct light_fusion light_fusion;
 
 /**
  * @brief Shared system context.
@@ -207,15 +577,15 @@ const char* dom_color_names[] = { "RED", "GREEN", "BLUE" };
  */
 static struct system_context ctx = {
     .phototransistor = &pt,
-    .soil_moisture = &sm,
-    .accelerometer = &accel,
+    .soil_probes = soil_probes,
+    .soil_probe_count = ARRAY_SIZE(soil_probes),
+    .i2c_mux = I2C_MUX_INSTANCE,
+    .i2c_sensors = i2c_sensors,
+    .i2c_sensor_count = ARRAY_SIZE(i2c_sensors),
     .accel_range = ACCEL_RANGE,
-    .temp_hum = &th,
-    .color = &color,
+    .light_fusion = &light_fusion,
     .gps = &gps,
-    .main_sensors_sem = &main_sensors_sem,
     .main_gps_sem = &main_gps_sem,
-    .sensors_sem = &sensors_sem,
     .gps_sem = &gps_sem,
 };
 
@@ -265,7 +635,8 @@ struct main_measurement {
     float c, r, g, b;
     char ns;
     char ew;
-    dom_color_t dom_color;
+    struct color_result color;
+    struct plant_result health;
     atomic_t rgb_flags;
 };
 
@@ -295,22 +666,67 @@ static struct main_measurement main_data = {
     .g = 0,
     .ns = '\0',
     .ew = '\0',
-    .dom_color = DOM_RED,
+    .color = {0},
+    .health = { .health = PLANT_HEALTHY, .confidence = 0 },
     .rgb_flags = ATOMIC_INIT(0),
 };
 
+/**
+ * @brief One reported sample, as passed along the reporting pipeline.
+ *
+ * main() acquires and analyses the sample into a pool buffer and hands the
+ * same buffer to both stages: the log stage prints @c view and the uplink
+ * stage transmits @c frame, without holding up acquisition.
+ */
+struct sample_record {
+    struct telemetry_frame frame;            /**< Uplink frame, stamped at acquisition. */
+    struct main_measurement view;            /**< Values as displayed. */
+    int32_t probes[MAX_SOIL_PROBES];         /**< Soil moisture per probe (% ×10). */
+};
+
+BUF_POOL_DEFINE(record_pool, sizeof(struct sample_record), RECORD_POOL_BUFS);
+
+/**
+ * @brief Merges a newer sample into one waiting for the uplink.
+ *
+ * The newest values win, but anomaly flags raised by the older sample are
+ * kept so an alarm is never lost to coalescing. The newer sample may be
+ * shared with the log stage; only its frame is written, which the log
+ * stage does not read.
+ *
+ * @param older Sample waiting in the queue.
+ * @param newer Sample being pushed.
+ * @return The newer sample.
+ */
+static void *record_coalesce(void *older, void *newer)
+{
+    const struct sample_record *old_rec = older;
+    struct sample_record *new_rec = newer;
+
+    new_rec->frame.anomaly |= old_rec->frame.anomaly;
+    return newer;
+}
+
+STAGE_QUEUE_DEFINE(log_queue, LOG_QUEUE_LEN, LOG_QUEUE_POLICY, QUEUE_DOWNSAMPLE, record_coalesce);
+STAGE_QUEUE_DEFINE(uplink_queue, UPLINK_QUEUE_LEN, UPLINK_QUEUE_POLICY, QUEUE_DOWNSAMPLE, record_coalesce);
+STAGE_QUEUE_DEFINE(history_queue, HISTORY_QUEUE_LEN, HISTORY_QUEUE_POLICY, QUEUE_DOWNSAMPLE, NULL);
+
 /**
  * @brief Statistics data structure for mean, max, and min calculations.
+ *
+ * Each channel is a sliding window over the last @ref STATS_WINDOW_PERIOD
+ * milliseconds (samples scaled by @ref STATS_SCALE), so the aggregates can
+ * be queried at any time. The color histogram is reset at every report.
  */
 struct stats_measurements {
-    float temp_mean, temp_max, temp_min;
-    float hum_mean, hum_max, hum_min;
-    float light_mean, light_max, light_min;
-    float moisture_mean, moisture_max, moisture_min;
-    float x_axis_max, x_axis_min;
-    float y_axis_max, y_axis_min;
-    float z_axis_max, z_axis_min;
-    int red_count, green_count, blue_count;
+    struct sliding_window temp;
+    struct sliding_window hum;
+    struct sliding_window light;
+    struct sliding_window moisture;
+    struct sliding_window x_axis;
+    struct sliding_window y_axis;
+    struct sliding_window z_axis;
+    int color_hist[COLOR_MAX_BINS + 1]; /**< Samples per hue bin; last entry is achromatic. */
     int count;
 };
 
@@ -319,6 +735,77 @@ struct stats_measurements {
  */
 struct stats_measurements stats_data = {0};
 
+/** @brief Protects @ref stats_data between the main thread and the report work. */
+static K_MUTEX_DEFINE(stats_lock);
+
+/**
+ * @brief Telemetry uplink state.
+ */
+static struct uplink uplink;
+
+/** @brief Uplink slot of the node. */
+static struct tdma tdma;
+
+/** @brief NORMAL_MODE reports are sent in the uplink slot. */
+static bool uplink_slots = UPLINK_SLOTS;
+
+/** @brief Routine summary owed after its slot was missed. */
+static bool report_deferred;
+
+/**
+ * @brief Anomaly detector tuning parameters.
+ */
+static const struct anomaly_config anomaly_cfg = {
+    .alpha = ANOMALY_ALPHA,
+    .seasonal_alpha = ANOMALY_SEASONAL_ALPHA,
+    .z_threshold = ANOMALY_Z_THRESHOLD,
+    .min_std = ANOMALY_MIN_STD,
+    .warmup = ANOMALY_WARMUP,
+    .cusum_drift = ANOMALY_CUSUM_DRIFT,
+    .cusum_threshold = ANOMALY_CUSUM_THRESHOLD,
+};
+
+/**
+ * @brief Streaming anomaly detector state.
+ */
+static struct anomaly_detector anomaly_det;
+
+/** @brief Battery charge estimate and energy tier. */
+static struct governor governor;
+
+/** @brief The board describes a battery and its supply channels work. */
+static bool battery_measured;
+
+/**
+ * @brief Runtime state restored after a warm reset.
+ */
+struct retained_state {
+    system_mode_t mode;                /**< Operating mode. */
+    uint32_t uptime_ms;                /**< Uptime when saved; base of the window timestamps. */
+    uint32_t restarts;                 /**< Warm restarts since the last cold boot. */
+    uint32_t uplink_seq;               /**< Sequence number of the next telemetry frame. */
+    struct stats_measurements stats;   /**< Statistics windows and color histogram. */
+    struct anomaly_detector anomaly;   /**< Detector baselines learned so far. */
+    struct gps_fix gps;                /**< Last GPS fix, @c utc = 0 if none. */
+};
+
+/**
+ * @brief Layout version of @ref retained_state.
+ *
+ * Change it with the fields of the state or of any type it contains: a
+ * state saved by a firmware with another layout is then discarded instead
+ * of restored field by field into the wrong places.
+ */
+#define RETAINED_STATE_LAYOUT 1
+
+RETAINED_DEFINE(retained, struct retained_state);
+
+/** @brief Warm restarts since the last cold boot. */
+static uint32_t warm_restarts;
+
+/** @brief Last GPS fix, from this boot or restored. */
+static struct gps_fix last_gps;
+
 /* --- Button timing and state -------------------------------------------------- */
 static struct k_work button_work;
 
@@ -428,175 +915,187 @@ static void rgb_timer_handler(struct k_timer *timer)
 
 /* --- Stats Timer -------------------------------------------------------- */
 static struct k_timer stats_timer;
+static struct k_work stats_work;
 
 /**
- * @brief Stats periodic handler for NORMAL_MODE
+ * @brief Prints the sliding-window aggregates of one channel.
+ *
+ * @param label Channel name.
+ * @param w Pointer to the channel window.
+ * @param unit Unit string.
+ * @param with_mean Whether the mean is printed as well as max/min.
  */
-static void stats_timer_handler(struct k_timer *timer)
+static void print_window_stats(const char *label, struct sliding_window *w,
+                               const char *unit, bool with_mean)
 {
-    if(main_data.mode == NORMAL_MODE) {
-        printk("--- STATS REPORT ---\n");
-        printk("Temperature: Mean: %.2f C, Max: %.2f C, Min: %.2f C\n",
-                (double)stats_data.temp_mean, (double)stats_data.temp_max, (double)stats_data.temp_min);
+    int32_t mean, max, min;
 
-        printk("Humidity: Mean: %.2f %%, Max: %.2f %%, Min: %.2f %%\n",
-                (double)stats_data.hum_mean, (double)stats_data.hum_max, (double)stats_data.hum_min);
+    window_expire(w, k_uptime_get_32());
 
-        printk("Light: Mean: %.2f %%, Max: %.2f %%, Min: %.2f %%\n",
-                (double)stats_data.light_mean, (double)stats_data.light_max, (double)stats_data.light_min);
-
-        printk("Soil Moisture: Mean: %.2f %%, Max: %.2f %%, Min: %.2f %%\n",
-                (double)stats_data.moisture_mean, (double)stats_data.moisture_max, (double)stats_data.moisture_min);
-
-        printk("Acceleration X-axis: Max: %.2f m/s2, Min: %.2f m/s2\n",
-                (double)stats_data.x_axis_max, (double)stats_data.x_axis_min);
+    if (window_mean(w, &mean) || window_max(w, &max) || window_min(w, &min)) {
+        printk("%s: no samples\n", label);
+        return;
+    }
 
-        printk("Acceleration Y-axis: Max: %.2f m/s2, Min: %.2f m/s2\n",
-                (double)stats_data.y_axis_max, (double)stats_data.y_axis_min);
+    if (with_mean) {
+        printk("%s: Mean: %.2f %s, Max: %.2f %s, Min: %.2f %s\n", label,
+                (double)(mean / STATS_SCALE), unit, (double)(max / STATS_SCALE), unit,
+                (double)(min / STATS_SCALE), unit);
+    } else {
+        printk("%s: Max: %.2f %s, Min: %.2f %s\n", label,
+                (double)(max / STATS_SCALE), unit, (double)(min / STATS_SCALE), unit);
+    }
+}
 
-        printk("Acceleration Z-axis: Max: %.2f m/s2, Min: %.2f m/s2\n",
-                (double)stats_data.z_axis_max, (double)stats_data.z_axis_min);
+/**
+ * @brief Work handler printing the statistics report for NORMAL_MODE.
+ *
+ * Runs in the system workqueue so the report is not printed from the
+ * timer ISR.
+ *
+ * @param work Pointer to the work structure.
+ */
+static void stats_work_handler(struct k_work *work)
+{
+    if(main_data.mode != NORMAL_MODE) {
+        return;
+    }
 
-        if(stats_data.red_count >= stats_data.green_count && stats_data.red_count >= stats_data.blue_count) {
-            printk("Dominant Color Detected: RED (%d times)\n", stats_data.red_count);
-        } else if(stats_data.green_count >= stats_data.red_count && stats_data.green_count >= stats_data.blue_count) {
-            printk("Dominant Color Detected: GREEN (%d times)\n", stats_data.green_count);
-        } else {
-            printk("Dominant Color Detected: BLUE (%d times)\n", stats_data.blue_count);
+    k_mutex_lock(&stats_lock, K_FOREVER);
+
+    printk("--- STATS REPORT ---\n");
+    print_window_stats("Temperature", &stats_data.temp, "C", true);
+    print_window_stats("Humidity", &stats_data.hum, "%", true);
+    print_window_stats("Light", &stats_data.light, "%", true);
+    print_window_stats("Soil Moisture", &stats_data.moisture, "%", true);
+    print_window_stats("Acceleration X-axis", &stats_data.x_axis, "m/s2", false);
+    print_window_stats("Acceleration Y-axis", &stats_data.y_axis, "m/s2", false);
+    print_window_stats("Acceleration Z-axis", &stats_data.z_axis, "m/s2", false);
+
+    struct color_result dominant = { .bin = 0 };
+    printk("Color histogram:");
+    for (size_t i = 0; i <= color_cfg.bin_count; i++) {
+        struct color_result bin = { .bin = (uint8_t)i };
+        printk(" %s: %d", color_bin_name(&color_cfg, &bin), stats_data.color_hist[i]);
+        if (stats_data.color_hist[i] > stats_data.color_hist[dominant.bin]) {
+            dominant.bin = (uint8_t)i;
         }
-        
-        printk("---------------------\n\n");
-
-        stats_data.temp_mean = 0.0f;
-        stats_data.temp_max = 0.0f;
-        stats_data.temp_min = 0.0f;
+    }
+    printk("\nDominant Color Detected: %s (%d times)\n",
+            color_bin_name(&color_cfg, &dominant), stats_data.color_hist[dominant.bin]);
 
-        stats_data.hum_mean = 0.0f;
-        stats_data.hum_max = 0.0f;
-        stats_data.hum_min = 0.0f;
+    light_fusion_print(&light_fusion);
+    if (battery_measured) {
+        governor_print(&governor);
+    }
+    sensor_cache_print();
+    i2c_arbiter_print();
+    stage_queue_print(&log_queue);
+    stage_queue_print(&uplink_queue);
+    stage_queue_print(&history_queue);
+    history_print();
+    history_export_print();
+    dfu_print();
+    buf_pool_print(&record_pool);
+
+    printk("---------------------\n\n");
+
+    memset(stats_data.color_hist, 0, sizeof(stats_data.color_hist));
+    stats_data.count = 0;
+
+    k_mutex_unlock(&stats_lock);
+}
 
-        stats_data.light_mean = 0.0f;
-        stats_data.light_max = 0.0f;
-        stats_data.light_min = 0.0f;
+/**
+ * @brief Stats periodic handler for NORMAL_MODE
+ */
+static void stats_timer_handler(struct k_timer *timer)
+{
+    k_work_submit(&stats_work);
+}
 
-        stats_data.moisture_mean = 0.0f;
-        stats_data.moisture_max = 0.0f;
-        stats_data.moisture_min = 0.0f;
 
-        stats_data.x_axis_max = 0.0f;
-        stats_data.x_axis_min = 0.0f;
-        stats_data.y_axis_max = 0.0f;
-        stats_data.y_axis_min = 0.0f;
-        stats_data.z_axis_max = 0.0f;
-        stats_data.z_axis_min = 0.0f;
+/* --- Energy Timer -------------------------------------------------------- */
+static struct k_timer energy_timer;
+static struct k_work energy_work;
 
-        stats_data.red_count = 0;
-        stats_data.green_count = 0;
-        stats_data.blue_count = 0;
+/**
+ * @brief Work handler printing the energy estimate of every mode.
+ *
+ * @param work Pointer to the work structure.
+ */
+static void energy_work_handler(struct k_work *work)
+{
+    energy_report();
+}
 
-        stats_data.count = 0;
-    }
+/**
+ * @brief Energy report periodic handler.
+ */
+static void energy_timer_handler(struct k_timer *timer)
+{
+    k_work_submit(&energy_work);
 }
 
 
 /* --- Helper Functions ----------------------------------------------------- */
 
 /**
- * @brief Calculates mean values for temperature, humidity, light and moisture.
- *
- * Updates the running mean based on the number of samples collected.
+ * @brief Initializes the sliding windows of all statistics channels.
  */
-static void mean_calculation()
+static void stats_init()
 {
-    if (stats_data.count == 1) {
-        stats_data.temp_mean = main_data.temp;
-        stats_data.hum_mean = main_data.hum;
-        stats_data.light_mean = main_data.light;
-        stats_data.moisture_mean = main_data.moisture;
-    } else {
-        stats_data.temp_mean = ((stats_data.temp_mean * (stats_data.count - 1)) + main_data.temp) / stats_data.count;
-        stats_data.hum_mean = ((stats_data.hum_mean * (stats_data.count - 1)) + main_data.hum) / stats_data.count;
-        stats_data.light_mean = ((stats_data.light_mean * (stats_data.count - 1)) + main_data.light) / stats_data.count;
-        stats_data.moisture_mean = ((stats_data.moisture_mean * (stats_data.count - 1)) + main_data.moisture) / stats_data.count;
-    }
+    window_init(&stats_data.temp, STATS_WINDOW_PERIOD);
+    window_init(&stats_data.hum, STATS_WINDOW_PERIOD);
+    window_init(&stats_data.light, STATS_WINDOW_PERIOD);
+    window_init(&stats_data.moisture, STATS_WINDOW_PERIOD);
+    window_init(&stats_data.x_axis, STATS_WINDOW_PERIOD);
+    window_init(&stats_data.y_axis, STATS_WINDOW_PERIOD);
+    window_init(&stats_data.z_axis, STATS_WINDOW_PERIOD);
 }
 
 /**
- * @brief Calculates max/min values for all sensor measurements.
+ * @brief Adds the latest measurements to the sliding windows.
  *
- * Keeps track of the highest and lowest values recorded since last reset.
+ * Each push is amortized O(1); mean, max and min are maintained incrementally.
  */
-static void max_min_calculation()
+static void window_calculation()
 {
-    if (stats_data.count == 1) {
-        // Initialize first values
-        stats_data.temp_max = stats_data.temp_min = main_data.temp;
-        stats_data.hum_max = stats_data.hum_min = main_data.hum;
-        stats_data.light_max = stats_data.light_min = main_data.light;
-        stats_data.moisture_max = stats_data.moisture_min = main_data.moisture;
-
-        stats_data.x_axis_max = stats_data.x_axis_min = main_data.x_axis;
-        stats_data.y_axis_max = stats_data.y_axis_min = main_data.y_axis;
-        stats_data.z_axis_max = stats_data.z_axis_min = main_data.z_axis;
-    } else {
-        // Temperature
-        if (main_data.temp > stats_data.temp_max) stats_data.temp_max = main_data.temp;
-        if (main_data.temp < stats_data.temp_min) stats_data.temp_min = main_data.temp;
-
-        // Humidity
-        if (main_data.hum > stats_data.hum_max) stats_data.hum_max = main_data.hum;
-        if (main_data.hum < stats_data.hum_min) stats_data.hum_min = main_data.hum;
-
-        // Light
-        if (main_data.light > stats_data.light_max) stats_data.light_max = main_data.light;
-        if (main_data.light < stats_data.light_min) stats_data.light_min = main_data.light;
-
-        // Moisture
-        if (main_data.moisture > stats_data.moisture_max) stats_data.moisture_max = main_data.moisture;
-        if (main_data.moisture < stats_data.moisture_min) stats_data.moisture_min = main_data.moisture;
-
-        // Accelerometer
-        if (main_data.x_axis > stats_data.x_axis_max) stats_data.x_axis_max = main_data.x_axis;
-        if (main_data.x_axis < stats_data.x_axis_min) stats_data.x_axis_min = main_data.x_axis;
-
-        if (main_data.y_axis > stats_data.y_axis_max) stats_data.y_axis_max = main_data.y_axis;
-        if (main_data.y_axis < stats_data.y_axis_min) stats_data.y_axis_min = main_data.y_axis;
-
-        if (main_data.z_axis > stats_data.z_axis_max) stats_data.z_axis_max = main_data.z_axis;
-        if (main_data.z_axis < stats_data.z_axis_min) stats_data.z_axis_min = main_data.z_axis;
-    }
+    uint32_t now = k_uptime_get_32();
+
+    window_push(&stats_data.temp, now, (int32_t)(main_data.temp * STATS_SCALE));
+    window_push(&stats_data.hum, now, (int32_t)(main_data.hum * STATS_SCALE));
+    window_push(&stats_data.light, now, (int32_t)(main_data.light * STATS_SCALE));
+    window_push(&stats_data.moisture, now, (int32_t)(main_data.moisture * STATS_SCALE));
+    window_push(&stats_data.x_axis, now, (int32_t)(main_data.x_axis * STATS_SCALE));
+    window_push(&stats_data.y_axis, now, (int32_t)(main_data.y_axis * STATS_SCALE));
+    window_push(&stats_data.z_axis, now, (int32_t)(main_data.z_axis * STATS_SCALE));
 }
 
 /**
- * @brief Updates the color counters based on the dominant color detected.
- *
- * Increments the count for the dominant color (red, green, or blue).
+ * @brief Updates the color histogram with the classified hue bin.
  */
 static void dominant_color_calculation()
 {
-    if (main_data.r > main_data.g && main_data.r > main_data.b) {
-        stats_data.red_count++;
-    } else if (main_data.g > main_data.r && main_data.g > main_data.b) {
-        stats_data.green_count++;
-    } else if (main_data.b > main_data.r && main_data.b > main_data.g) {
-        stats_data.blue_count++;
-    }
+    stats_data.color_hist[main_data.color.bin]++;
 }
 
 /**
  * @brief Main statistics management handler.
  *
- * Increments sample count and updates mean, max/min, and color stats.
+ * Increments sample count and updates the sliding windows and color stats.
  */
 static void stats_management()
 {
-    stats_data.count++;
+    k_mutex_lock(&stats_lock, K_FOREVER);
 
-    mean_calculation();
+    stats_data.count++;
 
-    max_min_calculation();
+    window_calculation();
 
     dominant_color_calculation();
+
+    k_mutex_unlock(&stats_lock);
 }
 
 /**
@@ -647,6 +1146,28 @@ static void check_limits(uint32_t *flags)
     atomic_set(&main_data.rgb_flags, (atomic_val_t)(*flags));
 }
 
+/**
+ * @brief Current UTC time of day, from the last GPS fix.
+ *
+ * The GPS is only woken every few cycles in the energy saving tiers, and
+ * not at all in SURVIVAL, so the time of its last sentence can be hours
+ * old. The fix time is advanced by the uptime elapsed since instead.
+ *
+ * @return Seconds since 00:00 UTC, or -1 if there has been no fix with a date.
+ */
+static int32_t utc_time_of_day()
+{
+    struct gps_fix fix;
+
+    if (gps_get_fix(&fix) != 0 || fix.utc <= 0) {
+        return -1;
+    }
+
+    int64_t utc = fix.utc + (k_uptime_get_32() - fix.uptime_ms) / MSEC_PER_SEC;
+
+    return (int32_t)(utc % SEC_PER_DAY);
+}
+
 /**
  * @brief Retrieves the latest measurements from atomic variables.
  */
@@ -660,7 +1181,6 @@ static void get_measurements()
     main_data.lon  = atomic_get(&measure.gps_lon) / 1e6f;
     main_data.alt  = atomic_get(&measure.gps_alt) / 100.0f;
     main_data.sats   = atomic_get(&measure.gps_sats);
-    main_data.time_int = atomic_get(&measure.gps_time);
 
     main_data.ns = (main_data.lat >= 0) ? 'N' : 'S';
     main_data.ew = (main_data.lon >= 0) ? 'E' : 'W';
@@ -668,11 +1188,15 @@ static void get_measurements()
     main_data.lat = fabsf(main_data.lat);
     main_data.lon = fabsf(main_data.lon);
 
-    if (main_data.time_int >= 0) {
-        main_data.hh = main_data.time_int / 10000;
-        main_data.mm = (main_data.time_int / 100) % 100;
-        main_data.ss = main_data.time_int % 100;
+    int32_t tod = utc_time_of_day();
+
+    if (tod >= 0) {
+        main_data.hh = tod / SEC_PER_HOUR;
+        main_data.mm = (tod / SEC_PER_MIN) % 60;
+        main_data.ss = tod % SEC_PER_MIN;
+        main_data.time_int = main_data.hh * 10000 + main_data.mm * 100 + main_data.ss;
     } else {
+        main_data.time_int = -1;
         printk("GPS time: --:--:--\n");
     }
 
@@ -690,28 +1214,544 @@ static void get_measurements()
 }
 
 /**
- * @brief Displays the latest measurements via printk.
+ * @brief Classifies the latest color measurement into a hue bin.
+ *
+ * Uses the fixed-point color analysis on the raw sensor channels.
  */
-static void display_measurements()
+static void color_calculation()
 {
-    printk("SOIL MOISTURE: %.1f%%\n", (double)main_data.moisture);
+    ColorSensorData raw = {
+        .clear = (uint16_t)main_data.c,
+        .red = (uint16_t)main_data.r,
+        .green = (uint16_t)main_data.g,
+        .blue = (uint16_t)main_data.b,
+    };
+
+    color_analyze(&color_cfg, &raw, &main_data.color);
+}
 
-    printk("LIGHT: %.1f%%\n", (double)main_data.light);
+/**
+ * @brief Classifies the plant condition from the latest measurements.
+ *
+ * Runs the on-device int8 model on color, light and environment features.
+ */
+static void health_calculation()
+{
+    struct plant_features features = {
+        .red = main_data.r,
+        .green = main_data.g,
+        .blue = main_data.b,
+        .clear = main_data.c,
+        .light = main_data.light,
+        .temp = main_data.temp,
+        .hum = main_data.hum,
+        .moisture = main_data.moisture,
+    };
+
+    plant_model_classify(&features, &main_data.health);
+}
+
+/**
+ * @brief Runs the anomaly detectors on the latest measurements.
+ *
+ * The UTC hour is used as time of day once the GPS has given the time, so
+ * light and temperature are compared against their daily profiles.
+ *
+ * @return Bitmask of @c ANOMALY_* flags raised by this sample.
+ */
+static uint32_t anomaly_check()
+{
+    struct anomaly_sample sample = {
+        .temp = main_data.temp,
+        .hum = main_data.hum,
+        .light = main_data.light,
+        .moisture = main_data.moisture,
+        .hour = (main_data.time_int >= 0) ? main_data.hh : -1,
+    };
+
+    return anomaly_update(&anomaly_det, &sample);
+}
+
+/**
+ * @brief Displays a reported sample via printk.
+ *
+ * @param rec Sample to display.
+ */
+static void display_measurements(const struct sample_record *rec)
+{
+    const struct main_measurement *d = &rec->view;
+
+    printk("SOIL MOISTURE: %.1f%%", (double)d->moisture);
+    if (ARRAY_SIZE(soil_probes) > 1) {
+        for (size_t i = 0; i < ARRAY_SIZE(soil_probes); i++) {
+            printk(" P%d: %.1f%%", (int)i, (double)(rec->probes[i] / 10.0f));
+        }
+    }
+    printk("\n");
+
+    printk("LIGHT: %.1f%%\n", (double)d->light);
 
     printk("GPS: #Sats: %d Lat(UTC): %.6f %c Long(UTC): %.6f %c Altitude: %.0f m GPS time: %02d:%02d:%02d\n",
-            main_data.sats, (double)main_data.lat, main_data.ns, (double)main_data.lon, 
-            main_data.ew, (double)main_data.alt, main_data.hh, main_data.mm, main_data.ss);
+            d->sats, (double)d->lat, d->ns, (double)d->lon, 
+            d->ew, (double)d->alt, d->hh, d->mm, d->ss);
 
-    printk("COLOR SENSOR: Clear: %.0f Red: %.0f Green: %.0f Blue: %.0f Dominant color: %s \n",
-            (double)main_data.c, (double)main_data.r, (double)main_data.g, (double)main_data.b, dom_color_names[main_data.dom_color]);
+    printk("COLOR SENSOR: Clear: %.0f Red: %.0f Green: %.0f Blue: %.0f Dominant color: %s (hue %u, %u%% confidence)\n",
+            (double)d->c, (double)d->r, (double)d->g, (double)d->b,
+            color_bin_name(&color_cfg, &d->color), d->color.hue, d->color.confidence);
                 
     printk("ACCELEROMETER: X_axis: %.2f m/s2, Y_axis: %.2f m/s2, Z_axis: %.2f m/s2 \n",
-            (double)main_data.x_axis, (double)main_data.y_axis, (double)main_data.z_axis);
+            (double)d->x_axis, (double)d->y_axis, (double)d->z_axis);
                 
-    printk("TEMP/HUM: Temperature: %.1fC, Relative Humidity: %.1f%%\n\n",
-            (double)main_data.temp, (double)main_data.hum);
+    printk("TEMP/HUM: Temperature: %.1fC, Relative Humidity: %.1f%%\n",
+            (double)d->temp, (double)d->hum);
+
+    printk("PLANT HEALTH: %s (%u%% confidence)\n\n",
+            plant_health_names[d->health.health], d->health.confidence);
+}
+
+
+/* --- Reporting pipeline stages ------------------------------------------------ */
+
+/**
+ * @brief Log stage: prints the sample.
+ */
+static void log_stage(void *item)
+{
+    display_measurements(item);
+}
+
+/**
+ * @brief Uplink stage: transmits the sample's frame.
+ */
+static void uplink_stage(void *item)
+{
+    const struct sample_record *rec = item;
+
+    uplink_transmit(&rec->frame);
+}
+
+/**
+ * @brief History stage: stores the transmitted frame in flash, stamped with
+ *        the UTC time of its acquisition if the GPS has given it.
+ */
+static void history_stage(void *item)
+{
+    const struct sample_record *rec = item;
+    struct gps_fix fix;
+    uint32_t utc = 0;
+
+    if (gps_get_fix(&fix) == 0 && fix.utc > 0) {
+        /* Signed: the fix may be newer than the sample (MSEC_PER_SEC is unsigned) */
+        int32_t age_ms = (int32_t)(rec->frame.uptime_ms - fix.uptime_ms);
+
+        utc = (uint32_t)(fix.utc + (int64_t)age_ms / (int64_t)MSEC_PER_SEC);
+    }
+    history_append(&rec->frame, utc);
+}
+
+/**
+ * @brief Stages after acquisition and analysis: the log and uplink stages
+ *        are fed by main(), the history stage by the uplink stage.
+ */
+static const struct pipeline_stage report_stages[] = {
+    { .name = "log_stage",     .in = &log_queue,     .out = NULL,           .handler = log_stage },
+    { .name = "uplink_stage",  .in = &uplink_queue,  .out = &history_queue, .handler = uplink_stage },
+    { .name = "history_stage", .in = &history_queue, .out = NULL,           .handler = history_stage },
+};
+
+/**
+ * @brief Hands the latest sample to the reporting pipeline.
+ *
+ * Never blocks: if the pipeline is behind, the queue policies decide what
+ * is dropped or merged, and if the pool is empty the sample is not reported
+ * (counted in the pool's allocation failures).
+ *
+ * @param anomalies Bitmask of @c ANOMALY_* flags raised by this sample.
+ */
+static void report_sample(uint32_t anomalies)
+{
+    struct sample_record *rec = buf_alloc(&record_pool, K_NO_WAIT);
+
+    if (rec == NULL) {
+        return;
+    }
+
+    uplink_build(&uplink, &measure, main_data.mode, &main_data.health, anomalies, &rec->frame);
+    /* Same clock as the console and the anomaly hour: UTC of the last fix plus uptime */
+    rec->frame.gps_time = main_data.time_int;
+    rec->view = main_data;
+    for (size_t i = 0; i < ARRAY_SIZE(soil_probes); i++) {
+        rec->probes[i] = atomic_get(&measure.moisture_probe[i]);
+    }
+
+    /* One reference per stage; a sample the uplink drops leaves a gap in the sequence numbers */
+    stage_queue_push(&log_queue, buf_ref(rec));
+    stage_queue_push(&uplink_queue, rec);
+
+    /* A full cycle was measured, analysed and reported: keep a new image */
+    dfu_confirm();
+}
+
+/**
+ * @brief Initializes every I2C sensor instance.
+ *
+ * Selects the multiplexer channel of each slot before initializing it.
+ *
+ * @return 0 on success, negative error code on failure.
+ */
+static int i2c_sensors_init()
+{
+    if (ctx.i2c_mux != NULL && i2c_mux_init(ctx.i2c_mux)) {
+        printk("I2C multiplexer initialization failed\n");
+        return -ENODEV;
+    }
+    i2c_arbiter_init(ctx.i2c_mux);
+
+    const struct sensor_profile *p = &sensor_profiles[INITIAL_MODE];
+
+    for (size_t i = 0; i < ARRAY_SIZE(i2c_sensors); i++) {
+        const struct i2c_sensor_slot *slot = &i2c_sensors[i];
+        int ret;
+
+        if (ctx.i2c_mux != NULL && i2c_mux_select(ctx.i2c_mux, slot->mux_channel)) {
+            return -EIO;
+        }
+
+        switch (slot->type) {
+        case SENSOR_ACCEL:
+            ret = accel_init(&slot->spec, ACCEL_RANGE);
+            break;
+        case SENSOR_TEMP_HUM:
+            ret = temp_hum_init(&slot->spec, p->temp_hum_resolution);
+            break;
+        case SENSOR_COLOR:
+            ret = color_init(&slot->spec, p->color_gain, p->color_atime);
+            break;
+        default:
+            ret = -EINVAL;
+            break;
+        }
+
+        if (ret) {
+            printk("I2C sensor %d (type %d, instance %d) initialization failed\n",
+                   (int)i, slot->type, slot->instance);
+            return ret;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Writes the I2C sensor settings of a profile to every instance.
+ *
+ * @param p Profile to write.
+ * @return 0 on success, negative error code from the first failing sensor.
+ */
+static int sensor_profile_write(const struct sensor_profile *p)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(i2c_sensors); i++) {
+        const struct i2c_sensor_slot *slot = &i2c_sensors[i];
+        int ret;
+
+        if (i2c_arbiter_acquire(&main_i2c, slot->mux_channel, K_FOREVER)) {
+            return -EIO;
+        }
+
+        switch (slot->type) {
+        case SENSOR_ACCEL:
+            ret = accel_set_power(&slot->spec, &p->accel);
+            break;
+        case SENSOR_TEMP_HUM:
+            ret = temp_hum_set_resolution(&slot->spec, p->temp_hum_resolution);
+            break;
+        case SENSOR_COLOR:
+            ret = color_set_timing(&slot->spec, p->color_gain, p->color_atime);
+            break;
+        default:
+            ret = -EINVAL;
+            break;
+        }
+        i2c_arbiter_release(&main_i2c);
+
+        if (ret) {
+            printk("[PROFILE] - I2C sensor %d (type %d, instance %d) rejected %s (%d)\n",
+                   (int)i, slot->type, slot->instance, p->name, ret);
+            return ret;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Switches every sensor to the profile of a mode, all or nothing.
+ *
+ * The SAVER and SURVIVAL energy tiers use @ref saver_sensor_profile
+ * whatever the mode. If any sensor rejects the new settings, the previous
+ * profile is written back to all of them and stays in use, so sensors
+ * never run with a mix of profiles. Once the sensors accept it, the
+ * settings read by the sensors thread are updated and the first color
+ * integration at the new timing is waited for.
+ *
+ * Must be called with the sensor cache held (@ref sensor_cache_hold), as it
+ * uses the I2C bus and the multiplexer.
+ *
+ * @param mode System mode.
+ * @return 0 on success, negative error code if the previous profile was kept.
+ */
+static int sensor_profile_apply(system_mode_t mode)
+{
+    static const struct sensor_profile *active;
+    const struct sensor_profile *next = governor_tier(&governor)->saver_profile ?
+                                        &saver_sensor_profile : &sensor_profiles[mode];
+
+    if (next == active) {
+        return 0;
+    }
+
+    int ret = sensor_profile_write(next);
+    if (ret) {
+        if (active != NULL && sensor_profile_write(active)) {
+            printk("[PROFILE] - Restoring %s failed\n", active->name);
+        }
+        return ret;
+    }
+
+    ctx.color_gain = next->color_gain;
+    ctx.color_atime = next->color_atime;
+    ctx.adc_oversampling = next->adc_oversampling;
+    ctx.color_refresh_ms = next->color_refresh_ms;
+    active = next;
+
+    k_usleep(color_integration_us(next->color_atime));
+
+    printk("[PROFILE] - %s: color %u ms, ADC x%u, accelerometer %u uA",
+           next->name, color_integration_us(next->color_atime) / 1000,
+           1U << next->adc_oversampling,
+           accel_supply_ua(next->accel.odr, next->accel.mods));
+    if (next->accel.auto_sleep) {
+        /* Sleep rates are the four slowest data rates */
+        printk(" (%u uA asleep)",
+               accel_supply_ua(ACCEL_ODR_50HZ + next->accel.sleep_rate, next->accel.sleep_mods));
+    }
+    if (next->color_refresh_ms != 0) {
+        printk(", color read on light change or every %u min", next->color_refresh_ms / 60000);
+    }
+    printk("\n");
+    return 0;
+}
+
+/**
+ * @brief Restores the retained runtime state after a warm reset.
+ *
+ * Must run after the statistics, anomaly detector, uplink and GPS are
+ * initialized, and before the measurement threads start. Window timestamps
+ * are rebased on the new uptime, the detector keeps the configuration of
+ * this firmware, and the last GPS position and time are advanced by the
+ * time elapsed since the fix, ready to be sent to the module at boot.
+ *
+ * @retval true If a valid state was restored.
+ * @retval false On a cold start.
+ */
+static bool retained_state_restore()
+{
+#if defined(CONFIG_HWINFO)
+    uint32_t cause;
+
+    if (hwinfo_get_reset_cause(&cause) == 0) {
+        printk("[RETAINED] - Reset cause 0x%08x\n", cause);
+        hwinfo_clear_reset_cause();
+    }
+#endif
+
+    if (!retained_valid(&retained, RETAINED_STATE_LAYOUT) || retained.data.mode > ADVANCED_MODE) {
+        printk("[RETAINED] - No retained state, cold start\n");
+        return false;
+    }
+
+    const struct retained_state *rs = &retained.data;
+    struct sliding_window *windows[] = {
+        &stats_data.temp, &stats_data.hum, &stats_data.light, &stats_data.moisture,
+        &stats_data.x_axis, &stats_data.y_axis, &stats_data.z_axis,
+    };
+
+    stats_data = rs->stats;
+    for (size_t i = 0; i < ARRAY_SIZE(windows); i++) {
+        window_rebase(windows[i], rs->uptime_ms);
+    }
+
+    anomaly_det = rs->anomaly;
+    anomaly_det.cfg = anomaly_cfg;
+
+    uplink.seq = rs->uplink_seq;
+    main_data.mode = rs->mode;
+    warm_restarts = rs->restarts + 1;
+
+    if (rs->gps.utc > 0) {
+        last_gps = rs->gps;
+        last_gps.utc += (rs->uptime_ms - rs->gps.uptime_ms) / MSEC_PER_SEC;
+        last_gps.uptime_ms = k_uptime_get_32();
+    }
+
+    printk("[RETAINED] - Warm restart %u: mode %d, %u temperature samples, frame %u\n",
+           warm_restarts, (int)main_data.mode, window_count(&stats_data.temp), uplink.seq);
+    return true;
+}
+
+/**
+ * @brief Saves the runtime state to retained RAM.
+ *
+ * Called once per measurement cycle. The image is invalidated while it is
+ * rewritten, so a reset in between leads to a cold start.
+ */
+static void retained_state_save()
+{
+    struct retained_state *rs = &retained.data;
+
+    gps_get_fix(&last_gps);
+
+    retained_invalidate(&retained.hdr);
+
+    rs->mode = main_data.mode;
+    rs->uptime_ms = k_uptime_get_32();
+    rs->restarts = warm_restarts;
+    rs->uplink_seq = uplink.seq;
+    k_mutex_lock(&stats_lock, K_FOREVER);
+    rs->stats = stats_data;
+    k_mutex_unlock(&stats_lock);
+    rs->anomaly = anomaly_det;
+    rs->gps = last_gps;
+
+    retained_commit(&retained, RETAINED_STATE_LAYOUT);
+}
+
+/**
+ * @brief Measures the battery and applies the energy tier it allows.
+ *
+ * Called from the main loop every @ref GOVERNOR_PERIOD. LEDs are switched
+ * off or back on at once; the GPS duty, sensor profile and report interval
+ * of the new tier apply from the next cycle.
+ */
+static void power_update()
+{
+    struct supply_reading supply;
+    const struct governor_tier *prev = governor_tier(&governor);
+
+    if (!battery_measured || supply_read(&supply)) {
+        return;
+    }
+    if (!governor_update(&governor, supply.vbat_mv, supply.vdda_mv,
+                         energy_consumed_uas(), k_uptime_get_32())) {
+        return;
+    }
+
+    const struct governor_tier *tier = governor_tier(&governor);
+
+    printk("[POWER] - Tier %s -> %s\n", prev->name, tier->name);
+    governor_print(&governor);
+
+    if (!tier->leds) {
+        k_timer_stop(&rgb_timer);
+        rgb_led_off(&rgb_leds);
+        led_off(&leds);
+    } else if (!prev->leds && main_data.mode == NORMAL_MODE) {
+        k_timer_start(&rgb_timer, K_MSEC(RGB_TIMER_PERIOD), K_MSEC(RGB_TIMER_PERIOD));
+    }
+}
+
+/**
+ * @brief Shows the mode on the board LEDs, if the energy tier allows it.
+ *
+ * @param show LED pattern of the mode (e.g. @c blue).
+ */
+static void show_mode(int (*show)(struct bus_led *))
+{
+    if (governor_tier(&governor)->leds) {
+        show(&leds);
+    } else {
+        led_off(&leds);
+    }
 }
 
+/**
+ * @brief Reads the sensors for one cycle, and the GPS if a fix is due.
+ *
+ * The energy tier sets how many cycles apart fixes are. The GPS tracks
+ * during the cycle before a fix, so it has time to hot-start, and during
+ * the fix; it is in standby otherwise.
+ */
+static void sample_sensors()
+{
+    static uint32_t gps_cycle;
+    uint16_t every = governor_tier(&governor)->gps_every;
+    bool fix = every != 0 && gps_cycle % every == 0;
+
+    if (fix) {
+        k_sem_give(ctx.gps_sem);
+    }
+    sensor_cache_get(SENSOR_GROUP_ALL, SAMPLE_MAX_AGE_MS, K_FOREVER);
+    if (fix) {
+        k_sem_take(ctx.main_gps_sem, K_FOREVER);
+    }
+
+    gps_cycle++;
+    bool track = every != 0 && (gps_cycle % every == 0 || (gps_cycle + 1) % every == 0);
+    gps_standby(!track);
+}
+
+/**
+ * @brief Reports a NORMAL_MODE sample in the node's uplink slot and starts
+ *        the next cycle ahead of the next slot.
+ *
+ * Anomalies are reported in every cycle, the routine summary in the cycle
+ * of the superframe that the slot schedule picks. The sample waits for
+ * the slot if the acquisition finished early. If it finished after the
+ * slot (slow GPS acquisition), anomalies go out at once and the routine
+ * summary waits for the slot of the next cycle, so the node never sends
+ * in another node's slot.
+ *
+ * The time is the last fix plus the uptime since, so the MCU clock error
+ * grows with the fix age: ECO and SAVER fix every 10 and 60 cycles,
+ * SURVIVAL never. Past @c UPLINK_MAX_FIX_AGE_MS the slot can no longer be
+ * trusted and the node reports on its free-running timer until the next fix.
+ *
+ * @param anomalies Bitmask of @c ANOMALY_* flags raised by this sample.
+ * @retval true If the sample was handled in the slot schedule.
+ * @retval false If slots are off or the GPS has not given a recent time.
+ */
+static bool report_in_slot(uint32_t anomalies)
+{
+    struct gps_fix fix;
+    uint32_t now = k_uptime_get_32();
+
+    if (!uplink_slots || gps_get_fix(&fix) || now - fix.uptime_ms > UPLINK_MAX_FIX_AGE_MS) {
+        report_deferred = false;
+        return false;
+    }
+
+    int64_t utc_ms = fix.utc * MSEC_PER_SEC + (now - fix.uptime_ms);
+    int32_t wait = tdma_until_slot(&tdma, utc_ms);
+    uint32_t cycles = SUMMARY_SAMPLES * governor_tier(&governor)->report_scale;
+    bool routine = report_deferred || tdma_report_cycle(&tdma, utc_ms + wait, cycles);
+
+    if (wait < 0) {
+        if (anomalies) {
+            report_sample(anomalies);
+        }
+        report_deferred = routine && !anomalies;
+    } else if (anomalies || routine) {
+        if (wait > 0) {
+            k_msleep(wait);
+        }
+        report_sample(anomalies);
+        report_deferred = false;
+    }
+
+    utc_ms += k_uptime_get_32() - now;
+    k_timer_start(&main_timer, K_MSEC(tdma_until_cycle(&tdma, utc_ms)), K_MSEC(NORMAL_PERIOD));
+    return true;
+}
 
 /* --- Main Application -------------------------------------------------------- */
 /**
@@ -730,11 +1770,17 @@ int main(void)
     printk("System ON (TEST MODE)\n\n");
 
     uint32_t flags = 0;
+    uint32_t anomalies = 0;
+    int routine_samples = 0;
+    uint32_t power_due = 0;
     system_mode_t previous_mode = INITIAL_MODE;
-    float r_norm = 0.0f, g_norm = 0.0f, b_norm = 0.0f;
+    unsigned int r_norm = 0, g_norm = 0, b_norm = 0;
     int r_duty = 0, g_duty = 0, b_duty = 0, r_value = 0, g_value = 0, b_value = 0;
     bool keep_running = true;
 
+    energy_init(&energy_model, INITIAL_MODE);
+    governor_init(&governor, &governor_cfg);
+
     /* Initialize peripherals */
     if (gps_init(&gps)) {
         printk("GPS initialization failed - Program stopped\n");
@@ -744,20 +1790,14 @@ int main(void)
         printk("Phototransistor initialization failed - Program stopped\n");
         return -1;
     }
-    if (adc_init(&sm)) {
-        printk("Soil moisture sensor initialization failed - Program stopped\n");
-        return -1;
-    }
-    if (accel_init(&accel, ACCEL_RANGE)) {
-        printk("Accelerometer initialization failed - Program stopped\n");
-        return -1;
-    }
-    if (temp_hum_init(&th, TEMP_HUM_RESOLUTION)) {
-        printk("Temperature/Humidity sensor initialization failed - Program stopped\n");
-        return -1;
+    for (size_t i = 0; i < ARRAY_SIZE(soil_probes); i++) {
+        if (adc_init(&soil_probes[i])) {
+            printk("Soil moisture probe %d initialization failed - Program stopped\n", (int)i);
+            return -1;
+        }
     }
-    if (color_init(&color, COLOR_GAIN, COLOR_INTEGRATION_TIME)) {
-        printk("Color sensor initialization failed - Program stopped\n");
+    if (i2c_sensors_init()) {
+        printk("I2C sensors initialization failed - Program stopped\n");
         return -1;
     }
     if (led_init(&leds) || led_off(&leds)) {
@@ -776,17 +1816,84 @@ int main(void)
         printk("Button callback setup failed - Program stopped\n");
         return -1;
     }
+    /* Not fatal: without a battery measurement the node stays in the first energy tier */
+#if BATTERY_FITTED
+    battery_measured = (supply_init() == 0);
+    if (battery_measured) {
+        printk("[POWER] - Battery %s, %u mAh\n", DT_PROP(BATTERY_NODE, chemistry),
+               (unsigned int)DT_PROP(BATTERY_NODE, capacity_mah));
+    } else {
+        printk("[POWER] - Supply measurement unavailable, tier %s kept\n",
+               governor_tier(&governor)->name);
+    }
+#else
+    printk("[POWER] - No battery in the devicetree, tier %s kept\n", governor_tier(&governor)->name);
+#endif
+
+    if (history_init() < 0) {
+        /* Not fatal: frames are transmitted but not kept */
+        printk("[HISTORY] - Flash history unavailable\n");
+    }
+    if (history_export_start() < 0) {
+        printk("[EXPORT] - History export unavailable\n");
+    }
 
     /* Initialize timers */
     k_timer_init(&main_timer, main_timer_handler, NULL);
     k_timer_init(&rgb_timer, rgb_timer_handler, NULL);
     k_timer_init(&stats_timer, stats_timer_handler, NULL);
+    k_timer_init(&energy_timer, energy_timer_handler, NULL);
 
     k_timer_start(&main_timer, K_MSEC(TEST_PERIOD), K_MSEC(TEST_PERIOD));
     k_timer_start(&stats_timer, K_MSEC(STATS_TIMER_PERIOD), K_MSEC(STATS_TIMER_PERIOD));
+    k_timer_start(&energy_timer, K_MSEC(ENERGY_REPORT_PERIOD), K_MSEC(ENERGY_REPORT_PERIOD));
 
     /* Button handling */
     k_work_init(&button_work, button_work_handler);
+    k_work_init(&stats_work, stats_work_handler);
+    k_work_init(&energy_work, energy_work_handler);
+
+    stats_init();
+
+    anomaly_init(&anomaly_det, &anomaly_cfg);
+    light_fusion_init(&light_fusion, &light_fusion_cfg);
+
+#if defined(CONFIG_BOARD_NATIVE_SIM)
+    plant_model_benchmark(PLANT_MODEL_BENCH_RUNS);
+    uplink_init(&uplink, sim_node_id());
+    uplink_slots = sim_uplink_slots(uplink_slots);
+#else
+    uplink_init(&uplink, uplink_hw_node_id());
+#endif
+    tdma_init(&tdma, &tdma_cfg, uplink.node_id);
+    if (uplink_slots) {
+        printk("[UPLINK] - Slot at +%u ms of every %u ms cycle\n", tdma.offset_ms, tdma_cfg.cycle_ms);
+    }
+
+    retained_state_restore();
+
+#if defined(CONFIG_BOARD_NATIVE_SIM)
+    main_data.mode = (system_mode_t)sim_initial_mode(main_data.mode);
+#endif
+
+    /* Shorten the time to first fix: orbits from flash, then time and position */
+    gps_epo_inject(&last_gps, GPS_EPO_MAX_SETS);
+    if (last_gps.utc > 0) {
+        gps_assist(&last_gps);
+    }
+
+    if (buf_pool_init(&record_pool) ||
+        stage_queue_init(&log_queue) || stage_queue_init(&uplink_queue) ||
+        stage_queue_init(&history_queue) ||
+        pipeline_start(report_stages, ARRAY_SIZE(report_stages))) {
+        printk("Reporting pipeline initialization failed - Program stopped\n");
+        return -1;
+    }
+
+    /* Accept patches; the image is only confirmed by the first report */
+    if (dfu_init() < 0) {
+        printk("[DFU] - Firmware update unavailable\n");
+    }
 
     /* Start measurement threads */
     start_sensors_thread(&ctx, &measure);
@@ -795,10 +1902,25 @@ int main(void)
     blue(&leds);
 
     while (1) {
+        energy_set_mode((uint8_t)main_data.mode);
+        energy_cpu_estimate(ENERGY_CPU_SAMPLE_US);
+
+        if ((int32_t)(k_uptime_get_32() - power_due) >= 0) {
+            power_due = k_uptime_get_32() + GOVERNOR_PERIOD;
+            power_update();
+        }
+
+        sensor_cache_hold();
+        sensor_profile_apply(main_data.mode);
+        sensor_cache_release();
+
+        /* Checkpoint the state left by the previous cycle */
+        retained_state_save();
+
         switch (main_data.mode) {
 
             case TEST_MODE:
-                blue(&leds);
+                show_mode(blue);
 
                 if(previous_mode != TEST_MODE) {
                     k_timer_stop(&rgb_timer);
@@ -808,62 +1930,69 @@ int main(void)
                     previous_mode = TEST_MODE;
                 }
 
-                k_sem_give(ctx.sensors_sem);
-                k_sem_give(ctx.gps_sem);
-
-                k_sem_take(ctx.main_sensors_sem, K_FOREVER);
-                k_sem_take(ctx.main_gps_sem, K_FOREVER);
+                sample_sensors();
 
                 get_measurements();
 
-                if (main_data.r > main_data.g && main_data.r > main_data.b) {
-                    rgb_red(&rgb_leds);
-                    main_data.dom_color = DOM_RED;
-                } else if (main_data.g > main_data.r && main_data.g > main_data.b) {
-                    rgb_green(&rgb_leds);
-                    main_data.dom_color = DOM_GREEN;
-                } else {
-                    rgb_blue(&rgb_leds);
-                    main_data.dom_color = DOM_BLUE;
+                color_calculation();
+
+                health_calculation();
+
+                if (governor_tier(&governor)->leds) {
+                    rgb_led_write(&rgb_leds, color_bin_led_mask(&color_cfg, &main_data.color));
                 }
 
-                display_measurements();
+                report_sample(0);
 
                 k_sem_take(&main_sem, K_FOREVER);
 
                 break;
 
             case NORMAL_MODE:
-                green(&leds);
+                show_mode(green);
                 flags = 0;
 
                 if(previous_mode != NORMAL_MODE) {
                     k_timer_stop(&main_timer);
                     k_timer_start(&main_timer, K_MSEC(NORMAL_PERIOD), K_MSEC(NORMAL_PERIOD));
-                    k_timer_start(&rgb_timer, K_MSEC(RGB_TIMER_PERIOD), K_MSEC(RGB_TIMER_PERIOD));
+                    if (governor_tier(&governor)->leds) {
+                        k_timer_start(&rgb_timer, K_MSEC(RGB_TIMER_PERIOD), K_MSEC(RGB_TIMER_PERIOD));
+                    }
                     previous_mode = NORMAL_MODE;
                 }
 
-                k_sem_give(ctx.sensors_sem);
-                k_sem_give(ctx.gps_sem);
-
-                k_sem_take(ctx.main_sensors_sem, K_FOREVER);
-                k_sem_take(ctx.main_gps_sem, K_FOREVER);
+                sample_sensors();
 
                 get_measurements();
 
                 check_limits(&flags);
 
+                color_calculation();
+
+                health_calculation();
+
                 stats_management();
-                
-                display_measurements();
+
+                /* Only anomalies and periodic summaries are reported */
+                anomalies = anomaly_check();
+                if (anomalies) {
+                    anomaly_print(anomalies);
+                }
+
+                if (report_in_slot(anomalies)) {
+                    routine_samples = 0;
+                } else if (anomalies ||
+                    ++routine_samples >= SUMMARY_SAMPLES * governor_tier(&governor)->report_scale) {
+                    report_sample(anomalies);
+                    routine_samples = 0;
+                }
 
                 k_sem_take(&main_sem, K_FOREVER);
                 
                 break;
 
             case ADVANCED_MODE:
-                red(&leds);
+                show_mode(red);
 
                 if(previous_mode != ADVANCED_MODE) {
                     k_timer_stop(&rgb_timer);
@@ -874,31 +2003,38 @@ int main(void)
                     previous_mode = ADVANCED_MODE;
                 }
 
-                k_sem_give(ctx.sensors_sem);
-                k_sem_give(ctx.gps_sem);
-
-                k_sem_take(ctx.main_sensors_sem, K_FOREVER);
-                k_sem_take(ctx.main_gps_sem, K_FOREVER);
+                sample_sensors();
 
                 get_measurements();
 
-                display_measurements();
+                color_calculation();
+
+                health_calculation();
+
+                report_sample(0);
 
                 if (main_data.c <= 0.0f) {
                     printk("[WARN] - Color clear channel == 0\n");
-                    r_norm = g_norm = b_norm = 0.0f;
+                    r_norm = g_norm = b_norm = 0;
                 } else {
-                    r_norm = (main_data.r / main_data.c) * 100.0f;
-                    g_norm = (main_data.g / main_data.c) * 100.0f;
-                    b_norm = (main_data.b / main_data.c) * 100.0f;
+                    /* Q8 channel / clear ratios, saturated at 100% */
+                    r_norm = MIN(main_data.color.norm_r, COLOR_Q8_ONE);
+                    g_norm = MIN(main_data.color.norm_g, COLOR_Q8_ONE);
+                    b_norm = MIN(main_data.color.norm_b, COLOR_Q8_ONE);
                 }
 
-                printk("NORMALIZED COLOR VALUES: R: %.2f%%, G: %.2f%%, B: %.2f%%\n\n",
-                        (double)r_norm, (double)g_norm, (double)b_norm);
+                printk("NORMALIZED COLOR VALUES: R: %u%%, G: %u%%, B: %u%%\n\n",
+                        (r_norm * 100) >> 8, (g_norm * 100) >> 8, (b_norm * 100) >> 8);
+
+                if (!governor_tier(&governor)->leds) {
+                    /* No color display: sleep until the next cycle */
+                    k_sem_take(&main_sem, K_FOREVER);
+                    break;
+                }
 
-                r_duty = (int)(r_norm * PWM_STEPS / 100);
-                g_duty = (int)(g_norm * PWM_STEPS / 100);
-                b_duty = (int)(b_norm * PWM_STEPS / 100);
+                r_duty = (int)((r_norm * PWM_STEPS) >> 8);
+                g_duty = (int)((g_norm * PWM_STEPS) >> 8);
+                b_duty = (int)((b_norm * PWM_STEPS) >> 8);
 
                 keep_running = true;
                 while (keep_running) {
@@ -908,6 +2044,7 @@ int main(void)
                         b_value = (t < b_duty) ? 1 : 0;
 
                         rgb_led_pwm_step(&rgb_leds, r_value, g_value, b_value);
+                        energy_cpu_estimate(ENERGY_CPU_WAKE_US);
                         k_sleep(K_MSEC(PWM_STEP));                      
 
                         if (k_sem_take(&main_sem, K_NO_WAIT) == 0) {
@@ -18,10 +18,37 @@
 #include "sensors/i2c/accel.h"
 #include "sensors/i2c/temp_hum.h"
 #include "sensors/i2c/color.h"
+#include "sensors/i2c/i2c_mux.h"
 #include "sensors/gps/gps.h"
 #include "sensors/led/rgb_led.h"
 #include "sensors/led/board_led.h"
 #include "sensors/user_button/user_button.h"
+#include "analysis/light_fusion.h"
+
+#define MAX_SOIL_PROBES       8  /**< Maximum number of soil moisture probes. */
+#define MAX_SENSOR_INSTANCES  4  /**< Maximum instances of each I2C sensor type. */
+#define MAX_I2C_SENSORS       (3 * MAX_SENSOR_INSTANCES) /**< Maximum I2C sensor slots. */
+
+/**
+ * @enum i2c_sensor_type_t
+ * @brief Types of I2C sensors handled by the sensors thread.
+ */
+typedef enum {
+    SENSOR_ACCEL = 0,   /**< MMA8451Q accelerometer. */
+    SENSOR_TEMP_HUM,    /**< Si7021 temperature and humidity sensor. */
+    SENSOR_COLOR        /**< TCS34725 color sensor. */
+} i2c_sensor_type_t;
+
+/**
+ * @struct i2c_sensor_slot
+ * @brief One I2C sensor instance and the multiplexer channel it sits behind.
+ */
+struct i2c_sensor_slot {
+    i2c_sensor_type_t type;         /**< Sensor type. */
+    uint8_t instance;               /**< Instance index within its type (0 = primary). */
+    uint8_t mux_channel;            /**< TCA9548A channel, or @ref I2C_MUX_NONE. */
+    struct i2c_dt_spec spec;        /**< I2C bus and address of the sensor. */
+};
 
 /**
  * @struct system_context
@@ -31,19 +58,26 @@
  * and shared state used to coordinate between the main, sensors, and GPS threads.
  */
 struct system_context {
-    struct adc_config *phototransistor; /**< Phototransistor ADC configuration. */
-    struct adc_config *soil_moisture;   /**< Soil moisture ADC configuration. */
+    const struct adc_config *phototransistor; /**< Phototransistor ADC configuration. */
+    const struct adc_config *soil_probes;     /**< Array of soil moisture probe ADC configurations. */
+    size_t soil_probe_count;            /**< Number of soil moisture probes (≤ @ref MAX_SOIL_PROBES). */
 
-    struct i2c_dt_spec *accelerometer;  /**< Accelerometer I2C device specification. */
+    struct i2c_mux *i2c_mux;            /**< I2C multiplexer, or NULL if all sensors are on the bus. */
+    const struct i2c_sensor_slot *i2c_sensors; /**< I2C sensor instances. */
+    size_t i2c_sensor_count;            /**< Number of I2C sensor instances (≤ @ref MAX_I2C_SENSORS). */
     uint8_t accel_range;                /**< Accelerometer full-scale range (e.g., 2G, 4G, 8G). */
 
-    struct i2c_dt_spec *temp_hum;       /**< Temperature and humidity sensor I2C specification. */
-    struct i2c_dt_spec *color;          /**< Color sensor I2C device specification. */
-    struct gps_config *gps;             /**< GPS module configuration. */
+    /* Sensor profile in use; changed by main only while the sensor cache is held */
+    uint8_t color_gain;                 /**< Color sensor gain (GAIN_*). */
+    uint8_t color_atime;                /**< Color sensor integration time (ATIME). */
+    uint8_t adc_oversampling;           /**< ADC oversampling ratio exponent. */
+    uint32_t color_refresh_ms;          /**< Longest time between color readings; 0 = every cycle. */
+
+    struct light_fusion *light_fusion;  /**< Brightness / clear channel calibration (updated by the sensors thread). */
+
+    const struct gps_config *gps;       /**< GPS module configuration. */
 
-    struct k_sem *main_sensors_sem;     /**< Semaphore for main-to-sensors synchronization. */
     struct k_sem *main_gps_sem;         /**< Semaphore for main-to-GPS synchronization. */
-    struct k_sem *sensors_sem;          /**< Semaphore to trigger sensor measurement. */
     struct k_sem *gps_sem;              /**< Semaphore to trigger GPS measurement. */
 };
 
@@ -56,25 +90,32 @@ struct system_context {
  */
 struct system_measurement {
     atomic_t brightness;  /**< Latest ambient brightness (0–100%). */
-    atomic_t moisture;    /**< Latest soil moisture (0–100%). */
+    atomic_t moisture;    /**< Latest soil moisture, mean of all probes (0–100%). */
+    atomic_t moisture_probe[MAX_SOIL_PROBES]; /**< Latest soil moisture per probe. */
 
     atomic_t accel_x_g;   /**< Latest X-axis acceleration (in g). */
     atomic_t accel_y_g;   /**< Latest Y-axis acceleration (in g). */
     atomic_t accel_z_g;   /**< Latest Z-axis acceleration (in g). */
 
-    atomic_t temp;        /**< Latest temperature (°C). */
-    atomic_t hum;         /**< Latest relative humidity (%RH). */
+    atomic_t temp;        /**< Latest temperature of the primary sensor (°C). */
+    atomic_t hum;         /**< Latest relative humidity of the primary sensor (%RH). */
+    atomic_t temp_inst[MAX_SENSOR_INSTANCES]; /**< Latest temperature per sensor instance. */
+    atomic_t hum_inst[MAX_SENSOR_INSTANCES];  /**< Latest humidity per sensor instance. */
 
-    atomic_t red;         /**< Latest red color value (raw). */
-    atomic_t green;       /**< Latest green color value (raw). */
-    atomic_t blue;        /**< Latest blue color value (raw). */
-    atomic_t clear;       /**< Latest clear color channel value (raw). */
+    atomic_t red;         /**< Latest red color value of the primary sensor (raw). */
+    atomic_t green;       /**< Latest green color value of the primary sensor (raw). */
+    atomic_t blue;        /**< Latest blue color value of the primary sensor (raw). */
+    atomic_t clear;       /**< Latest clear color channel value of the primary sensor (raw). */
+    atomic_t red_inst[MAX_SENSOR_INSTANCES];   /**< Latest red value per sensor instance. */
+    atomic_t green_inst[MAX_SENSOR_INSTANCES]; /**< Latest green value per sensor instance. */
+    atomic_t blue_inst[MAX_SENSOR_INSTANCES];  /**< Latest blue value per sensor instance. */
+    atomic_t clear_inst[MAX_SENSOR_INSTANCES]; /**< Latest clear value per sensor instance. */
 
     atomic_t gps_lat;     /**< Latest GPS latitude (degrees). */
     atomic_t gps_lon;     /**< Latest GPS longitude (degrees). */
     atomic_t gps_alt;     /**< Latest GPS altitude (meters). */
     atomic_t gps_sats;    /**< Latest number of satellites in view. */
-    atomic_t gps_time;    /**< Latest GPS timestamp (float or encoded). */
+    atomic_t gps_time;    /**< UTC time of the latest GGA sentence as hhmmss, -1 if unknown. */
 };
 
 #endif /* MAIN_H */
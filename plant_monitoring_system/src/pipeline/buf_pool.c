@@ -0,0 +1,93 @@
+/**
+ * @file buf_pool.c
+ * @brief Reference-counted buffers allocated from k_mem_slab pools.
+ */
+
+#include "buf_pool.h"
+#include <zephyr/sys/printk.h>
+#include <errno.h>
+
+/**
+ * @brief Header of a buffer returned by @ref buf_alloc.
+ */
+static inline struct buf_hdr *buf_hdr_of(void *buf)
+{
+    return (struct buf_hdr *)((char *)buf - BUF_HDR_SIZE);
+}
+
+int buf_pool_init(struct buf_pool *pool)
+{
+    if (k_mem_slab_init(&pool->slab, pool->storage, pool->block_size, pool->count) != 0) {
+        return -EINVAL;
+    }
+
+    atomic_set(&pool->used, 0);
+    atomic_set(&pool->high_water, 0);
+    atomic_set(&pool->failures, 0);
+    return 0;
+}
+
+void *buf_alloc(struct buf_pool *pool, k_timeout_t timeout)
+{
+    void *mem;
+
+    if (k_mem_slab_alloc(&pool->slab, &mem, timeout) != 0) {
+        atomic_inc(&pool->failures);
+        return NULL;
+    }
+
+    struct buf_hdr *hdr = mem;
+
+    hdr->pool = pool;
+    atomic_set(&hdr->refs, 1);
+
+    /* Raise the high-water mark; retry if another allocation raced us */
+    atomic_val_t used = atomic_inc(&pool->used) + 1;
+    atomic_val_t high = atomic_get(&pool->high_water);
+
+    while (used > high && !atomic_cas(&pool->high_water, high, used)) {
+        high = atomic_get(&pool->high_water);
+    }
+
+    return (char *)mem + BUF_HDR_SIZE;
+}
+
+void *buf_ref(void *buf)
+{
+    atomic_inc(&buf_hdr_of(buf)->refs);
+    return buf;
+}
+
+void buf_unref(void *buf)
+{
+    if (buf == NULL) {
+        return;
+    }
+
+    struct buf_hdr *hdr = buf_hdr_of(buf);
+
+    /* atomic_dec() returns the previous value */
+    if (atomic_dec(&hdr->refs) == 1) {
+        struct buf_pool *pool = hdr->pool;
+
+        atomic_dec(&pool->used);
+        k_mem_slab_free(&pool->slab, hdr);
+    }
+}
+
+void buf_pool_metrics(struct buf_pool *pool, struct buf_pool_metrics *out)
+{
+    out->used = (uint32_t)atomic_get(&pool->used);
+    out->count = pool->count;
+    out->high_water = (uint32_t)atomic_get(&pool->high_water);
+    out->failures = (uint32_t)atomic_get(&pool->failures);
+}
+
+void buf_pool_print(struct buf_pool *pool)
+{
+    struct buf_pool_metrics m;
+
+    buf_pool_metrics(pool, &m);
+    printk("[POOL] - %s: used %u/%u (max %u), %u allocation failure(s)\n",
+           pool->name, m.used, m.count, m.high_water, m.failures);
+}
@@ -0,0 +1,129 @@
+/**
+ * @file buf_pool.h
+ * @brief Fixed-size, reference-counted buffer pools on top of k_mem_slab.
+ *
+ * Transient buffers (records handed between pipeline stages, encoded
+ * frames) come from statically sized pools instead of stacks or dedicated
+ * static arrays, so the memory they can take is known at build time.
+ *
+ * A buffer is allocated with one reference, owned by the caller. Passing the
+ * buffer to another thread passes that reference; @ref buf_ref adds one for
+ * each extra consumer, so one buffer can go to several stages without being
+ * copied. The last @ref buf_unref returns it to its pool.
+ *
+ * Shared buffers are read-only by convention: write a buffer only while
+ * holding its only reference.
+ */
+
+#ifndef BUF_POOL_H
+#define BUF_POOL_H
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
+#include <stdint.h>
+
+/**
+ * @brief Header stored in front of every buffer.
+ */
+struct buf_hdr {
+    struct buf_pool *pool;  /**< Pool the buffer belongs to. */
+    atomic_t refs;          /**< References held. */
+};
+
+#define BUF_HDR_SIZE ROUND_UP(sizeof(struct buf_hdr), 8)  /**< Header size, keeping payloads 8-byte aligned. */
+
+/** @brief Slab block size for buffers of @p size bytes. */
+#define BUF_POOL_BLOCK_SIZE(size) ROUND_UP(BUF_HDR_SIZE + (size), 8)
+
+/**
+ * @brief Pool occupancy and counters.
+ */
+struct buf_pool_metrics {
+    uint32_t used;        /**< Buffers allocated now. */
+    uint32_t count;       /**< Buffers in the pool. */
+    uint32_t high_water;  /**< Most buffers ever allocated at once. */
+    uint32_t failures;    /**< Allocations that found the pool empty. */
+};
+
+/**
+ * @brief Pool of equally sized buffers.
+ *
+ * Define with @ref BUF_POOL_DEFINE.
+ */
+struct buf_pool {
+    struct k_mem_slab slab;   /**< Underlying slab. */
+    const char *name;         /**< Name used in reports. */
+    char *storage;            /**< Slab storage. */
+    size_t block_size;        /**< Slab block size (header included). */
+    uint32_t count;           /**< Buffers in the pool. */
+    atomic_t used;            /**< Buffers allocated now. */
+    atomic_t high_water;      /**< Most buffers ever allocated at once. */
+    atomic_t failures;        /**< Failed allocations. */
+};
+
+/**
+ * @brief Statically define a buffer pool.
+ *
+ * @param pname Variable name.
+ * @param size Usable size of each buffer, in bytes.
+ * @param num Number of buffers.
+ */
+#define BUF_POOL_DEFINE(pname, size, num)                                       \
+    static char __aligned(8) pname##_storage[(num) * BUF_POOL_BLOCK_SIZE(size)]; \
+    static struct buf_pool pname = {                                            \
+        .name = #pname,                                                         \
+        .storage = pname##_storage,                                             \
+        .block_size = BUF_POOL_BLOCK_SIZE(size),                                \
+        .count = (num),                                                         \
+    }
+
+/**
+ * @brief Initialize a buffer pool.
+ *
+ * @param pool Pool defined with @ref BUF_POOL_DEFINE.
+ * @retval 0 On success.
+ * @retval -EINVAL If the slab could not be set up.
+ */
+int buf_pool_init(struct buf_pool *pool);
+
+/**
+ * @brief Allocate a buffer holding one reference. ISR-safe with K_NO_WAIT.
+ *
+ * @param pool Pool to allocate from.
+ * @param timeout How long to wait for a free buffer.
+ * @return Buffer, or NULL if the pool stayed empty.
+ */
+void *buf_alloc(struct buf_pool *pool, k_timeout_t timeout);
+
+/**
+ * @brief Add a reference to a buffer. ISR-safe.
+ *
+ * @param buf Buffer from @ref buf_alloc.
+ * @return @p buf, for use in calls that take the new reference.
+ */
+void *buf_ref(void *buf);
+
+/**
+ * @brief Drop a reference, freeing the buffer with the last one. ISR-safe.
+ *
+ * @param buf Buffer from @ref buf_alloc, or NULL (ignored).
+ */
+void buf_unref(void *buf);
+
+/**
+ * @brief Get the occupancy and counters of a pool.
+ *
+ * @param pool Pool.
+ * @param out Output metrics.
+ */
+void buf_pool_metrics(struct buf_pool *pool, struct buf_pool_metrics *out);
+
+/**
+ * @brief Print the metrics of a pool on one line.
+ *
+ * @param pool Pool.
+ */
+void buf_pool_print(struct buf_pool *pool);
+
+#endif /* BUF_POOL_H */
@@ -0,0 +1,200 @@
+/**
+ * @file pipeline.c
+ * @brief Stage queues with overflow policies and the stage threads.
+ */
+
+#include "pipeline.h"
+#include <zephyr/sys/printk.h>
+#include <zephyr/sys/util.h>
+#include <errno.h>
+#include <string.h>
+
+#define PIPELINE_STACK_SIZE 2048  /**< Stack of each stage thread. */
+#define PIPELINE_PRIORITY   8     /**< Below the sensors and GPS threads. */
+
+K_THREAD_STACK_ARRAY_DEFINE(stage_stacks, PIPELINE_MAX_STAGES, PIPELINE_STACK_SIZE);
+static struct k_thread stage_threads[PIPELINE_MAX_STAGES];
+
+int stage_queue_init(struct stage_queue *q)
+{
+    if (q->capacity == 0 ||
+        (q->policy == STAGE_DOWNSAMPLE && q->downsample < 2) ||
+        (q->policy == STAGE_COALESCE && q->coalesce == NULL)) {
+        return -EINVAL;
+    }
+
+    k_msgq_init(&q->msgq, q->buffer, sizeof(void *), q->capacity);
+    q->pending = NULL;
+    q->skip = 0;
+    memset(&q->metrics, 0, sizeof(q->metrics));
+    q->metrics.capacity = q->capacity;
+    return 0;
+}
+
+/**
+ * @brief Queue an item if there is room and track the high-water mark.
+ */
+static int stage_queue_put(struct stage_queue *q, void *item)
+{
+    int ret = k_msgq_put(&q->msgq, &item, K_NO_WAIT);
+
+    if (ret == 0) {
+        uint32_t used = k_msgq_num_used_get(&q->msgq);
+        q->metrics.high_water = MAX(q->metrics.high_water, used);
+    }
+    return ret;
+}
+
+int stage_queue_push(struct stage_queue *q, void *item)
+{
+    k_spinlock_key_t key;
+
+    q->metrics.offered++;
+
+    key = k_spin_lock(&q->lock);
+    if (q->pending != NULL) {
+        /* Keep order: the pending item goes first, or absorbs this one */
+        if (stage_queue_put(q, q->pending) != 0) {
+            void *keep = q->coalesce(q->pending, item);
+            void *merged = (keep == item) ? q->pending : item;
+
+            q->pending = keep;
+            q->metrics.coalesced++;
+            k_spin_unlock(&q->lock, key);
+            buf_unref(merged);
+            return 0;
+        }
+        q->pending = NULL;
+    }
+    k_spin_unlock(&q->lock, key);
+
+    if (q->policy == STAGE_DOWNSAMPLE &&
+        k_msgq_num_used_get(&q->msgq) >= q->capacity / 2 &&
+        (q->skip++ % q->downsample) != 0) {
+        buf_unref(item);
+        q->metrics.downsampled++;
+        return -EAGAIN;
+    }
+
+    if (stage_queue_put(q, item) == 0) {
+        return 0;
+    }
+
+    switch (q->policy) {
+    case STAGE_DROP_OLDEST: {
+        /* The consumer may have made room meanwhile, so the get can find nothing */
+        void *oldest;
+        int ret = 0;
+
+        if (k_msgq_get(&q->msgq, &oldest, K_NO_WAIT) == 0) {
+            buf_unref(oldest);
+            q->metrics.dropped++;
+            ret = -ENOBUFS;
+        }
+        if (stage_queue_put(q, item) != 0) {
+            buf_unref(item);
+            q->metrics.dropped++;
+            ret = -ENOBUFS;
+        }
+        return ret;
+    }
+    case STAGE_COALESCE:
+        /* Only park the item while the queue is full: an empty queue would
+         * leave it to a consumer already waiting on the message queue */
+        key = k_spin_lock(&q->lock);
+        if (stage_queue_put(q, item) != 0) {
+            q->pending = item;
+        }
+        k_spin_unlock(&q->lock, key);
+        return 0;
+    case STAGE_DOWNSAMPLE:
+    default:
+        buf_unref(item);
+        q->metrics.dropped++;
+        return -ENOBUFS;
+    }
+}
+
+int stage_queue_get(struct stage_queue *q, void **item, k_timeout_t timeout)
+{
+    if (q->policy == STAGE_COALESCE) {
+        k_spinlock_key_t key;
+
+        if (k_msgq_get(&q->msgq, item, K_NO_WAIT) == 0) {
+            return 0;
+        }
+        /* Queue drained: the pending item is the newest, hand it over now
+         * rather than at the next push, which may be a sample period away */
+        key = k_spin_lock(&q->lock);
+        *item = q->pending;
+        q->pending = NULL;
+        k_spin_unlock(&q->lock, key);
+        if (*item != NULL) {
+            return 0;
+        }
+    }
+
+    return k_msgq_get(&q->msgq, item, timeout) == 0 ? 0 : -EAGAIN;
+}
+
+void stage_queue_metrics(struct stage_queue *q, struct stage_metrics *out)
+{
+    *out = q->metrics;
+    out->depth = k_msgq_num_used_get(&q->msgq) + (q->pending != NULL ? 1 : 0);
+}
+
+void stage_queue_print(struct stage_queue *q)
+{
+    struct stage_metrics m;
+
+    stage_queue_metrics(q, &m);
+    printk("[PIPELINE] - %s: depth %u/%u (max %u), offered %u, dropped %u, downsampled %u, coalesced %u\n",
+           q->name, m.depth, m.capacity, m.high_water, m.offered, m.dropped, m.downsampled, m.coalesced);
+}
+
+/**
+ * @brief Stage thread: take, handle and forward items.
+ *
+ * @param arg1 Pointer to the @ref pipeline_stage.
+ */
+static void stage_thread_fn(void *arg1, void *arg2, void *arg3)
+{
+    const struct pipeline_stage *stage = arg1;
+    void *item;
+
+    while (1) {
+        if (stage_queue_get(stage->in, &item, K_FOREVER) != 0) {
+            continue;
+        }
+        stage->handler(item);
+        if (stage->out != NULL) {
+            stage_queue_push(stage->out, item);
+        } else {
+            buf_unref(item);
+        }
+    }
+}
+
+int pipeline_start(const struct pipeline_stage *stages, size_t count)
+{
+    if (count > PIPELINE_MAX_STAGES) {
+        return -EINVAL;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        if (stages[i].in == NULL || stages[i].handler == NULL) {
+            printk("[PIPELINE] - Stage %s: missing input queue or handler\n", stages[i].name);
+            return -EINVAL;
+        }
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        k_thread_create(&stage_threads[i], stage_stacks[i], K_THREAD_STACK_SIZEOF(stage_stacks[i]),
+                        stage_thread_fn, (void *)&stages[i], NULL, NULL,
+                        PIPELINE_PRIORITY, 0, K_NO_WAIT);
+        k_thread_name_set(&stage_threads[i], stages[i].name);
+    }
+
+    printk("[PIPELINE] - %d stage(s) started\n", (int)count);
+    return 0;
+}
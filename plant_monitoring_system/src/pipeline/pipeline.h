@@ -0,0 +1,187 @@
+/**
+ * @file pipeline.h
+ * @brief Bounded, non-blocking processing pipeline between threads.
+ *
+ * A pipeline is a set of stages, each running in its own thread and
+ * fed by a bounded @ref stage_queue. Pushing into a queue never blocks:
+ * when the consumer falls behind, the queue's overflow policy decides what
+ * is lost, so the producer (the acquisition loop) keeps its timing
+ * whatever happens downstream.
+ *
+ * Items are @ref buf_pool buffers. Pushing a buffer passes one reference
+ * to the queue; the queue releases the references of the items it drops,
+ * and a stage releases its item once handled unless it forwards it. To
+ * feed several stages with the same buffer, take one reference per queue.
+ *
+ * Policies:
+ * - @ref STAGE_DROP_OLDEST: the oldest queued item is discarded.
+ * - @ref STAGE_DOWNSAMPLE: once the queue is half full, only one item in
+ *   @c downsample is accepted; the newest is dropped if it is still full.
+ * - @ref STAGE_COALESCE: items that do not fit are merged into one pending
+ *   item (see @c coalesce), queued by the first push that finds room or
+ *   taken by the consumer once it has emptied the queue.
+ *
+ * Each queue has a single producer, so the producer-side state needs no
+ * locking; the underlying @c k_msgq is safe between producer and consumer,
+ * and the pending item, shared by both, is guarded by a spinlock.
+ */
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <zephyr/kernel.h>
+#include <stdint.h>
+#include "buf_pool.h"
+
+#define PIPELINE_MAX_STAGES 4  /**< Stage threads available. */
+
+/**
+ * @brief Overflow policy of a stage queue.
+ */
+enum stage_policy {
+    STAGE_DROP_OLDEST = 0,  /**< Discard the oldest item to make room. */
+    STAGE_DOWNSAMPLE,       /**< Keep 1 in N items above half occupancy. */
+    STAGE_COALESCE,         /**< Merge overflowing items into one. */
+};
+
+/**
+ * @brief Merge two items into one (@ref STAGE_COALESCE).
+ *
+ * @param older Item waiting in the queue.
+ * @param newer Item being pushed.
+ * @return The item to keep, @p older or @p newer; the queue releases the other.
+ */
+typedef void *(*stage_coalesce_t)(void *older, void *newer);
+
+/**
+ * @brief Queue counters and occupancy.
+ */
+struct stage_metrics {
+    uint32_t depth;        /**< Items queued now. */
+    uint32_t capacity;     /**< Queue length. */
+    uint32_t high_water;   /**< Most items ever queued. */
+    uint32_t offered;      /**< Items pushed by the producer. */
+    uint32_t dropped;      /**< Items discarded (oldest or newest). */
+    uint32_t downsampled;  /**< Items skipped by downsampling. */
+    uint32_t coalesced;    /**< Items merged into a pending item. */
+};
+
+/**
+ * @brief Bounded queue between two pipeline stages.
+ *
+ * Define with @ref STAGE_QUEUE_DEFINE.
+ */
+struct stage_queue {
+    struct k_msgq msgq;             /**< Underlying message queue of buffer pointers. */
+    const char *name;               /**< Name used in reports. */
+    char *buffer;                   /**< Ring storage for @c msgq. */
+    void *pending;                  /**< Coalesced item waiting for room, or NULL. */
+    struct k_spinlock lock;         /**< Guards @c pending. */
+    uint32_t capacity;              /**< Queue length. */
+    enum stage_policy policy;       /**< Overflow policy. */
+    uint8_t downsample;             /**< Keep 1 item in this many (@ref STAGE_DOWNSAMPLE). */
+    stage_coalesce_t coalesce;      /**< Merge function (@ref STAGE_COALESCE). */
+    uint32_t skip;                  /**< Downsampling phase. */
+    struct stage_metrics metrics;   /**< Counters. */
+};
+
+/**
+ * @brief Statically define a stage queue.
+ *
+ * @param qname Variable name.
+ * @param len Queue length.
+ * @param pol Overflow policy.
+ * @param factor Downsampling factor (@ref STAGE_DOWNSAMPLE, else ignored).
+ * @param merge Merge function (@ref STAGE_COALESCE, else NULL).
+ */
+#define STAGE_QUEUE_DEFINE(qname, len, pol, factor, merge)                        \
+    static char __aligned(sizeof(void *)) qname##_buffer[(len) * sizeof(void *)]; \
+    static struct stage_queue qname = {                                           \
+        .name = #qname,                                                           \
+        .buffer = qname##_buffer,                                                 \
+        .capacity = (len),                                                        \
+        .policy = (pol),                                                          \
+        .downsample = (factor),                                                   \
+        .coalesce = (merge),                                                      \
+    }
+
+/**
+ * @brief One stage of a pipeline.
+ *
+ * The stage thread takes items from @c in, runs @c handler and then passes
+ * the item to @c out, if any, or releases it. The handler may modify the
+ * item for the next stage if it holds the only reference.
+ */
+struct pipeline_stage {
+    const char *name;              /**< Thread name. */
+    struct stage_queue *in;        /**< Input queue. */
+    struct stage_queue *out;       /**< Output queue, or NULL for the last stage. */
+    void (*handler)(void *item);   /**< Work done on each item; must not release it. */
+};
+
+/**
+ * @brief Initialize a stage queue.
+ *
+ * @param q Queue defined with @ref STAGE_QUEUE_DEFINE.
+ * @retval 0 On success.
+ * @retval -EINVAL If the configuration is inconsistent.
+ */
+int stage_queue_init(struct stage_queue *q);
+
+/**
+ * @brief Push an item without blocking, applying the overflow policy.
+ *
+ * Must only be called by the queue's producer. The queue takes the
+ * caller's reference to @p item, even if the item is dropped.
+ *
+ * @param q Queue.
+ * @param item Buffer from @ref buf_alloc.
+ * @retval 0 If the item was queued or merged into the pending item.
+ * @retval -ENOBUFS If the item (or an older one) was dropped.
+ * @retval -EAGAIN If the item was skipped by downsampling.
+ */
+int stage_queue_push(struct stage_queue *q, void *item);
+
+/**
+ * @brief Take the next item.
+ *
+ * The caller receives the queue's reference to the item. Once the queue is
+ * empty, the pending coalesced item, if any, is returned without waiting
+ * for the next push.
+ *
+ * @param q Queue.
+ * @param item Output item.
+ * @param timeout How long to wait for an item.
+ * @retval 0 On success.
+ * @retval -EAGAIN If no item arrived in time.
+ */
+int stage_queue_get(struct stage_queue *q, void **item, k_timeout_t timeout);
+
+/**
+ * @brief Get the counters and occupancy of a queue.
+ *
+ * @param q Queue.
+ * @param out Output metrics.
+ */
+void stage_queue_metrics(struct stage_queue *q, struct stage_metrics *out);
+
+/**
+ * @brief Print the metrics of a queue on one line.
+ *
+ * @param q Queue.
+ */
+void stage_queue_print(struct stage_queue *q);
+
+/**
+ * @brief Start one thread per stage.
+ *
+ * Stage threads run at a lower priority than the acquisition threads.
+ *
+ * @param stages Stage descriptors; must stay valid.
+ * @param count Number of stages (≤ @ref PIPELINE_MAX_STAGES).
+ * @retval 0 On success.
+ * @retval -EINVAL If there are too many stages or a stage has no input queue or handler.
+ */
+int pipeline_start(const struct pipeline_stage *stages, size_t count);
+
+#endif /* PIPELINE_H */
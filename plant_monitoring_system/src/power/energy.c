@@ -0,0 +1,209 @@
+/**
+ * @file energy.c
+ * @brief Per-mode active-time accounting and current model.
+ *
+ * Interval charges go straight to the current mode. Level rails and the
+ * elapsed time are integrated lazily: every update first adds
+ * `level × (now − last update)` to the current mode, so a mode change or a
+ * report always sees up-to-date totals.
+ */
+
+#include "energy.h"
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+#include <zephyr/sys/util.h>
+#include <errno.h>
+
+#define ENERGY_LINE_SIZE 256  /**< Report line buffer. */
+
+const char *const energy_rail_names[ENERGY_RAIL_COUNT] = {
+    [ENERGY_CPU] = "cpu",
+    [ENERGY_I2C] = "i2c",
+    [ENERGY_ADC] = "adc",
+    [ENERGY_UART_RX] = "uart_rx",
+    [ENERGY_GPS] = "gps",
+    [ENERGY_RGB_LED] = "rgb_led",
+    [ENERGY_BOARD_LED] = "board_led",
+    [ENERGY_COLOR] = "color",
+};
+
+static struct k_spinlock lock;
+static const struct energy_model *model;
+static uint8_t mode;
+static uint8_t levels[ENERGY_RAIL_COUNT];
+static uint64_t last_us;
+static uint64_t last_cpu_cycles;
+static struct energy_usage usage[ENERGY_MAX_MODES];
+
+/**
+ * @brief Bring the current mode up to date. Must hold @ref lock.
+ *
+ * @param cpu_cycles Non-idle CPU cycles since boot (measured CPU only).
+ */
+static void energy_flush(uint64_t cpu_cycles)
+{
+    uint64_t now = k_ticks_to_us_floor64(k_uptime_ticks());
+    uint64_t delta = now - last_us;
+    struct energy_usage *u = &usage[mode];
+
+    u->elapsed_us += delta;
+    for (int i = 0; i < ENERGY_RAIL_COUNT; i++) {
+        u->active_us[i] += levels[i] * delta;
+    }
+    last_us = now;
+
+#if defined(CONFIG_SCHED_THREAD_USAGE_ALL)
+    u->active_us[ENERGY_CPU] += k_cyc_to_us_floor64(cpu_cycles - last_cpu_cycles);
+    last_cpu_cycles = cpu_cycles;
+#else
+    ARG_UNUSED(cpu_cycles);
+#endif
+}
+
+/**
+ * @brief Non-idle CPU cycles since boot, or 0 if not measured.
+ *
+ * Read outside @ref lock, as the scheduler statistics take their own lock.
+ */
+static uint64_t energy_cpu_cycles(void)
+{
+#if defined(CONFIG_SCHED_THREAD_USAGE_ALL)
+    k_thread_runtime_stats_t stats;
+
+    if (k_thread_runtime_stats_all_get(&stats) == 0) {
+        return stats.total_cycles;
+    }
+#endif
+    return last_cpu_cycles;
+}
+
+void energy_init(const struct energy_model *m, uint8_t initial_mode)
+{
+    uint64_t cpu = energy_cpu_cycles();
+    k_spinlock_key_t key = k_spin_lock(&lock);
+
+    energy_flush(cpu);
+    model = m;
+    mode = MIN(initial_mode, ENERGY_MAX_MODES - 1);
+    k_spin_unlock(&lock, key);
+}
+
+void energy_set_mode(uint8_t new_mode)
+{
+    if (new_mode >= ENERGY_MAX_MODES || new_mode == mode) {
+        return;
+    }
+
+    uint64_t cpu = energy_cpu_cycles();
+    k_spinlock_key_t key = k_spin_lock(&lock);
+
+    energy_flush(cpu);
+    mode = new_mode;
+    k_spin_unlock(&lock, key);
+}
+
+void energy_charge(enum energy_rail rail, uint32_t us)
+{
+    if (rail >= ENERGY_RAIL_COUNT) {
+        return;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+
+    usage[mode].active_us[rail] += us;
+    k_spin_unlock(&lock, key);
+}
+
+void energy_set_level(enum energy_rail rail, uint8_t level)
+{
+    if (rail >= ENERGY_RAIL_COUNT || levels[rail] == level) {
+        return;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+
+    energy_flush(last_cpu_cycles);
+    levels[rail] = level;
+    k_spin_unlock(&lock, key);
+}
+
+void energy_cpu_estimate(uint32_t us)
+{
+#if !defined(CONFIG_SCHED_THREAD_USAGE_ALL)
+    energy_charge(ENERGY_CPU, us);
+#else
+    ARG_UNUSED(us);
+#endif
+}
+
+int energy_get(uint8_t m, struct energy_usage *out)
+{
+    if (m >= ENERGY_MAX_MODES || out == NULL) {
+        return -EINVAL;
+    }
+
+    uint64_t cpu = energy_cpu_cycles();
+    k_spinlock_key_t key = k_spin_lock(&lock);
+
+    energy_flush(cpu);
+    *out = usage[m];
+    k_spin_unlock(&lock, key);
+    return 0;
+}
+
+uint32_t energy_average_ua(const struct energy_usage *u)
+{
+    if (model == NULL || u->elapsed_us == 0) {
+        return 0;
+    }
+
+    uint64_t charge = 0;  /* µA·µs above the idle current */
+
+    for (int i = 0; i < ENERGY_RAIL_COUNT; i++) {
+        charge += (uint64_t)model->active_ua[i] * u->active_us[i];
+    }
+    return model->idle_ua + (uint32_t)(charge / u->elapsed_us);
+}
+
+uint64_t energy_consumed_uas(void)
+{
+    struct energy_usage u;
+    uint64_t charge = 0;  /* µA·µs */
+
+    if (model == NULL) {
+        return 0;
+    }
+
+    for (uint8_t m = 0; m < ENERGY_MAX_MODES; m++) {
+        energy_get(m, &u);
+        charge += (uint64_t)model->idle_ua * u.elapsed_us;
+        for (int i = 0; i < ENERGY_RAIL_COUNT; i++) {
+            charge += (uint64_t)model->active_ua[i] * u.active_us[i];
+        }
+    }
+    return charge / USEC_PER_SEC;
+}
+
+void energy_report(void)
+{
+    static char line[ENERGY_LINE_SIZE];
+    struct energy_usage u;
+
+    for (uint8_t m = 0; m < ENERGY_MAX_MODES; m++) {
+        if (energy_get(m, &u) || u.elapsed_us < USEC_PER_SEC) {
+            continue;
+        }
+
+        uint32_t avg_ua = energy_average_ua(&u);
+        uint32_t centi_mah_day = avg_ua * 24U / 10U;  /* µA × 24 h, in 0.01 mAh */
+        size_t len = snprintk(line, sizeof(line), "@ENERGY mode=%u elapsed_s=%u avg_ua=%u mah_day=%u.%02u",
+                              m, (unsigned int)(u.elapsed_us / USEC_PER_SEC), avg_ua,
+                              centi_mah_day / 100U, centi_mah_day % 100U);
+
+        for (int i = 0; i < ENERGY_RAIL_COUNT && len < sizeof(line); i++) {
+            len += snprintk(line + len, sizeof(line) - len, " %s_ms=%llu", energy_rail_names[i],
+                            (unsigned long long)(u.active_us[i] / USEC_PER_MSEC));
+        }
+        printk("%s\n", line);
+    }
+}
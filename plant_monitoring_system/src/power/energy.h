@@ -0,0 +1,149 @@
+/**
+ * @file energy.h
+ * @brief Software energy estimator based on per-peripheral active time.
+ *
+ * Drivers report how long each power consumer ("rail") is active, either
+ * as intervals of known length (@ref energy_charge) or as a level that
+ * holds until it is changed (@ref energy_set_level, e.g. the number of LED
+ * channels on). Active time is accumulated per operating mode and combined
+ * with a datasheet-derived current model into an average current and a
+ * mAh/day figure, so scheduling and power features can be compared without
+ * measuring the hardware.
+ *
+ * Time is taken from the kernel uptime, so the estimate works in simulated
+ * time on native_sim. Where the transfer itself takes no time there (the
+ * emulated I2C, ADC and UART), drivers charge the time the transfer would
+ * take on the real bus instead of measuring it.
+ */
+
+#ifndef ENERGY_H
+#define ENERGY_H
+
+#include <stdint.h>
+
+#define ENERGY_MAX_MODES 3  /**< Operating modes accounted separately. */
+
+/**
+ * @brief Power consumers accounted by the estimator.
+ */
+enum energy_rail {
+    ENERGY_CPU = 0,     /**< CPU running (not idle). */
+    ENERGY_I2C,         /**< I2C bus transfer in progress. */
+    ENERGY_ADC,         /**< ADC conversion in progress. */
+    ENERGY_UART_RX,     /**< GPS UART receiving. */
+    ENERGY_GPS,         /**< GPS module powered. */
+    ENERGY_RGB_LED,     /**< RGB LED channels on. */
+    ENERGY_BOARD_LED,   /**< Board LEDs on. */
+    ENERGY_COLOR,       /**< Color sensors powered and integrating. */
+    ENERGY_RAIL_COUNT
+};
+
+/**
+ * @brief Current model of the node.
+ *
+ * Rail currents are the increase over @c idle_ua while one unit of the
+ * rail is active (one LED channel, one transfer, ...).
+ */
+struct energy_model {
+    uint32_t idle_ua;                       /**< Current with every rail inactive (µA). */
+    uint32_t active_ua[ENERGY_RAIL_COUNT];  /**< Extra current per active unit of each rail (µA). */
+};
+
+/**
+ * @brief Accumulated usage of one operating mode.
+ */
+struct energy_usage {
+    uint64_t elapsed_us;                    /**< Time spent in the mode (µs). */
+    uint64_t active_us[ENERGY_RAIL_COUNT];  /**< Active time of each rail, times its level (µs). */
+};
+
+/** @brief Short rail names, as printed by @ref energy_report. */
+extern const char *const energy_rail_names[ENERGY_RAIL_COUNT];
+
+/**
+ * @brief Set the current model and the initial operating mode.
+ *
+ * Usage reported before this call is kept and attributed to @p mode.
+ *
+ * @param model Current model; must stay valid.
+ * @param mode Initial operating mode (< @ref ENERGY_MAX_MODES).
+ */
+void energy_init(const struct energy_model *model, uint8_t mode);
+
+/**
+ * @brief Attribute the following usage to another operating mode.
+ *
+ * Does nothing if @p mode is already the current one.
+ *
+ * @param mode Operating mode (< @ref ENERGY_MAX_MODES).
+ */
+void energy_set_mode(uint8_t mode);
+
+/**
+ * @brief Add an interval of activity of known length. ISR-safe.
+ *
+ * @param rail Rail that was active.
+ * @param us Active time in microseconds.
+ */
+void energy_charge(enum energy_rail rail, uint32_t us);
+
+/**
+ * @brief Set how many units of a rail are active from now on. ISR-safe.
+ *
+ * @param rail Rail to update.
+ * @param level Active units (0 = off).
+ */
+void energy_set_level(enum energy_rail rail, uint8_t level);
+
+/**
+ * @brief Charge an estimate of CPU time that could not be measured.
+ *
+ * CPU time is measured from the scheduler when CONFIG_SCHED_THREAD_USAGE_ALL
+ * is enabled and this call does nothing. Otherwise (native_sim, where code
+ * runs in zero simulated time) callers charge their estimated run time.
+ *
+ * @param us Estimated CPU time in microseconds.
+ */
+void energy_cpu_estimate(uint32_t us);
+
+/**
+ * @brief Get the usage accumulated in one operating mode.
+ *
+ * @param mode Operating mode.
+ * @param out Output usage.
+ * @retval 0 On success.
+ * @retval -EINVAL If @p mode is out of range.
+ */
+int energy_get(uint8_t mode, struct energy_usage *out);
+
+/**
+ * @brief Average current of a usage record under the current model.
+ *
+ * @param usage Usage record.
+ * @return Average current in µA, or 0 if no time has elapsed.
+ */
+uint32_t energy_average_ua(const struct energy_usage *usage);
+
+/**
+ * @brief Charge drawn since boot, all modes together, under the current model.
+ *
+ * Meant for coulomb counting: the difference between two calls is the
+ * charge drawn in between.
+ *
+ * @return Charge in µA·s, or 0 if no model is set.
+ */
+uint64_t energy_consumed_uas(void);
+
+/**
+ * @brief Print one `@ENERGY` line per mode that has been used.
+ *
+ * @verbatim
+ *   @ENERGY mode=1 elapsed_s=86400 avg_ua=20512 mah_day=492.28 cpu_ms=4320 i2c_ms=1900 ...
+ * @endverbatim
+ *
+ * Figures are cumulative since boot; @c <rail>_ms is the active time of the
+ * rail times its level.
+ */
+void energy_report(void);
+
+#endif /* ENERGY_H */
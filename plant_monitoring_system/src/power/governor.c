@@ -0,0 +1,133 @@
+/**
+ * @file governor.c
+ * @brief Coulomb counting corrected by the open-circuit voltage, and tier
+ *        selection with hysteresis.
+ */
+
+#include "governor.h"
+#include <zephyr/sys/printk.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/sys/time_units.h>
+
+#define GOVERNOR_UAS_PER_MAH 3600000LL  /**< µA·s in one mAh. */
+
+/**
+ * @brief State of charge read on the open-circuit curve.
+ *
+ * @return State of charge in ‰, clamped to the ends of the curve.
+ */
+static int32_t ocv_permille(const struct governor_config *cfg, uint16_t mv)
+{
+    const struct governor_ocv_point *p = cfg->ocv;
+    size_t last = cfg->ocv_count - 1;
+
+    if (mv <= p[0].mv) {
+        return p[0].soc * 10;
+    }
+    if (mv >= p[last].mv) {
+        return p[last].soc * 10;
+    }
+
+    size_t i = 1;
+    while (p[i].mv < mv) {
+        i++;
+    }
+    return p[i - 1].soc * 10 +
+           (int32_t)(p[i].soc - p[i - 1].soc) * 10 * (mv - p[i - 1].mv) / (p[i].mv - p[i - 1].mv);
+}
+
+/**
+ * @brief Most generous tier allowed at a state of charge.
+ */
+static uint8_t tier_for(const struct governor_config *cfg, int32_t soc)
+{
+    for (size_t i = 0; i < cfg->tier_count; i++) {
+        if (soc >= cfg->tiers[i].min_soc) {
+            return (uint8_t)i;
+        }
+    }
+    return (uint8_t)(cfg->tier_count - 1);
+}
+
+void governor_init(struct governor *g, const struct governor_config *cfg)
+{
+    *g = (struct governor){ .cfg = cfg };
+}
+
+bool governor_update(struct governor *g, uint16_t vbat_mv, uint16_t vdda_mv,
+                     uint64_t consumed_uas, uint32_t now_ms)
+{
+    const struct governor_config *cfg = g->cfg;
+    int64_t capacity_uas = (int64_t)cfg->capacity_mah * GOVERNOR_UAS_PER_MAH;
+    int64_t voltage_uas = capacity_uas * ocv_permille(cfg, vbat_mv) / 1000;
+
+    if (!g->started) {
+        g->started = true;
+        g->charge_uas = voltage_uas;
+    } else {
+        uint64_t used = consumed_uas - g->consumed_uas;
+        uint32_t dt_ms = now_ms - g->updated_ms;
+
+        g->charge_uas -= (int64_t)used;
+        int64_t correction = (voltage_uas - g->charge_uas) / (1 << cfg->voltage_shift);
+        g->charge_uas = CLAMP(g->charge_uas + correction, 0, capacity_uas);
+
+        if (dt_ms > 0) {
+            int32_t harvest = (int32_t)(correction * MSEC_PER_SEC / dt_ms);
+            int32_t load = (int32_t)(used * MSEC_PER_SEC / dt_ms);
+            uint32_t *tier_load = &g->load_ua[g->tier];
+
+            g->harvest_ua += (harvest - g->harvest_ua) / (1 << cfg->harvest_shift);
+            /* The interval is charged to the tier that ran during it */
+            if (*tier_load == 0) {
+                *tier_load = (uint32_t)load;
+            } else {
+                *tier_load += (load - (int32_t)*tier_load) / (1 << cfg->harvest_shift);
+            }
+        }
+    }
+
+    g->consumed_uas = consumed_uas;
+    g->updated_ms = now_ms;
+    g->vbat_mv = vbat_mv;
+    g->vdda_mv = vdda_mv;
+    g->soc = capacity_uas ? (uint8_t)(g->charge_uas * 100 / capacity_uas) : 0;
+
+    uint8_t tier = tier_for(cfg, g->soc);
+
+    /* Moving up needs the charge to clear the threshold by the hysteresis */
+    if (tier < g->tier) {
+        tier = MIN(tier_for(cfg, (int32_t)g->soc - cfg->hysteresis), g->tier);
+    }
+    /* The harvest pays for the tier above (which draws at least what this one does) */
+    if (tier > 0 && g->harvest_ua > (int32_t)MAX(g->load_ua[tier - 1], g->load_ua[tier])) {
+        tier--;
+    }
+    if (vdda_mv < cfg->vdda_min_mv) {
+        tier = (uint8_t)(cfg->tier_count - 1);
+    }
+
+    if (tier == g->tier) {
+        return false;
+    }
+    g->tier = tier;
+    g->changes++;
+    return true;
+}
+
+const struct governor_tier *governor_tier(const struct governor *g)
+{
+    return &g->cfg->tiers[g->tier];
+}
+
+void governor_print(const struct governor *g)
+{
+    if (!g->started) {
+        printk("[POWER] - No supply measurement, tier %s\n", governor_tier(g)->name);
+        return;
+    }
+    printk("[POWER] - Charge %u %% (battery %u mV, VDDA %u mV), load %u uA, harvest %+d uA, "
+           "tier %s, %u change(s)\n",
+           g->soc, g->vbat_mv, g->vdda_mv, g->load_ua[g->tier], g->harvest_ua,
+           governor_tier(g)->name, g->changes);
+}
@@ -0,0 +1,130 @@
+/**
+ * @file governor.h
+ * @brief Energy tiers chosen from the battery charge and the harvest.
+ *
+ * The state of charge is tracked by coulomb counting, subtracting the
+ * charge the energy estimator accounts (@ref energy_consumed_uas), and
+ * pulled towards the charge read from the battery voltage on its
+ * open-circuit curve. The counter follows short-term changes that the flat
+ * voltage curve hides; the voltage corrects the counter's drift and
+ * brings in what it cannot see: the solar harvest and the errors of the
+ * current model. The correction, as a current, is the harvest estimate.
+ *
+ * The node then runs in the most generous tier its charge allows, most
+ * generous first:
+ *
+ * @code
+ * static const struct governor_tier tiers[] = {
+ *     { .name = "FULL",     .min_soc = 60, ... },
+ *     { .name = "ECO",      .min_soc = 35, ... },
+ *     { .name = "SURVIVAL", .min_soc = 0,  ... },
+ * };
+ * @endcode
+ *
+ * A tier is left for a more generous one only once the charge is
+ * @c hysteresis points above its threshold. The average current drawn in
+ * each tier is learned as it runs; while the harvest pays for the tier
+ * above the charge's, the node runs in that one. An analog supply below
+ * @c vdda_min_mv selects the last tier at once, whatever the estimate, so
+ * the node degrades before it browns out.
+ *
+ * Pure computation: no hardware access, no locking.
+ */
+
+#ifndef GOVERNOR_H
+#define GOVERNOR_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define GOVERNOR_MAX_TIERS 8  /**< Largest number of tiers. */
+
+/**
+ * @brief What the node may spend in one tier.
+ */
+struct governor_tier {
+    const char *name;        /**< Name used in reports. */
+    uint8_t min_soc;         /**< Lowest state of charge of the tier (%); 0 for the last one. */
+    uint16_t gps_every;      /**< GPS fix every N measurement cycles; 0 = GPS in standby. */
+    bool leds;               /**< LED effects (mode LEDs, RGB alerts, color display). */
+    bool saver_profile;      /**< Sensors use the low-power profile in every mode. */
+    uint8_t report_scale;    /**< Multiplier of the routine report interval. */
+};
+
+/**
+ * @brief A point of the battery's open-circuit voltage curve.
+ */
+struct governor_ocv_point {
+    uint16_t mv;   /**< Voltage (mV). */
+    uint8_t soc;   /**< State of charge at that voltage (%). */
+};
+
+/**
+ * @brief Battery and tier configuration.
+ */
+struct governor_config {
+    const struct governor_ocv_point *ocv;  /**< Open-circuit curve, by increasing voltage. */
+    size_t ocv_count;                      /**< Points of the curve (≥ 2). */
+    uint32_t capacity_mah;                 /**< Usable capacity of the battery. */
+    uint8_t voltage_shift;                 /**< Each update closes 1 / 2^n of the gap to the voltage estimate. */
+    uint8_t harvest_shift;                 /**< Harvest and load averages: a new update weighs 1 / 2^n. */
+    uint8_t hysteresis;                    /**< Charge above a threshold needed to move up (%). */
+    uint16_t vdda_min_mv;                  /**< Analog supply below which the last tier is forced. */
+    const struct governor_tier *tiers;     /**< Tiers, most generous first, by decreasing @c min_soc. */
+    size_t tier_count;                     /**< Number of tiers (≤ @ref GOVERNOR_MAX_TIERS). */
+};
+
+/**
+ * @brief Charge estimate and current tier.
+ */
+struct governor {
+    const struct governor_config *cfg;  /**< Configuration. */
+    int64_t charge_uas;                 /**< Estimated charge left (µA·s). */
+    uint64_t consumed_uas;              /**< Estimator total at the last update. */
+    uint32_t updated_ms;                /**< Uptime of the last update. */
+    int32_t harvest_ua;                 /**< Average current the model does not account for (µA). */
+    uint32_t load_ua[GOVERNOR_MAX_TIERS];  /**< Average current drawn in each tier (µA, 0 = not run yet). */
+    uint16_t vbat_mv;                   /**< Last battery voltage. */
+    uint16_t vdda_mv;                   /**< Last analog supply. */
+    uint8_t soc;                        /**< Estimated state of charge (%). */
+    uint8_t tier;                       /**< Index of the current tier. */
+    bool started;                       /**< A measurement has been taken. */
+    uint32_t changes;                   /**< Tier changes. */
+};
+
+/**
+ * @brief Start with the most generous tier and no estimate.
+ *
+ * @param g Governor to initialize.
+ * @param cfg Configuration; must stay valid.
+ */
+void governor_init(struct governor *g, const struct governor_config *cfg);
+
+/**
+ * @brief Update the estimate with a supply measurement and pick the tier.
+ *
+ * The first call takes the charge from the voltage alone.
+ *
+ * @param g Governor.
+ * @param vbat_mv Battery voltage (mV).
+ * @param vdda_mv Analog supply (mV).
+ * @param consumed_uas Charge drawn since boot (@ref energy_consumed_uas).
+ * @param now_ms Uptime of the measurement.
+ * @retval true If the tier changed.
+ * @retval false Otherwise.
+ */
+bool governor_update(struct governor *g, uint16_t vbat_mv, uint16_t vdda_mv,
+                     uint64_t consumed_uas, uint32_t now_ms);
+
+/**
+ * @brief Current tier.
+ */
+const struct governor_tier *governor_tier(const struct governor *g);
+
+/**
+ * @brief Print the estimate and the current tier on one line.
+ */
+void governor_print(const struct governor *g);
+
+#endif /* GOVERNOR_H */
@@ -0,0 +1,28 @@
+/**
+ * @file retained.c
+ * @brief Validation of state kept in RAM across warm resets.
+ */
+
+#include "retained.h"
+#include <zephyr/sys/crc.h>
+
+bool retained_check(const struct retained_header *hdr, const void *data, size_t size, uint32_t layout)
+{
+    return hdr->magic == RETAINED_MAGIC && hdr->size == size && hdr->layout == layout &&
+           hdr->crc == crc32_ieee(data, size);
+}
+
+void retained_invalidate(struct retained_header *hdr)
+{
+    hdr->magic = 0;
+    compiler_barrier();
+}
+
+void retained_seal(struct retained_header *hdr, const void *data, size_t size, uint32_t layout)
+{
+    hdr->size = size;
+    hdr->layout = layout;
+    hdr->crc = crc32_ieee(data, size);
+    compiler_barrier();
+    hdr->magic = RETAINED_MAGIC;
+}
@@ -0,0 +1,88 @@
+/**
+ * @file retained.h
+ * @brief Runtime state kept in RAM across warm resets.
+ *
+ * Objects defined with @ref RETAINED_DEFINE live in the @c .noinit section,
+ * which the startup code neither zeroes nor initializes, so their contents
+ * survive a watchdog, software or brown-out reset as long as the RAM stays
+ * powered. A header holding a magic word, the payload size and layout
+ * version and a CRC-32 tells a saved image from whatever the RAM holds
+ * after a power-on, a reset in the middle of a save, or a firmware with
+ * another layout. The size alone does not catch reordered or retyped
+ * fields, so the layout version must change with the payload type.
+ *
+ * Typical use: restore with @ref retained_valid at boot, then save
+ * periodically by filling the payload and sealing it with @ref retained_seal.
+ */
+
+#ifndef RETAINED_H
+#define RETAINED_H
+
+#include <zephyr/toolchain.h>
+#include <zephyr/linker/section_tags.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define RETAINED_MAGIC 0x504C4E54  /**< "PLNT" */
+
+/**
+ * @brief Header in front of a retained payload.
+ */
+struct retained_header {
+    uint32_t magic;  /**< @ref RETAINED_MAGIC when the payload is sealed. */
+    uint32_t size;   /**< Payload size when sealed. */
+    uint32_t layout; /**< Layout version of the payload when sealed. */
+    uint32_t crc;    /**< CRC-32 (IEEE) of the payload. */
+};
+
+/**
+ * @brief Statically define a retained object.
+ *
+ * @param name Variable name; the payload is @c name.data.
+ * @param type Payload type.
+ */
+#define RETAINED_DEFINE(name, type)        \
+    static __noinit struct {               \
+        struct retained_header hdr;        \
+        type data;                         \
+    } name
+
+/** @brief @ref retained_check on an object defined with @ref RETAINED_DEFINE. */
+#define retained_valid(r, layout) retained_check(&(r)->hdr, &(r)->data, sizeof((r)->data), (layout))
+
+/** @brief @ref retained_seal on an object defined with @ref RETAINED_DEFINE. */
+#define retained_commit(r, layout) retained_seal(&(r)->hdr, &(r)->data, sizeof((r)->data), (layout))
+
+/**
+ * @brief Check whether a payload was sealed and is intact.
+ *
+ * @param hdr Header.
+ * @param data Payload.
+ * @param size Payload size.
+ * @param layout Layout version of the payload type in this firmware.
+ * @return true if the magic word, size, layout version and CRC match.
+ */
+bool retained_check(const struct retained_header *hdr, const void *data, size_t size, uint32_t layout);
+
+/**
+ * @brief Mark a payload as invalid before changing it.
+ *
+ * A reset before the next @ref retained_seal then leads to a cold start
+ * instead of restoring a half-written payload.
+ *
+ * @param hdr Header.
+ */
+void retained_invalidate(struct retained_header *hdr);
+
+/**
+ * @brief Compute the CRC of a payload and mark it valid.
+ *
+ * @param hdr Header.
+ * @param data Payload.
+ * @param size Payload size.
+ * @param layout Layout version of the payload type.
+ */
+void retained_seal(struct retained_header *hdr, const void *data, size_t size, uint32_t layout);
+
+#endif /* RETAINED_H */
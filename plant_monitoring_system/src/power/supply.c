@@ -0,0 +1,89 @@
+/**
+ * @file supply.c
+ * @brief VREFINT / VBAT readings through the STM32 sensor drivers, or the
+ *        simulated battery on native_sim.
+ */
+
+#include "supply.h"
+#include "power/energy.h"
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/devicetree.h>
+#include <errno.h>
+
+#if defined(CONFIG_BOARD_NATIVE_SIM)
+#include "sim/sim.h"
+#else
+#include <zephyr/drivers/sensor.h>
+#endif
+
+/* ADC active time charged to the energy estimator for each measurement */
+#define SUPPLY_STARTUP_US    20  /**< Regulator and internal reference start-up. */
+#define SUPPLY_CONVERSION_US 20  /**< Long sampling time of the internal channels, per channel. */
+
+#define SUPPLY_VREF_NODE DT_NODELABEL(vref)
+#define SUPPLY_VBAT_NODE DT_NODELABEL(vbat)
+
+#if !defined(CONFIG_BOARD_NATIVE_SIM) && DT_NODE_HAS_STATUS(SUPPLY_VREF_NODE, okay) && \
+    DT_NODE_HAS_STATUS(SUPPLY_VBAT_NODE, okay)
+#define SUPPLY_SENSORS 1
+static const struct device *const vref_dev = DEVICE_DT_GET(SUPPLY_VREF_NODE);
+static const struct device *const vbat_dev = DEVICE_DT_GET(SUPPLY_VBAT_NODE);
+
+/**
+ * @brief Fetch one voltage sensor.
+ *
+ * @param dev Sensor device.
+ * @param mv Pointer to store the voltage (mV).
+ * @return 0 on success, negative error code from the driver.
+ */
+static int supply_sensor_mv(const struct device *dev, uint16_t *mv)
+{
+    struct sensor_value val;
+    int ret = sensor_sample_fetch(dev);
+
+    if (ret == 0) {
+        ret = sensor_channel_get(dev, SENSOR_CHAN_VOLTAGE, &val);
+    }
+    if (ret == 0) {
+        *mv = (uint16_t)(val.val1 * 1000 + val.val2 / 1000);
+    }
+    return ret;
+}
+#endif
+
+int supply_init(void)
+{
+#if defined(CONFIG_BOARD_NATIVE_SIM)
+    return 0;
+#elif defined(SUPPLY_SENSORS)
+    if (!device_is_ready(vref_dev) || !device_is_ready(vbat_dev)) {
+        return -ENODEV;
+    }
+    return 0;
+#else
+    return -ENOTSUP;
+#endif
+}
+
+int supply_read(struct supply_reading *out)
+{
+#if defined(CONFIG_BOARD_NATIVE_SIM)
+    sim_battery_read(&out->vdda_mv, &out->vbat_mv);
+#elif defined(SUPPLY_SENSORS)
+    int ret = supply_sensor_mv(vref_dev, &out->vdda_mv);
+
+    if (ret == 0) {
+        ret = supply_sensor_mv(vbat_dev, &out->vbat_mv);
+    }
+    if (ret < 0) {
+        return ret;
+    }
+#else
+    ARG_UNUSED(out);
+    return -ENOTSUP;
+#endif
+
+    energy_charge(ENERGY_ADC, SUPPLY_STARTUP_US + 2 * SUPPLY_CONVERSION_US);
+    return 0;
+}
@@ -0,0 +1,54 @@
+/**
+ * @file supply.h
+ * @brief Supply voltage measurement through the internal ADC channels.
+ *
+ * On a battery-powered node the battery is wired to the VBAT pin and
+ * supplies the board through a regulator (see dts/bindings/plant,battery.yaml),
+ * so the MCU measures it itself:
+ *
+ * - VREFINT, converted against VDDA and corrected with its factory
+ *   calibration, gives the analog supply (VDDA), which stays at the
+ *   regulator's output until the battery is nearly empty;
+ * - VBAT, through the internal 1/3 bridge, gives the battery terminal
+ *   voltage (at most 3.6 V).
+ *
+ * Both are read with the Zephyr STM32 @c vref and @c vbat sensor drivers,
+ * enabled in the board overlay. On native_sim they come from the simulated
+ * battery (see sim_battery.c).
+ */
+
+#ifndef SUPPLY_H
+#define SUPPLY_H
+
+#include <stdint.h>
+
+/**
+ * @brief One supply measurement.
+ */
+struct supply_reading {
+    uint16_t vdda_mv;   /**< Analog supply, from VREFINT (mV). */
+    uint16_t vbat_mv;   /**< Battery terminal voltage (mV). */
+};
+
+/**
+ * @brief Check that the supply channels are available.
+ *
+ * @retval 0 On success.
+ * @retval -ENODEV If a channel is not ready.
+ * @retval -ENOTSUP If the board does not enable them.
+ */
+int supply_init(void);
+
+/**
+ * @brief Measure the supply.
+ *
+ * Each call costs two ADC conversions, charged to the energy estimator.
+ *
+ * @param out Pointer to store the measurement.
+ * @retval 0 On success.
+ * @retval -ENOTSUP If the board does not enable the channels.
+ * @retval <0 Error from the sensor driver.
+ */
+int supply_read(struct supply_reading *out);
+
+#endif /* SUPPLY_H */
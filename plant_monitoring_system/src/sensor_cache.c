@@ -0,0 +1,202 @@
+/**
+ * @file sensor_cache.c
+ * @brief Sample timestamps, request merging and refresh hand-off to the
+ *        sensors thread.
+ *
+ * All the state is protected by one mutex. Requesters wait on a condition
+ * variable broadcast at the end of every refresh and re-check their groups,
+ * so a requester served by someone else's refresh simply finds them fresh.
+ */
+
+#include "sensor_cache.h"
+#include <zephyr/sys/printk.h>
+#include <errno.h>
+
+static K_MUTEX_DEFINE(cache_lock);     /**< Protects everything below. */
+static K_CONDVAR_DEFINE(cache_done);   /**< Broadcast when a refresh completes. */
+static K_SEM_DEFINE(cache_request, 0, 1);  /**< Wakes the sensors thread. */
+
+static uint32_t sampled_ms[SENSOR_GROUP_COUNT];  /**< Start of the refresh that read each group. */
+static uint32_t failed_seq[SENSOR_GROUP_COUNT];  /**< Refresh that last failed to read each group. */
+static uint32_t valid;         /**< Groups read at least once. */
+static uint32_t pending;       /**< Groups requested, not yet taken by the sensors thread. */
+static uint32_t running;       /**< Groups being read. */
+static uint32_t running_ms;    /**< Start of the running refresh. */
+static uint32_t refresh_seq;   /**< Completed refreshes. */
+static bool held;              /**< The sensors thread must stay off the bus. */
+static struct sensor_cache_metrics metrics;
+
+/**
+ * @brief Groups of @p groups read more than @p max_age_ms before @p now.
+ */
+static uint32_t stale_groups(uint32_t groups, uint32_t max_age_ms, uint32_t now)
+{
+    uint32_t stale = groups & ~valid;
+
+    for (int i = 0; i < SENSOR_GROUP_COUNT; i++) {
+        if ((groups & valid & BIT(i)) && (int32_t)(now - sampled_ms[i]) > (int64_t)max_age_ms) {
+            stale |= BIT(i);
+        }
+    }
+    return stale;
+}
+
+/**
+ * @brief Whether a stale group failed in a refresh completed after @p seq.
+ */
+static bool failed_since(uint32_t stale, uint32_t seq)
+{
+    for (int i = 0; i < SENSOR_GROUP_COUNT; i++) {
+        if ((stale & BIT(i)) && (int32_t)(failed_seq[i] - seq) > 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int sensor_cache_get(uint32_t groups, uint32_t max_age_ms, k_timeout_t timeout)
+{
+    k_timepoint_t end = sys_timepoint_calc(timeout);
+    bool first = true;
+    int ret = 0;
+
+    k_mutex_lock(&cache_lock, K_FOREVER);
+    metrics.requests++;
+
+    /* Ages are counted at the request: a refresh started after it always serves it */
+    uint32_t now = k_uptime_get_32();
+    uint32_t seq = refresh_seq;
+
+    while (1) {
+        uint32_t stale = stale_groups(groups & SENSOR_GROUP_ALL, max_age_ms, now);
+
+        if (stale == 0) {
+            if (first) {
+                metrics.hits++;
+            }
+            break;
+        }
+        if (failed_since(stale, seq)) {
+            metrics.failures++;
+            ret = -EIO;
+            break;
+        }
+
+        /* A running refresh serves the groups it reads if it started recently enough */
+        uint32_t covered = pending;
+        if ((int32_t)(now - running_ms) <= (int64_t)max_age_ms) {
+            covered |= running;
+        }
+
+        uint32_t ask = stale & ~covered;
+        if (ask != 0) {
+            pending |= ask;
+            if (!held) {
+                k_sem_give(&cache_request);
+            }
+        } else if (first) {
+            metrics.merged++;
+        }
+        first = false;
+
+        if (k_condvar_wait(&cache_done, &cache_lock, sys_timepoint_timeout(end)) != 0) {
+            ret = -EAGAIN;
+            break;
+        }
+    }
+
+    k_mutex_unlock(&cache_lock);
+    return ret;
+}
+
+uint32_t sensor_cache_age_ms(enum sensor_group group)
+{
+    uint32_t age = UINT32_MAX;
+
+    k_mutex_lock(&cache_lock, K_FOREVER);
+    for (int i = 0; i < SENSOR_GROUP_COUNT; i++) {
+        if (group == BIT(i) && (valid & BIT(i))) {
+            age = k_uptime_get_32() - sampled_ms[i];
+        }
+    }
+    k_mutex_unlock(&cache_lock);
+    return age;
+}
+
+void sensor_cache_hold(void)
+{
+    k_mutex_lock(&cache_lock, K_FOREVER);
+    held = true;
+    while (running != 0) {
+        k_condvar_wait(&cache_done, &cache_lock, K_FOREVER);
+    }
+    k_mutex_unlock(&cache_lock);
+}
+
+void sensor_cache_release(void)
+{
+    k_mutex_lock(&cache_lock, K_FOREVER);
+    held = false;
+    if (pending != 0) {
+        k_sem_give(&cache_request);
+    }
+    k_mutex_unlock(&cache_lock);
+}
+
+uint32_t sensor_cache_next_refresh(void)
+{
+    while (1) {
+        k_sem_take(&cache_request, K_FOREVER);
+
+        k_mutex_lock(&cache_lock, K_FOREVER);
+        uint32_t groups = held ? 0 : pending;
+
+        if (groups & SENSOR_GROUP_COLOR) {
+            groups |= SENSOR_GROUP_ADC;
+        }
+        if (groups != 0) {
+            pending = 0;
+            running = groups;
+            running_ms = k_uptime_get_32();
+        }
+        k_mutex_unlock(&cache_lock);
+
+        if (groups != 0) {
+            return groups;
+        }
+    }
+}
+
+void sensor_cache_complete(uint32_t read, uint32_t failed)
+{
+    k_mutex_lock(&cache_lock, K_FOREVER);
+    refresh_seq++;
+    for (int i = 0; i < SENSOR_GROUP_COUNT; i++) {
+        if (read & BIT(i)) {
+            sampled_ms[i] = running_ms;
+        } else if (failed & BIT(i)) {
+            failed_seq[i] = refresh_seq;
+        }
+    }
+    valid |= read;
+    running = 0;
+    metrics.refreshes++;
+    k_condvar_broadcast(&cache_done);
+    k_mutex_unlock(&cache_lock);
+}
+
+void sensor_cache_metrics_get(struct sensor_cache_metrics *out)
+{
+    k_mutex_lock(&cache_lock, K_FOREVER);
+    *out = metrics;
+    k_mutex_unlock(&cache_lock);
+}
+
+void sensor_cache_print(void)
+{
+    struct sensor_cache_metrics m;
+
+    sensor_cache_metrics_get(&m);
+    printk("[CACHE] - %u request(s): %u hit(s), %u merged, %u refresh(es), %u failure(s)\n",
+           m.requests, m.hits, m.merged, m.refreshes, m.failures);
+}
@@ -0,0 +1,129 @@
+/**
+ * @file sensor_cache.h
+ * @brief Read-through cache in front of the sensors thread.
+ *
+ * The sensors thread stores its readings in the shared
+ * @ref system_measurement structure. The cache records when each group of
+ * sensors was last read, so a consumer only causes bus traffic when the
+ * stored values are older than it can accept:
+ *
+ * @code
+ * if (sensor_cache_get(SENSOR_GROUP_TEMP_HUM, 60000, K_MSEC(500)) == 0) {
+ *     int32_t temp = atomic_get(&measure.temp);
+ * }
+ * @endcode
+ *
+ * Requests for stale groups are merged: every requester waiting when the
+ * sensors thread starts a refresh is served by it, whatever the number of
+ * consumers. A refresh already running when a request arrives is waited
+ * for instead of queued again if its sample is recent enough.
+ *
+ * Groups are the units the sensors thread reads in one go. Reading the
+ * color sensors needs the brightness of the same cycle (see
+ * @ref light_fusion.h), so a color refresh also refreshes the ADC group.
+ */
+
+#ifndef SENSOR_CACHE_H
+#define SENSOR_CACHE_H
+
+#include <stdint.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+
+/**
+ * @brief Groups of sensors refreshed together (bit mask).
+ */
+enum sensor_group {
+    SENSOR_GROUP_ADC      = BIT(0),  /**< Phototransistor and soil probes (one ADC scan). */
+    SENSOR_GROUP_ACCEL    = BIT(1),  /**< Primary accelerometer. */
+    SENSOR_GROUP_TEMP_HUM = BIT(2),  /**< Temperature / humidity instances. */
+    SENSOR_GROUP_COLOR    = BIT(3),  /**< Color instances (read or estimated). */
+};
+
+#define SENSOR_GROUP_COUNT 4                       /**< Number of groups. */
+#define SENSOR_GROUP_ALL   BIT_MASK(SENSOR_GROUP_COUNT)  /**< Every group. */
+
+/**
+ * @brief Cache counters.
+ */
+struct sensor_cache_metrics {
+    uint32_t requests;   /**< Calls to @ref sensor_cache_get. */
+    uint32_t hits;       /**< Requests served from the stored values. */
+    uint32_t merged;     /**< Requests served by a refresh asked for by another one. */
+    uint32_t refreshes;  /**< Refresh cycles run by the sensors thread. */
+    uint32_t failures;   /**< Requests answered with -EIO. */
+};
+
+/**
+ * @brief Make sure the stored values of some groups are recent enough.
+ *
+ * Returns at once if every group in @p groups was read less than
+ * @p max_age_ms ago; otherwise asks the sensors thread for the stale groups
+ * (unless already asked) and waits for the refresh. The values are then
+ * read from the shared @ref system_measurement structure.
+ *
+ * Must not be called from an ISR or from the sensors thread.
+ *
+ * @param groups Mask of @ref sensor_group.
+ * @param max_age_ms Oldest acceptable sample, counted at the call; 0 asks
+ *        for a reading started after the call.
+ * @param timeout Longest wait for the refresh.
+ * @retval 0 If the values are recent enough.
+ * @retval -EAGAIN If the refresh did not complete in time.
+ * @retval -EIO If a sensor of a stale group could not be read.
+ */
+int sensor_cache_get(uint32_t groups, uint32_t max_age_ms, k_timeout_t timeout);
+
+/**
+ * @brief Age of the stored values of a group.
+ *
+ * @param group One @ref sensor_group.
+ * @return Milliseconds since the group was read, UINT32_MAX if never.
+ */
+uint32_t sensor_cache_age_ms(enum sensor_group group);
+
+/**
+ * @brief Keep the sensors thread off the bus.
+ *
+ * Waits for a running refresh to complete; refreshes requested meanwhile
+ * are started by @ref sensor_cache_release. Used to reconfigure the
+ * sensors. Must not be nested.
+ */
+void sensor_cache_hold(void);
+
+/**
+ * @brief Let the sensors thread run requested refreshes again.
+ */
+void sensor_cache_release(void);
+
+/**
+ * @brief Wait for the next refresh to run (sensors thread).
+ *
+ * @return Mask of the groups to read (never 0).
+ */
+uint32_t sensor_cache_next_refresh(void);
+
+/**
+ * @brief Publish the result of a refresh (sensors thread).
+ *
+ * Groups read successfully are stamped with the start time of the refresh;
+ * requesters waiting for the others get -EIO.
+ *
+ * @param read Mask of the groups read successfully.
+ * @param failed Mask of the groups that could not be read.
+ */
+void sensor_cache_complete(uint32_t read, uint32_t failed);
+
+/**
+ * @brief Copy the cache counters.
+ *
+ * @param out Destination.
+ */
+void sensor_cache_metrics_get(struct sensor_cache_metrics *out);
+
+/**
+ * @brief Print the cache counters on one line.
+ */
+void sensor_cache_print(void);
+
+#endif /* SENSOR_CACHE_H */
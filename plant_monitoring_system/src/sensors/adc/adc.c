@@ -8,12 +8,27 @@
  */
 
 #include "adc.h"
+#include "power/energy.h"
 #include <zephyr/drivers/adc.h>
 #include <zephyr/kernel.h>
 
+/* ADC active time charged to the energy estimator for each read sequence */
+#define ADC_STARTUP_US    20  /**< Regulator start-up and stabilization. */
+#define ADC_CONVERSION_US 4   /**< Sampling plus 12-bit conversion, per channel. */
+
+#if defined(CONFIG_ADC_EMUL)
+/* The emulated ADC has no oversampler; results are exact anyway. */
+#define ADC_HW_OVERSAMPLING 0
+#else
+#define ADC_HW_OVERSAMPLING 1
+#endif
+
 /** @brief Static buffer used for single-sample ADC conversions. */
 static int16_t sample_buffer[BUFFER_SIZE];
 
+/** @brief Static buffer used for multi-channel scan conversions. */
+static int16_t scan_buffer[ADC_SCAN_MAX_CHANNELS];
+
 /**
  * @brief Initializes the specified ADC device.
  *
@@ -74,6 +89,7 @@ int adc_read_raw(const struct adc_config *cfg, int16_t *raw_val)
     };
 
     ret = adc_read(cfg->dev, &sequence);
+    energy_charge(ENERGY_ADC, ADC_STARTUP_US + ADC_CONVERSION_US);
     if (ret < 0) {
         printk("ADC read failed (%d)\n", ret);
         return ret;
@@ -101,7 +117,7 @@ float adc_read_normalized(const struct adc_config *cfg)
         return ret;
     }
 
-    return (float)raw_val / ((1 << cfg->resolution) - 1);
+    return (float)raw_val / cfg->full_scale;
 }
 
 /**
@@ -124,6 +140,84 @@ int adc_read_voltage(const struct adc_config *cfg, int32_t *out_mv)
         return ret;
     }
 
-    *out_mv = ((int32_t)raw_val * cfg->vref_mv) / ((1 << cfg->resolution) - 1);
+    *out_mv = ((int32_t)raw_val * cfg->vref_mv) / cfg->full_scale;
+    return 0;
+}
+
+/**
+ * @brief Converts several channels of the same ADC in one scan sequence.
+ *
+ * Sets up every channel, builds the channel bitmask and performs a single
+ * read. Each result is located in the buffer by counting the enabled
+ * channels with a lower number than its own.
+ *
+ * @param cfgs Array of pointers to the channel configurations.
+ * @param count Number of channels.
+ * @param oversampling Oversampling ratio exponent.
+ * @param out_mv Array to store each voltage in millivolts.
+ * @retval 0 If the scan was successful.
+ * @retval -EINVAL If the channel set is invalid.
+ * @retval Negative error code from the ADC driver on failure.
+ */
+int adc_read_scan(const struct adc_config *const *cfgs, size_t count, uint8_t oversampling,
+                  int32_t *out_mv)
+{
+    if (!cfgs || !out_mv || count == 0 || count > ADC_SCAN_MAX_CHANNELS ||
+        oversampling > ADC_MAX_OVERSAMPLING) {
+        return -EINVAL;
+    }
+
+    if (!ADC_HW_OVERSAMPLING) {
+        oversampling = 0;
+    }
+
+    uint32_t channels = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        const struct adc_config *cfg = cfgs[i];
+
+        if (cfg->dev != cfgs[0]->dev || cfg->resolution != cfgs[0]->resolution ||
+            (channels & BIT(cfg->channel_id))) {
+            return -EINVAL;
+        }
+
+        struct adc_channel_cfg channel_cfg = {
+            .gain             = cfg->gain,
+            .reference        = cfg->ref,
+            .acquisition_time = cfg->acquisition_time,
+            .channel_id       = cfg->channel_id,
+        };
+
+        int ret = adc_channel_setup(cfg->dev, &channel_cfg);
+        if (ret < 0) {
+            printk("ADC channel %d setup failed (%d)\n", cfg->channel_id, ret);
+            return ret;
+        }
+
+        channels |= BIT(cfg->channel_id);
+    }
+
+    struct adc_sequence sequence = {
+        .channels    = channels,
+        .buffer      = scan_buffer,
+        .buffer_size = count * sizeof(scan_buffer[0]),
+        .resolution  = cfgs[0]->resolution,
+        .oversampling = oversampling,
+    };
+
+    int ret = adc_read(cfgs[0]->dev, &sequence);
+    energy_charge(ENERGY_ADC, ADC_STARTUP_US + (count * ADC_CONVERSION_US << oversampling));
+    if (ret < 0) {
+        printk("ADC scan failed (%d)\n", ret);
+        return ret;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        const struct adc_config *cfg = cfgs[i];
+        size_t index = __builtin_popcount(channels & (BIT(cfg->channel_id) - 1));
+
+        out_mv[i] = ((int32_t)scan_buffer[index] * cfg->vref_mv) / cfg->full_scale;
+    }
+
     return 0;
 }
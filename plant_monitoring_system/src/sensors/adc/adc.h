@@ -19,6 +19,12 @@
 /** @brief ADC sample buffer size (number of samples per read). */
 #define BUFFER_SIZE 1
 
+/** @brief Maximum number of channels converted in one scan sequence. */
+#define ADC_SCAN_MAX_CHANNELS 16
+
+/** @brief Largest oversampling setting (2^8 = 256 samples averaged per result). */
+#define ADC_MAX_OVERSAMPLING 8
+
 /**
  * @brief ADC channel configuration structure.
  *
@@ -34,6 +40,7 @@ struct adc_config {
     enum adc_reference ref;        /**< Voltage reference source for conversion. */
     uint32_t acquisition_time;     /**< Sampling acquisition time in microseconds. */
     int32_t vref_mv;               /**< Reference voltage in millivolts. */
+    int32_t full_scale;            /**< Largest raw value, `(1 << resolution) - 1`. */
 };
 
 /**
@@ -86,4 +93,31 @@ float adc_read_normalized(const struct adc_config *cfg);
  */
 int adc_read_voltage(const struct adc_config *cfg, int32_t *out_mv);
 
+/**
+ * @brief Converts several channels of the same ADC in one scan sequence.
+ *
+ * All channels are configured and then converted by a single
+ * @ref adc_read call (scan mode), instead of one conversion per channel.
+ * The ADC stores samples in ascending channel order; results are returned
+ * in the order of @p cfgs.
+ *
+ * All configurations must use the same device and resolution.
+ *
+ * With @p oversampling, each result is the average of 2^oversampling
+ * conversions done by the ADC's hardware oversampler: less noise, for a
+ * proportionally longer conversion.
+ *
+ * @param cfgs Array of pointers to the channel configurations.
+ * @param count Number of channels (≤ @ref ADC_SCAN_MAX_CHANNELS).
+ * @param oversampling Oversampling ratio exponent (0 for single conversions,
+ *                     at most @ref ADC_MAX_OVERSAMPLING).
+ * @param out_mv Array of @p count entries to store each voltage in millivolts.
+ * @retval 0 If the scan was successful.
+ * @retval -EINVAL If the channel set is invalid (duplicate, mixed devices, too many)
+ *                 or the oversampling setting is out of range.
+ * @retval Negative error code from the ADC driver on failure.
+ */
+int adc_read_scan(const struct adc_config *const *cfgs, size_t count, uint8_t oversampling,
+                  int32_t *out_mv);
+
 #endif // ADC_H
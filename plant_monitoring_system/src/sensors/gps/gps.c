@@ -8,28 +8,71 @@
  * GPS data structure. Once new data is available, a semaphore is released
  * to notify waiting threads.
  *
+ * While an EPO upload is in progress the link carries PMTK binary packets
+ * instead; the ISR then only looks for EPO acknowledgements.
+ *
  * The design prioritizes simplicity and robustness for embedded systems.
  */
 
 #include "gps.h"
+#include "power/energy.h"
 #include <zephyr/kernel.h>
 #include <zephyr/sys/printk.h>
 #include <zephyr/device.h>
 #include <zephyr/drivers/uart.h>
+#include <zephyr/sys/timeutil.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/util.h>
+#include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <time.h>
 
 #define BUF_SIZE 128      /**< Maximum NMEA sentence length. */
 #define MAX_FIELDS 16     /**< Maximum number of comma-separated fields per sentence. */
+#define DEFAULT_BAUDRATE 9600  /**< Assumed if the UART does not report its configuration. */
+#define UART_FRAME_BITS 10     /**< Start + 8 data + stop bits per byte. */
+#define CMD_SIZE 96            /**< Maximum command length, checksum included. */
+#define BIN_PREAMBLE0 0x04     /**< First byte of a binary packet. */
+#define BIN_PREAMBLE1 0x24     /**< Second byte of a binary packet. */
+#define BIN_HEADER 6           /**< Preamble, length and command. */
+#define BIN_OVERHEAD 9         /**< Header, checksum and CR LF. */
+#define BIN_RX_SIZE 32         /**< Largest binary packet received (acknowledgements). */
+#define BIN_SET_FORMAT 253     /**< Set output format: protocol (0 = NMEA), baud rate (0 = keep). */
 
 static const struct device *uart_dev = NULL;
 static char nmea_line[BUF_SIZE];
 static uint8_t line_pos = 0;
+static uint32_t line_bytes = 0;     /**< Bytes received since the last end of line. */
+static uint32_t byte_time_us = 0;   /**< Time on the wire of one byte. */
 
 /** @brief Internal storage for parsed GPS data. */
 static gps_data_t parsed_data;
 /** @brief Semaphore signaling when a valid GGA frame is available. */
 static struct k_sem parsed_sem;
+/** @brief UTC date (ddmmyy) of the last valid RMC sentence. */
+static char utc_date[8];
+/** @brief Last GGA sentence with a fix, and the uptime it was received at. */
+static gps_data_t last_fix;
+static uint32_t last_fix_uptime;
+static char last_fix_date[8];
+
+/** @brief True while the link carries binary packets. */
+static volatile bool binary_mode;
+static uint8_t bin_rx[BIN_RX_SIZE];
+static uint8_t bin_pos;
+/** @brief Semaphore signaling a binary acknowledgement, and its contents. */
+static struct k_sem ack_sem;
+static uint16_t ack_seq;
+static uint8_t ack_result;
+
+/** @brief Uptime at @ref gps_init, and time to the first fix (0 = none yet). */
+static uint32_t init_uptime;
+static uint32_t ttff;
+static bool ttff_reported;
+
+/** @brief Module put in standby by @ref gps_standby. */
+static bool standby_mode;
 
 /**
  * @brief Converts an NMEA latitude/longitude string to decimal degrees.
@@ -79,25 +122,14 @@ static float nmea_to_degrees(const char *nmea, char dir)
 }
 
 /**
- * @brief Parses a single NMEA GGA sentence and extracts relevant fields.
- *
- * Extracts latitude, longitude, altitude, HDOP, number of satellites,
- * and UTC time from a GGA sentence. Populates a @ref gps_data_t structure
- * with the parsed values.
+ * @brief Splits a sentence in place at its commas.
  *
- * @param line Pointer to the null-terminated GGA sentence string.
- * @param out Pointer to store the parsed GPS data.
- * @retval true If parsing succeeded and valid data was extracted.
- * @retval false If the sentence was invalid or incomplete.
+ * @param line Null-terminated sentence, modified.
+ * @param fields Output array of @ref MAX_FIELDS field pointers; missing fields stay NULL.
  */
-static bool parse_gga(const char *line, gps_data_t *out)
+static void split_fields(char *line, char **fields)
 {
-    char buf[BUF_SIZE];
-    strncpy(buf, line, BUF_SIZE - 1);
-    buf[BUF_SIZE - 1] = '\0';
-
-    char *fields[MAX_FIELDS] = {0};
-    char *p = buf;
+    char *p = line;
     int idx = 0;
 
     fields[idx++] = p;
@@ -108,6 +140,53 @@ static bool parse_gga(const char *line, gps_data_t *out)
         }
         p++;
     }
+}
+
+/**
+ * @brief Parses the date of an NMEA RMC sentence.
+ *
+ * RMC field layout: 0 = $xxRMC, 1 = UTC time, 2 = status (A = valid),
+ * 3–8 = position, speed and course, 9 = date (ddmmyy).
+ *
+ * @param line Pointer to the null-terminated RMC sentence, modified.
+ * @param date Output buffer of at least 7 bytes for the date.
+ * @retval true If the sentence is valid and carries a date.
+ * @retval false Otherwise.
+ */
+static bool parse_rmc_date(char *line, char *date)
+{
+    char *fields[MAX_FIELDS] = {0};
+
+    split_fields(line, fields);
+
+    if (!fields[2] || fields[2][0] != 'A' || !fields[9] || strlen(fields[9]) != 6) {
+        return false;
+    }
+
+    memcpy(date, fields[9], 7);
+    return true;
+}
+
+/**
+ * @brief Parses a single NMEA GGA sentence and extracts relevant fields.
+ *
+ * Extracts latitude, longitude, altitude, HDOP, number of satellites,
+ * and UTC time from a GGA sentence. Populates a @ref gps_data_t structure
+ * with the parsed values.
+ *
+ * The sentence is split in place (commas become terminators), so no copy
+ * of the line is needed; the ISR discards the line afterwards anyway.
+ *
+ * @param line Pointer to the null-terminated GGA sentence string, modified.
+ * @param out Pointer to store the parsed GPS data.
+ * @retval true If parsing succeeded and valid data was extracted.
+ * @retval false If the sentence was invalid or incomplete.
+ */
+static bool parse_gga(char *line, gps_data_t *out)
+{
+    char *fields[MAX_FIELDS] = {0};
+
+    split_fields(line, fields);
 
     /* Expected GGA field layout:
      *  0 = $GPGGA or $GNGGA
@@ -129,6 +208,7 @@ static bool parse_gga(const char *line, gps_data_t *out)
     out->alt = fields[9] ? (float)atof(fields[9]) : 0.0f;
     out->sats = fields[7] ? atoi(fields[7]) : 0;
     out->hdop = fields[8] ? (float)atof(fields[8]) : 0.0f;
+    out->fix = fields[6] ? atoi(fields[6]) : 0;
 
     if (fields[1]) {
         strncpy(out->utc_time, fields[1], sizeof(out->utc_time) - 1);
@@ -140,6 +220,67 @@ static bool parse_gga(const char *line, gps_data_t *out)
     return true;
 }
 
+/**
+ * @brief XOR checksum of a binary packet (length to payload).
+ *
+ * @param pkt Packet, starting at the preamble.
+ * @param len Total packet length.
+ */
+static uint8_t bin_checksum(const uint8_t *pkt, size_t len)
+{
+    uint8_t cs = 0;
+
+    for (size_t i = 2; i < len - 3; i++) {
+        cs ^= pkt[i];
+    }
+    return cs;
+}
+
+/**
+ * @brief Feeds one received byte to the binary packet parser.
+ *
+ * Bytes before a preamble are skipped. A complete EPO acknowledgement
+ * (command 723, not the generic acknowledgement) with a valid checksum is
+ * stored and @c ack_sem is given; other packets are ignored.
+ *
+ * @param c Received byte.
+ */
+static void bin_rx_byte(uint8_t c)
+{
+    if ((bin_pos == 0 && c != BIN_PREAMBLE0) || (bin_pos == 1 && c != BIN_PREAMBLE1)) {
+        bin_pos = 0;
+        return;
+    }
+
+    bin_rx[bin_pos++] = c;
+    if (bin_pos < BIN_HEADER) {
+        return;
+    }
+
+    uint16_t len = sys_get_le16(&bin_rx[2]);
+
+    if (len < BIN_OVERHEAD || len > sizeof(bin_rx)) {
+        bin_pos = 0;
+        return;
+    }
+    if (bin_pos < len) {
+        return;
+    }
+
+    bin_pos = 0;
+    energy_charge(ENERGY_UART_RX, len * byte_time_us);
+
+    if (bin_checksum(bin_rx, len) != bin_rx[len - 3] ||
+        bin_rx[len - 2] != '\r' || bin_rx[len - 1] != '\n') {
+        return;
+    }
+    if (sys_get_le16(&bin_rx[4]) == GPS_BIN_ACK_EPO && len >= BIN_OVERHEAD + 3) {
+        ack_seq = sys_get_le16(&bin_rx[6]);
+        ack_result = bin_rx[8];
+        k_sem_give(&ack_sem);
+    }
+}
+
 /**
  * @brief UART interrupt handler for GPS data reception.
  *
@@ -157,6 +298,12 @@ static void uart_isr(const struct device *dev, void *user_data)
 
     while (uart_irq_update(dev) && uart_irq_rx_ready(dev)) {
         if (uart_fifo_read(dev, &c, 1) == 1) {
+            if (binary_mode) {
+                bin_rx_byte(c);
+                continue;
+            }
+
+            line_bytes++;
             if (c == '$') {
                 line_pos = 0;
                 nmea_line[line_pos++] = (char)c;
@@ -166,13 +313,25 @@ static void uart_isr(const struct device *dev, void *user_data)
 
             if (c == '\n') {
                 nmea_line[line_pos] = '\0';
+                energy_charge(ENERGY_UART_RX, line_bytes * byte_time_us);
+                line_bytes = 0;
 
                 if (strstr(nmea_line, "$GPGGA") || strstr(nmea_line, "$GNGGA")) {
                     gps_data_t tmp;
                     if (parse_gga(nmea_line, &tmp)) {
                         memcpy(&parsed_data, &tmp, sizeof(gps_data_t));
+                        if (tmp.fix > 0 && ttff == 0) {
+                            ttff = MAX(k_uptime_get_32() - init_uptime, 1U);
+                        }
+                        if (tmp.fix > 0 && utc_date[0] != '\0') {
+                            memcpy(&last_fix, &tmp, sizeof(gps_data_t));
+                            memcpy(last_fix_date, utc_date, sizeof(utc_date));
+                            last_fix_uptime = k_uptime_get_32();
+                        }
                         k_sem_give(&parsed_sem);
                     }
+                } else if (strstr(nmea_line, "$GPRMC") || strstr(nmea_line, "$GNRMC")) {
+                    parse_rmc_date(nmea_line, utc_date);
                 }
 
                 line_pos = 0;
@@ -187,7 +346,9 @@ static void uart_isr(const struct device *dev, void *user_data)
  * @brief Initializes the GPS UART and enables the interrupt handler.
  *
  * Validates the provided configuration, verifies UART readiness, sets up
- * the ISR for GPS data reception, and enables RX interrupts.
+ * the ISR for GPS data reception, and enables RX interrupts. The module is
+ * accounted as powered from here on, and received bytes are charged to
+ * the energy estimator at the UART baud rate.
  *
  * @param cfg Pointer to the GPS configuration structure.
  * @retval 0 If initialization succeeded.
@@ -210,7 +371,17 @@ int gps_init(const struct gps_config *cfg)
         return -ENODEV;
     }
 
+    struct uart_config uart_cfg;
+    uint32_t baudrate = DEFAULT_BAUDRATE;
+    if (uart_config_get(uart_dev, &uart_cfg) == 0 && uart_cfg.baudrate > 0) {
+        baudrate = uart_cfg.baudrate;
+    }
+    byte_time_us = UART_FRAME_BITS * USEC_PER_SEC / baudrate;
+
     k_sem_init(&parsed_sem, 0, 1);
+    k_sem_init(&ack_sem, 0, 1);
+    init_uptime = k_uptime_get_32();
+    energy_set_level(ENERGY_GPS, 1);
     uart_irq_callback_set(uart_dev, uart_isr);
     uart_irq_rx_enable(uart_dev);
 
@@ -223,6 +394,7 @@ int gps_init(const struct gps_config *cfg)
  *
  * Blocks until a new GGA frame is available or the specified timeout expires.
  * On success, copies the latest parsed data into the provided buffer.
+ * The first call after the first fix prints the time to first fix.
  *
  * @param out Pointer to store the parsed GPS data.
  * @param timeout Timeout duration (e.g. @c K_FOREVER, @c K_MSEC(2000), @c K_NO_WAIT).
@@ -237,6 +409,257 @@ int gps_wait_for_gga(gps_data_t *out, k_timeout_t timeout)
     int ret = k_sem_take(&parsed_sem, timeout);
     if (ret < 0) return ret;
 
+    if (ttff != 0 && !ttff_reported) {
+        ttff_reported = true;
+        printk("[GPS] - First fix after %u ms\n", ttff);
+    }
+
     memcpy(out, &parsed_data, sizeof(gps_data_t));
     return 0;
 }
+
+/**
+ * @brief Converts two ASCII digits to their value.
+ */
+static int two_digits(const char *s)
+{
+    return (s[0] - '0') * 10 + (s[1] - '0');
+}
+
+/**
+ * @brief Gets the last fix with a known date.
+ *
+ * Copies the fix with interrupts locked, then converts its date (ddmmyy)
+ * and time (hhmmss) to seconds since the epoch.
+ *
+ * @param out Pointer to store the fix.
+ * @retval 0 On success.
+ * @retval -ENODATA If no fix with a date has been received yet.
+ */
+int gps_get_fix(struct gps_fix *out)
+{
+    gps_data_t fix;
+    char date[8];
+    uint32_t uptime;
+
+    unsigned int key = irq_lock();
+    fix = last_fix;
+    memcpy(date, last_fix_date, sizeof(date));
+    uptime = last_fix_uptime;
+    irq_unlock(key);
+
+    if (date[0] == '\0' || strlen(fix.utc_time) < 6) {
+        return -ENODATA;
+    }
+
+    struct tm tm = {
+        .tm_mday = two_digits(&date[0]),
+        .tm_mon = two_digits(&date[2]) - 1,
+        .tm_year = two_digits(&date[4]) + 100,  /* Years since 1900 */
+        .tm_hour = two_digits(&fix.utc_time[0]),
+        .tm_min = two_digits(&fix.utc_time[2]),
+        .tm_sec = two_digits(&fix.utc_time[4]),
+    };
+
+    out->lat = fix.lat;
+    out->lon = fix.lon;
+    out->alt = fix.alt;
+    out->utc = timeutil_timegm64(&tm);
+    out->uptime_ms = uptime;
+    return 0;
+}
+
+/**
+ * @brief Sends an NMEA command to the GPS module.
+ *
+ * The checksum is the XOR of every character between '$' and '*'.
+ *
+ * @param body Command without '$' or checksum.
+ * @retval 0 On success.
+ * @retval -ENODEV If the GPS has not been initialized.
+ * @retval -EINVAL If the command is too long.
+ */
+int gps_send_command(const char *body)
+{
+    char line[CMD_SIZE];
+    uint8_t cs = 0;
+
+    if (uart_dev == NULL) {
+        return -ENODEV;
+    }
+
+    for (const char *p = body; *p; p++) {
+        cs ^= (uint8_t)*p;
+    }
+
+    int n = snprintf(line, sizeof(line), "$%s*%02X\r\n", body, cs);
+    if (n < 0 || n >= (int)sizeof(line)) {
+        return -EINVAL;
+    }
+
+    for (int i = 0; i < n; i++) {
+        uart_poll_out(uart_dev, line[i]);
+    }
+    return 0;
+}
+
+/**
+ * @brief Gives the module a reference position and time (PMTK741).
+ *
+ * Format: PMTK741,lat,lon,alt,YYYY,MM,DD,hh,mm,ss (degrees, meters, UTC).
+ *
+ * @param fix Last known position and time.
+ * @retval 0 On success.
+ * @retval -EINVAL If the fix has no time.
+ * @retval -ENODEV If the GPS has not been initialized.
+ */
+int gps_assist(const struct gps_fix *fix)
+{
+    char body[CMD_SIZE - 8];
+    struct tm tm;
+
+    if (fix->utc <= 0) {
+        return -EINVAL;
+    }
+
+    time_t now = (time_t)(fix->utc + (k_uptime_get_32() - fix->uptime_ms) / MSEC_PER_SEC);
+
+    gmtime_r(&now, &tm);
+    snprintf(body, sizeof(body), "PMTK741,%.6f,%.6f,%d,%04d,%02d,%02d,%02d,%02d,%02d",
+             (double)fix->lat, (double)fix->lon, (int)fix->alt,
+             tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec);
+
+    printk("[GPS] - Assisted start: %s\n", body);
+    return gps_send_command(body);
+}
+
+/**
+ * @brief Switches the link between NMEA and the PMTK binary protocol.
+ *
+ * The ISR switches to binary before PMTK253 is sent, so that no reply is
+ * missed, and back to NMEA once the binary command has been sent.
+ *
+ * @param binary True for binary, false for NMEA.
+ * @retval 0 On success.
+ * @retval -ENODEV If the GPS has not been initialized.
+ */
+int gps_set_binary(bool binary)
+{
+    if (uart_dev == NULL) {
+        return -ENODEV;
+    }
+
+    if (binary) {
+        /* Parse the reply as binary already */
+        bin_pos = 0;
+        k_sem_reset(&ack_sem);
+        binary_mode = true;
+        return gps_send_command("PMTK253,1,0");
+    }
+
+    uint8_t payload[5] = {0};  /* NMEA, keep the baud rate */
+    int ret = gps_bin_send(BIN_SET_FORMAT, payload, sizeof(payload));
+
+    binary_mode = false;
+    line_pos = 0;
+    return ret;
+}
+
+/**
+ * @brief Sends a PMTK binary packet.
+ *
+ * The packet is assembled in place: preamble, length, command, payload,
+ * checksum and CR LF.
+ *
+ * @param cmd Command.
+ * @param payload Payload bytes.
+ * @param len Payload length.
+ * @retval 0 On success.
+ * @retval -ENODEV If the GPS has not been initialized.
+ * @retval -EINVAL If the payload is too long.
+ */
+int gps_bin_send(uint16_t cmd, const uint8_t *payload, size_t len)
+{
+    uint8_t pkt[GPS_BIN_MAX_PAYLOAD + BIN_OVERHEAD];
+    size_t total = len + BIN_OVERHEAD;
+
+    if (uart_dev == NULL) {
+        return -ENODEV;
+    }
+    if (len > GPS_BIN_MAX_PAYLOAD) {
+        return -EINVAL;
+    }
+
+    pkt[0] = BIN_PREAMBLE0;
+    pkt[1] = BIN_PREAMBLE1;
+    sys_put_le16((uint16_t)total, &pkt[2]);
+    sys_put_le16(cmd, &pkt[4]);
+    memcpy(&pkt[BIN_HEADER], payload, len);
+    pkt[total - 3] = bin_checksum(pkt, total);
+    pkt[total - 2] = '\r';
+    pkt[total - 1] = '\n';
+
+    for (size_t i = 0; i < total; i++) {
+        uart_poll_out(uart_dev, pkt[i]);
+    }
+    return 0;
+}
+
+/**
+ * @brief Waits for the acknowledgement of an EPO packet.
+ *
+ * @param seq Pointer to store the acknowledged sequence number.
+ * @param result Pointer to store the result.
+ * @param timeout How long to wait.
+ * @retval 0 If an acknowledgement was received.
+ * @retval -EAGAIN If none arrived in time.
+ */
+int gps_bin_wait_ack(uint16_t *seq, uint8_t *result, k_timeout_t timeout)
+{
+    int ret = k_sem_take(&ack_sem, timeout);
+    if (ret < 0) {
+        return ret;
+    }
+
+    unsigned int key = irq_lock();
+    *seq = ack_seq;
+    *result = ack_result;
+    irq_unlock(key);
+    return 0;
+}
+
+/**
+ * @brief Gets the time to first fix.
+ *
+ * @return Milliseconds from @ref gps_init() to the first fix, or 0.
+ */
+uint32_t gps_ttff_ms(void)
+{
+    return ttff;
+}
+
+/**
+ * @brief Puts the module in standby or wakes it up.
+ *
+ * Any byte wakes the module; PMTK000 is the harmless test command.
+ *
+ * @param standby True to enter standby, false to wake up.
+ * @retval 0 On success.
+ * @retval -ENODEV If the GPS has not been initialized.
+ */
+int gps_standby(bool standby)
+{
+    if (uart_dev == NULL) {
+        return -ENODEV;
+    }
+    if (standby == standby_mode) {
+        return 0;
+    }
+
+    int ret = gps_send_command(standby ? "PMTK161,0" : "PMTK000");
+    if (ret == 0) {
+        standby_mode = standby;
+        energy_set_level(ENERGY_GPS, standby ? 0 : 1);
+    }
+    return ret;
+}
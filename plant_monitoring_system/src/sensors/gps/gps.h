@@ -9,6 +9,13 @@
  * Functions:
  *  - @ref gps_init() to initialize the UART and enable ISR-based reception.
  *  - @ref gps_wait_for_gga() to wait for a parsed GGA sentence.
+ *  - @ref gps_get_fix() to get the last fix with its UTC date and time.
+ *  - @ref gps_assist() to give the module a position and time to start from.
+ *  - @ref gps_send_command() to send a PMTK command.
+ *  - @ref gps_set_binary(), @ref gps_bin_send() and @ref gps_bin_wait_ack()
+ *    to exchange PMTK binary packets (EPO upload, see gps_epo.h).
+ *  - @ref gps_ttff_ms() to get the time to first fix.
+ *  - @ref gps_standby() to stop and resume tracking between fixes.
  *
  * Parsed data is returned as floating-point values in a @ref gps_data_t structure.
  */
@@ -21,6 +28,9 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+#define GPS_BIN_MAX_PAYLOAD 182  /**< Largest binary payload sent (EPO packet: 2 + 3 × 60 bytes). */
+#define GPS_BIN_ACK_EPO 723      /**< EPO packet acknowledgement: sequence (2 bytes), result (1 byte). */
+
 /**
  * @brief GPS configuration structure.
  *
@@ -44,8 +54,20 @@ typedef struct {
     int   sats;          /**< Number of satellites currently in use. */
     float hdop;          /**< Horizontal dilution of precision. */
     char  utc_time[16];  /**< UTC time (hhmmss.ss), null-terminated if available. */
+    int   fix;           /**< Fix quality (0 = no fix). */
 } gps_data_t;
 
+/**
+ * @brief Position and UTC time of a fix.
+ */
+struct gps_fix {
+    float lat;           /**< Latitude in decimal degrees. */
+    float lon;           /**< Longitude in decimal degrees. */
+    float alt;           /**< Altitude in meters above mean sea level. */
+    int64_t utc;         /**< UTC time of the fix, seconds since 1970-01-01. */
+    uint32_t uptime_ms;  /**< @c k_uptime_get_32() when @c utc was valid. */
+};
+
 /**
  * @brief Initializes the GPS module UART and interrupt service routine.
  *
@@ -74,4 +96,103 @@ int gps_init(const struct gps_config *cfg);
  */
 int gps_wait_for_gga(gps_data_t *out, k_timeout_t timeout);
 
+/**
+ * @brief Gets the last fix with a known date.
+ *
+ * The date comes from RMC sentences, the position and time from GGA.
+ *
+ * @param out Pointer to store the fix.
+ * @retval 0 On success.
+ * @retval -ENODATA If no fix with a date has been received yet.
+ */
+int gps_get_fix(struct gps_fix *out);
+
+/**
+ * @brief Sends an NMEA command to the GPS module.
+ *
+ * Adds the leading '$', the checksum and the line terminator.
+ *
+ * @param body Command without '$' or checksum (e.g. "PMTK101").
+ * @retval 0 On success.
+ * @retval -ENODEV If the GPS has not been initialized.
+ */
+int gps_send_command(const char *body);
+
+/**
+ * @brief Gives the module a reference position and time (PMTK741).
+ *
+ * With ephemeris still valid in the module, this lets it hot-start after
+ * losing its own time, instead of searching the whole sky. The time sent
+ * is the fix time advanced by the uptime elapsed since @c uptime_ms.
+ *
+ * @param fix Last known position and time.
+ * @retval 0 On success.
+ * @retval -EINVAL If the fix has no time.
+ * @retval -ENODEV If the GPS has not been initialized.
+ */
+int gps_assist(const struct gps_fix *fix);
+
+/**
+ * @brief Switches the link between NMEA and the PMTK binary protocol.
+ *
+ * Binary packets are framed as 0x04 0x24, length (2 bytes, whole packet),
+ * command (2 bytes), payload, XOR checksum of length to payload, CR LF; all
+ * integers little-endian. While the link is binary, NMEA sentences are not
+ * parsed and @ref gps_wait_for_gga() times out. The baud rate is kept.
+ *
+ * @param binary True for binary (PMTK253,1), false to return to NMEA.
+ * @retval 0 On success.
+ * @retval -ENODEV If the GPS has not been initialized.
+ */
+int gps_set_binary(bool binary);
+
+/**
+ * @brief Sends a PMTK binary packet.
+ *
+ * @param cmd Command (e.g. 722 for EPO data).
+ * @param payload Payload bytes.
+ * @param len Payload length (≤ @ref GPS_BIN_MAX_PAYLOAD).
+ * @retval 0 On success.
+ * @retval -ENODEV If the GPS has not been initialized.
+ * @retval -EINVAL If the payload is too long.
+ */
+int gps_bin_send(uint16_t cmd, const uint8_t *payload, size_t len);
+
+/**
+ * @brief Waits for the acknowledgement of an EPO packet (command
+ *        @ref GPS_BIN_ACK_EPO).
+ *
+ * @param seq Pointer to store the acknowledged sequence number.
+ * @param result Pointer to store the result (1 = accepted).
+ * @param timeout How long to wait.
+ * @retval 0 If an acknowledgement was received.
+ * @retval -EAGAIN If none arrived in time.
+ */
+int gps_bin_wait_ack(uint16_t *seq, uint8_t *result, k_timeout_t timeout);
+
+/**
+ * @brief Gets the time to first fix.
+ *
+ * Measured from @ref gps_init() to the first GGA sentence with a fix; it is
+ * also printed once, by the first @ref gps_wait_for_gga() call that follows.
+ *
+ * @return Time to first fix in milliseconds, or 0 if there is no fix yet.
+ */
+uint32_t gps_ttff_ms(void);
+
+/**
+ * @brief Puts the module in standby (PMTK161,0) or wakes it up.
+ *
+ * In standby the module stops tracking but keeps its time and ephemeris,
+ * so it hot-starts within seconds when woken by any byte on its UART
+ * (a PMTK000 test command here). Until then no sentence is sent and
+ * @ref gps_wait_for_gga() times out. The energy estimator accounts the
+ * module as off; its standby current is negligible next to tracking.
+ *
+ * @param standby True to enter standby, false to wake up.
+ * @retval 0 On success, or if the module is already in that state.
+ * @retval -ENODEV If the GPS has not been initialized.
+ */
+int gps_standby(bool standby);
+
 #endif /* GPS_H_ */
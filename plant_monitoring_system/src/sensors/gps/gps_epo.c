@@ -0,0 +1,190 @@
+/**
+ * @file gps_epo.c
+ * @brief EPO upload: reads the orbit sets from flash and streams them to
+ *        the GPS module over the PMTK binary protocol.
+ */
+
+#include "gps_epo.h"
+#include <zephyr/kernel.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/storage/flash_map.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/printk.h>
+#include <errno.h>
+#include <string.h>
+
+#define EPO_SAT_SIZE 60                            /**< Bytes per satellite record. */
+#define EPO_SATS 32                                /**< Records per set. */
+#define EPO_SET_SIZE (EPO_SAT_SIZE * EPO_SATS)     /**< Bytes per set. */
+#define EPO_SET_HOURS 6                            /**< Validity of a set. */
+#define EPO_HOUR_ERASED 0xFFFFFFu                  /**< GPS hour read from erased flash. */
+#define EPO_SATS_PER_PACKET 3                      /**< Records per binary packet. */
+#define EPO_CMD 722                                /**< PMTK binary EPO data command. */
+#define EPO_END_SEQ 0xFFFF                         /**< Sequence number ending an upload. */
+#define EPO_ACK_TIMEOUT_MS 1000                    /**< Wait for each acknowledgement. */
+#define EPO_RETRIES 3                              /**< Attempts per packet. */
+#define GPS_EPOCH_UNIX 315964800LL                 /**< 1980-01-06 00:00:00 UTC. */
+#define GPS_LEAP_SECONDS 18                        /**< GPS time minus UTC. */
+
+#if DT_HAS_CHOSEN(plant_epo_partition)
+
+/** @brief Payload of an EPO packet: sequence number and three records. */
+static uint8_t epo_payload[2 + EPO_SATS_PER_PACKET * EPO_SAT_SIZE];
+
+/**
+ * @brief Converts a UTC time to GPS hours since the GPS epoch.
+ */
+static uint32_t gps_hour(int64_t utc)
+{
+    return (uint32_t)((utc - GPS_EPOCH_UNIX + GPS_LEAP_SECONDS) / 3600);
+}
+
+/**
+ * @brief Sends @c epo_payload and waits for its acknowledgement.
+ *
+ * @param seq Sequence number already stored in the payload.
+ * @retval 0 If the module accepted the packet.
+ * @retval -EIO If it was rejected or never acknowledged.
+ */
+static int epo_send_packet(uint16_t seq)
+{
+    for (int attempt = 0; attempt < EPO_RETRIES; attempt++) {
+        uint16_t ack_seq;
+        uint8_t result;
+        int ret = gps_bin_send(EPO_CMD, epo_payload, sizeof(epo_payload));
+
+        if (ret < 0) {
+            return ret;
+        }
+        if (gps_bin_wait_ack(&ack_seq, &result, K_MSEC(EPO_ACK_TIMEOUT_MS)) == 0 &&
+            ack_seq == seq && result == 1) {
+            return 0;
+        }
+    }
+
+    printk("[EPO] - Packet %u not acknowledged\n", seq);
+    return -EIO;
+}
+
+/**
+ * @brief Streams the records of consecutive sets, then the end packet.
+ *
+ * Records are packed three per packet across set boundaries; the last
+ * packet is padded with zeros.
+ *
+ * @param fa EPO partition.
+ * @param first First set to send.
+ * @param count Number of sets.
+ * @retval 0 On success.
+ * @retval <0 Flash or link error.
+ */
+static int epo_stream(const struct flash_area *fa, unsigned int first, unsigned int count)
+{
+    unsigned int sats = count * EPO_SATS;
+    off_t off = (off_t)first * EPO_SET_SIZE;
+    uint16_t seq = 0;
+    int ret;
+
+    for (unsigned int i = 0; i < sats; i += EPO_SATS_PER_PACKET, seq++) {
+        unsigned int n = MIN(sats - i, (unsigned int)EPO_SATS_PER_PACKET);
+
+        memset(epo_payload, 0, sizeof(epo_payload));
+        sys_put_le16(seq, epo_payload);
+        ret = flash_area_read(fa, off + (off_t)i * EPO_SAT_SIZE, &epo_payload[2], n * EPO_SAT_SIZE);
+        if (ret < 0) {
+            return ret;
+        }
+
+        ret = epo_send_packet(seq);
+        if (ret < 0) {
+            return ret;
+        }
+    }
+
+    memset(epo_payload, 0, sizeof(epo_payload));
+    sys_put_le16(EPO_END_SEQ, epo_payload);
+    return epo_send_packet(EPO_END_SEQ);
+}
+
+int gps_epo_inject(const struct gps_fix *ref, unsigned int max_sets)
+{
+    const struct flash_area *fa;
+    unsigned int first = 0, count = 0;
+    uint32_t now;
+    int ret;
+
+    ret = flash_area_open(DT_FIXED_PARTITION_ID(DT_CHOSEN(plant_epo_partition)), &fa);
+    if (ret < 0) {
+        printk("[EPO] - Partition not available (%d)\n", ret);
+        return ret;
+    }
+
+    /* Without a time, expired sets cannot be told from current ones */
+    if (ref == NULL || ref->utc <= 0) {
+        printk("[EPO] - No reference time, upload skipped\n");
+        flash_area_close(fa);
+        return 0;
+    }
+    now = gps_hour(ref->utc + (k_uptime_get_32() - ref->uptime_ms) / MSEC_PER_SEC);
+
+    /* Find the current sets: skip expired ones, stop at erased flash */
+    for (unsigned int set = 0; set < fa->fa_size / EPO_SET_SIZE && count < max_sets; set++) {
+        uint8_t hour[3];
+
+        ret = flash_area_read(fa, (off_t)set * EPO_SET_SIZE, hour, sizeof(hour));
+        if (ret < 0) {
+            flash_area_close(fa);
+            return ret;
+        }
+
+        uint32_t start = hour[0] | (hour[1] << 8) | ((uint32_t)hour[2] << 16);
+
+        if (start == EPO_HOUR_ERASED) {
+            break;
+        }
+        if (start + EPO_SET_HOURS <= now) {
+            first = set + 1;
+            continue;
+        }
+        count++;
+    }
+
+    if (count == 0) {
+        printk("[EPO] - No current EPO data in flash\n");
+        flash_area_close(fa);
+        return 0;
+    }
+
+    uint32_t t0 = k_uptime_get_32();
+
+    ret = gps_set_binary(true);
+    if (ret == 0) {
+        ret = epo_stream(fa, first, count);
+    }
+    int restore = gps_set_binary(false);
+
+    flash_area_close(fa);
+
+    if (ret == 0) {
+        ret = restore;
+    }
+    if (ret < 0) {
+        printk("[EPO] - Upload failed (%d)\n", ret);
+        return ret;
+    }
+
+    printk("[EPO] - Sent %u set(s) (%u h of orbits) in %u ms\n",
+           count, count * EPO_SET_HOURS, k_uptime_get_32() - t0);
+    return (int)count;
+}
+
+#else
+
+int gps_epo_inject(const struct gps_fix *ref, unsigned int max_sets)
+{
+    ARG_UNUSED(ref);
+    ARG_UNUSED(max_sets);
+    return -ENOTSUP;
+}
+
+#endif /* DT_HAS_CHOSEN(plant_epo_partition) */
@@ -0,0 +1,45 @@
+/**
+ * @file gps_epo.h
+ * @brief Upload of EPO orbit predictions from flash to the GPS module.
+ *
+ * EPO (Extended Prediction Orbit) files hold predicted ephemeris of the 32
+ * GPS satellites, in sets of 32 records of 60 bytes; each set is valid for
+ * 6 hours from the GPS hour stored in the first 3 bytes (little-endian) of
+ * its records. With them, the module does not have to download ephemeris
+ * from the sky, which takes most of a cold start.
+ *
+ * The file is stored as-is at the start of the flash partition chosen as
+ * @c plant,epo-partition; the first set whose GPS hour reads 0xFFFFFF
+ * (erased flash) ends the data. tools/epo/epo_image.py prepares the image:
+ * an Intel HEX file for the board, or the flash simulator file given with
+ * @c -flash= on native_sim.
+ */
+
+#ifndef GPS_EPO_H_
+#define GPS_EPO_H_
+
+#include "gps.h"
+
+/**
+ * @brief Uploads the current EPO sets to the GPS module.
+ *
+ * Sets that expired before the reference time are skipped, then up to
+ * @p max_sets sets are sent in PMTK binary packets (command 722, three
+ * satellite records each), every packet being acknowledged before the next
+ * is sent (command 723 with its sequence number and result). The link is
+ * returned to NMEA afterwards, even on error. Without a reference time
+ * nothing is sent.
+ *
+ * Blocks for about 0.2 s per packet at 9600 baud (11 packets per set).
+ *
+ * @param ref Last known fix, or NULL; only its time is used.
+ * @param max_sets Maximum number of sets to send.
+ * @return Number of sets sent (0 if the partition holds no current data or
+ *         there is no reference time).
+ * @retval -ENOTSUP If no EPO partition is configured.
+ * @retval -EIO If the module rejected or did not acknowledge a packet.
+ * @retval <0 Other error from the flash or the UART.
+ */
+int gps_epo_inject(const struct gps_fix *ref, unsigned int max_sets);
+
+#endif /* GPS_EPO_H_ */
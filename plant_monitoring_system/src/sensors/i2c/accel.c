@@ -9,8 +9,24 @@
 #include "accel.h"
 #include "i2c.h"
 #include <zephyr/sys/printk.h>
+#include <zephyr/sys/util.h>
 #include <zephyr/kernel.h>
 
+#define ACCEL_ASLP_STEP_MS       320  /**< ASLP_COUNT step, at every active ODR but 1.56 Hz. */
+#define ACCEL_ASLP_STEP_1_56HZ   640  /**< ASLP_COUNT step at 1.56 Hz. */
+
+/**
+ * @brief Typical supply current (µA) by oversampling mode and data rate.
+ *
+ * Rows follow ACCEL_MODS_*, columns ACCEL_ODR_* (800 Hz to 1.56 Hz).
+ */
+static const uint16_t accel_current_ua[4][8] = {
+    [ACCEL_MODS_NORMAL]    = { 165, 165, 85, 44, 24, 24, 24, 24 },
+    [ACCEL_MODS_LNLP]      = { 165, 165, 85, 44, 24, 8, 8, 8 },
+    [ACCEL_MODS_HIGH_RES]  = { 165, 165, 165, 165, 165, 165, 165, 165 },
+    [ACCEL_MODS_LOW_POWER] = { 165, 84, 44, 24, 14, 6, 6, 6 },
+};
+
 /**
  * @brief Set accelerometer measurement range.
  *
@@ -36,7 +52,7 @@ int accel_set_standby(const struct i2c_dt_spec *dev)
     int ret = i2c_read_regs(dev, ACCEL_REG_CTRL1, &ctrl1, 1);
     if (ret < 0) return ret;
 
-    ctrl1 &= ~0x01; // Clear ACTIVE bit
+    ctrl1 &= ~ACCEL_CTRL1_ACTIVE;
     return i2c_write_reg(dev, ACCEL_REG_CTRL1, ctrl1);
 }
 
@@ -54,7 +70,7 @@ int accel_set_active(const struct i2c_dt_spec *dev)
     int ret = i2c_read_regs(dev, ACCEL_REG_CTRL1, &ctrl1, 1);
     if (ret < 0) return ret;
 
-    ctrl1 |= 0x01; // Set ACTIVE bit
+    ctrl1 |= ACCEL_CTRL1_ACTIVE;
     return i2c_write_reg(dev, ACCEL_REG_CTRL1, ctrl1);
 }
 
@@ -98,6 +114,76 @@ int accel_init(const struct i2c_dt_spec *dev, uint8_t range) {
     return accel_set_active(dev);
 }
 
+/**
+ * @brief Apply a power configuration.
+ *
+ * Programs CTRL2 (MODS, SMODS, SLPE), ASLP_COUNT and the transient wake
+ * source in standby, then CTRL1 (DR, ASLP_RATE) together with the ACTIVE
+ * bit. The low-noise and fast-read bits of CTRL1 are preserved.
+ *
+ * @param dev Pointer to I2C device descriptor.
+ * @param cfg Power configuration.
+ * @return 0 on success, negative errno code on failure.
+ */
+int accel_set_power(const struct i2c_dt_spec *dev, const struct accel_power_config *cfg)
+{
+    if (cfg->odr > ACCEL_ODR_1_56HZ || cfg->mods > ACCEL_MODS_LOW_POWER ||
+        cfg->sleep_rate > ACCEL_ASLP_1_56HZ || cfg->sleep_mods > ACCEL_MODS_LOW_POWER) {
+        return -EINVAL;
+    }
+
+    int ret = accel_set_standby(dev);
+    if (ret < 0) return ret;
+
+    uint16_t step_ms = (cfg->odr == ACCEL_ODR_1_56HZ) ? ACCEL_ASLP_STEP_1_56HZ : ACCEL_ASLP_STEP_MS;
+    uint8_t aslp_count = (uint8_t)MIN(DIV_ROUND_UP(cfg->sleep_after_ms, step_ms), 255);
+    uint8_t wake_ths = (uint8_t)CLAMP(DIV_ROUND_UP(cfg->wake_mg, ACCEL_TRANSIENT_MG_PER_LSB), 1, 127);
+    uint8_t ctrl2 = cfg->mods | (uint8_t)(cfg->sleep_mods << ACCEL_CTRL2_SMODS_SHIFT);
+
+    if (cfg->auto_sleep) {
+        ctrl2 |= ACCEL_CTRL2_SLPE;
+    }
+
+    const uint8_t writes[][2] = {
+        { ACCEL_REG_CTRL2, ctrl2 },
+        { ACCEL_REG_ASLP_COUNT, aslp_count },
+        { ACCEL_REG_TRANSIENT_CFG, cfg->auto_sleep ? ACCEL_TRANSIENT_XYZ : 0 },
+        { ACCEL_REG_TRANSIENT_THS, wake_ths },
+        { ACCEL_REG_TRANSIENT_COUNT, 1 },
+        { ACCEL_REG_CTRL3, cfg->auto_sleep ? ACCEL_CTRL3_WAKE_TRANS : 0 },
+        { ACCEL_REG_CTRL4, cfg->auto_sleep ? ACCEL_CTRL4_INT_EN_TRANS : 0 },
+    };
+
+    for (size_t i = 0; i < ARRAY_SIZE(writes); i++) {
+        ret = i2c_write_reg(dev, writes[i][0], writes[i][1]);
+        if (ret < 0) return ret;
+    }
+
+    uint8_t ctrl1;
+    ret = i2c_read_regs(dev, ACCEL_REG_CTRL1, &ctrl1, 1);
+    if (ret < 0) return ret;
+
+    ctrl1 &= 0x06;  /* Keep LNOISE and F_READ */
+    ctrl1 |= (uint8_t)(cfg->sleep_rate << ACCEL_CTRL1_ASLP_SHIFT) |
+             (uint8_t)(cfg->odr << ACCEL_CTRL1_DR_SHIFT) | ACCEL_CTRL1_ACTIVE;
+    return i2c_write_reg(dev, ACCEL_REG_CTRL1, ctrl1);
+}
+
+/**
+ * @brief Typical supply current of a data rate and oversampling mode.
+ *
+ * @param odr Data rate (ACCEL_ODR_*).
+ * @param mods Oversampling mode (ACCEL_MODS_*).
+ * @return Supply current in µA, or 0 for an invalid setting.
+ */
+uint16_t accel_supply_ua(uint8_t odr, uint8_t mods)
+{
+    if (odr > ACCEL_ODR_1_56HZ || mods > ACCEL_MODS_LOW_POWER) {
+        return 0;
+    }
+    return accel_current_ua[mods][odr];
+}
+
 /**
  * @brief Read raw accelerometer X, Y, Z values.
  *
@@ -10,6 +10,12 @@
 #include "i2c.h"
 #include <zephyr/kernel.h>
 #include <zephyr/sys/printk.h>
+#include <zephyr/sys/util.h>
+
+#define COLOR_CYCLE_US 2400  /**< Duration of one integration cycle. */
+
+/** @brief Gain multiplier of each GAIN_* setting. */
+static const uint8_t color_gain_mult[] = { 1, 4, 16, 60 };
 
 /* === Internal helper functions === */
 
@@ -24,7 +30,7 @@
 static int color_write_reg(const struct i2c_dt_spec *dev, uint8_t reg, uint8_t val)
 {
     uint8_t buf[2] = { COLOR_COMMAND | reg, val };
-    return i2c_write_dt(dev, buf, sizeof(buf));
+    return i2c_write_buf(dev, buf, sizeof(buf));
 }
 
 /**
@@ -41,7 +47,7 @@ static int color_write_reg(const struct i2c_dt_spec *dev, uint8_t reg, uint8_t v
 static int color_read_regs(const struct i2c_dt_spec *dev, uint8_t reg, uint8_t *buf, size_t len)
 {
     uint8_t reg_cmd = COLOR_COMMAND | AUTO_INCREMENT | reg;
-    return i2c_write_read_dt(dev, &reg_cmd, 1, buf, len);
+    return i2c_write_read_buf(dev, &reg_cmd, 1, buf, len);
 }
 
 /* === Public API === */
@@ -71,13 +77,82 @@ int color_init(const struct i2c_dt_spec *dev, uint8_t gain, uint8_t atime)
     }
 
     /* Apply default settings */
-    color_write_reg(dev, COLOR_CONTROL, gain);
-    color_write_reg(dev, COLOR_ATIME, atime);
+    if (color_set_timing(dev, gain, atime) < 0) {
+        printk("[COLOR] - Failed to set gain and integration time\n");
+        return -EIO;
+    }
 
     printk("[COLOR] - Color sensor initialized successfully\n");
     return 0;
 }
 
+/**
+ * @brief Change gain and integration time.
+ *
+ * If the sensor is converting, the ADC is disabled while the registers
+ * change, then re-enabled so a new integration cycle starts with the new
+ * timing. A sleeping sensor keeps sleeping and uses the timing once woken.
+ *
+ * @param dev Pointer to I2C device descriptor.
+ * @param gain Gain setting.
+ * @param atime Integration time setting.
+ * @return 0 on success, negative errno code on failure.
+ */
+int color_set_timing(const struct i2c_dt_spec *dev, uint8_t gain, uint8_t atime)
+{
+    uint8_t enable;
+
+    if (gain >= ARRAY_SIZE(color_gain_mult)) {
+        return -EINVAL;
+    }
+
+    int ret = color_read_regs(dev, COLOR_ENABLE, &enable, 1);
+    if (ret < 0) return ret;
+
+    if (enable & ENABLE_AEN) {
+        ret = color_write_reg(dev, COLOR_ENABLE, enable & ~ENABLE_AEN);
+        if (ret < 0) return ret;
+    }
+    ret = color_write_reg(dev, COLOR_CONTROL, gain);
+    if (ret < 0) return ret;
+    ret = color_write_reg(dev, COLOR_ATIME, atime);
+    if (ret < 0) return ret;
+
+    if (enable & ENABLE_AEN) {
+        return color_write_reg(dev, COLOR_ENABLE, enable);
+    }
+    return 0;
+}
+
+/**
+ * @brief Integration time of an ATIME setting.
+ *
+ * @param atime ATIME register value.
+ * @return (256 − ATIME) cycles of 2.4 ms, in microseconds.
+ */
+uint32_t color_integration_us(uint8_t atime)
+{
+    return (256U - atime) * COLOR_CYCLE_US;
+}
+
+/**
+ * @brief Rescale a channel count to the reference timing.
+ *
+ * Counts are proportional to gain × integration cycles.
+ *
+ * @param raw Count read with @p gain and @p atime.
+ * @param gain Gain of the count.
+ * @param atime Integration time of the count.
+ * @return Rescaled count, saturated at 65535.
+ */
+uint16_t color_rescale(uint16_t raw, uint8_t gain, uint8_t atime)
+{
+    uint32_t ref = color_gain_mult[COLOR_REF_GAIN] * (256U - COLOR_REF_ATIME);
+    uint32_t sens = color_gain_mult[gain & 0x03] * (256U - atime);
+
+    return (uint16_t)MIN((uint32_t)raw * ref / sens, UINT16_MAX);
+}
+
 /**
  * @brief Wake up the sensor (power on and enable ADC).
  *
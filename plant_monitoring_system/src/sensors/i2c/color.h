@@ -45,6 +45,13 @@
 #define INTEGRATION_154MS   0xC0 /**< 154 ms */
 #define INTEGRATION_700MS   0x00 /**< 700 ms */
 
+/* === Reference timing ===
+ * Counts read with another gain and integration time can be rescaled to this
+ * setting with @ref color_rescale, so the analysis sees the same scale
+ * whatever the timing. */
+#define COLOR_REF_GAIN      GAIN_4X           /**< Reference gain */
+#define COLOR_REF_ATIME     INTEGRATION_154MS /**< Reference integration time */
+
 /**
  * @brief Structure for storing raw color sensor data.
  */
@@ -65,6 +72,34 @@ typedef struct {
  */
 int color_init(const struct i2c_dt_spec *dev, uint8_t gain, uint8_t atime);
 
+/**
+ * @brief Change gain and integration time.
+ * Restarts the integration cycle of a converting sensor, so the first
+ * valid counts at the new timing are available after
+ * @ref color_integration_us; a sleeping sensor stays asleep.
+ * @param dev Pointer to the I2C device descriptor.
+ * @param gain One of the GAIN_* settings.
+ * @param atime ATIME register value (INTEGRATION_* or any 0x00–0xFF).
+ * @return 0 on success, negative errno code on failure.
+ */
+int color_set_timing(const struct i2c_dt_spec *dev, uint8_t gain, uint8_t atime);
+
+/**
+ * @brief Integration time of an ATIME setting.
+ * @param atime ATIME register value.
+ * @return Integration time in microseconds.
+ */
+uint32_t color_integration_us(uint8_t atime);
+
+/**
+ * @brief Rescale a channel count to the reference gain and integration time.
+ * @param raw Count read with @p gain and @p atime.
+ * @param gain Gain of the count.
+ * @param atime Integration time of the count.
+ * @return Count at @ref COLOR_REF_GAIN / @ref COLOR_REF_ATIME, saturated at 65535.
+ */
+uint16_t color_rescale(uint16_t raw, uint8_t gain, uint8_t atime);
+
 /**
  * @brief Wake up the color sensor (enable ADC and power).
  *
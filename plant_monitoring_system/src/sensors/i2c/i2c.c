@@ -5,16 +5,114 @@
  * This module provides simple functions to read multiple registers, write
  * a single register, and check if an I2C device is ready. Devices are
  * described using Zephyr devicetree `i2c_dt_spec`.
+ *
+ * Every transfer goes through @ref i2c_write_buf, @ref i2c_write_read_buf or
+ * @ref i2c_read_buf, which charge the bus time of the transfer to the energy
+ * estimator.
  */
 
 #include "i2c.h"
+#include "power/energy.h"
+#include <zephyr/kernel.h>
 #include <zephyr/sys/printk.h>
 
+#define I2C_DEFAULT_HZ 100000  /**< Bus speed assumed if the controller does not report one. */
+#define I2C_BITS_PER_BYTE 9    /**< Eight data bits plus ACK. */
+
+/**
+ * @brief Get the SCL frequency of an I2C controller.
+ *
+ * The result is cached for the last controller queried.
+ *
+ * @param bus I2C controller.
+ * @return Bus speed in Hz.
+ */
+static uint32_t i2c_bus_hz(const struct device *bus)
+{
+    static const struct device *cached_bus;
+    static uint32_t cached_hz;
+    uint32_t cfg;
+
+    if (bus == cached_bus) {
+        return cached_hz;
+    }
+
+    cached_hz = I2C_DEFAULT_HZ;
+    if (i2c_get_config(bus, &cfg) == 0) {
+        switch (I2C_SPEED_GET(cfg)) {
+        case I2C_SPEED_FAST:
+            cached_hz = 400000;
+            break;
+        case I2C_SPEED_FAST_PLUS:
+            cached_hz = 1000000;
+            break;
+        default:
+            break;
+        }
+    }
+    cached_bus = bus;
+    return cached_hz;
+}
+
+/**
+ * @brief Charge the bus time of a transfer to the energy estimator.
+ *
+ * @param dev I2C device descriptor.
+ * @param bytes Bytes on the wire, including address bytes.
+ */
+static void i2c_account(const struct i2c_dt_spec *dev, size_t bytes)
+{
+    energy_charge(ENERGY_I2C, (uint32_t)((uint64_t)bytes * I2C_BITS_PER_BYTE * USEC_PER_SEC /
+                                         i2c_bus_hz(dev->bus)));
+}
+
+/**
+ * @brief Write a buffer to an I2C device.
+ *
+ * @param dev Pointer to the I2C device descriptor.
+ * @param buf Bytes to write.
+ * @param len Number of bytes to write.
+ * @return 0 on success, negative errno code on failure.
+ */
+int i2c_write_buf(const struct i2c_dt_spec *dev, const uint8_t *buf, size_t len) {
+    i2c_account(dev, 1 + len);
+    return i2c_write_dt(dev, buf, len);
+}
+
+/**
+ * @brief Write a buffer to an I2C device, then read back with a repeated start.
+ *
+ * @param dev Pointer to the I2C device descriptor.
+ * @param wbuf Bytes to write.
+ * @param wlen Number of bytes to write.
+ * @param rbuf Buffer to store the read bytes.
+ * @param rlen Number of bytes to read.
+ * @return 0 on success, negative errno code on failure.
+ */
+int i2c_write_read_buf(const struct i2c_dt_spec *dev, const uint8_t *wbuf, size_t wlen,
+                       uint8_t *rbuf, size_t rlen) {
+    i2c_account(dev, 2 + wlen + rlen);
+    return i2c_write_read_dt(dev, wbuf, wlen, rbuf, rlen);
+}
+
+/**
+ * @brief Read bytes from an I2C device without writing first.
+ *
+ * @param dev Pointer to the I2C device descriptor.
+ * @param buf Buffer to store the read bytes.
+ * @param len Number of bytes to read.
+ * @return 0 on success, negative errno code on failure.
+ */
+int i2c_read_buf(const struct i2c_dt_spec *dev, uint8_t *buf, size_t len) {
+    i2c_account(dev, 1 + len);
+    return i2c_read_dt(dev, buf, len);
+}
+
 /**
  * @brief Read multiple bytes from a device starting at a given register.
  *
  * This function sends the register address first and then reads `len` bytes
- * into the provided buffer. Uses `i2c_write_read_dt` internally.
+ * into the provided buffer. Uses @ref i2c_write_read_buf internally.
  *
  * @param dev Pointer to the I2C device descriptor.
  * @param reg Register address to start reading.
@@ -23,14 +121,14 @@
  * @return 0 on success, negative errno code on failure.
  */
 int i2c_read_regs(const struct i2c_dt_spec *dev, uint8_t reg, uint8_t *buf, size_t len) {
-    return i2c_write_read_dt(dev, &reg, 1, buf, len);
+    return i2c_write_read_buf(dev, &reg, 1, buf, len);
 }
 
 /**
  * @brief Write a single byte to a specific register of the I2C device.
  *
  * This function sends the register address followed by the byte value.
- * Uses `i2c_write_dt` internally.
+ * Uses @ref i2c_write_buf internally.
  *
  * @param dev Pointer to the I2C device descriptor.
  * @param reg Register address to write to.
@@ -39,7 +137,7 @@ int i2c_read_regs(const struct i2c_dt_spec *dev, uint8_t reg, uint8_t *buf, size
  */
 int i2c_write_reg(const struct i2c_dt_spec *dev, uint8_t reg, uint8_t val) {
     uint8_t data[2] = { reg, val };
-    return i2c_write_dt(dev, data, sizeof(data));
+    return i2c_write_buf(dev, data, sizeof(data));
 }
 
 /**
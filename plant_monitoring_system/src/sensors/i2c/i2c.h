@@ -14,6 +14,43 @@
 #include <zephyr/drivers/i2c.h>
 #include <stdint.h>
 
+/**
+ * @brief Write a buffer to an I2C device.
+ *
+ * All I2C traffic should use this function, @ref i2c_write_read_buf or
+ * @ref i2c_read_buf, so that bus time is accounted by the energy estimator.
+ *
+ * @param dev Pointer to the I2C device descriptor.
+ * @param buf Bytes to write.
+ * @param len Number of bytes to write.
+ * @return 0 on success, negative errno code on failure.
+ */
+int i2c_write_buf(const struct i2c_dt_spec *dev, const uint8_t *buf, size_t len);
+
+/**
+ * @brief Write a buffer to an I2C device, then read back with a repeated start.
+ *
+ * @param dev Pointer to the I2C device descriptor.
+ * @param wbuf Bytes to write (usually a register address or command).
+ * @param wlen Number of bytes to write.
+ * @param rbuf Buffer to store the read bytes.
+ * @param rlen Number of bytes to read.
+ * @return 0 on success, negative errno code on failure.
+ */
+int i2c_write_read_buf(const struct i2c_dt_spec *dev, const uint8_t *wbuf, size_t wlen,
+                       uint8_t *rbuf, size_t rlen);
+
+/**
+ * @brief Read bytes from an I2C device without writing first.
+ *
+ * @param dev Pointer to the I2C device descriptor.
+ * @param buf Buffer to store the read bytes.
+ * @param len Number of bytes to read.
+ * @return 0 on success, negative errno code on failure (including a NACK
+ *         of the address by a busy device).
+ */
+int i2c_read_buf(const struct i2c_dt_spec *dev, uint8_t *buf, size_t len);
+
 /**
  * @brief Read multiple bytes from a device register over I2C.
  *
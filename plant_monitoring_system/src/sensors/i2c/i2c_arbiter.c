@@ -0,0 +1,231 @@
+/**
+ * @file i2c_arbiter.c
+ * @brief Bus ownership, priority-ordered hand-over and priority inheritance.
+ *
+ * Pending clients wait on a semaphore of their own, in a list sorted by
+ * priority. The releasing owner hands the bus directly to the head of the
+ * list, so a client arriving in between cannot overtake it.
+ */
+
+#include "i2c_arbiter.h"
+#include <zephyr/sys/printk.h>
+#include <errno.h>
+
+/**
+ * @brief A client waiting for the bus (on the waiting thread's stack).
+ */
+struct i2c_waiter {
+    struct i2c_waiter *next;     /**< Next, less or equally urgent, waiter. */
+    struct i2c_client *client;   /**< Waiting client. */
+    k_tid_t thread;              /**< Waiting thread. */
+    struct k_sem granted_sem;    /**< Given when the bus is handed over. */
+    bool granted;                /**< The bus was handed over. */
+};
+
+static K_MUTEX_DEFINE(arb_lock);       /**< Protects everything below. */
+static struct i2c_mux *arb_mux;        /**< Multiplexer, or NULL. */
+static struct i2c_client *owner;       /**< Client owning the bus, or NULL. */
+static k_tid_t owner_thread;           /**< Thread owning the bus. */
+static int owner_base_prio;            /**< Priority of @c owner_thread before inheritance. */
+static uint8_t owner_channel;          /**< Channel of the transaction in progress. */
+static struct i2c_waiter *waiters;     /**< Pending clients, most urgent first. */
+static struct i2c_client *clients;     /**< Clients that used the bus. */
+
+/**
+ * @brief Microseconds elapsed since a cycle counter value.
+ */
+static uint32_t elapsed_us(uint32_t since)
+{
+    return k_cyc_to_us_floor32(k_cycle_get_32() - since);
+}
+
+/**
+ * @brief Run the owner at the priority of the most urgent waiter, if higher.
+ *
+ * Called with @c arb_lock held.
+ */
+static void arb_inherit(void)
+{
+    int prio = owner_base_prio;
+
+    if (waiters != NULL && waiters->client->prio < prio) {
+        prio = waiters->client->prio;
+    }
+    if (k_thread_priority_get(owner_thread) != prio) {
+        k_thread_priority_set(owner_thread, prio);
+    }
+}
+
+/**
+ * @brief Make a client the owner. Called with @c arb_lock held.
+ */
+static void arb_take(struct i2c_client *client, k_tid_t thread, uint8_t channel)
+{
+    owner = client;
+    owner_thread = thread;
+    owner_base_prio = k_thread_priority_get(thread);
+    owner_channel = channel;
+    client->acquired_cyc = k_cycle_get_32();
+    arb_inherit();
+}
+
+/**
+ * @brief Select the channel of a new transaction (bus owned).
+ */
+static int arb_select(uint8_t channel)
+{
+    return (arb_mux != NULL) ? i2c_mux_select(arb_mux, channel) : 0;
+}
+
+void i2c_arbiter_init(struct i2c_mux *mux)
+{
+    arb_mux = mux;
+}
+
+/**
+ * @brief Wait until the bus is owned by the calling thread.
+ *
+ * @param client Calling client.
+ * @param channel Channel recorded for the transaction (not selected).
+ * @param timeout Longest wait.
+ * @retval 0 If the bus is owned.
+ * @retval -EAGAIN On timeout.
+ * @retval -EDEADLK If the calling thread already owns the bus.
+ */
+static int arb_wait(struct i2c_client *client, uint8_t channel, k_timeout_t timeout)
+{
+    struct i2c_waiter w = { .client = client, .thread = k_current_get() };
+    uint32_t start = k_cycle_get_32();
+
+    k_mutex_lock(&arb_lock, K_FOREVER);
+
+    if (!client->registered) {
+        client->next = clients;
+        clients = client;
+        client->registered = true;
+    }
+
+    if (owner == NULL) {
+        arb_take(client, w.thread, channel);
+        k_mutex_unlock(&arb_lock);
+        return 0;
+    }
+    if (owner_thread == w.thread) {
+        k_mutex_unlock(&arb_lock);
+        return -EDEADLK;
+    }
+
+    struct i2c_waiter **pos = &waiters;
+
+    while (*pos != NULL && (*pos)->client->prio <= client->prio) {
+        pos = &(*pos)->next;
+    }
+    k_sem_init(&w.granted_sem, 0, 1);
+    w.next = *pos;
+    *pos = &w;
+    client->contended++;
+    arb_inherit();
+    k_mutex_unlock(&arb_lock);
+
+    int ret = k_sem_take(&w.granted_sem, timeout);
+
+    k_mutex_lock(&arb_lock, K_FOREVER);
+    if (ret != 0 && !w.granted) {
+        for (pos = &waiters; *pos != &w; pos = &(*pos)->next) {
+        }
+        *pos = w.next;
+        arb_inherit();
+        client->timeouts++;
+        k_mutex_unlock(&arb_lock);
+        return -EAGAIN;
+    }
+
+    uint32_t waited = elapsed_us(start);
+
+    owner_channel = channel;
+    client->wait_total_us += waited;
+    client->wait_max_us = MAX(client->wait_max_us, waited);
+    k_mutex_unlock(&arb_lock);
+    return 0;
+}
+
+int i2c_arbiter_acquire(struct i2c_client *client, uint8_t channel, k_timeout_t timeout)
+{
+    client->transactions++;
+
+    int ret = arb_wait(client, channel, timeout);
+    if (ret < 0) {
+        return ret;
+    }
+
+    ret = arb_select(channel);
+    if (ret < 0) {
+        i2c_arbiter_release(client);
+    }
+    return ret;
+}
+
+void i2c_arbiter_release(struct i2c_client *client)
+{
+    k_mutex_lock(&arb_lock, K_FOREVER);
+
+    if (owner != client) {
+        k_mutex_unlock(&arb_lock);
+        return;
+    }
+
+    client->hold_max_us = MAX(client->hold_max_us, elapsed_us(client->acquired_cyc));
+    if (k_thread_priority_get(owner_thread) != owner_base_prio) {
+        k_thread_priority_set(owner_thread, owner_base_prio);
+    }
+
+    struct i2c_waiter *next = waiters;
+
+    if (next == NULL) {
+        owner = NULL;
+        owner_thread = NULL;
+    } else {
+        waiters = next->next;
+        next->granted = true;
+        /* The new owner records and selects its channel itself */
+        arb_take(next->client, next->thread, I2C_MUX_NONE);
+        k_sem_give(&next->granted_sem);
+    }
+
+    k_mutex_unlock(&arb_lock);
+}
+
+int i2c_arbiter_sleep_us(uint32_t us)
+{
+    k_mutex_lock(&arb_lock, K_FOREVER);
+
+    struct i2c_client *client = (owner_thread == k_current_get()) ? owner : NULL;
+    uint8_t channel = owner_channel;
+
+    k_mutex_unlock(&arb_lock);
+
+    if (client == NULL) {
+        k_usleep(us);
+        return 0;
+    }
+
+    i2c_arbiter_release(client);
+    k_usleep(us);
+
+    /* Same transaction: waits like an acquisition, but is not counted as one */
+    arb_wait(client, channel, K_FOREVER);
+    return arb_select(channel);
+}
+
+void i2c_arbiter_print(void)
+{
+    k_mutex_lock(&arb_lock, K_FOREVER);
+    for (const struct i2c_client *c = clients; c != NULL; c = c->next) {
+        printk("[I2C BUS] - %s (prio %d): %u transaction(s), %u waited (max %u us, mean %u us), "
+               "%u timeout(s), longest hold %u us\n",
+               c->name, c->prio, c->transactions, c->contended, c->wait_max_us,
+               c->contended ? (uint32_t)(c->wait_total_us / c->contended) : 0U,
+               c->timeouts, c->hold_max_us);
+    }
+    k_mutex_unlock(&arb_lock);
+}
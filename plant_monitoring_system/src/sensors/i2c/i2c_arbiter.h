@@ -0,0 +1,111 @@
+/**
+ * @file i2c_arbiter.h
+ * @brief Priority arbitration of the shared sensor I2C bus.
+ *
+ * Every sensor shares one controller, and a transaction on a multiplexed
+ * sensor (channel selection, then transfers) must not be interleaved with
+ * another one. Threads therefore acquire the bus for a transaction, with
+ * the multiplexer channel they need, and release it afterwards:
+ *
+ * @code
+ * static struct i2c_client motion = I2C_CLIENT_INIT("motion", 2);
+ *
+ * if (i2c_arbiter_acquire(&motion, slot->mux_channel, K_MSEC(5)) == 0) {
+ *     accel_read_xyz(&slot->spec, &x, &y, &z);
+ *     i2c_arbiter_release(&motion);
+ * }
+ * @endcode
+ *
+ * Pending transactions are served by client priority (same scale as thread
+ * priorities: lower is more urgent), first come first served among equal
+ * priorities. While a more urgent client waits, the thread owning the bus
+ * runs at that client's priority so a preempted low-priority owner does
+ * not delay it further (priority inheritance).
+ *
+ * Transfers cannot be preempted: a client waits for the one in progress.
+ * Drivers therefore must not keep the bus busy while a sensor works; they
+ * wait with @ref i2c_arbiter_sleep_us, which hands the bus over for the
+ * duration. The Si7021 is read in No Hold Master mode for that reason.
+ *
+ * Not usable from ISRs: an interrupt handler defers its reads to a thread.
+ * Before the sensor threads start, main accesses the bus directly.
+ */
+
+#ifndef I2C_ARBITER_H
+#define I2C_ARBITER_H
+
+#include "i2c_mux.h"
+#include <zephyr/kernel.h>
+#include <stdint.h>
+
+/**
+ * @brief A user of the bus, with its priority and latency counters.
+ */
+struct i2c_client {
+    const char *name;          /**< Name printed with the counters. */
+    int prio;                  /**< Transaction priority (thread priority scale). */
+    uint32_t transactions;     /**< Acquisitions. */
+    uint32_t contended;        /**< Acquisitions that had to wait. */
+    uint32_t timeouts;         /**< Acquisitions abandoned on timeout. */
+    uint32_t wait_max_us;      /**< Longest wait for the bus. */
+    uint64_t wait_total_us;    /**< Total wait for the bus. */
+    uint32_t hold_max_us;      /**< Longest transaction (bus owned). */
+    uint32_t acquired_cyc;     /**< Cycle counter at the acquisition. */
+    struct i2c_client *next;   /**< Registered clients, for @ref i2c_arbiter_print. */
+    bool registered;           /**< Linked in the client list. */
+};
+
+/**
+ * @brief Static initializer of a client.
+ *
+ * @param _name Name printed with the counters.
+ * @param _prio Transaction priority (lower is more urgent).
+ */
+#define I2C_CLIENT_INIT(_name, _prio) { .name = (_name), .prio = (_prio) }
+
+/**
+ * @brief Set the multiplexer handled by the arbiter.
+ *
+ * @param mux Multiplexer in front of the sensors, or NULL if none.
+ */
+void i2c_arbiter_init(struct i2c_mux *mux);
+
+/**
+ * @brief Acquire the bus for a transaction and select a multiplexer channel.
+ *
+ * @param client Calling client.
+ * @param channel Multiplexer channel of the transaction, or @ref I2C_MUX_NONE.
+ * @param timeout Longest wait for the bus.
+ * @retval 0 If the bus is owned by the caller.
+ * @retval -EAGAIN If the bus was not free in time.
+ * @retval -EDEADLK If the calling thread already owns the bus.
+ * @retval <0 If the channel could not be selected (the bus is released).
+ */
+int i2c_arbiter_acquire(struct i2c_client *client, uint8_t channel, k_timeout_t timeout);
+
+/**
+ * @brief Release the bus to the most urgent pending client.
+ *
+ * @param client Client that owns the bus.
+ */
+void i2c_arbiter_release(struct i2c_client *client);
+
+/**
+ * @brief Wait for a sensor without holding the bus.
+ *
+ * If the calling thread owns the bus, it is released for the duration and
+ * acquired again, with the same channel, afterwards; otherwise this is a
+ * plain sleep.
+ *
+ * @param us Time to wait.
+ * @return 0, or a negative errno code if the channel could not be selected
+ *         again (the bus is owned in both cases).
+ */
+int i2c_arbiter_sleep_us(uint32_t us);
+
+/**
+ * @brief Print the counters of every client, one line each.
+ */
+void i2c_arbiter_print(void);
+
+#endif /* I2C_ARBITER_H */
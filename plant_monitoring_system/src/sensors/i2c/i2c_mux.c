@@ -0,0 +1,77 @@
+/**
+ * @file i2c_mux.c
+ * @brief Implementation of the TCA9548A I2C multiplexer driver.
+ *
+ * The TCA9548A has a single control register: bit @c n enables downstream
+ * channel @c n. Only one channel is enabled at a time by this driver.
+ */
+
+#include "i2c_mux.h"
+#include "i2c.h"
+#include <zephyr/sys/printk.h>
+
+/**
+ * @brief Write the multiplexer control register.
+ *
+ * @param mux Pointer to the multiplexer descriptor.
+ * @param control Channel enable bitmask.
+ * @return 0 on success, negative errno code on failure.
+ */
+static int i2c_mux_write_control(struct i2c_mux *mux, uint8_t control)
+{
+    return i2c_write_buf(&mux->spec, &control, 1);
+}
+
+/**
+ * @brief Initialize the multiplexer and disconnect all downstream channels.
+ *
+ * @param mux Pointer to the multiplexer descriptor.
+ * @return 0 on success, negative errno code on failure.
+ */
+int i2c_mux_init(struct i2c_mux *mux)
+{
+    printk("[I2C MUX] - Initializing I2C multiplexer...\n");
+
+    int ret = i2c_dev_ready(&mux->spec);
+    if (ret < 0) return ret;
+
+    ret = i2c_mux_write_control(mux, 0x00);
+    if (ret < 0) {
+        printk("[I2C MUX] - Multiplexer not responding at 0x%02X (%d)\n", mux->spec.addr, ret);
+        return ret;
+    }
+
+    mux->channel = I2C_MUX_NONE;
+
+    printk("[I2C MUX] - I2C multiplexer initialized successfully\n");
+    return 0;
+}
+
+/**
+ * @brief Connect one downstream channel to the upstream bus.
+ *
+ * @param mux Pointer to the multiplexer descriptor.
+ * @param channel Channel number (0–7) or @ref I2C_MUX_NONE.
+ * @return 0 on success, negative errno code on failure.
+ */
+int i2c_mux_select(struct i2c_mux *mux, uint8_t channel)
+{
+    if (channel != I2C_MUX_NONE && channel >= I2C_MUX_CHANNELS) {
+        return -EINVAL;
+    }
+
+    if (channel == mux->channel) {
+        return 0;
+    }
+
+    uint8_t control = (channel == I2C_MUX_NONE) ? 0x00 : (uint8_t)(1U << channel);
+    int ret = i2c_mux_write_control(mux, control);
+    if (ret < 0) {
+        printk("[I2C MUX] - Failed to select channel %d (%d)\n", channel, ret);
+        mux->channel = I2C_MUX_CHANNELS; /* Unknown state, force a rewrite next time */
+        return ret;
+    }
+
+    mux->channel = channel;
+    return 0;
+}
@@ -0,0 +1,55 @@
+/**
+ * @file i2c_mux.h
+ * @brief Interface for the TCA9548A 8-channel I2C multiplexer.
+ *
+ * The TCA9548A connects the upstream I2C bus to any of its 8 downstream
+ * channels, allowing several sensors with the same fixed address (e.g. more
+ * than one Si7021 or TCS34725) to share one controller bus. Channel
+ * selection is a single-byte write to the multiplexer control register.
+ *
+ * The current selection is cached so consecutive accesses on the same
+ * channel do not generate extra bus traffic.
+ */
+
+#ifndef I2C_MUX_H
+#define I2C_MUX_H
+
+#include <zephyr/device.h>
+#include <zephyr/drivers/i2c.h>
+#include <stdint.h>
+
+/* === TCA9548A I2C Configuration === */
+#define I2C_MUX_ADDR       0x70  /**< Default I2C address (A2..A0 = 0). */
+#define I2C_MUX_CHANNELS   8     /**< Number of downstream channels. */
+#define I2C_MUX_NONE       0xFF  /**< Sensor is wired directly to the upstream bus. */
+
+/**
+ * @brief TCA9548A multiplexer descriptor.
+ */
+struct i2c_mux {
+    struct i2c_dt_spec spec;  /**< I2C bus and address of the multiplexer. */
+    uint8_t channel;          /**< Currently selected channel, or @ref I2C_MUX_NONE. */
+};
+
+/**
+ * @brief Initialize the multiplexer and disconnect all downstream channels.
+ *
+ * @param mux Pointer to the multiplexer descriptor.
+ * @return 0 on success, negative errno code on failure.
+ */
+int i2c_mux_init(struct i2c_mux *mux);
+
+/**
+ * @brief Connect one downstream channel to the upstream bus.
+ *
+ * Selecting @ref I2C_MUX_NONE disconnects all channels so that sensors wired
+ * directly to the bus can be accessed without address conflicts. Selecting
+ * the channel that is already active does nothing.
+ *
+ * @param mux Pointer to the multiplexer descriptor.
+ * @param channel Channel number (0–7) or @ref I2C_MUX_NONE.
+ * @return 0 on success, negative errno code on failure.
+ */
+int i2c_mux_select(struct i2c_mux *mux, uint8_t channel);
+
+#endif /* I2C_MUX_H */
@@ -8,10 +8,35 @@
 
 #include "temp_hum.h"
 #include "i2c.h"
+#include "i2c_arbiter.h"
 #include <zephyr/kernel.h>
 #include <zephyr/sys/printk.h>
+#include <zephyr/sys/util.h>
 #include <math.h>
 
+/**
+ * @brief Typical conversion times of a resolution setting.
+ *
+ * In Hold Master mode the sensor would stretch SCL for the whole
+ * conversion, keeping every other client off the bus; measurements use No
+ * Hold Master mode instead and the bus is handed over while converting.
+ */
+struct th_timing {
+    uint8_t resolution;  /**< TH_RES_* setting. */
+    uint16_t rh_us;      /**< RH measurement (includes a temperature conversion). */
+    uint16_t temp_us;    /**< Temperature measurement. */
+};
+
+static const struct th_timing th_timings[] = {
+    { TH_RES_RH12_TEMP14, 17000, 7000 },
+    { TH_RES_RH11_TEMP11, 7300,  1500 },
+    { TH_RES_RH10_TEMP13, 7700,  4000 },
+    { TH_RES_RH8_TEMP12,  5000,  2400 },
+};
+
+/** @brief Timing of the last resolution set; every instance shares the setting. */
+static const struct th_timing *th_timing = &th_timings[0];
+
 /**
  * @brief Write a single command to the Si7021 sensor.
  *
@@ -21,7 +46,7 @@
  */
 static int temp_hum_write_cmd(const struct i2c_dt_spec *dev, uint8_t cmd)
 {
-    return i2c_write_dt(dev, &cmd, 1);
+    return i2c_write_buf(dev, &cmd, 1);
 }
 
 /**
@@ -35,7 +60,42 @@ static int temp_hum_write_cmd(const struct i2c_dt_spec *dev, uint8_t cmd)
  */
 static int temp_hum_read_data(const struct i2c_dt_spec *dev, uint8_t cmd, uint8_t *buf, size_t len)
 {
-    return i2c_write_read_dt(dev, &cmd, 1, buf, len);
+    return i2c_write_read_buf(dev, &cmd, 1, buf, len);
+}
+
+#define TH_POLL_US 1000     /**< Delay between reads while a conversion is late. */
+#define TH_POLL_RETRIES 8   /**< Reads NACKed before a measurement fails (covers the maximum conversion times). */
+
+/**
+ * @brief Run a No Hold Master measurement.
+ *
+ * Starts the conversion, waits its typical duration without holding the
+ * bus, then reads the result; the sensor NACKs the read until the
+ * conversion is complete, which is retried a few times.
+ *
+ * @param dev Pointer to a valid I2C device descriptor.
+ * @param cmd TH_MEAS_*_NOHOLD command.
+ * @param conv_us Typical conversion time.
+ * @param buf Buffer for the 2-byte result.
+ * @return 0 on success, negative errno code on failure.
+ */
+static int temp_hum_measure(const struct i2c_dt_spec *dev, uint8_t cmd, uint32_t conv_us,
+                            uint8_t buf[2])
+{
+    int ret = temp_hum_write_cmd(dev, cmd);
+    if (ret < 0) {
+        return ret;
+    }
+
+    ret = i2c_arbiter_sleep_us(conv_us);
+    for (int attempt = 0; ret == 0; attempt++) {
+        ret = i2c_read_buf(dev, buf, 2);
+        if (ret == 0 || attempt >= TH_POLL_RETRIES) {
+            break;
+        }
+        ret = i2c_arbiter_sleep_us(TH_POLL_US);
+    }
+    return ret;
 }
 
 /**
@@ -65,11 +125,8 @@ int temp_hum_init(const struct i2c_dt_spec *dev, uint8_t resolution)
 
     k_msleep(50);
 
-    // Write resolution to user register
-    uint8_t write_buf[2] = { TH_WRITE_USER_REG, resolution };
-    ret = i2c_write_dt(dev, write_buf, sizeof(write_buf)); 
+    ret = temp_hum_set_resolution(dev, resolution);
     if (ret < 0) {
-        printk("[TEMP_HUM] - Failed to write user register (%d)\n", ret);
         return ret;
     }
 
@@ -78,11 +135,53 @@ int temp_hum_init(const struct i2c_dt_spec *dev, uint8_t resolution)
     return 0;
 }
 
+/**
+ * @brief Change the measurement resolution.
+ *
+ * Reads User Register 1 and rewrites it with the new resolution bits.
+ *
+ * @param dev Pointer to a valid I2C device descriptor.
+ * @param resolution One of the TH_RES_* settings.
+ * @return 0 on success, negative errno code on failure.
+ */
+int temp_hum_set_resolution(const struct i2c_dt_spec *dev, uint8_t resolution)
+{
+    const struct th_timing *timing = NULL;
+
+    for (size_t i = 0; i < ARRAY_SIZE(th_timings); i++) {
+        if (th_timings[i].resolution == resolution) {
+            timing = &th_timings[i];
+            break;
+        }
+    }
+    if (timing == NULL) {
+        return -EINVAL;
+    }
+
+    uint8_t user_reg;
+    int ret = temp_hum_read_data(dev, TH_READ_USER_REG, &user_reg, 1);
+    if (ret < 0) {
+        printk("[TEMP_HUM] - Failed to read user register (%d)\n", ret);
+        return ret;
+    }
+
+    uint8_t write_buf[2] = { TH_WRITE_USER_REG, (user_reg & ~TH_RES_MASK) | resolution };
+    ret = i2c_write_buf(dev, write_buf, sizeof(write_buf));
+    if (ret < 0) {
+        printk("[TEMP_HUM] - Failed to write user register (%d)\n", ret);
+        return ret;
+    }
+
+    th_timing = timing;
+    return 0;
+}
+
 /**
  * @brief Read relative humidity from the temp_hum sensor.
  *
- * Uses the Hold Master mode to measure humidity and converts the raw value
- * to %RH using the formula from the datasheet.
+ * Uses the No Hold Master mode to measure humidity (the bus is free while
+ * the sensor converts) and converts the raw value to %RH using the formula
+ * from the datasheet.
  *
  * @param dev Pointer to a valid I2C device descriptor.
  * @param humidity Pointer to float variable to store relative humidity (%RH).
@@ -91,7 +190,7 @@ int temp_hum_init(const struct i2c_dt_spec *dev, uint8_t resolution)
 int temp_hum_read_humidity(const struct i2c_dt_spec *dev, float *humidity)
 {
     uint8_t buf[2];
-    int ret = temp_hum_read_data(dev, TH_MEAS_RH_HOLD, buf, sizeof(buf));
+    int ret = temp_hum_measure(dev, TH_MEAS_RH_NOHOLD, th_timing->rh_us, buf);
     if (ret < 0) {
         printk("[TEMP_HUM] - Failed to read humidity (%d)\n", ret);
         return ret;
@@ -110,7 +209,7 @@ int temp_hum_read_humidity(const struct i2c_dt_spec *dev, float *humidity)
 /**
  * @brief Read temperature from the temp_hum sensor in degrees Celsius.
  *
- * Uses the Hold Master mode to measure temperature and converts the raw
+ * Uses the No Hold Master mode to measure temperature and converts the raw
  * value to °C using the formula from the datasheet.
  *
  * @param dev Pointer to a valid I2C device descriptor.
@@ -120,7 +219,7 @@ int temp_hum_read_humidity(const struct i2c_dt_spec *dev, float *humidity)
 int temp_hum_read_temperature(const struct i2c_dt_spec *dev, float *temperature)
 {
     uint8_t buf[2];
-    int ret = temp_hum_read_data(dev, TH_MEAS_TEMP_HOLD, buf, sizeof(buf));
+    int ret = temp_hum_measure(dev, TH_MEAS_TEMP_NOHOLD, th_timing->temp_us, buf);
     if (ret < 0) {
         printk("[TEMP_HUM] - Failed to read temperature (%d)\n", ret);
         return ret;
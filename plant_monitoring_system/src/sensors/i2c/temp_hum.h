@@ -21,6 +21,8 @@
 #define TH_READ_USER_REG       0xE7  /**< Read User Register 1 */
 #define TH_MEAS_RH_HOLD        0xE5  /**< Measure Relative Humidity, Hold Master mode */
 #define TH_MEAS_TEMP_HOLD      0xE3  /**< Measure Temperature, Hold Master mode */
+#define TH_MEAS_RH_NOHOLD      0xF5  /**< Measure Relative Humidity, No Hold Master mode */
+#define TH_MEAS_TEMP_NOHOLD    0xF3  /**< Measure Temperature, No Hold Master mode */
 #define TH_READ_TEMP_FROM_RH   0xE0  /**< Read Temperature from previous RH measurement */
 #define TH_RESET               0xFE  /**< Soft reset command */
 
@@ -28,6 +30,7 @@
 #define TH_RES_RH8_TEMP12    0x01  /**< RH:8-bit,  Temp:12-bit */
 #define TH_RES_RH10_TEMP13   0x80  /**< RH:10-bit, Temp:13-bit */
 #define TH_RES_RH11_TEMP11   0x81  /**< RH:11-bit, Temp:11-bit */
+#define TH_RES_MASK          0x81  /**< Resolution bits of User Register 1 */
 
 /* === Function Prototypes === */
 
@@ -42,6 +45,17 @@
  */
 int temp_hum_init(const struct i2c_dt_spec *dev, uint8_t resolution);
 
+/**
+ * @brief Change the measurement resolution.
+ * Updates the resolution bits of User Register 1, keeping the others. Lower
+ * resolutions convert faster: RH 12-bit / temperature 14-bit takes about
+ * 17 ms, RH 8-bit / temperature 12-bit about 5 ms.
+ * @param dev Pointer to a valid I2C device descriptor.
+ * @param resolution One of the TH_RES_* settings.
+ * @return 0 on success, -EINVAL for an unknown setting, negative errno code on I2C failure.
+ */
+int temp_hum_set_resolution(const struct i2c_dt_spec *dev, uint8_t resolution);
+
 /**
  * @brief Read temperature in degrees Celsius from the sensor.
  *
@@ -8,7 +8,9 @@
  */
 
 #include "board_led.h"
+#include "power/energy.h"
 #include <zephyr/sys/printk.h>
+#include <zephyr/sys/util.h>
 
 /**
  * @brief Initializes all GPIO pins used by the LED.
@@ -38,6 +40,12 @@ int led_init(struct bus_led *led) {
         }
     }
 
+    int ret = gpio_bus_init(&led->bus, led->pins, led->pin_count);
+    if (ret != 0) {
+        printk("[LED] - Too many pins (%d)\n", (int)led->pin_count);
+        return ret;
+    }
+
     printk("[LED] - BOARD LEDs initialized successfully\n");
     return 0;
 }
@@ -55,20 +63,22 @@ int led_init(struct bus_led *led) {
  * - `0x3` → Red + Green ON (Yellow)
  * - `0x7` → All ON (White)
  *
+ * All channels change in a single masked write per GPIO port (see
+ * @ref gpio_bus_write), so no intermediate color is ever shown.
+ *
  * @param led Pointer to the LED descriptor structure.
  * @param value Bitmask (0–7) controlling the color combination.
  * @retval 0 If the operation succeeded.
  * @retval -EIO If a GPIO write failed.
  */
 int led_write(struct bus_led *led, int value) {
-    for (size_t i = 0; i < led->pin_count; i++) {
-        int pin_value = (value >> i) & 0x1;
-        int ret = gpio_pin_set_dt(&led->pins[i], pin_value);
-        if (ret != 0) {
-            printk("Error: Failed to set pin %d (code %d)\n", i, ret);
-            return ret;
-        }
+    uint32_t on = (uint32_t)value & (BIT(led->pin_count) - 1);
+    int ret = gpio_bus_write(&led->bus, on);
+    if (ret != 0) {
+        printk("Error: Failed to set pins (code %d)\n", ret);
+        return ret;
     }
+    energy_set_level(ENERGY_BOARD_LED, (uint8_t)POPCOUNT(on));
     return 0;
 }
 
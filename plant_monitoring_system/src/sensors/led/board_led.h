@@ -13,6 +13,7 @@
 
 #include <zephyr/drivers/gpio.h>
 #include <zephyr/kernel.h>
+#include "gpio_bus.h"
 
 /** @brief Number of GPIO pins used to control an RGB LED (R, G, B). */
 #define BUS_SIZE 3
@@ -26,6 +27,7 @@
 struct bus_led {
     struct gpio_dt_spec pins[BUS_SIZE];  /**< GPIO pin specifications for R, G, and B. */
     size_t pin_count;                    /**< Number of active pins (typically 3 for RGB). */
+    struct gpio_bus bus;                 /**< Port writes, set up by the init function. */
 };
 
 /**
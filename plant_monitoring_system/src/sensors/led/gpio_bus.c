@@ -0,0 +1,63 @@
+/**
+ * @file gpio_bus.c
+ * @brief Port grouping and masked writes for GPIO buses.
+ */
+
+#include "gpio_bus.h"
+#include <zephyr/sys/util.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <string.h>
+
+int gpio_bus_init(struct gpio_bus *bus, const struct gpio_dt_spec *pins, size_t pin_count)
+{
+    if (pin_count > GPIO_BUS_MAX_PINS) {
+        return -EINVAL;
+    }
+
+    memset(bus, 0, sizeof(*bus));
+
+    for (size_t i = 0; i < pin_count; i++) {
+        struct gpio_bus_port *p = NULL;
+
+        for (size_t j = 0; j < bus->port_count; j++) {
+            if (bus->ports[j].port == pins[i].port) {
+                p = &bus->ports[j];
+                break;
+            }
+        }
+        if (p == NULL) {
+            p = &bus->ports[bus->port_count++];
+            p->port = pins[i].port;
+        }
+
+        gpio_port_pins_t bit = BIT(pins[i].pin);
+        bool active_low = (pins[i].dt_flags & GPIO_ACTIVE_LOW) != 0;
+
+        p->mask |= bit;
+        for (uint32_t v = 0; v < GPIO_BUS_PATTERNS; v++) {
+            bool on = (v >> i) & 0x1;
+
+            if (on != active_low) {
+                p->values[v] |= bit;
+            }
+        }
+    }
+
+    return 0;
+}
+
+int gpio_bus_write(const struct gpio_bus *bus, uint32_t value)
+{
+    value &= GPIO_BUS_PATTERNS - 1;
+
+    for (size_t i = 0; i < bus->port_count; i++) {
+        const struct gpio_bus_port *p = &bus->ports[i];
+        int ret = gpio_port_set_masked_raw(p->port, p->mask, p->values[value]);
+
+        if (ret != 0) {
+            return ret;
+        }
+    }
+    return 0;
+}
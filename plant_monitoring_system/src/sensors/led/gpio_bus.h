@@ -0,0 +1,63 @@
+/**
+ * @file gpio_bus.h
+ * @brief Glitch-free writes to a small group of GPIO output pins.
+ *
+ * The pins of a bus are grouped by GPIO port once, at initialization, and
+ * the raw port value of every bit pattern is precomputed (active-low pins
+ * included). A write is then one @ref gpio_port_set_masked_raw call per
+ * port, so pins sharing a port change together, with no transient
+ * combination and a single driver call instead of one per pin.
+ */
+
+#ifndef GPIO_BUS_H
+#define GPIO_BUS_H
+
+#include <zephyr/drivers/gpio.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define GPIO_BUS_MAX_PINS 3                         /**< Pins per bus. */
+#define GPIO_BUS_PATTERNS (1U << GPIO_BUS_MAX_PINS)  /**< Bit patterns a bus can show. */
+
+/**
+ * @brief Pins of a bus that belong to one GPIO port.
+ */
+struct gpio_bus_port {
+    const struct device *port;                      /**< GPIO controller. */
+    gpio_port_pins_t mask;                          /**< Bus pins on this port. */
+    gpio_port_value_t values[GPIO_BUS_PATTERNS];    /**< Raw port value for each bit pattern. */
+};
+
+/**
+ * @brief Precomputed port writes of a bus.
+ */
+struct gpio_bus {
+    struct gpio_bus_port ports[GPIO_BUS_MAX_PINS];  /**< One entry per distinct port. */
+    size_t port_count;                              /**< Entries in use. */
+};
+
+/**
+ * @brief Group bus pins by port and precompute the value of each pattern.
+ *
+ * Bit @c i of a pattern drives @p pins[i]; a set bit means active, so an
+ * active-low pin is driven low.
+ *
+ * @param bus Output bus.
+ * @param pins Pin specifications, in bit order.
+ * @param pin_count Number of pins (≤ @ref GPIO_BUS_MAX_PINS).
+ * @retval 0 On success.
+ * @retval -EINVAL If there are too many pins.
+ */
+int gpio_bus_init(struct gpio_bus *bus, const struct gpio_dt_spec *pins, size_t pin_count);
+
+/**
+ * @brief Drive the bus to a bit pattern. ISR-safe.
+ *
+ * @param bus Bus set up with @ref gpio_bus_init.
+ * @param value Bit pattern; bits beyond the bus width are ignored.
+ * @retval 0 On success.
+ * @retval <0 Error from @ref gpio_port_set_masked_raw.
+ */
+int gpio_bus_write(const struct gpio_bus *bus, uint32_t value);
+
+#endif /* GPIO_BUS_H */
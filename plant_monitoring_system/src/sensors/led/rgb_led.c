@@ -8,7 +8,9 @@
  */
 
 #include "rgb_led.h"
+#include "power/energy.h"
 #include <zephyr/sys/printk.h>
+#include <zephyr/sys/util.h>
 
 /**
  * @brief Initialize all GPIO pins used by the RGB LED.
@@ -37,6 +39,12 @@ int rgb_led_init(struct bus_rgb_led *rgb_led) {
         }
     }
 
+    int ret = gpio_bus_init(&rgb_led->bus, rgb_led->pins, rgb_led->pin_count);
+    if (ret != 0) {
+        printk("[RGB LED] - Too many pins (%d)\n", (int)rgb_led->pin_count);
+        return ret;
+    }
+
     printk("[RGB LED] - RGB LED initialized successfully\n");
     return 0;
 }
@@ -54,20 +62,22 @@ int rgb_led_init(struct bus_rgb_led *rgb_led) {
  * - `0x3` → Yellow (Red + Green)
  * - `0x7` → White (all channels ON)
  *
+ * All channels change in a single masked write per GPIO port (see
+ * @ref gpio_bus_write), so no intermediate color is ever shown.
+ *
  * @param rgb_led Pointer to the RGB LED descriptor structure.
  * @param value Bitmask (0–7) controlling the color combination.
  * @retval 0 If the operation succeeded.
  * @retval -EIO If a GPIO write failed.
  */
 int rgb_led_write(struct bus_rgb_led *rgb_led, int value) {
-    for (size_t i = 0; i < rgb_led->pin_count; i++) {
-        int pin_value = (value >> i) & 0x1;
-        int ret = gpio_pin_set_dt(&rgb_led->pins[i], pin_value);
-        if (ret != 0) {
-            printk("Error: Failed to set pin %d (code %d)\n", i, ret);
-            return ret;
-        }
+    uint32_t on = (uint32_t)value & (BIT(rgb_led->pin_count) - 1);
+    int ret = gpio_bus_write(&rgb_led->bus, on);
+    if (ret != 0) {
+        printk("Error: Failed to set pins (code %d)\n", ret);
+        return ret;
     }
+    energy_set_level(ENERGY_RGB_LED, (uint8_t)POPCOUNT(on));
     return 0;
 }
 
@@ -170,7 +180,5 @@ int rgb_black(struct bus_rgb_led *rgb_led) { return rgb_led_write(rgb_led, 0x0);
  */
 void rgb_led_pwm_step(struct bus_rgb_led *rgb_led, int r_value, int g_value, int b_value)
 {
-    gpio_pin_set_dt(&rgb_led->pins[0], r_value);
-    gpio_pin_set_dt(&rgb_led->pins[1], g_value);
-    gpio_pin_set_dt(&rgb_led->pins[2], b_value);
+    rgb_led_write(rgb_led, (r_value ? 0x1 : 0) | (g_value ? 0x2 : 0) | (b_value ? 0x4 : 0));
 }
\ No newline at end of file
@@ -4,21 +4,42 @@
  *
  * This module defines the Zephyr thread responsible for periodically
  * acquiring data from multiple environmental sensors:
- * - **ADC sensors:** ambient brightness and soil moisture
+ * - **ADC sensors:** ambient brightness and one or more soil moisture probes,
+ *   converted together in a single scan-mode ADC sequence
  * - **I2C sensors:** accelerometer, temperature/humidity, and color sensor
+ *   instances, optionally behind a TCA9548A multiplexer
  *
- * The thread’s activity depends on the current system mode:
- * - In @ref TEST_MODE or @ref NORMAL_MODE, periodic sampling is active.
- * - In @ref ADVANCED_MODE, the thread remains idle until reactivated.
+ * I2C sensors are visited grouped by multiplexer channel so that each channel
+ * is selected at most once per cycle. Each instance is read in its own bus
+ * transaction (@ref i2c_arbiter.h), so more urgent clients get the bus
+ * between two instances, and while a sensor integrates or converts.
+ *
+ * Cycles are requested through @ref sensor_cache.h, which tells the thread
+ * which groups of sensors are stale; the others are left alone, their
+ * multiplexer channels included.
+ *
+ * The color sensors are the most expensive read of the cycle (one
+ * integration of up to 700 ms, sensor powered). Outside TEST_MODE they
+ * sleep between readings and are only read when @ref light_fusion.h asks
+ * for it; in between, the primary clear count is estimated from the
+ * phototransistor and its RGB channels follow at the last chromaticity.
+ *
+ * The thread is idle until a consumer asks for values older than it accepts.
  */
 
 #include "sensors_thread.h"
+#include "sensor_cache.h"
 #include "sensors/adc/adc.h"
 #include "sensors/i2c/accel.h"
 #include "sensors/i2c/temp_hum.h"
 #include "sensors/i2c/color.h"
+#include "sensors/i2c/i2c_mux.h"
+#include "sensors/i2c/i2c_arbiter.h"
+#include "analysis/light_fusion.h"
+#include "power/energy.h"
 #include <zephyr/kernel.h>
 #include <zephyr/sys/printk.h>
+#include <errno.h>
 
 /* --- Thread configuration --------------------------------------------------- */
 #define SENSORS_THREAD_STACK_SIZE 1024  /**< Stack size allocated for the sensors thread. */
@@ -26,30 +47,71 @@
 
 K_THREAD_STACK_DEFINE(sensors_stack, SENSORS_THREAD_STACK_SIZE); /**< Thread stack for sensors task. */
 static struct k_thread sensors_thread_data;                      /**< Thread control block for sensors. */
+static struct i2c_client sensors_i2c = I2C_CLIENT_INIT("sensors", SENSORS_THREAD_PRIORITY); /**< Bus client of the thread. */
+
+static bool color_awake[MAX_SENSOR_INSTANCES];  /**< Color sensor instances powered and integrating. */
+static uint8_t colors_on;                       /**< Number of @c color_awake instances. */
+static ColorSensorData color_ref;               /**< Last reading of the primary color sensor (rescaled). */
+static bool color_fresh;                        /**< The primary color sensor was read this cycle. */
 
 /* ---------------------------------------------------------------------------
  * Helper functions
  * ---------------------------------------------------------------------------*/
 
 /**
- * @brief Read an ADC sensor and store its value as a scaled percentage.
- *
- * Converts a raw ADC reading to a percentage (×10 for one decimal precision).
+ * @brief Convert an ADC voltage to a scaled percentage.
  *
  * @param cfg Pointer to the ADC configuration structure.
- * @param target Pointer to the atomic variable where the scaled value will be stored.
- * @param label Descriptive name of the sensor (for logging).
- * @param mv Pointer to store the measured voltage (in millivolts).
+ * @param mv Measured voltage (in millivolts).
+ * @return Percentage of the reference voltage ×10 (one decimal precision).
+ */
+static int32_t adc_percentage(const struct adc_config *cfg, int32_t mv)
+{
+    return (mv * 1000) / cfg->vref_mv;
+}
+
+/**
+ * @brief Read the phototransistor and all soil probes in one ADC scan.
+ *
+ * Brightness and per-probe moisture are stored as scaled percentages (×10).
+ * The aggregate moisture value is the mean of all probes.
+ *
+ * @param ctx Pointer to the shared @ref system_context structure.
+ * @param measure Pointer to the shared @ref system_measurement structure.
+ * @return 0 on success, negative errno code if the scan failed.
  */
-static void read_adc_percentage(const struct adc_config *cfg, atomic_t *target,
-                                const char *label, int32_t *mv)
+static int read_adc_sensors(const struct system_context *ctx,
+                            struct system_measurement *measure)
 {
-    if (adc_read_voltage(cfg, mv) == 0) {
-        int32_t percent10 = ((*mv) * 1000) / cfg->vref_mv; /**< Scaled percentage ×10. */
-        atomic_set(target, percent10);
-    } else {
-        printk("[ADC]: %s read error\n", label);
+    const struct adc_config *cfgs[1 + MAX_SOIL_PROBES];
+    int32_t mv[1 + MAX_SOIL_PROBES];
+    size_t probes = MIN(ctx->soil_probe_count, (size_t)MAX_SOIL_PROBES);
+
+    cfgs[0] = ctx->phototransistor;
+    for (size_t i = 0; i < probes; i++) {
+        cfgs[1 + i] = &ctx->soil_probes[i];
+    }
+
+    int ret = adc_read_scan(cfgs, 1 + probes, ctx->adc_oversampling, mv);
+    if (ret != 0) {
+        printk("[ADC]: Scan read error\n");
+        return ret;
     }
+
+    atomic_set(&measure->brightness, adc_percentage(cfgs[0], mv[0]));
+
+    if (probes == 0) {
+        return 0;
+    }
+
+    int32_t sum = 0;
+    for (size_t i = 0; i < probes; i++) {
+        int32_t percent10 = adc_percentage(cfgs[1 + i], mv[1 + i]);
+        atomic_set(&measure->moisture_probe[i], percent10);
+        sum += percent10;
+    }
+    atomic_set(&measure->moisture, sum / (int32_t)probes);
+    return 0;
 }
 
 /**
@@ -62,8 +124,9 @@ static void read_adc_percentage(const struct adc_config *cfg, atomic_t *target,
  * @param x_ms2 Pointer to atomic variable for X-axis acceleration.
  * @param y_ms2 Pointer to atomic variable for Y-axis acceleration.
  * @param z_ms2 Pointer to atomic variable for Z-axis acceleration.
+ * @return 0 on success, -EIO on a read error.
  */
-static void read_accelerometer(const struct i2c_dt_spec *dev, uint8_t range,
+static int read_accelerometer(const struct i2c_dt_spec *dev, uint8_t range,
                                atomic_t *x_ms2, atomic_t *y_ms2, atomic_t *z_ms2) {
     int16_t x_raw, y_raw, z_raw;
     float x_val, y_val, z_val;
@@ -76,9 +139,11 @@ static void read_accelerometer(const struct i2c_dt_spec *dev, uint8_t range,
         atomic_set(x_ms2, (int32_t)(x_val * 100));
         atomic_set(y_ms2, (int32_t)(y_val * 100));
         atomic_set(z_ms2, (int32_t)(z_val * 100));
-    } else {
-        printk("[ACCELEROMETER] - Error reading accelerometer\n");
+        return 0;
     }
+
+    printk("[ACCELEROMETER] - Error reading accelerometer\n");
+    return -EIO;
 }
 
 /**
@@ -90,8 +155,9 @@ static void read_accelerometer(const struct i2c_dt_spec *dev, uint8_t range,
  * @param dev Pointer to the temperature/humidity I2C device specification.
  * @param temp Pointer to atomic variable for temperature (°C ×100).
  * @param hum Pointer to atomic variable for relative humidity (%RH ×100).
+ * @return 0 on success, -EIO on a read error.
  */
-static void read_temperature_humidity(const struct i2c_dt_spec *dev,
+static int read_temperature_humidity(const struct i2c_dt_spec *dev,
                                       atomic_t *temp, atomic_t *hum) {
 
     float humidity;
@@ -100,46 +166,233 @@ static void read_temperature_humidity(const struct i2c_dt_spec *dev,
         float temperature;  // ahora solo existe dentro del bloque if
 
         uint8_t buf[2];
-        int ret = i2c_write_read_dt(dev, (uint8_t[]){ TH_READ_TEMP_FROM_RH }, 1, buf, 2);
+        int ret = i2c_write_read_buf(dev, (uint8_t[]){ TH_READ_TEMP_FROM_RH }, 1, buf, 2);
         if (ret == 0) {
             uint16_t raw_temp = ((uint16_t)buf[0] << 8) | buf[1];
             temperature = ((175.72f * raw_temp) / 65536.0f) - 46.85f;
         } else {
             printk("[TEMP_HUM SENSOR] - Error reading temperature from RH (%d)\n", ret);
-            return;
+            return -EIO;
         }
 
         atomic_set(hum,  (int32_t)(humidity * 100));
         atomic_set(temp, (int32_t)(temperature * 100));
-
-    } else {
-        printk("[TEMP_HUM SENSOR] - Read error (humidity)\n");
+        return 0;
     }
+
+    printk("[TEMP_HUM SENSOR] - Read error (humidity)\n");
+    return -EIO;
 }
 
 
 /**
  * @brief Read RGB color sensor and update measurement structure.
  *
- * Reads raw RGB and clear channel values from the color sensor and updates
- * the shared measurement structure atomically.
+ * Reads raw RGB and clear channel values from the color sensor, rescales
+ * them to the reference gain and integration time, and updates the shared
+ * measurement structure atomically.
+ *
+ * Instance 0 also updates the primary color fields used by the analysis code.
  *
+ * @param ctx Pointer to the shared @ref system_context structure.
  * @param dev Pointer to the color sensor I2C device specification.
+ * @param instance Sensor instance index.
  * @param measure Pointer to the shared @ref system_measurement structure.
+ * @return 0 on success, -EIO on a read error.
  */
-static void read_color_sensor(const struct i2c_dt_spec *dev, struct system_measurement *measure) {
+static int read_color_sensor(const struct system_context *ctx,
+                              const struct i2c_dt_spec *dev, uint8_t instance,
+                              struct system_measurement *measure) {
     ColorSensorData color_data;
 
     if (color_read_rgb(dev, &color_data) == 0) {
-        atomic_set(&measure->red,   color_data.red);
-        atomic_set(&measure->green, color_data.green);
-        atomic_set(&measure->blue,  color_data.blue);
-        atomic_set(&measure->clear, color_data.clear);
-    } else {
-        printk("[COLOR SENSOR] - Read error\n");
+        color_data.red   = color_rescale(color_data.red, ctx->color_gain, ctx->color_atime);
+        color_data.green = color_rescale(color_data.green, ctx->color_gain, ctx->color_atime);
+        color_data.blue  = color_rescale(color_data.blue, ctx->color_gain, ctx->color_atime);
+        color_data.clear = color_rescale(color_data.clear, ctx->color_gain, ctx->color_atime);
+
+        atomic_set(&measure->red_inst[instance],   color_data.red);
+        atomic_set(&measure->green_inst[instance], color_data.green);
+        atomic_set(&measure->blue_inst[instance],  color_data.blue);
+        atomic_set(&measure->clear_inst[instance], color_data.clear);
+
+        if (instance == 0) {
+            atomic_set(&measure->red,   color_data.red);
+            atomic_set(&measure->green, color_data.green);
+            atomic_set(&measure->blue,  color_data.blue);
+            atomic_set(&measure->clear, color_data.clear);
+            color_ref = color_data;
+            color_fresh = true;
+        }
+        return 0;
+    }
+
+    printk("[COLOR SENSOR] - Read error (instance %d)\n", instance);
+    return -EIO;
+}
+
+/**
+ * @brief Power a color sensor instance up or down, if not already.
+ *
+ * A woken sensor only has valid counts after one full integration, so
+ * waking blocks for the integration time of the current profile.
+ *
+ * @param ctx Pointer to the shared @ref system_context structure.
+ * @param dev Pointer to the color sensor I2C device specification.
+ * @param instance Sensor instance index.
+ * @param on True to wake the sensor, false to put it to sleep.
+ */
+static void color_power(const struct system_context *ctx,
+                        const struct i2c_dt_spec *dev, uint8_t instance, bool on)
+{
+    if (color_awake[instance] == on) {
+        return;
+    }
+
+    int ret = on ? color_wake_up(dev) : color_sleep(dev);
+    if (ret < 0) {
+        printk("[COLOR SENSOR] - Power %s failed (instance %d)\n", on ? "up" : "down", instance);
+        return;
+    }
+
+    color_awake[instance] = on;
+    colors_on += on ? 1 : -1;
+    energy_set_level(ENERGY_COLOR, colors_on);
+    if (on) {
+        i2c_arbiter_sleep_us(color_integration_us(ctx->color_atime));
+    }
+}
+
+/**
+ * @brief Serve the primary color fields from the phototransistor.
+ *
+ * The clear count is estimated by the light fusion and the RGB channels of
+ * the last reading are scaled by the same factor, keeping its chromaticity.
+ *
+ * @param lf Calibrated light fusion.
+ * @param brightness Brightness measured this cycle (% × 10).
+ * @param measure Pointer to the shared @ref system_measurement structure.
+ */
+static void estimate_color(struct light_fusion *lf, int32_t brightness,
+                           struct system_measurement *measure)
+{
+    uint32_t clear = light_fusion_estimate(lf, brightness);
+    uint32_t ref = MAX(color_ref.clear, 1U);
+
+    atomic_set(&measure->clear, clear);
+    atomic_set(&measure->red,   MIN(color_ref.red * clear / ref, UINT16_MAX));
+    atomic_set(&measure->green, MIN(color_ref.green * clear / ref, UINT16_MAX));
+    atomic_set(&measure->blue,  MIN(color_ref.blue * clear / ref, UINT16_MAX));
+}
+
+/**
+ * @brief Cache group of a slot, 0 for unknown sensor types.
+ */
+static uint32_t slot_group(const struct i2c_sensor_slot *slot)
+{
+    switch (slot->type) {
+    case SENSOR_ACCEL:
+        return SENSOR_GROUP_ACCEL;
+    case SENSOR_TEMP_HUM:
+        return SENSOR_GROUP_TEMP_HUM;
+    case SENSOR_COLOR:
+        return SENSOR_GROUP_COLOR;
+    default:
+        return 0;
     }
 }
 
+/**
+ * @brief Sort key of a slot: direct-bus sensors first, then by mux channel.
+ */
+static int slot_key(const struct i2c_sensor_slot *slot)
+{
+    return (slot->mux_channel == I2C_MUX_NONE) ? -1 : slot->mux_channel;
+}
+
+/**
+ * @brief Build the I2C visiting order grouped by multiplexer channel.
+ *
+ * Stable insertion sort over slot indices, so instances on the same channel
+ * keep their table order.
+ *
+ * @param ctx Pointer to the shared @ref system_context structure.
+ * @param order Output array of slot indices (at least @ref MAX_I2C_SENSORS).
+ * @return Number of slots in @p order.
+ */
+static size_t build_i2c_order(const struct system_context *ctx, uint8_t *order)
+{
+    size_t n = MIN(ctx->i2c_sensor_count, (size_t)MAX_I2C_SENSORS);
+
+    for (size_t i = 0; i < n; i++) {
+        size_t j = i;
+        while (j > 0 && slot_key(&ctx->i2c_sensors[order[j - 1]]) >
+                        slot_key(&ctx->i2c_sensors[i])) {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = (uint8_t)i;
+    }
+
+    return n;
+}
+
+/**
+ * @brief Read one I2C sensor instance into the measurement structure.
+ *
+ * Color sensors are only read when @p color_due; otherwise they are put
+ * to sleep, unless the profile reads them every cycle.
+ *
+ * @param ctx Pointer to the shared @ref system_context structure.
+ * @param slot Sensor slot to read.
+ * @param color_due Whether the color sensors are read this cycle.
+ * @param measure Pointer to the shared @ref system_measurement structure.
+ * @return 0 on success (or nothing to read), negative errno code on a read error.
+ */
+static int read_i2c_slot(const struct system_context *ctx,
+                         const struct i2c_sensor_slot *slot, bool color_due,
+                         struct system_measurement *measure)
+{
+    int ret = 0;
+
+    if (slot->instance >= MAX_SENSOR_INSTANCES) {
+        return 0;
+    }
+
+    switch (slot->type) {
+    case SENSOR_ACCEL:
+        /* Tilt is tracked for the primary accelerometer only. */
+        if (slot->instance == 0) {
+            ret = read_accelerometer(&slot->spec, ctx->accel_range,
+                                     &measure->accel_x_g, &measure->accel_y_g, &measure->accel_z_g);
+        }
+        break;
+    case SENSOR_TEMP_HUM:
+        ret = read_temperature_humidity(&slot->spec, &measure->temp_inst[slot->instance],
+                                        &measure->hum_inst[slot->instance]);
+        if (ret == 0 && slot->instance == 0) {
+            atomic_set(&measure->temp, atomic_get(&measure->temp_inst[0]));
+            atomic_set(&measure->hum,  atomic_get(&measure->hum_inst[0]));
+        }
+        break;
+    case SENSOR_COLOR:
+        if (!color_due) {
+            color_power(ctx, &slot->spec, slot->instance, false);
+            break;
+        }
+        color_power(ctx, &slot->spec, slot->instance, true);
+        ret = read_color_sensor(ctx, &slot->spec, slot->instance, measure);
+        if (ctx->color_refresh_ms != 0) {
+            color_power(ctx, &slot->spec, slot->instance, false);
+        }
+        break;
+    default:
+        break;
+    }
+
+    return ret;
+}
+
 /* ---------------------------------------------------------------------------
  * Sensors thread
  * ---------------------------------------------------------------------------*/
@@ -147,9 +400,9 @@ static void read_color_sensor(const struct i2c_dt_spec *dev, struct system_measu
 /**
  * @brief Main function for the sensors measurement thread.
  *
- * This thread continuously monitors the system mode and performs ADC and I2C
- * sensor readings when appropriate. The results are stored in the shared
- * @ref system_measurement structure.
+ * Waits for a refresh requested through the sensor cache, reads the
+ * requested groups into the shared @ref system_measurement structure and
+ * reports which of them were read.
  *
  * @param arg1 Pointer to the shared @ref system_context structure.
  * @param arg2 Pointer to the shared @ref system_measurement structure.
@@ -159,19 +412,63 @@ static void sensors_thread_fn(void *arg1, void *arg2, void *arg3) {
     struct system_context *ctx = (struct system_context *)arg1;
     struct system_measurement *measure = (struct system_measurement *)arg2;
 
-    int32_t mv = 0;
+    uint8_t order[MAX_I2C_SENSORS];
+    size_t slots = build_i2c_order(ctx, order);
+
+    /* color_init() left every color sensor converting */
+    for (size_t i = 0; i < slots; i++) {
+        const struct i2c_sensor_slot *slot = &ctx->i2c_sensors[i];
+
+        if (slot->type == SENSOR_COLOR && slot->instance < MAX_SENSOR_INSTANCES) {
+            color_awake[slot->instance] = true;
+            colors_on++;
+        }
+    }
+    energy_set_level(ENERGY_COLOR, colors_on);
 
     while (1) {
-        k_sem_take(ctx->sensors_sem, K_FOREVER);
+        /* Color requests always include the ADC group */
+        uint32_t groups = sensor_cache_next_refresh();
+        uint32_t failed = 0;
 
-        read_adc_percentage(ctx->phototransistor, &measure->brightness, "Brightness", &mv);
-        read_adc_percentage(ctx->soil_moisture, &measure->moisture, "Moisture", &mv);
-        read_accelerometer(ctx->accelerometer, ctx->accel_range,
-                                   &measure->accel_x_g, &measure->accel_y_g, &measure->accel_z_g);
-        read_temperature_humidity(ctx->temp_hum, &measure->temp, &measure->hum);
-        read_color_sensor(ctx->color, measure);
+        if ((groups & SENSOR_GROUP_ADC) && read_adc_sensors(ctx, measure) != 0) {
+            failed |= SENSOR_GROUP_ADC;
+        }
+
+        bool adc_ok = !(failed & SENSOR_GROUP_ADC);
+        int32_t brightness = atomic_get(&measure->brightness);
+        uint32_t now = k_uptime_get_32();
+        bool color_due = !adc_ok ||
+                         light_fusion_need_color(ctx->light_fusion, brightness, now,
+                                                 ctx->color_refresh_ms);
+
+        color_fresh = false;
+        for (size_t i = 0; i < slots; i++) {
+            const struct i2c_sensor_slot *slot = &ctx->i2c_sensors[order[i]];
+            uint32_t group = slot_group(slot);
+
+            if (!(groups & group)) {
+                continue;
+            }
+            if (i2c_arbiter_acquire(&sensors_i2c, slot->mux_channel, K_FOREVER) != 0) {
+                failed |= group;
+                continue;
+            }
+            if (read_i2c_slot(ctx, slot, color_due, measure) != 0) {
+                failed |= group;
+            }
+            i2c_arbiter_release(&sensors_i2c);
+        }
+
+        if (groups & SENSOR_GROUP_COLOR) {
+            if (color_fresh && adc_ok) {
+                light_fusion_update(ctx->light_fusion, brightness, color_ref.clear, now);
+            } else if (!color_due) {
+                estimate_color(ctx->light_fusion, brightness, measure);
+            }
+        }
 
-        k_sem_give(ctx->main_sensors_sem);
+        sensor_cache_complete(groups & ~failed, groups & failed);
     }
 }
 
@@ -10,9 +10,9 @@
  *  - Temperature & humidity (I²C)
  *  - Color sensor (I²C)
  *
- * The thread is active in @ref TEST_MODE and @ref NORMAL_MODE and performs
- * periodic sampling. In other modes (e.g., @ref ADVANCED_MODE) the thread
- * suspends sampling and waits to be re-triggered.
+ * The thread reads sensors on demand: consumers ask for values through
+ * @ref sensor_cache.h, which runs one refresh of the stale groups for all
+ * of them.
  */
 
 #ifndef SENSORS_THREAD_H
@@ -23,14 +23,9 @@
 /**
  * @brief Start the sensors measurement thread.
  *
- * Initializes synchronization primitives (timer, semaphores) and launches a
- * dedicated Zephyr thread that periodically samples sensors and stores the
- * results into the provided @ref system_measurement structure.
- *
- * The sampling cadence depends on the system mode:
- *  - @ref TEST_MODE: faster cadence for rapid feedback.
- *  - @ref NORMAL_MODE: regular cadence for ongoing monitoring.
- *  - Other modes: sampling is paused until reactivated.
+ * Launches a dedicated Zephyr thread that reads the sensor groups requested
+ * through @ref sensor_cache_get and stores the results into the provided
+ * @ref system_measurement structure.
  *
  * The function does not block; the thread runs asynchronously.
  *
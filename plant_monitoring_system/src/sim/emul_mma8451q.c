@@ -0,0 +1,118 @@
+/**
+ * @file emul_mma8451q.c
+ * @brief MMA8451Q accelerometer emulator.
+ *
+ * Emulates the auto-incrementing register file used by accel.c. Output
+ * samples are 14-bit left-justified values of the simulated acceleration
+ * at the configured full-scale range, updated while the device is active.
+ */
+
+#define DT_DRV_COMPAT plant_mma8451q_emul
+
+#include <zephyr/device.h>
+#include <zephyr/drivers/emul.h>
+#include <zephyr/drivers/emul_stub_device.h>
+#include <zephyr/drivers/i2c.h>
+#include <zephyr/drivers/i2c_emul.h>
+#include <zephyr/sys/util.h>
+
+#include "sim_env.h"
+#include "sensors/i2c/accel.h"
+
+#define MMA8451Q_REG_COUNT    0x32
+#define MMA8451Q_REG_STATUS   0x00
+#define MMA8451Q_CTRL1_ACTIVE 0x01
+#define MMA8451Q_ZYXDR        0x08
+#define MMA8451Q_G            9.80665f
+
+/**
+ * @brief Emulator state.
+ */
+struct mma8451q_emul_data {
+    uint8_t regs[MMA8451Q_REG_COUNT];  /**< Register file. */
+    uint8_t ptr;                       /**< Register pointer. */
+};
+
+static void put_axis(uint8_t *regs, uint8_t reg, float ms2, float counts_per_g)
+{
+    float counts = ms2 / MMA8451Q_G * counts_per_g;
+    int16_t v = (int16_t)CLAMP(counts, -8192.0f, 8191.0f);
+    uint16_t out = (uint16_t)((uint16_t)v << 2);
+
+    regs[reg] = (uint8_t)(out >> 8);
+    regs[reg + 1] = (uint8_t)out;
+}
+
+/**
+ * @brief Latch a new sample into the output registers.
+ */
+static void mma8451q_emul_sample(struct mma8451q_emul_data *data)
+{
+    struct sim_env_values v;
+
+    if (!(data->regs[ACCEL_REG_CTRL1] & MMA8451Q_CTRL1_ACTIVE)) {
+        return;
+    }
+
+    float counts_per_g = 4096.0f / (float)(1 << (data->regs[ACCEL_REG_XYZ_DATA_CFG] & 0x03));
+
+    sim_env_sample(&v);
+    put_axis(data->regs, ACCEL_REG_OUT_X_MSB, v.accel_x, counts_per_g);
+    put_axis(data->regs, ACCEL_REG_OUT_Y_MSB, v.accel_y, counts_per_g);
+    put_axis(data->regs, ACCEL_REG_OUT_Z_MSB, v.accel_z, counts_per_g);
+    data->regs[MMA8451Q_REG_STATUS] = MMA8451Q_ZYXDR;
+}
+
+static int mma8451q_emul_transfer(const struct emul *target, struct i2c_msg *msgs,
+                                  int num_msgs, int addr)
+{
+    struct mma8451q_emul_data *data = target->data;
+
+    for (int i = 0; i < num_msgs; i++) {
+        struct i2c_msg *msg = &msgs[i];
+
+        if (msg->flags & I2C_MSG_READ) {
+            if (data->ptr <= ACCEL_REG_OUT_X_MSB) {
+                mma8451q_emul_sample(data);
+            }
+            for (uint32_t j = 0; j < msg->len; j++) {
+                msg->buf[j] = data->regs[data->ptr];
+                data->ptr = (data->ptr + 1) % MMA8451Q_REG_COUNT;
+            }
+            continue;
+        }
+
+        if (msg->len == 0 || msg->buf[0] >= MMA8451Q_REG_COUNT) {
+            return -EIO;
+        }
+        data->ptr = msg->buf[0];
+        for (uint32_t j = 1; j < msg->len; j++) {
+            if (data->ptr != ACCEL_REG_WHO_AM_I) {
+                data->regs[data->ptr] = msg->buf[j];
+            }
+            data->ptr = (data->ptr + 1) % MMA8451Q_REG_COUNT;
+        }
+    }
+
+    return 0;
+}
+
+static const struct i2c_emul_api mma8451q_emul_api = {
+    .transfer = mma8451q_emul_transfer,
+};
+
+static int mma8451q_emul_init(const struct emul *target, const struct device *parent)
+{
+    struct mma8451q_emul_data *data = target->data;
+
+    data->regs[ACCEL_REG_WHO_AM_I] = ACCEL_WHO_AM_I_VALUE;
+    return 0;
+}
+
+#define MMA8451Q_EMUL(n)                                                        \
+    static struct mma8451q_emul_data mma8451q_emul_data_##n;                    \
+    EMUL_DT_INST_DEFINE(n, mma8451q_emul_init, &mma8451q_emul_data_##n, NULL,   \
+                        &mma8451q_emul_api, NULL)
+
+DT_INST_FOREACH_STATUS_OKAY(MMA8451Q_EMUL)
+DT_INST_FOREACH_STATUS_OKAY(EMUL_STUB_DEVICE)
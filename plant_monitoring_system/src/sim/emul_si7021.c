@@ -0,0 +1,176 @@
+/**
+ * @file emul_si7021.c
+ * @brief Si7021 temperature and humidity sensor emulator.
+ *
+ * Implements the command set used by temp_hum.c: soft reset, user register
+ * write/read, hold and no-hold master RH and temperature measurements and
+ * reading the temperature of the previous RH measurement. A no-hold
+ * measurement NACKs reads until the datasheet maximum conversion time of
+ * the resolution set has elapsed.
+ */
+
+#define DT_DRV_COMPAT plant_si7021_emul
+
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/emul.h>
+#include <zephyr/drivers/emul_stub_device.h>
+#include <zephyr/drivers/i2c.h>
+#include <zephyr/drivers/i2c_emul.h>
+
+#include "sim_env.h"
+#include "sensors/i2c/temp_hum.h"
+
+/**
+ * @brief Maximum conversion times (ms) by resolution setting.
+ *
+ * An RH measurement includes a temperature conversion.
+ */
+static const struct {
+    uint8_t resolution;
+    uint8_t rh_ms;
+    uint8_t temp_ms;
+} si7021_emul_conv[] = {
+    { TH_RES_RH12_TEMP14, 23, 11 },
+    { TH_RES_RH8_TEMP12,  7,  4 },
+    { TH_RES_RH10_TEMP13, 11, 7 },
+    { TH_RES_RH11_TEMP11, 10, 3 },
+};
+
+/**
+ * @brief Emulator state.
+ */
+struct si7021_emul_data {
+    uint8_t user_reg;    /**< User register 1. */
+    uint8_t cmd;         /**< Last command byte written. */
+    uint16_t last_temp;  /**< Temperature code of the last RH measurement. */
+    int64_t ready_ms;    /**< Uptime at which a no-hold conversion completes. */
+};
+
+/**
+ * @brief Conversion time of a no-hold measurement at the current resolution.
+ */
+static int64_t si7021_emul_conv_ms(const struct si7021_emul_data *data, bool rh)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(si7021_emul_conv); i++) {
+        if (si7021_emul_conv[i].resolution == (data->user_reg & TH_RES_MASK)) {
+            return rh ? si7021_emul_conv[i].rh_ms : si7021_emul_conv[i].temp_ms;
+        }
+    }
+    return 0;
+}
+
+static uint16_t temp_code(float t)
+{
+    return (uint16_t)((t + 46.85f) * 65536.0f / 175.72f) & 0xFFFC;
+}
+
+static uint16_t rh_code(float rh)
+{
+    return ((uint16_t)((rh + 6.0f) * 65536.0f / 125.0f) & 0xFFFC) | 0x0002;
+}
+
+static int si7021_emul_read(struct si7021_emul_data *data, uint8_t *buf, uint32_t len)
+{
+    struct sim_env_values v;
+    uint16_t code;
+
+    switch (data->cmd) {
+    case TH_MEAS_RH_NOHOLD:
+    case TH_MEAS_TEMP_NOHOLD:
+        if (k_uptime_get() < data->ready_ms) {
+            return -EIO; /* NACK: still converting */
+        }
+        sim_env_sample(&v);
+        if (data->cmd == TH_MEAS_RH_NOHOLD) {
+            code = rh_code(v.hum);
+            data->last_temp = temp_code(v.temp);
+        } else {
+            code = temp_code(v.temp);
+        }
+        break;
+    case TH_MEAS_RH_HOLD:
+        sim_env_sample(&v);
+        code = rh_code(v.hum);
+        data->last_temp = temp_code(v.temp);
+        break;
+    case TH_MEAS_TEMP_HOLD:
+        sim_env_sample(&v);
+        code = temp_code(v.temp);
+        break;
+    case TH_READ_TEMP_FROM_RH:
+        code = data->last_temp;
+        break;
+    case TH_READ_USER_REG:
+        if (len != 1) {
+            return -EIO;
+        }
+        buf[0] = data->user_reg;
+        return 0;
+    default:
+        return -EIO;
+    }
+
+    if (len < 2) {
+        return -EIO;
+    }
+    buf[0] = (uint8_t)(code >> 8);
+    buf[1] = (uint8_t)code;
+    for (uint32_t i = 2; i < len; i++) {
+        buf[i] = 0; /* Checksum byte is not emulated */
+    }
+    return 0;
+}
+
+static int si7021_emul_transfer(const struct emul *target, struct i2c_msg *msgs,
+                                int num_msgs, int addr)
+{
+    struct si7021_emul_data *data = target->data;
+
+    for (int i = 0; i < num_msgs; i++) {
+        struct i2c_msg *msg = &msgs[i];
+
+        if (msg->flags & I2C_MSG_READ) {
+            int ret = si7021_emul_read(data, msg->buf, msg->len);
+            if (ret) {
+                return ret;
+            }
+            continue;
+        }
+
+        if (msg->len == 0) {
+            return -EIO;
+        }
+        data->cmd = msg->buf[0];
+        if (data->cmd == TH_RESET) {
+            data->user_reg = 0x3A;
+        } else if (data->cmd == TH_WRITE_USER_REG && msg->len == 2) {
+            data->user_reg = msg->buf[1];
+        } else if (data->cmd == TH_MEAS_RH_NOHOLD || data->cmd == TH_MEAS_TEMP_NOHOLD) {
+            data->ready_ms = k_uptime_get() +
+                             si7021_emul_conv_ms(data, data->cmd == TH_MEAS_RH_NOHOLD);
+        }
+    }
+
+    return 0;
+}
+
+static const struct i2c_emul_api si7021_emul_api = {
+    .transfer = si7021_emul_transfer,
+};
+
+static int si7021_emul_init(const struct emul *target, const struct device *parent)
+{
+    struct si7021_emul_data *data = target->data;
+
+    data->user_reg = 0x3A;
+    return 0;
+}
+
+#define SI7021_EMUL(n)                                                          \
+    static struct si7021_emul_data si7021_emul_data_##n;                        \
+    EMUL_DT_INST_DEFINE(n, si7021_emul_init, &si7021_emul_data_##n, NULL,       \
+                        &si7021_emul_api, NULL)
+
+DT_INST_FOREACH_STATUS_OKAY(SI7021_EMUL)
+DT_INST_FOREACH_STATUS_OKAY(EMUL_STUB_DEVICE)
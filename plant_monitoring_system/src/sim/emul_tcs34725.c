@@ -0,0 +1,132 @@
+/**
+ * @file emul_tcs34725.c
+ * @brief TCS34725 color sensor emulator.
+ *
+ * Emulates the register file behind the command byte protocol used by
+ * color.c. Channel counts follow the simulated light level and scale with
+ * the programmed gain and integration time, saturating like the real
+ * sensor.
+ */
+
+#define DT_DRV_COMPAT plant_tcs34725_emul
+
+#include <zephyr/device.h>
+#include <zephyr/drivers/emul.h>
+#include <zephyr/drivers/emul_stub_device.h>
+#include <zephyr/drivers/i2c.h>
+#include <zephyr/drivers/i2c_emul.h>
+#include <zephyr/sys/util.h>
+
+#include "sim_env.h"
+#include "sensors/i2c/color.h"
+
+#define TCS34725_REG_COUNT   0x20
+#define TCS34725_REG_ID      0x12
+#define TCS34725_REG_STATUS  0x13
+#define TCS34725_ID          0x44
+#define TCS34725_AVALID      0x01
+#define TCS34725_REF_CYCLES  64.0f  /**< Integration cycles of the reference counts (154 ms). */
+#define TCS34725_REF_GAIN    4.0f   /**< Gain of the reference counts. */
+
+/**
+ * @brief Emulator state.
+ */
+struct tcs34725_emul_data {
+    uint8_t regs[TCS34725_REG_COUNT];  /**< Register file. */
+    uint8_t ptr;                       /**< Register pointer. */
+    bool auto_increment;               /**< Pointer advances after each access. */
+};
+
+static void put_channel(uint8_t *regs, uint8_t reg, float counts, float max)
+{
+    uint16_t v = (uint16_t)(counts > max ? max : counts);
+
+    regs[reg] = (uint8_t)v;
+    regs[reg + 1] = (uint8_t)(v >> 8);
+}
+
+/**
+ * @brief Latch a new conversion into the data registers.
+ */
+static void tcs34725_emul_convert(struct tcs34725_emul_data *data)
+{
+    static const float gains[] = { 1.0f, 4.0f, 16.0f, 60.0f };
+    struct sim_env_values v;
+
+    if ((data->regs[COLOR_ENABLE] & (ENABLE_PON | ENABLE_AEN)) != (ENABLE_PON | ENABLE_AEN)) {
+        return;
+    }
+
+    float cycles = 256.0f - data->regs[COLOR_ATIME];
+    float scale = gains[data->regs[COLOR_CONTROL] & 0x03] / TCS34725_REF_GAIN *
+                  cycles / TCS34725_REF_CYCLES;
+    float max = MIN(65535.0f, 1024.0f * cycles);
+
+    sim_env_sample(&v);
+    put_channel(data->regs, COLOR_CLEAR_L, v.clear * scale, max);
+    put_channel(data->regs, COLOR_RED_L, v.red * scale, max);
+    put_channel(data->regs, COLOR_GREEN_L, v.green * scale, max);
+    put_channel(data->regs, COLOR_BLUE_L, v.blue * scale, max);
+    data->regs[TCS34725_REG_STATUS] |= TCS34725_AVALID;
+}
+
+static int tcs34725_emul_transfer(const struct emul *target, struct i2c_msg *msgs,
+                                  int num_msgs, int addr)
+{
+    struct tcs34725_emul_data *data = target->data;
+
+    for (int i = 0; i < num_msgs; i++) {
+        struct i2c_msg *msg = &msgs[i];
+
+        if (msg->flags & I2C_MSG_READ) {
+            if (data->ptr == COLOR_CLEAR_L) {
+                tcs34725_emul_convert(data);
+            }
+            for (uint32_t j = 0; j < msg->len; j++) {
+                msg->buf[j] = data->regs[data->ptr];
+                if (data->auto_increment) {
+                    data->ptr = (data->ptr + 1) % TCS34725_REG_COUNT;
+                }
+            }
+            continue;
+        }
+
+        if (msg->len == 0 || !(msg->buf[0] & COLOR_COMMAND)) {
+            return -EIO;
+        }
+        data->ptr = msg->buf[0] & 0x1F;
+        data->auto_increment = (msg->buf[0] & 0x60) == AUTO_INCREMENT;
+
+        for (uint32_t j = 1; j < msg->len; j++) {
+            if (data->ptr != TCS34725_REG_ID && data->ptr != TCS34725_REG_STATUS) {
+                data->regs[data->ptr] = msg->buf[j];
+            }
+            if (data->auto_increment) {
+                data->ptr = (data->ptr + 1) % TCS34725_REG_COUNT;
+            }
+        }
+    }
+
+    return 0;
+}
+
+static const struct i2c_emul_api tcs34725_emul_api = {
+    .transfer = tcs34725_emul_transfer,
+};
+
+static int tcs34725_emul_init(const struct emul *target, const struct device *parent)
+{
+    struct tcs34725_emul_data *data = target->data;
+
+    data->regs[COLOR_ATIME] = 0xFF;
+    data->regs[TCS34725_REG_ID] = TCS34725_ID;
+    return 0;
+}
+
+#define TCS34725_EMUL(n)                                                        \
+    static struct tcs34725_emul_data tcs34725_emul_data_##n;                    \
+    EMUL_DT_INST_DEFINE(n, tcs34725_emul_init, &tcs34725_emul_data_##n, NULL,   \
+                        &tcs34725_emul_api, NULL)
+
+DT_INST_FOREACH_STATUS_OKAY(TCS34725_EMUL)
+DT_INST_FOREACH_STATUS_OKAY(EMUL_STUB_DEVICE)
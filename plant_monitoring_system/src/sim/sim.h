@@ -0,0 +1,73 @@
+/**
+ * @file sim.h
+ * @brief native_sim board support of the Plant Monitoring System.
+ *
+ * On native_sim the ADC, the I2C sensors and the GPS UART are emulated and
+ * fed from @ref sim_env.h. Each instance is configured on the command line,
+ * which lets a host harness run a whole fleet of differently seeded nodes:
+ *
+ * @verbatim
+ *   zephyr.exe -node_id=7 -boot_time=43200 -mode=1 -stop_at=86400 -no-rt
+ * @endverbatim
+ *
+ * - @c -node_id: node identifier and environment seed (default 1).
+ * - @c -boot_time: UTC time of day at boot, in seconds (default 0).
+ * - @c -mode: initial operating mode, 0 = TEST, 1 = NORMAL, 2 = ADVANCED.
+ * - @c -tdma: NORMAL_MODE uplink in GPS-timed slots (1) or free-running (0).
+ * - @c -gps_period: interval between GGA sentences in ms (default 1000).
+ * - @c -gps_ttff: GPS time to first fix without assistance, in ms (default 35000).
+ * - @c -flash: flash simulator file; its storage partition holds the EPO
+ *   data sent to the GPS (see tools/epo/epo_image.py).
+ * - @c -soak_period: soak report interval in seconds (see sim_soak.c).
+ * - @c -battery_mah, @c -battery_soc, @c -solar_ua: capacity and initial
+ *   charge of the battery, current of the solar cell (see sim_battery.c).
+ */
+
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <zephyr/devicetree.h>
+
+/** @brief ADC channel wired to the phototransistor (first plant,light-sensor node). */
+#define SIM_ADC_LIGHT_CHANNEL DT_IO_CHANNELS_INPUT(DT_INST(0, plant_light_sensor))
+
+/**
+ * @brief Get the node identifier given on the command line.
+ */
+uint32_t sim_node_id(void);
+
+/**
+ * @brief Get the initial operating mode.
+ *
+ * @param def Mode to use if none was given on the command line.
+ * @return Requested mode, or @p def.
+ */
+int sim_initial_mode(int def);
+
+/**
+ * @brief Whether the uplink uses GPS-timed slots (see tdma.h).
+ *
+ * @param def Setting to use if none was given on the command line.
+ * @return Requested setting, or @p def.
+ */
+bool sim_uplink_slots(bool def);
+
+/**
+ * @brief Measure the simulated battery.
+ *
+ * @param vdda_mv Pointer to store the analog supply (mV).
+ * @param vbat_mv Pointer to store the battery voltage (mV).
+ */
+void sim_battery_read(uint16_t *vdda_mv, uint16_t *vbat_mv);
+
+/**
+ * @brief Host monotonic clock (ns), for timing computation.
+ *
+ * The kernel clock counts simulated time, which stands still while the
+ * firmware computes (see sim_host.c).
+ */
+uint64_t sim_host_time_ns(void);
+
+#endif /* SIM_H */
@@ -0,0 +1,103 @@
+/**
+ * @file sim_battery.c
+ * @brief Simulated battery and solar cell of a native_sim node.
+ *
+ * The battery described by the @c plant,battery node (capacity overridden
+ * by @c -battery_mah, starting at @c -battery_soc percent) is discharged by
+ * the charge the energy estimator accounts (@ref energy_consumed_uas) and
+ * recharged by a small solar cell delivering @c -solar_ua at full
+ * brightness, scaled by the simulated light. The terminal voltage follows
+ * the open-circuit curve of the node; the firmware reads it as VBAT. VDDA
+ * comes from a regulator that holds 3.3 V until the battery is empty.
+ *
+ * The battery is brought up to date whenever the firmware measures it.
+ */
+
+#include "sim.h"
+#include "sim_env.h"
+#include "power/energy.h"
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+#include <zephyr/sys/util.h>
+
+#include "cmdline.h"
+#include "posix_native_task.h"
+
+#define SIM_UAS_PER_MAH 3600000LL  /**< µA·s in one mAh. */
+#define SIM_REGULATED_MV 3300      /**< VDD from the regulator. */
+#define SIM_BATTERY_NODE DT_INST(0, plant_battery)
+
+/** @brief Open-circuit voltage of the battery from 0 % to 100 % in steps of 10 %. */
+static const uint16_t ocv_mv[] = DT_PROP(SIM_BATTERY_NODE, ocv_mv);
+
+static uint32_t capacity_mah = DT_PROP(SIM_BATTERY_NODE, capacity_mah);
+static uint32_t initial_soc = 100;
+static uint32_t solar_ua;
+
+static bool started;
+static int64_t charge_uas;         /**< Charge left in the cells. */
+static uint64_t last_consumed_uas;  /**< Estimator total at the last update. */
+static int64_t last_ms;             /**< Uptime of the last update. */
+
+/**
+ * @brief Register the battery command-line options.
+ */
+static void sim_battery_options(void)
+{
+    static struct args_struct_t options[] = {
+        { .option = "battery_mah", .name = "mAh", .type = 'u', .dest = (void *)&capacity_mah,
+          .descript = "Capacity of the simulated battery (default: capacity-mah of the devicetree)" },
+        { .option = "battery_soc", .name = "percent", .type = 'u', .dest = (void *)&initial_soc,
+          .descript = "State of charge of the battery at boot (default 100)" },
+        { .option = "solar_ua", .name = "uA", .type = 'u', .dest = (void *)&solar_ua,
+          .descript = "Solar cell current at full brightness (default 0 = none)" },
+        ARG_TABLE_ENDMARKER
+    };
+
+    native_add_command_line_opts(options);
+}
+NATIVE_TASK(sim_battery_options, PRE_BOOT_1, 12);
+
+/**
+ * @brief Open-circuit voltage at a state of charge.
+ *
+ * @param permille State of charge (0–1000).
+ */
+static uint16_t sim_battery_ocv(int32_t permille)
+{
+    int32_t i = CLAMP(permille, 0, 999) / 100;
+    int32_t frac = CLAMP(permille, 0, 1000) - i * 100;
+
+    return (uint16_t)(ocv_mv[i] + (ocv_mv[i + 1] - ocv_mv[i]) * frac / 100);
+}
+
+void sim_battery_read(uint16_t *vdda_mv, uint16_t *vbat_mv)
+{
+    int64_t capacity_uas = (int64_t)capacity_mah * SIM_UAS_PER_MAH;
+    int64_t now = k_uptime_get();
+    uint64_t consumed = energy_consumed_uas();
+
+    if (!started) {
+        started = true;
+        charge_uas = capacity_uas * MIN(initial_soc, 100U) / 100;
+        printk("[SIM] - Battery %u mAh at %u %%, solar cell %u uA\n",
+               capacity_mah, MIN(initial_soc, 100U), solar_ua);
+    } else {
+        struct sim_env_values v;
+
+        sim_env_sample(&v);
+        float harvest_ua = solar_ua * CLAMP(v.light, 0.0f, 100.0f) / 100.0f;
+
+        charge_uas -= (int64_t)(consumed - last_consumed_uas);
+        charge_uas += (int64_t)(harvest_ua * (float)(now - last_ms) / MSEC_PER_SEC);
+        charge_uas = CLAMP(charge_uas, 0, capacity_uas);
+    }
+    last_consumed_uas = consumed;
+    last_ms = now;
+
+    int32_t permille = capacity_uas ? (int32_t)(charge_uas * 1000 / capacity_uas) : 0;
+
+    *vbat_mv = sim_battery_ocv(permille);
+    *vdda_mv = (charge_uas > 0) ? SIM_REGULATED_MV : *vbat_mv;
+}
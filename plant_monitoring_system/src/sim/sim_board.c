@@ -0,0 +1,371 @@
+/**
+ * @file sim_board.c
+ * @brief native_sim command-line options, ADC inputs and GPS feed.
+ *
+ * The emulated ADC returns the simulated light level on
+ * @ref SIM_ADC_LIGHT_CHANNEL and soil moisture on every other channel.
+ * The emulated GPS UART receives one GGA sentence per second (see
+ * @c -gps_period) carrying the simulated position and UTC time, followed by
+ * an RMC sentence with the date once the module has a fix.
+ *
+ * The module's time to first fix is modelled from what the firmware sends
+ * it: @c -gps_ttff after power-up, @ref SIM_GPS_TTFF_EPO_MS after a
+ * complete EPO upload (PMTK binary command 722, each packet acknowledged
+ * with command 723) and @ref SIM_GPS_TTFF_ASSISTED_MS once it also has the time and
+ * position (PMTK741). No fix is reported until then, so the TTFF printed by
+ * the firmware shows the effect of the assistance.
+ *
+ * PMTK161,0 puts the module in standby: it sends nothing until the next
+ * byte from the firmware wakes it, and then hot-starts within
+ * @ref SIM_GPS_TTFF_HOT_MS.
+ */
+
+#include "sim.h"
+#include "sim_env.h"
+
+#include <zephyr/kernel.h>
+#include <zephyr/init.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/adc/adc_emul.h>
+#include <zephyr/drivers/serial/uart_emul.h>
+#include <zephyr/sys/printk.h>
+#include <zephyr/sys/byteorder.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "cmdline.h"
+#include "posix_native_task.h"
+
+#define SIM_ADC_NODE      DT_NODELABEL(adc1)
+#define SIM_ADC_CHANNELS  DT_PROP(SIM_ADC_NODE, nchannels)
+#define SIM_ADC_VREF_MV   DT_PROP(SIM_ADC_NODE, ref_internal_mv)
+#define SIM_GPS_SATS      8     /**< Satellites reported in every fix. */
+#define SIM_OPTION_UNSET  0xFFFFFFFFu  /**< Option not given on the command line. */
+
+#define SIM_GPS_TTFF_COLD_MS     35000  /**< Default TTFF without assistance (@c -gps_ttff). */
+#define SIM_GPS_TTFF_EPO_MS      15000  /**< TTFF after an EPO upload. */
+#define SIM_GPS_TTFF_ASSISTED_MS 5000   /**< TTFF after an EPO upload and PMTK741. */
+#define SIM_GPS_TTFF_HOT_MS      1000   /**< Fix after waking from standby. */
+#define SIM_GPS_START_UTC 1767225600LL  /**< Date of the first simulated day (2026-01-01). */
+#define SIM_GPS_RX_SIZE   200           /**< Longest command or binary packet from the firmware. */
+#define SIM_GPS_EPO_CMD   722           /**< PMTK binary EPO data. */
+#define SIM_GPS_EPO_END   0xFFFF        /**< Sequence number ending an EPO upload. */
+#define SIM_GPS_SET_FORMAT 253          /**< PMTK binary set output format (back to NMEA). */
+#define SIM_GPS_ACK_EPO   723           /**< PMTK binary EPO acknowledgement: sequence, result. */
+
+static uint32_t node_id = 1;
+static uint32_t boot_time_s;
+static uint32_t initial_mode = SIM_OPTION_UNSET;
+static uint32_t uplink_slots = SIM_OPTION_UNSET;
+static uint32_t gps_period_ms = 1000;
+static uint32_t gps_ttff_ms = SIM_GPS_TTFF_COLD_MS;
+
+static const struct device *const adc_dev = DEVICE_DT_GET(SIM_ADC_NODE);
+static const struct device *const gps_dev = DEVICE_DT_GET(DT_CHOSEN(plant_gps_uart));
+
+static struct k_work_delayable gps_work;
+
+/** @brief State of the emulated GPS module. */
+static struct {
+    uint32_t fix_at;                  /**< Uptime of the first fix (ms). */
+    bool binary;                      /**< Link switched to binary by PMTK253. */
+    bool epo;                         /**< Complete EPO upload received. */
+    bool assisted;                    /**< Time and position received (PMTK741). */
+    bool standby;                     /**< Put in standby by PMTK161,0. */
+    uint16_t epo_packets;             /**< EPO packets received. */
+    uint8_t rx[SIM_GPS_RX_SIZE];      /**< Command or packet being received. */
+    size_t rx_pos;                    /**< Bytes in @c rx. */
+} gps_module;
+
+/**
+ * @brief Register the command-line options of the simulated node.
+ */
+static void sim_add_options(void)
+{
+    static struct args_struct_t options[] = {
+        { .option = "node_id", .name = "id", .type = 'u', .dest = (void *)&node_id,
+          .descript = "Node identifier and environment seed" },
+        { .option = "boot_time", .name = "seconds", .type = 'u', .dest = (void *)&boot_time_s,
+          .descript = "UTC time of day at boot (seconds since midnight)" },
+        { .option = "mode", .name = "mode", .type = 'u', .dest = (void *)&initial_mode,
+          .descript = "Initial mode: 0 = TEST, 1 = NORMAL, 2 = ADVANCED" },
+        { .option = "tdma", .name = "0|1", .type = 'u', .dest = (void *)&uplink_slots,
+          .descript = "Uplink in GPS-timed slots (1) or free-running (0)" },
+        { .option = "gps_period", .name = "ms", .type = 'u', .dest = (void *)&gps_period_ms,
+          .descript = "Interval between GGA sentences (default 1000)" },
+        { .option = "gps_ttff", .name = "ms", .type = 'u', .dest = (void *)&gps_ttff_ms,
+          .descript = "GPS time to first fix without EPO or time assistance (default 35000)" },
+        ARG_TABLE_ENDMARKER
+    };
+
+    native_add_command_line_opts(options);
+}
+NATIVE_TASK(sim_add_options, PRE_BOOT_1, 10);
+
+uint32_t sim_node_id(void)
+{
+    return node_id;
+}
+
+int sim_initial_mode(int def)
+{
+    return (initial_mode <= 2) ? (int)initial_mode : def;
+}
+
+bool sim_uplink_slots(bool def)
+{
+    return (uplink_slots <= 1) ? (uplink_slots == 1) : def;
+}
+
+/**
+ * @brief Emulated ADC input: simulated sensor output in millivolts.
+ *
+ * @param dev ADC device.
+ * @param chan Channel being converted.
+ * @param data Unused.
+ * @param result Pointer to store the input voltage (mV).
+ * @return 0 always.
+ */
+static int sim_adc_value(const struct device *dev, unsigned int chan, void *data, uint32_t *result)
+{
+    struct sim_env_values v;
+
+    sim_env_sample(&v);
+    float percent = (chan == SIM_ADC_LIGHT_CHANNEL) ? v.light : v.moisture;
+
+    *result = (uint32_t)(percent * SIM_ADC_VREF_MV / 100.0f);
+    return 0;
+}
+
+/**
+ * @brief Format a coordinate as NMEA (D)DDMM.MMMM.
+ */
+static void nmea_coord(char *buf, size_t len, float deg, int deg_digits)
+{
+    float a = deg < 0 ? -deg : deg;
+    int d = (int)a;
+    float minutes = (a - d) * 60.0f;
+
+    snprintf(buf, len, "%0*d%07.4f", deg_digits, d, (double)minutes);
+}
+
+/**
+ * @brief Push one NMEA sentence into the emulated GPS UART.
+ *
+ * @param body Sentence without '$', checksum or line terminator.
+ */
+static void gps_put_sentence(const char *body)
+{
+    char line[128];
+    uint8_t cs = 0;
+
+    for (const char *p = body; *p; p++) {
+        cs ^= (uint8_t)*p;
+    }
+    int n = snprintf(line, sizeof(line), "$%s*%02X\r\n", body, cs);
+
+    uart_emul_put_rx_data(gps_dev, (uint8_t *)line, (size_t)n);
+}
+
+/**
+ * @brief Push the sentences of one GPS epoch into the emulated UART.
+ *
+ * Before the modelled first fix the GGA sentence has no position and fix
+ * quality 0. Nothing is sent while the link is binary or the module is in
+ * standby.
+ */
+static void gps_work_handler(struct k_work *work)
+{
+    char lat[16], lon[16], hms[12], body[112];
+    float la, lo, alt;
+    uint32_t tod = sim_env_time_of_day();
+
+    k_work_reschedule(&gps_work, K_MSEC(gps_period_ms));
+    if (gps_module.binary || gps_module.standby) {
+        return;
+    }
+
+    snprintf(hms, sizeof(hms), "%02u%02u%02u.00",
+             (unsigned int)(tod / 3600), (unsigned int)(tod / 60 % 60), (unsigned int)(tod % 60));
+
+    if ((int32_t)(k_uptime_get_32() - gps_module.fix_at) < 0) {
+        snprintf(body, sizeof(body), "GPGGA,%s,,,,,0,00,99.9,,M,,M,,", hms);
+        gps_put_sentence(body);
+        return;
+    }
+
+    sim_env_position(&la, &lo, &alt);
+    nmea_coord(lat, sizeof(lat), la, 2);
+    nmea_coord(lon, sizeof(lon), lo, 3);
+
+    snprintf(body, sizeof(body), "GPGGA,%s,%s,%c,%s,%c,1,%02d,0.9,%.1f,M,50.0,M,,",
+             hms, lat, la >= 0 ? 'N' : 'S', lon, lo >= 0 ? 'E' : 'W', SIM_GPS_SATS, (double)alt);
+    gps_put_sentence(body);
+
+    /* Day number from the boot time of day and the uptime */
+    time_t utc = (time_t)(SIM_GPS_START_UTC +
+                          (boot_time_s + k_uptime_get() / MSEC_PER_SEC) / 86400 * 86400);
+    struct tm tm;
+
+    gmtime_r(&utc, &tm);
+    snprintf(body, sizeof(body), "GPRMC,%s,A,%s,%c,%s,%c,0.0,0.0,%02d%02d%02d,,,A",
+             hms, lat, la >= 0 ? 'N' : 'S', lon, lo >= 0 ? 'E' : 'W',
+             tm.tm_mday, tm.tm_mon + 1, tm.tm_year % 100);
+    gps_put_sentence(body);
+}
+
+/**
+ * @brief Bring the modelled first fix forward to @p ttff_ms from now.
+ */
+static void gps_assisted(uint32_t ttff_ms)
+{
+    uint32_t at = k_uptime_get_32() + ttff_ms;
+
+    if ((int32_t)(at - gps_module.fix_at) < 0) {
+        gps_module.fix_at = at;
+    }
+}
+
+/**
+ * @brief Handle a PMTK command sent by the firmware.
+ *
+ * @param line Null-terminated command, starting with '$'.
+ */
+static void gps_nmea_command(const char *line)
+{
+    if (strncmp(line, "$PMTK253,1", 10) == 0) {
+        gps_module.binary = true;
+    } else if (strncmp(line, "$PMTK161,0", 10) == 0) {
+        gps_module.standby = true;
+    } else if (strncmp(line, "$PMTK741,", 9) == 0) {
+        gps_module.assisted = true;
+        if (gps_module.epo) {
+            gps_assisted(SIM_GPS_TTFF_ASSISTED_MS);
+        }
+    }
+}
+
+/**
+ * @brief Handle a PMTK binary packet sent by the firmware.
+ *
+ * EPO packets are acknowledged with their sequence number and a result,
+ * 0 for a packet out of sequence; the end packet completes the upload.
+ *
+ * @param pkt Packet, starting at the preamble.
+ * @param len Packet length.
+ */
+static void gps_binary_packet(const uint8_t *pkt, size_t len)
+{
+    uint8_t cs = 0;
+
+    for (size_t i = 2; i < len - 3; i++) {
+        cs ^= pkt[i];
+    }
+    if (cs != pkt[len - 3]) {
+        return;
+    }
+
+    uint16_t cmd = sys_get_le16(&pkt[4]);
+
+    if (cmd == SIM_GPS_SET_FORMAT) {
+        gps_module.binary = false;
+    } else if (cmd == SIM_GPS_EPO_CMD && len >= 11) {
+        uint16_t seq = sys_get_le16(&pkt[6]);
+        uint8_t ack[12] = { 0x04, 0x24, sizeof(ack), 0 };
+        uint8_t result = 1;
+
+        if (seq == SIM_GPS_EPO_END) {
+            printk("[SIM] - GPS received %u EPO packet(s)\n", gps_module.epo_packets);
+            gps_module.epo = true;
+            gps_module.epo_packets = 0;
+            gps_assisted(gps_module.assisted ? SIM_GPS_TTFF_ASSISTED_MS : SIM_GPS_TTFF_EPO_MS);
+        } else if (seq == gps_module.epo_packets) {
+            gps_module.epo_packets++;
+        } else if (seq + 1 != gps_module.epo_packets) {
+            /* A resent packet (its acknowledgement was lost) is accepted again */
+            result = 0;
+        }
+
+        sys_put_le16(SIM_GPS_ACK_EPO, &ack[4]);
+        sys_put_le16(seq, &ack[6]);
+        ack[8] = result;
+        for (size_t i = 2; i < 9; i++) {
+            ack[9] ^= ack[i];
+        }
+        ack[10] = '\r';
+        ack[11] = '\n';
+        uart_emul_put_rx_data(gps_dev, ack, sizeof(ack));
+    }
+}
+
+/**
+ * @brief Receive what the firmware wrote to the GPS UART.
+ *
+ * Splits the byte stream into NMEA commands and binary packets.
+ */
+static void gps_tx_ready(const struct device *dev, size_t size, void *user_data)
+{
+    uint8_t c;
+
+    while (uart_emul_get_tx_data(dev, &c, 1) == 1) {
+        uint8_t *rx = gps_module.rx;
+
+        if (gps_module.standby) {
+            /* Any byte wakes the module; it has lost its fix meanwhile */
+            uint32_t at = k_uptime_get_32() + SIM_GPS_TTFF_HOT_MS;
+
+            gps_module.standby = false;
+            if ((int32_t)(at - gps_module.fix_at) > 0) {
+                gps_module.fix_at = at;
+            }
+        }
+
+        if (gps_module.rx_pos == 0 && c != '$' && c != 0x04) {
+            continue;
+        }
+        rx[gps_module.rx_pos++] = c;
+
+        if (rx[0] == '$') {
+            if (c == '\n' || gps_module.rx_pos == SIM_GPS_RX_SIZE - 1) {
+                rx[gps_module.rx_pos] = '\0';
+                gps_nmea_command((const char *)rx);
+                gps_module.rx_pos = 0;
+            }
+        } else if (gps_module.rx_pos >= 4) {
+            uint16_t len = sys_get_le16(&rx[2]);
+
+            if (len < 9 || len > SIM_GPS_RX_SIZE) {
+                gps_module.rx_pos = 0;
+            } else if (gps_module.rx_pos == len) {
+                gps_binary_packet(rx, len);
+                gps_module.rx_pos = 0;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Seed the environment and connect it to the emulated peripherals.
+ */
+static int sim_board_init(void)
+{
+    sim_env_init(node_id, boot_time_s);
+
+    for (unsigned int chan = 0; chan < SIM_ADC_CHANNELS; chan++) {
+        int ret = adc_emul_value_func_set(adc_dev, chan, sim_adc_value, NULL);
+        if (ret) {
+            printk("[SIM] - ADC channel %u setup failed (%d)\n", chan, ret);
+            return ret;
+        }
+    }
+
+    gps_module.fix_at = k_uptime_get_32() + gps_ttff_ms;
+    uart_emul_callback_tx_data_ready_set(gps_dev, gps_tx_ready, NULL);
+    k_work_init_delayable(&gps_work, gps_work_handler);
+    k_work_schedule(&gps_work, K_MSEC(gps_period_ms));
+
+    printk("[SIM] - Node %u, boot time %u s\n", (unsigned int)node_id, (unsigned int)boot_time_s);
+    return 0;
+}
+SYS_INIT(sim_board_init, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
@@ -0,0 +1,192 @@
+/**
+ * @file sim_env.c
+ * @brief Simulated plant environment implementation.
+ *
+ * Slow quantities (soil moisture, cloud cover) are integrated in one-minute
+ * steps up to the current uptime; the diurnal cycle is a closed-form
+ * function of the time of day. Measurement noise is added on every sample.
+ */
+
+#include "sim_env.h"
+#include <zephyr/kernel.h>
+#include <math.h>
+
+#define SIM_STEP_MS       60000     /**< Integration step of the slow quantities. */
+#define SIM_DAY_S         86400     /**< Seconds per day. */
+#define SIM_PI            3.14159265f
+#define SIM_G             9.80665f  /**< Standard gravity (m/s²). */
+
+#define SIM_SITE_LAT      40.4168f  /**< Latitude of the simulated site. */
+#define SIM_SITE_LON      -3.7038f  /**< Longitude of the simulated site. */
+#define SIM_SITE_ALT      650.0f    /**< Altitude of the simulated site (m). */
+#define SIM_SITE_SPREAD   0.01f     /**< Node scatter around the site (degrees). */
+
+/**
+ * @brief Environment state of this node.
+ */
+static struct {
+    uint32_t rng;          /**< xorshift32 state. */
+    uint32_t boot_time_s;  /**< Time of day at boot. */
+    int64_t last_ms;       /**< Uptime of the last integration step. */
+
+    float moisture;        /**< Current soil moisture (%). */
+    float dry_rate;        /**< Night-time drying rate (%/h). */
+    float water_level;     /**< Moisture at which the plant is watered (%). */
+    float cloud;           /**< Cloud transmission factor (0.3–1). */
+
+    float temp_offset;     /**< Microclimate temperature offset (°C). */
+    float hum_offset;      /**< Microclimate humidity offset (%RH). */
+    float light_gain;      /**< Shading of the phototransistor. */
+    float tint[3];         /**< Canopy red/green/blue reflectance. */
+    float tilt_x;          /**< Pot tilt around the Y axis (rad). */
+    float tilt_y;          /**< Pot tilt around the X axis (rad). */
+
+    float lat;             /**< Latitude (degrees). */
+    float lon;             /**< Longitude (degrees). */
+    float alt;             /**< Altitude (m). */
+} env;
+
+static struct k_spinlock env_lock;
+
+/**
+ * @brief Draw a uniform random number in [0, 1).
+ */
+static float rand_uniform(void)
+{
+    env.rng ^= env.rng << 13;
+    env.rng ^= env.rng >> 17;
+    env.rng ^= env.rng << 5;
+    return (float)(env.rng >> 8) / 16777216.0f;
+}
+
+/**
+ * @brief Draw approximately normal noise (Irwin–Hall, four terms).
+ *
+ * @param sigma Standard deviation.
+ */
+static float rand_noise(float sigma)
+{
+    float sum = rand_uniform() + rand_uniform() + rand_uniform() + rand_uniform();
+
+    return (sum - 2.0f) * 1.7320508f * sigma;
+}
+
+static float clampf(float v, float lo, float hi)
+{
+    return v < lo ? lo : (v > hi ? hi : v);
+}
+
+/**
+ * @brief Solar elevation factor (0 at night, 1 at solar noon).
+ *
+ * @param hour Time of day in hours.
+ */
+static float sun_factor(float hour)
+{
+    if (hour <= 6.0f || hour >= 18.0f) {
+        return 0.0f;
+    }
+    return sinf(SIM_PI * (hour - 6.0f) / 12.0f);
+}
+
+/**
+ * @brief Time of day in hours at a given uptime.
+ */
+static float hour_at(int64_t uptime_ms)
+{
+    uint32_t s = (uint32_t)((env.boot_time_s + uptime_ms / 1000) % SIM_DAY_S);
+
+    return s / 3600.0f;
+}
+
+/**
+ * @brief Integrate the slow quantities over one step.
+ */
+static void env_step(int64_t uptime_ms)
+{
+    float sun = sun_factor(hour_at(uptime_ms)) * env.cloud;
+
+    env.cloud = clampf(env.cloud + rand_noise(0.03f), 0.3f, 1.0f);
+
+    /* Evaporation follows the sun; watering refills the pot */
+    env.moisture -= (env.dry_rate + 1.5f * sun) * SIM_STEP_MS / 3600000.0f;
+    if (env.moisture < env.water_level) {
+        env.moisture = 70.0f + 15.0f * rand_uniform();
+    }
+}
+
+void sim_env_init(uint32_t seed, uint32_t boot_time_s)
+{
+    k_spinlock_key_t key = k_spin_lock(&env_lock);
+
+    /* Spread consecutive node IDs over the whole state space */
+    env.rng = (seed + 1) * 2654435761u;
+    if (env.rng == 0) {
+        env.rng = 1;
+    }
+    env.boot_time_s = boot_time_s % SIM_DAY_S;
+    env.last_ms = 0;
+
+    env.moisture = 45.0f + 30.0f * rand_uniform();
+    env.dry_rate = 0.3f + 0.4f * rand_uniform();
+    env.water_level = 25.0f + 10.0f * rand_uniform();
+    env.cloud = 0.6f + 0.4f * rand_uniform();
+
+    env.temp_offset = rand_noise(1.5f);
+    env.hum_offset = rand_noise(5.0f);
+    env.light_gain = 0.8f + 0.2f * rand_uniform();
+    env.tint[0] = 0.25f + 0.06f * rand_uniform();
+    env.tint[1] = 0.40f + 0.08f * rand_uniform();
+    env.tint[2] = 0.20f + 0.05f * rand_uniform();
+    env.tilt_x = rand_noise(0.03f);
+    env.tilt_y = rand_noise(0.03f);
+
+    env.lat = SIM_SITE_LAT + SIM_SITE_SPREAD * (2.0f * rand_uniform() - 1.0f);
+    env.lon = SIM_SITE_LON + SIM_SITE_SPREAD * (2.0f * rand_uniform() - 1.0f);
+    env.alt = SIM_SITE_ALT + 20.0f * rand_uniform();
+
+    k_spin_unlock(&env_lock, key);
+}
+
+void sim_env_sample(struct sim_env_values *out)
+{
+    int64_t now = k_uptime_get();
+    k_spinlock_key_t key = k_spin_lock(&env_lock);
+
+    while (env.last_ms + SIM_STEP_MS <= now) {
+        env.last_ms += SIM_STEP_MS;
+        env_step(env.last_ms);
+    }
+
+    float hour = hour_at(now);
+    float sun = sun_factor(hour) * env.cloud;
+    float daily = sinf(2.0f * SIM_PI * (hour - 9.0f) / 24.0f);
+
+    out->light = clampf(3.0f + 92.0f * env.light_gain * sun + rand_noise(0.5f), 0.0f, 100.0f);
+    out->moisture = clampf(env.moisture + rand_noise(0.3f), 0.0f, 100.0f);
+    out->temp = 17.0f + env.temp_offset + 7.0f * daily + 2.0f * sun + rand_noise(0.1f);
+    out->hum = clampf(60.0f + env.hum_offset - 18.0f * daily + rand_noise(0.5f), 5.0f, 99.0f);
+
+    out->clear = clampf((200.0f + 90.0f * out->light) * (1.0f + rand_noise(0.01f)), 1.0f, 65535.0f);
+    out->red = out->clear * env.tint[0];
+    out->green = out->clear * env.tint[1];
+    out->blue = out->clear * env.tint[2];
+
+    out->accel_x = SIM_G * sinf(env.tilt_x) + rand_noise(0.02f);
+    out->accel_y = SIM_G * sinf(env.tilt_y) + rand_noise(0.02f);
+    out->accel_z = SIM_G * cosf(env.tilt_x) * cosf(env.tilt_y) + rand_noise(0.02f);
+
+    k_spin_unlock(&env_lock, key);
+}
+
+uint32_t sim_env_time_of_day(void)
+{
+    return (uint32_t)((env.boot_time_s + k_uptime_get() / 1000) % SIM_DAY_S);
+}
+
+void sim_env_position(float *lat, float *lon, float *alt)
+{
+    *lat = env.lat;
+    *lon = env.lon;
+    *alt = env.alt;
+}
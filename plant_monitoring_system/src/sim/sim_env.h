@@ -0,0 +1,68 @@
+/**
+ * @file sim_env.h
+ * @brief Simulated plant environment for the native_sim board.
+ *
+ * Produces the physical quantities seen by the emulated sensors of one
+ * node: a diurnal light, temperature and humidity cycle, soil that dries
+ * out and is watered again, the color of the canopy and the tilt of the
+ * pot. Everything is derived from a seed (the node ID), so every node of
+ * a simulated fleet sees a different but reproducible environment.
+ */
+
+#ifndef SIM_ENV_H
+#define SIM_ENV_H
+
+#include <stdint.h>
+
+/**
+ * @struct sim_env_values
+ * @brief Environment seen by the sensors at one instant.
+ */
+struct sim_env_values {
+    float light;      /**< Phototransistor output (% of full scale). */
+    float moisture;   /**< Soil probe output (% of full scale). */
+    float temp;       /**< Air temperature (°C). */
+    float hum;        /**< Relative humidity (%RH). */
+    float red;        /**< Red channel at 4x gain and 154 ms integration (counts). */
+    float green;      /**< Green channel (counts). */
+    float blue;       /**< Blue channel (counts). */
+    float clear;      /**< Clear channel (counts). */
+    float accel_x;    /**< X-axis acceleration (m/s²). */
+    float accel_y;    /**< Y-axis acceleration (m/s²). */
+    float accel_z;    /**< Z-axis acceleration (m/s²). */
+};
+
+/**
+ * @brief Initialize the environment of one node.
+ *
+ * @param seed Seed of every random quantity (e.g., the node ID).
+ * @param boot_time_s UTC time of day at boot (seconds since midnight).
+ */
+void sim_env_init(uint32_t seed, uint32_t boot_time_s);
+
+/**
+ * @brief Advance the environment to the current uptime and sample it.
+ *
+ * Every call adds fresh sensor noise.
+ *
+ * @param out Pointer to store the sampled values.
+ */
+void sim_env_sample(struct sim_env_values *out);
+
+/**
+ * @brief Get the simulated UTC time of day.
+ *
+ * @return Seconds since midnight (0–86399).
+ */
+uint32_t sim_env_time_of_day(void);
+
+/**
+ * @brief Get the position of the node.
+ *
+ * @param lat Pointer to store the latitude (degrees, north positive).
+ * @param lon Pointer to store the longitude (degrees, east positive).
+ * @param alt Pointer to store the altitude (m).
+ */
+void sim_env_position(float *lat, float *lon, float *alt);
+
+#endif /* SIM_ENV_H */
@@ -0,0 +1,109 @@
+/**
+ * @file sim_soak.c
+ * @brief Periodic health report for accelerated-time soak runs on native_sim.
+ *
+ * With @c -soak_period=S the firmware prints one line every S simulated
+ * seconds:
+ *
+ * @verbatim
+ *   @SOAK n=3 uptime_ms=259200000 main=812/2048 sensors_thread=604/1024 ...
+ * @endverbatim
+ *
+ * @c n is the report index and every thread is listed as
+ * `name=used/size` bytes of stack, where @c used is the high-water mark
+ * found by scanning the painted stack (CONFIG_INIT_STACKS). The host side
+ * (tools/soak_test) adds CPU time and checks the rest of the console output.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/init.h>
+#include <zephyr/sys/printk.h>
+#include <zephyr/sys/util.h>
+
+#include "cmdline.h"
+#include "posix_native_task.h"
+
+#define SOAK_LINE_SIZE 512  /**< Report line buffer. */
+
+static uint32_t soak_period_s;
+static uint32_t soak_index;
+static struct k_work_delayable soak_work;
+
+/**
+ * @brief Register the soak command-line option.
+ */
+static void sim_soak_options(void)
+{
+    static struct args_struct_t options[] = {
+        { .option = "soak_period", .name = "seconds", .type = 'u', .dest = (void *)&soak_period_s,
+          .descript = "Print a stack/uptime report every this many simulated seconds (0 = off)" },
+        ARG_TABLE_ENDMARKER
+    };
+
+    native_add_command_line_opts(options);
+}
+NATIVE_TASK(sim_soak_options, PRE_BOOT_1, 11);
+
+/**
+ * @brief Report buffer being filled by @ref soak_thread_cb.
+ */
+struct soak_line {
+    char buf[SOAK_LINE_SIZE];
+    size_t len;
+};
+
+/**
+ * @brief Append the stack usage of one thread to the report line.
+ */
+static void soak_thread_cb(const struct k_thread *thread, void *user_data)
+{
+    struct soak_line *line = user_data;
+    const char *name = k_thread_name_get((k_tid_t)thread);
+    size_t size = thread->stack_info.size;
+    size_t unused = 0;
+
+    if (k_thread_stack_space_get(thread, &unused) != 0 || line->len >= sizeof(line->buf)) {
+        return;
+    }
+
+    int n;
+    if (name != NULL && name[0] != '\0') {
+        n = snprintk(line->buf + line->len, sizeof(line->buf) - line->len, " %s=%u/%u",
+                     name, (unsigned int)(size - unused), (unsigned int)size);
+    } else {
+        n = snprintk(line->buf + line->len, sizeof(line->buf) - line->len, " %p=%u/%u",
+                     (void *)thread, (unsigned int)(size - unused), (unsigned int)size);
+    }
+    line->len = MIN(line->len + (size_t)n, sizeof(line->buf) - 1);
+}
+
+/**
+ * @brief Print one soak report and schedule the next.
+ */
+static void soak_work_handler(struct k_work *work)
+{
+    static struct soak_line line;
+
+    soak_index++;
+    line.len = snprintk(line.buf, sizeof(line.buf), "@SOAK n=%u uptime_ms=%llu",
+                        (unsigned int)soak_index, (unsigned long long)k_uptime_get());
+    k_thread_foreach(soak_thread_cb, &line);
+    printk("%s\n", line.buf);
+
+    k_work_reschedule(&soak_work, K_SECONDS(soak_period_s));
+}
+
+/**
+ * @brief Start the soak reports if they were requested.
+ */
+static int sim_soak_init(void)
+{
+    if (soak_period_s == 0) {
+        return 0;
+    }
+
+    k_work_init_delayable(&soak_work, soak_work_handler);
+    k_work_schedule(&soak_work, K_SECONDS(soak_period_s));
+    return 0;
+}
+SYS_INIT(sim_soak_init, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
@@ -0,0 +1,241 @@
+/**
+ * @file export_protocol.h
+ * @brief History records and the bulk export protocol, shared by the
+ *        firmware and the host tools.
+ *
+ * ## History record
+ *
+ * Every transmitted telemetry frame is kept in flash as a fixed-size
+ * record (a multiple of the 8-byte flash write unit of the STM32WL):
+ *
+ * | Offset | Size | Field   | Notes                                  |
+ * |-------:|-----:|---------|----------------------------------------|
+ * |      0 |    4 | index   | records written since the history was created |
+ * |      4 |    4 | utc     | seconds since 1970-01-01, 0 if unknown |
+ * |      8 |   62 | frame   | encoded @ref telemetry_frame           |
+ * |     70 |    2 | crc     | CRC-16 of bytes 0..69                  |
+ *
+ * ## Export link
+ *
+ * Packets are COBS-encoded and each one is followed by a 0x00 delimiter,
+ * so a receiver resynchronizes on the next delimiter after any error. A
+ * packet is a type byte, its fields (little-endian) and a CRC-16 of both.
+ *
+ * @verbatim
+ *   host                                     node
+ *   HELLO(baud)          -- default baud -->
+ *                        <-- default baud --  INFO(first, next, ..., baud)
+ *   (both switch to the baud of INFO)
+ *   READ(from)           -->
+ *                        <--                  DATA(index, n, round, records) x window
+ *   ACK(next, round)     -->
+ *                        <--                  DATA ...
+ *                        <--                  DONE(next)
+ *   END                  -->
+ *                        <--                  BYE   (back to the default baud)
+ * @endverbatim
+ *
+ * The node keeps up to @ref EXPORT_WINDOW packets unacknowledged and goes
+ * back to the first unacknowledged record when the host acknowledges the
+ * same record again (it received a packet out of order), or when no
+ * acknowledgement has advanced for @ref EXPORT_RTO_MS. Each go-back starts
+ * a new round, which DATA carries and ACK echoes, so the repeated ACKs of
+ * the packets that were already on the line do not cause another one, but
+ * a packet lost again in the new round does. The host only
+ * accepts the record it expects next (go-back-N) and acknowledges every
+ * DATA packet, so it writes records in order and can resume any later
+ * session from the record after the last one it has; after its own
+ * timeout it sends READ again from that record. A READ for records the
+ * node has already overwritten starts at its oldest one, and if records
+ * are overwritten during the transfer the node stops and sends INFO again,
+ * so the host sees the gap and sends a new READ.
+ *
+ * ## Firmware update
+ *
+ * The same session carries a delta patch (update/delta.h), a chunk at a
+ * time, each one acknowledged before the next is sent:
+ *
+ * @verbatim
+ *   UPDATE(offset, bytes) -->
+ *                         <--                 UPDATE_ACK(next, status, apply_ms)
+ * @endverbatim
+ *
+ * The host sends the chunk at @c next until @c status is 1 (image
+ * written and checked) or negative (an errno of update/dfu.h; a chunk at
+ * offset 0 starts again). A chunk lost in either direction is sent again
+ * after @ref EXPORT_RTO_MS; the node ignores chunks it already has. After
+ * END the node reboots into the new image if it has a bootloader.
+ */
+
+#ifndef EXPORT_PROTOCOL_H
+#define EXPORT_PROTOCOL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <errno.h>
+
+#include "telemetry_frame.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HISTORY_RECORD_SIZE  72  /**< Bytes per history record. */
+#define HISTORY_RECORD_INDEX 0   /**< Offset of the record index. */
+#define HISTORY_RECORD_UTC   4   /**< Offset of the UTC time. */
+#define HISTORY_RECORD_FRAME 8   /**< Offset of the telemetry frame. */
+#define HISTORY_RECORD_CRC   (HISTORY_RECORD_FRAME + TELEMETRY_FRAME_SIZE) /**< Offset of the CRC. */
+
+#define EXPORT_DEFAULT_BAUD  115200  /**< Baud rate outside transfers. */
+#define EXPORT_RECORDS       4       /**< Records per DATA packet. */
+#define EXPORT_WINDOW        8       /**< DATA packets sent ahead of the acknowledgements. */
+#define EXPORT_RTO_MS        500     /**< Time without progress before going back. */
+#define EXPORT_IDLE_MS       5000    /**< Time without a packet before a session ends. */
+#define EXPORT_SWITCH_MS     50      /**< Delay between INFO and the baud change. */
+#define EXPORT_UPDATE_CHUNK  128     /**< Patch bytes per UPDATE packet. */
+
+/** @brief Packet types; bit 7 is set on packets from the node. */
+enum export_type {
+    EXPORT_HELLO = 0x01,  /**< Host: u32 requested baud (0 = keep). */
+    EXPORT_READ = 0x02,   /**< Host: u32 first record wanted. */
+    EXPORT_ACK = 0x03,    /**< Host: u32 next record expected, u8 round of the DATA received. */
+    EXPORT_END = 0x04,    /**< Host: end of session. */
+    EXPORT_UPDATE = 0x05, /**< Host: u32 patch offset, up to @ref EXPORT_UPDATE_CHUNK patch bytes. */
+    EXPORT_INFO = 0x81,   /**< Node: u32 first, u32 next, u16 record size, u8 records per packet, u8 window, u32 baud. */
+    EXPORT_DATA = 0x82,   /**< Node: u32 index of the first record, u8 count, u8 round, records. */
+    EXPORT_DONE = 0x83,   /**< Node: u32 next; every record before it is acknowledged. */
+    EXPORT_BYE = 0x84,    /**< Node: session over, back to the default baud. */
+    EXPORT_UPDATE_ACK = 0x85, /**< Node: u32 next patch offset, i8 status, u32 apply time (ms). */
+};
+
+#define EXPORT_INFO_SIZE   (1 + 4 + 4 + 2 + 1 + 1 + 4)  /**< INFO packet without CRC. */
+#define EXPORT_DATA_HEADER (1 + 4 + 1 + 1)              /**< DATA packet before the records. */
+#define EXPORT_UPDATE_HEADER (1 + 4)                    /**< UPDATE packet before the patch bytes. */
+#define EXPORT_UPDATE_ACK_SIZE (1 + 4 + 1 + 4)          /**< UPDATE_ACK packet without CRC. */
+/** Largest packet, CRC included. */
+#define EXPORT_MAX_PACKET  (EXPORT_DATA_HEADER + EXPORT_RECORDS * HISTORY_RECORD_SIZE + 2)
+/** Largest COBS encoding of @p len bytes, without the delimiter. */
+#define EXPORT_COBS_MAX(len) ((len) + (len) / 254 + 1)
+
+/**
+ * @brief Build a history record.
+ *
+ * @param rec Output, @ref HISTORY_RECORD_SIZE bytes.
+ * @param index Record index.
+ * @param utc UTC time of the sample (s), 0 if unknown.
+ * @param f Frame to store.
+ */
+static inline void history_record_encode(uint8_t *rec, uint32_t index, uint32_t utc,
+                                         const struct telemetry_frame *f)
+{
+    telemetry_put_u32(&rec[HISTORY_RECORD_INDEX], index);
+    telemetry_put_u32(&rec[HISTORY_RECORD_UTC], utc);
+    telemetry_encode(f, &rec[HISTORY_RECORD_FRAME]);
+    telemetry_put_u16(&rec[HISTORY_RECORD_CRC], telemetry_crc16(rec, HISTORY_RECORD_CRC));
+}
+
+/**
+ * @brief Check the CRC of a history record.
+ *
+ * @retval 0 If the record is intact.
+ * @retval -EBADMSG Otherwise (erased, torn or corrupt).
+ */
+static inline int history_record_check(const uint8_t *rec)
+{
+    return telemetry_get_u16(&rec[HISTORY_RECORD_CRC]) == telemetry_crc16(rec, HISTORY_RECORD_CRC)
+           ? 0 : -EBADMSG;
+}
+
+/**
+ * @brief Append the CRC to a packet.
+ *
+ * @param pkt Packet, with room for two more bytes.
+ * @param len Bytes in @p pkt.
+ * @return Length with the CRC.
+ */
+static inline size_t export_packet_seal(uint8_t *pkt, size_t len)
+{
+    telemetry_put_u16(&pkt[len], telemetry_crc16(pkt, len));
+    return len + 2;
+}
+
+/**
+ * @brief Check the CRC of a received packet.
+ *
+ * @return Length without the CRC, or -EBADMSG.
+ */
+static inline int export_packet_check(const uint8_t *pkt, size_t len)
+{
+    if (len < 3 || telemetry_get_u16(&pkt[len - 2]) != telemetry_crc16(pkt, len - 2)) {
+        return -EBADMSG;
+    }
+    return (int)(len - 2);
+}
+
+/**
+ * @brief COBS-encode a packet.
+ *
+ * @param in Packet.
+ * @param len Bytes in @p in.
+ * @param out Output, at least @ref EXPORT_COBS_MAX(len) bytes; contains no 0x00.
+ * @return Encoded length.
+ */
+static inline size_t export_cobs_encode(const uint8_t *in, size_t len, uint8_t *out)
+{
+    size_t code_at = 0;
+    size_t o = 1;
+    uint8_t code = 1;
+
+    for (size_t i = 0; i < len; i++) {
+        if (in[i] != 0) {
+            out[o++] = in[i];
+            code++;
+        }
+        if (in[i] == 0 || code == 0xFF) {
+            out[code_at] = code;
+            code_at = o++;
+            code = 1;
+        }
+    }
+    out[code_at] = code;
+    return o;
+}
+
+/**
+ * @brief Decode a COBS block received between two delimiters.
+ *
+ * @param in Encoded bytes, without the delimiter.
+ * @param len Bytes in @p in.
+ * @param out Output buffer.
+ * @param max Size of @p out.
+ * @return Decoded length, or -EBADMSG if the block is malformed or too long.
+ */
+static inline int export_cobs_decode(const uint8_t *in, size_t len, uint8_t *out, size_t max)
+{
+    size_t i = 0;
+    size_t o = 0;
+
+    while (i < len) {
+        uint8_t code = in[i++];
+
+        if (code == 0 || i + code - 1 > len || o + code - 1 > max) {
+            return -EBADMSG;
+        }
+        for (uint8_t k = 1; k < code; k++) {
+            out[o++] = in[i++];
+        }
+        if (code != 0xFF && i < len) {
+            if (o >= max) {
+                return -EBADMSG;
+            }
+            out[o++] = 0;
+        }
+    }
+    return (int)o;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EXPORT_PROTOCOL_H */
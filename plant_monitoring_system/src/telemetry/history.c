@@ -0,0 +1,218 @@
+/**
+ * @file history.c
+ * @brief Flash ring of fixed-size telemetry records.
+ */
+
+#include "history.h"
+#include "telemetry/export_protocol.h"
+#include <zephyr/kernel.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/flash.h>
+#include <zephyr/storage/flash_map.h>
+#include <zephyr/sys/printk.h>
+#include <zephyr/sys/util.h>
+#include <errno.h>
+
+#if DT_HAS_CHOSEN(plant_history_partition)
+
+#define HISTORY_PARTITION_ID DT_FIXED_PARTITION_ID(DT_CHOSEN(plant_history_partition))
+
+/** @brief Serializes the pipeline's appends and the exporter's reads. */
+static K_MUTEX_DEFINE(history_lock);
+
+static const struct flash_area *history_fa;
+static uint32_t page_size;      /**< Flash erase page. */
+static uint32_t page_records;   /**< Records per page; the rest of the page is unused. */
+static uint32_t capacity;       /**< Record slots in the partition. */
+static uint32_t first_index;    /**< Oldest record stored. */
+static uint32_t next_index;     /**< Index of the next record. */
+
+/**
+ * @brief Offset in the partition of the slot holding a record.
+ */
+static off_t slot_offset(uint32_t index)
+{
+    uint32_t slot = index % capacity;
+
+    return (off_t)(slot / page_records) * page_size + (off_t)(slot % page_records) * HISTORY_RECORD_SIZE;
+}
+
+int history_init(void)
+{
+    const struct flash_area *fa;
+    struct flash_pages_info info;
+    uint8_t rec[HISTORY_RECORD_SIZE];
+    uint32_t found = 0;
+    int ret = flash_area_open(HISTORY_PARTITION_ID, &fa);
+
+    if (ret < 0) {
+        return ret;
+    }
+    ret = flash_get_page_info_by_offs(flash_area_get_device(fa), fa->fa_off, &info);
+    if (ret < 0 || info.size < HISTORY_RECORD_SIZE) {
+        flash_area_close(fa);
+        return ret < 0 ? ret : -EINVAL;
+    }
+
+    page_size = info.size;
+    page_records = page_size / HISTORY_RECORD_SIZE;
+    capacity = (uint32_t)(fa->fa_size / page_size) * page_records;
+
+    /* Every intact record in its own slot belongs to the ring */
+    for (uint32_t slot = 0; slot < capacity; slot++) {
+        ret = flash_area_read(fa, slot_offset(slot), rec, sizeof(rec));
+        if (ret < 0) {
+            flash_area_close(fa);
+            return ret;
+        }
+        uint32_t index = telemetry_get_u32(&rec[HISTORY_RECORD_INDEX]);
+
+        if (history_record_check(rec) || index % capacity != slot) {
+            continue;
+        }
+        if (found == 0 || index < first_index) {
+            first_index = index;
+        }
+        if (found == 0 || index >= next_index) {
+            next_index = index + 1;
+        }
+        found++;
+    }
+
+    history_fa = fa;
+    printk("[HISTORY] - %u of %u records in use\n", found, capacity);
+    return 0;
+}
+
+int history_append(const struct telemetry_frame *f, uint32_t utc)
+{
+    uint8_t rec[HISTORY_RECORD_SIZE];
+    off_t off;
+    int ret;
+
+    if (history_fa == NULL) {
+        return -ENODEV;
+    }
+
+    k_mutex_lock(&history_lock, K_FOREVER);
+    for (;;) {
+        off = slot_offset(next_index);
+
+        /* Entering a page: erase it, dropping the oldest records */
+        if (next_index % capacity % page_records == 0) {
+            ret = flash_area_erase(history_fa, off, page_size);
+            if (ret < 0) {
+                k_mutex_unlock(&history_lock);
+                return ret;
+            }
+            if (next_index + page_records > capacity) {
+                first_index = MAX(first_index, next_index + page_records - capacity);
+            }
+            break;
+        }
+
+        /* A slot written by a torn record cannot be written again until its page is erased */
+        ret = flash_area_read(history_fa, off, rec, sizeof(rec));
+        if (ret < 0) {
+            k_mutex_unlock(&history_lock);
+            return ret;
+        }
+        bool erased = true;
+
+        for (size_t i = 0; i < sizeof(rec); i++) {
+            erased = erased && rec[i] == flash_area_erased_val(history_fa);
+        }
+        if (erased) {
+            break;
+        }
+        next_index++;
+    }
+
+    history_record_encode(rec, next_index, utc, f);
+    ret = flash_area_write(history_fa, off, rec, sizeof(rec));
+    if (ret == 0) {
+        next_index++;
+    }
+    k_mutex_unlock(&history_lock);
+    return ret;
+}
+
+int history_read(uint32_t index, uint8_t *buf, size_t count)
+{
+    int ret = 0;
+
+    if (history_fa == NULL) {
+        return -ENODEV;
+    }
+
+    k_mutex_lock(&history_lock, K_FOREVER);
+    if (index < first_index || index >= next_index) {
+        k_mutex_unlock(&history_lock);
+        return -ENOENT;
+    }
+
+    size_t n = MIN(count, next_index - index);
+
+    for (size_t i = 0; i < n && ret == 0; i++) {
+        ret = flash_area_read(history_fa, slot_offset(index + i), &buf[i * HISTORY_RECORD_SIZE],
+                              HISTORY_RECORD_SIZE);
+    }
+    k_mutex_unlock(&history_lock);
+    return ret < 0 ? ret : (int)n;
+}
+
+void history_range(uint32_t *first, uint32_t *next)
+{
+    k_mutex_lock(&history_lock, K_FOREVER);
+    *first = first_index;
+    *next = next_index;
+    k_mutex_unlock(&history_lock);
+}
+
+void history_print(void)
+{
+    uint32_t first, next;
+
+    if (history_fa == NULL) {
+        printk("[HISTORY] - Not available\n");
+        return;
+    }
+    history_range(&first, &next);
+    printk("[HISTORY] - %u of %u records stored, oldest %u, next %u\n",
+           next - first, capacity, first, next);
+}
+
+#else /* !DT_HAS_CHOSEN(plant_history_partition) */
+
+int history_init(void)
+{
+    return -ENOTSUP;
+}
+
+int history_append(const struct telemetry_frame *f, uint32_t utc)
+{
+    ARG_UNUSED(f);
+    ARG_UNUSED(utc);
+    return -ENODEV;
+}
+
+int history_read(uint32_t index, uint8_t *buf, size_t count)
+{
+    ARG_UNUSED(index);
+    ARG_UNUSED(buf);
+    ARG_UNUSED(count);
+    return -ENODEV;
+}
+
+void history_range(uint32_t *first, uint32_t *next)
+{
+    *first = 0;
+    *next = 0;
+}
+
+void history_print(void)
+{
+    printk("[HISTORY] - Not available\n");
+}
+
+#endif /* DT_HAS_CHOSEN(plant_history_partition) */
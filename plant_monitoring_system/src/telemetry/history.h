@@ -0,0 +1,66 @@
+/**
+ * @file history.h
+ * @brief Telemetry history kept in a flash ring, for bulk export.
+ *
+ * Every transmitted frame is appended to the partition chosen as
+ * @c plant,history-partition as one record (see export_protocol.h). Records
+ * are numbered from the first one ever written, and the number is part of
+ * the record: the ring is found again after a reset by scanning the
+ * partition, and an export resumes from any record number. When the
+ * partition is full the oldest flash page is erased, losing its records.
+ *
+ * A record torn by a reset fails its CRC; its slot is skipped.
+ */
+
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "telemetry/telemetry_frame.h"
+
+/**
+ * @brief Open the partition and find the oldest and next records.
+ *
+ * @retval 0 On success.
+ * @retval -ENOTSUP If the board has no history partition.
+ * @retval <0 Flash error.
+ */
+int history_init(void);
+
+/**
+ * @brief Append a frame.
+ *
+ * @param f Frame to store.
+ * @param utc UTC time of the sample (s), 0 if unknown.
+ * @retval 0 On success.
+ * @retval -ENODEV If the history is not initialized.
+ * @retval <0 Flash error.
+ */
+int history_append(const struct telemetry_frame *f, uint32_t utc);
+
+/**
+ * @brief Read consecutive records.
+ *
+ * @param index Index of the first record.
+ * @param buf Output, @p count records of @ref HISTORY_RECORD_SIZE bytes.
+ * @param count Records wanted.
+ * @return Records read (fewer at the end of the history), or a negative
+ *         error code: -ENOENT if @p index is no longer or not yet stored.
+ */
+int history_read(uint32_t index, uint8_t *buf, size_t count);
+
+/**
+ * @brief Stored range: records @p first to @p next - 1.
+ *
+ * @param first Output, oldest record.
+ * @param next Output, index of the next record to be written.
+ */
+void history_range(uint32_t *first, uint32_t *next);
+
+/**
+ * @brief Print the stored range and the capacity on one line.
+ */
+void history_print(void);
+
+#endif /* HISTORY_H */
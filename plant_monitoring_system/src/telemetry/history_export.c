@@ -0,0 +1,467 @@
+/**
+ * @file history_export.c
+ * @brief Export sessions: COBS packets, sliding window and baud switching.
+ */
+
+#include "history_export.h"
+#include "history.h"
+#include "telemetry/export_protocol.h"
+#include "update/dfu.h"
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/uart.h>
+#include <zephyr/sys/printk.h>
+#include <zephyr/sys/util.h>
+#include <errno.h>
+
+#if DT_HAS_CHOSEN(plant_export_uart)
+
+#define EXPORT_THREAD_STACK_SIZE 1024  /**< Stack of the export thread. */
+#define EXPORT_THREAD_PRIORITY   10    /**< Below the reporting pipeline. */
+#define EXPORT_RX_PACKETS 4            /**< Host packets waiting for the thread. */
+/** Longest host packet (UPDATE), encoded. */
+#define EXPORT_RX_MAX     EXPORT_COBS_MAX(EXPORT_UPDATE_HEADER + EXPORT_UPDATE_CHUNK + 2)
+#define EXPORT_POLL_MS    1            /**< Receive polling period on UARTs without interrupts. */
+
+/* Console output is dropped during sessions if the export UART is the console.
+ * With LOG_PRINTK, printk goes through the log and never reaches the hook, so
+ * the log backends are suspended too. */
+#if DT_HAS_CHOSEN(zephyr_console) && DT_SAME_NODE(DT_CHOSEN(zephyr_console), DT_CHOSEN(plant_export_uart))
+#if defined(CONFIG_PRINTK)
+#include <zephyr/sys/printk-hooks.h>
+#define EXPORT_MUTE_PRINTK 1
+#endif
+#if defined(CONFIG_LOG) && !defined(CONFIG_LOG_MODE_MINIMAL)
+#include <zephyr/logging/log_backend.h>
+#define EXPORT_MUTE_LOG 1
+#endif
+#endif
+
+K_THREAD_STACK_DEFINE(export_stack, EXPORT_THREAD_STACK_SIZE); /**< Export thread stack. */
+static struct k_thread export_thread_data;
+
+static const struct device *const export_dev = DEVICE_DT_GET(DT_CHOSEN(plant_export_uart));
+
+/** @brief One encoded host packet, as cut at its delimiter. */
+struct export_rx {
+    uint8_t len;
+    uint8_t data[EXPORT_RX_MAX];
+};
+
+K_MSGQ_DEFINE(export_rx_queue, sizeof(struct export_rx), EXPORT_RX_PACKETS, 1);
+
+static struct export_rx rx_cur;    /**< Packet being received. */
+static bool rx_overflow;           /**< @c rx_cur overflowed: drop it at the delimiter. */
+static bool rx_polled;             /**< The UART has no interrupt API. */
+static uint32_t link_baud;         /**< Baud rate between sessions. */
+
+/* Buffers of the export thread */
+static uint8_t tx_packet[EXPORT_MAX_PACKET];
+static uint8_t tx_encoded[EXPORT_COBS_MAX(EXPORT_MAX_PACKET) + 1];
+
+/** @brief Counters since boot. */
+static struct {
+    uint32_t sessions;
+    uint32_t records;       /**< Records sent, resends included. */
+    uint32_t resent;        /**< Records sent again after a timeout. */
+    uint32_t bad_packets;   /**< Host packets with a bad encoding or CRC. */
+} export_stats;
+
+#if defined(EXPORT_MUTE_PRINTK)
+static printk_hook_fn_t console_hook;
+
+/**
+ * @brief printk hook of a session: drops the character.
+ */
+static int export_console_drop(int c)
+{
+    return c;
+}
+#endif
+
+#if defined(EXPORT_MUTE_LOG)
+static uint32_t log_suspended;  /**< Backends deactivated by the session, one bit each. */
+#endif
+
+/**
+ * @brief Drop console output (@p mute) or restore it.
+ *
+ * The log backends active at the start of a session are deactivated, so
+ * their messages are dropped rather than interleaved with the packets.
+ */
+static void export_console_mute(bool mute)
+{
+#if defined(EXPORT_MUTE_LOG)
+    for (uint32_t i = 0; i < MIN(log_backend_count_get(), 32U); i++) {
+        const struct log_backend *backend = log_backend_get(i);
+
+        if (mute && log_backend_is_active(backend)) {
+            log_backend_deactivate(backend);
+            log_suspended |= BIT(i);
+        } else if (!mute && (log_suspended & BIT(i))) {
+            log_backend_activate(backend, backend->cb->ctx);
+        }
+    }
+    if (!mute) {
+        log_suspended = 0;
+    }
+#endif
+#if defined(EXPORT_MUTE_PRINTK)
+    if (mute) {
+        console_hook = __printk_get_hook();
+        __printk_hook_install(export_console_drop);
+    } else if (console_hook != NULL) {
+        __printk_hook_install(console_hook);
+    }
+#endif
+    ARG_UNUSED(mute);
+}
+
+/**
+ * @brief Cut received bytes into packets at the 0x00 delimiters.
+ *
+ * Called from the UART interrupt, or from the thread when polling.
+ */
+static void export_rx_byte(uint8_t c)
+{
+    if (c != 0) {
+        if (rx_cur.len < sizeof(rx_cur.data)) {
+            rx_cur.data[rx_cur.len++] = c;
+        } else {
+            rx_overflow = true;
+        }
+        return;
+    }
+    if (rx_cur.len > 0 && !rx_overflow) {
+        k_msgq_put(&export_rx_queue, &rx_cur, K_NO_WAIT);
+    }
+    rx_cur.len = 0;
+    rx_overflow = false;
+}
+
+/**
+ * @brief UART interrupt handler: feeds received bytes to the packet cutter.
+ */
+static void export_isr(const struct device *dev, void *user_data)
+{
+    uint8_t c;
+
+    ARG_UNUSED(user_data);
+    while (uart_irq_update(dev) && uart_irq_rx_ready(dev)) {
+        if (uart_fifo_read(dev, &c, 1) != 1) {
+            break;
+        }
+        export_rx_byte(c);
+    }
+}
+
+/**
+ * @brief Wait for the next valid host packet.
+ *
+ * @param pkt Output, at least @ref EXPORT_RX_MAX bytes.
+ * @param timeout How long to wait.
+ * @return Packet length without the CRC, or -EAGAIN on timeout.
+ */
+static int export_receive(uint8_t *pkt, k_timeout_t timeout)
+{
+    k_timepoint_t end = sys_timepoint_calc(timeout);
+    struct export_rx rx;
+
+    for (;;) {
+        if (rx_polled) {
+            unsigned char c;
+
+            while (uart_poll_in(export_dev, &c) == 0) {
+                export_rx_byte(c);
+            }
+        }
+        if (k_msgq_get(&export_rx_queue, &rx, rx_polled ? K_NO_WAIT : sys_timepoint_timeout(end)) == 0) {
+            int n = export_cobs_decode(rx.data, rx.len, pkt, EXPORT_RX_MAX);
+
+            n = (n < 0) ? n : export_packet_check(pkt, (size_t)n);
+            if (n > 0) {
+                return n;
+            }
+            export_stats.bad_packets++;
+            continue;
+        }
+        if (sys_timepoint_expired(end)) {
+            return -EAGAIN;
+        }
+        if (rx_polled) {
+            k_msleep(EXPORT_POLL_MS);
+        }
+    }
+}
+
+/**
+ * @brief Seal, encode and send @c tx_packet.
+ *
+ * @param len Bytes in @c tx_packet, without the CRC.
+ */
+static void export_send(size_t len)
+{
+    size_t n = export_cobs_encode(tx_packet, export_packet_seal(tx_packet, len), tx_encoded);
+
+    tx_encoded[n++] = 0;
+    for (size_t i = 0; i < n; i++) {
+        uart_poll_out(export_dev, tx_encoded[i]);
+    }
+}
+
+/**
+ * @brief Send a packet made of its type and one 32-bit field.
+ */
+static void export_send_u32(uint8_t type, uint32_t value)
+{
+    tx_packet[0] = type;
+    telemetry_put_u32(&tx_packet[1], value);
+    export_send(5);
+}
+
+/**
+ * @brief Change the baud rate of the link.
+ *
+ * @retval 0 On success (or if it is already at @p baud).
+ * @retval <0 If the UART cannot be reconfigured.
+ */
+static int export_set_baud(uint32_t baud)
+{
+    struct uart_config cfg;
+    int ret = uart_config_get(export_dev, &cfg);
+
+    if (ret == 0 && cfg.baudrate != baud) {
+        cfg.baudrate = baud;
+        ret = uart_configure(export_dev, &cfg);
+    }
+    return ret;
+}
+
+/**
+ * @brief Send INFO: the stored range and the session parameters.
+ *
+ * @param baud Baud rate of the session.
+ */
+static void export_send_info(uint32_t baud)
+{
+    uint32_t first, next;
+
+    history_range(&first, &next);
+    tx_packet[0] = EXPORT_INFO;
+    telemetry_put_u32(&tx_packet[1], first);
+    telemetry_put_u32(&tx_packet[5], next);
+    telemetry_put_u16(&tx_packet[9], HISTORY_RECORD_SIZE);
+    tx_packet[11] = EXPORT_RECORDS;
+    tx_packet[12] = EXPORT_WINDOW;
+    telemetry_put_u32(&tx_packet[13], baud);
+    export_send(EXPORT_INFO_SIZE);
+}
+
+/**
+ * @brief Answer a HELLO and switch to the baud rate agreed in INFO.
+ *
+ * The requested rate is applied once and the link rate restored before
+ * INFO is sent, so INFO only promises a rate the UART accepted.
+ *
+ * @param baud Baud rate asked for by the host, 0 to keep the current one.
+ * @return Baud rate of the session.
+ */
+static uint32_t export_hello(uint32_t baud)
+{
+    int ret = (baud == 0) ? -EINVAL : export_set_baud(baud);
+
+    if (export_set_baud(link_baud) != 0 || ret != 0) {
+        baud = link_baud;
+    }
+    export_send_info(baud);
+
+    /* Let the last byte leave at the old rate */
+    k_msleep(EXPORT_SWITCH_MS);
+    if (export_set_baud(baud) != 0) {
+        /* The host times out at the promised rate and says HELLO again */
+        baud = link_baud;
+        export_set_baud(baud);
+    }
+    return baud;
+}
+
+/**
+ * @brief Serve one session, after its first HELLO.
+ *
+ * @param pkt Packet buffer, holding the HELLO.
+ * @retval true If it ended with a new HELLO (the host restarted).
+ * @retval false If it ended with END or by timeout.
+ */
+static bool export_session(uint8_t *pkt)
+{
+    uint32_t first, base = 0, sent = 0, end = 0, baud;
+    bool reading = false;
+    bool done_sent = false;
+    bool hello = false;
+    uint8_t round = 0;
+    int64_t rx_at = k_uptime_get();
+    int64_t progress_at = rx_at;
+
+    baud = export_hello(telemetry_get_u32(&pkt[1]));
+
+    for (;;) {
+        bool can_send = reading && sent < end && sent - base < EXPORT_WINDOW * EXPORT_RECORDS;
+        int n = export_receive(pkt, can_send ? K_NO_WAIT : K_MSEC(EXPORT_POLL_MS * 10));
+        int64_t now = k_uptime_get();
+
+        if (n > 0) {
+            rx_at = now;
+        }
+        if (n >= 5 && pkt[0] == EXPORT_HELLO) {
+            hello = true;
+            break;
+        } else if (n >= 5 && pkt[0] == EXPORT_READ) {
+            history_range(&first, &end);
+            base = sent = MAX(telemetry_get_u32(&pkt[1]), first);
+            reading = true;
+            done_sent = false;
+            round++;
+            progress_at = now;
+        } else if (n >= 5 && pkt[0] == EXPORT_ACK && reading) {
+            uint32_t acked = telemetry_get_u32(&pkt[1]);
+
+            if (acked > base && acked <= sent) {
+                base = acked;
+                progress_at = now;
+            } else if (acked == base && base < sent && n >= 6 && pkt[5] == round) {
+                /* A packet of this round was lost and the host discards the next ones */
+                export_stats.resent += sent - base;
+                sent = base;
+                round++;
+                progress_at = now;
+            } else if (acked == end) {
+                done_sent = false;  /* The host missed DONE */
+            }
+        } else if (n >= EXPORT_UPDATE_HEADER && pkt[0] == EXPORT_UPDATE) {
+            int status = dfu_patch_write(telemetry_get_u32(&pkt[1]), &pkt[EXPORT_UPDATE_HEADER],
+                                         n - EXPORT_UPDATE_HEADER);
+
+            tx_packet[0] = EXPORT_UPDATE_ACK;
+            telemetry_put_u32(&tx_packet[1], dfu_patch_next());
+            tx_packet[5] = (uint8_t)(int8_t)status;
+            telemetry_put_u32(&tx_packet[6], dfu_apply_ms());
+            export_send(EXPORT_UPDATE_ACK_SIZE);
+        } else if (n >= 1 && pkt[0] == EXPORT_END) {
+            tx_packet[0] = EXPORT_BYE;
+            export_send(1);
+            break;
+        }
+
+        if (now - rx_at > EXPORT_IDLE_MS) {
+            break;
+        }
+        if (!reading) {
+            continue;
+        }
+
+        if (sent < end && sent - base < EXPORT_WINDOW * EXPORT_RECORDS) {
+            int count = history_read(sent, &tx_packet[EXPORT_DATA_HEADER], MIN(EXPORT_RECORDS, end - sent));
+
+            if (count == -ENOENT) {
+                /* Overwritten since READ: tell the host, which reads again */
+                export_send_info(baud);
+                reading = false;
+                continue;
+            }
+            if (count <= 0) {
+                break;
+            }
+            tx_packet[0] = EXPORT_DATA;
+            telemetry_put_u32(&tx_packet[1], sent);
+            tx_packet[5] = (uint8_t)count;
+            tx_packet[6] = round;
+            export_send(EXPORT_DATA_HEADER + count * HISTORY_RECORD_SIZE);
+            sent += count;
+            export_stats.records += count;
+        } else if (base == end && !done_sent) {
+            export_send_u32(EXPORT_DONE, end);
+            done_sent = true;
+        } else if (base < end && now - progress_at > EXPORT_RTO_MS) {
+            /* Go back to the first record not acknowledged */
+            export_stats.resent += sent - base;
+            sent = base;
+            round++;
+            progress_at = now;
+        }
+    }
+
+    export_set_baud(link_baud);
+    return hello;
+}
+
+/**
+ * @brief Export thread: waits for a HELLO, then serves sessions.
+ */
+static void export_thread_fn(void *p1, void *p2, void *p3)
+{
+    static uint8_t pkt[EXPORT_RX_MAX];
+
+    ARG_UNUSED(p1);
+    ARG_UNUSED(p2);
+    ARG_UNUSED(p3);
+
+    for (;;) {
+        int n = export_receive(pkt, K_FOREVER);
+
+        if (n < 5 || pkt[0] != EXPORT_HELLO) {
+            continue;
+        }
+
+        export_console_mute(true);
+        export_stats.sessions++;
+        while (export_session(pkt)) {
+        }
+        export_console_mute(false);
+        history_export_print();
+        dfu_reboot();
+    }
+}
+
+int history_export_start(void)
+{
+    struct uart_config cfg;
+
+    if (!device_is_ready(export_dev)) {
+        return -ENODEV;
+    }
+
+    link_baud = (uart_config_get(export_dev, &cfg) == 0 && cfg.baudrate > 0) ? cfg.baudrate
+                                                                             : EXPORT_DEFAULT_BAUD;
+    if (uart_irq_callback_set(export_dev, export_isr) == 0) {
+        uart_irq_rx_enable(export_dev);
+    } else {
+        rx_polled = true;
+    }
+
+    k_thread_create(&export_thread_data, export_stack, K_THREAD_STACK_SIZEOF(export_stack),
+                    export_thread_fn, NULL, NULL, NULL, EXPORT_THREAD_PRIORITY, 0, K_NO_WAIT);
+    k_thread_name_set(&export_thread_data, "export_thread");
+    return 0;
+}
+
+void history_export_print(void)
+{
+    printk("[EXPORT] - %u session(s), %u records sent, %u resent, %u bad packets (link %u baud)\n",
+           export_stats.sessions, export_stats.records, export_stats.resent,
+           export_stats.bad_packets, link_baud);
+}
+
+#else /* !DT_HAS_CHOSEN(plant_export_uart) */
+
+int history_export_start(void)
+{
+    return -ENOTSUP;
+}
+
+void history_export_print(void)
+{
+    printk("[EXPORT] - Not available\n");
+}
+
+#endif /* DT_HAS_CHOSEN(plant_export_uart) */
@@ -0,0 +1,41 @@
+/**
+ * @file history_export.h
+ * @brief Bulk export of the telemetry history over a UART.
+ *
+ * A thread serves the protocol of export_protocol.h on the UART chosen as
+ * @c plant,export-uart (the console on the Nucleo, a pseudo-terminal on
+ * native_sim). Between sessions the UART keeps its configured baud rate
+ * and anything but a HELLO packet is ignored, so console input does no
+ * harm. During a session:
+ *
+ * - the link runs at the baud rate the host asked for, if the UART
+ *   accepts it, and goes back when the session ends or the host has been
+ *   silent for @ref EXPORT_IDLE_MS;
+ * - console output is dropped if the UART is the console, since it would
+ *   only corrupt packets.
+ *
+ * Sessions also carry firmware patches (update/dfu.h); the node reboots
+ * into a new image once the session that completed it is over.
+ *
+ * The host client is @c plant_tsdb @c export, or @c plant_tsdb @c update
+ * for patches (tools/tsdb).
+ */
+
+#ifndef HISTORY_EXPORT_H
+#define HISTORY_EXPORT_H
+
+/**
+ * @brief Start the export thread.
+ *
+ * @retval 0 On success.
+ * @retval -ENOTSUP If the board has no export UART.
+ * @retval -ENODEV If the UART is not ready.
+ */
+int history_export_start(void);
+
+/**
+ * @brief Print the export counters on one line.
+ */
+void history_export_print(void);
+
+#endif /* HISTORY_EXPORT_H */
@@ -0,0 +1,68 @@
+/**
+ * @file tdma.c
+ * @brief Slot and report cycle selection from the node ID and UTC.
+ */
+
+#include "tdma.h"
+
+/**
+ * @brief Mix the bits of a 32-bit value (lowbias32 finalizer).
+ *
+ * Consecutive node IDs and superframe numbers land on unrelated slots.
+ */
+static uint32_t tdma_hash(uint32_t x)
+{
+    x ^= x >> 16;
+    x *= 0x7feb352dU;
+    x ^= x >> 15;
+    x *= 0x846ca68bU;
+    x ^= x >> 16;
+    return x;
+}
+
+/**
+ * @brief @p a modulo @p m, in [0, m) for negative @p a as well.
+ */
+static uint32_t tdma_mod(int64_t a, uint32_t m)
+{
+    int64_t r = a % m;
+
+    return (uint32_t)(r < 0 ? r + m : r);
+}
+
+void tdma_init(struct tdma *t, const struct tdma_config *cfg, uint32_t node_id)
+{
+    uint32_t slots = cfg->cycle_ms / cfg->slot_ms;
+
+    t->cfg = cfg;
+    t->node_id = node_id;
+    t->offset_ms = (tdma_hash(node_id) % slots) * cfg->slot_ms;
+}
+
+uint32_t tdma_until_cycle(const struct tdma *t, int64_t utc_ms)
+{
+    return tdma_mod((int64_t)t->offset_ms - t->cfg->lead_ms - utc_ms, t->cfg->cycle_ms);
+}
+
+int32_t tdma_until_slot(const struct tdma *t, int64_t utc_ms)
+{
+    uint32_t until = tdma_mod((int64_t)t->offset_ms - utc_ms, t->cfg->cycle_ms);
+
+    /* Further than the acquisition time: the slot of this cycle has passed */
+    if (until > t->cfg->lead_ms) {
+        return (int32_t)until - (int32_t)t->cfg->cycle_ms;
+    }
+    return (int32_t)until;
+}
+
+bool tdma_report_cycle(const struct tdma *t, int64_t slot_utc_ms, uint32_t cycles)
+{
+    if (cycles <= 1) {
+        return true;
+    }
+
+    int64_t cycle = slot_utc_ms / t->cfg->cycle_ms;
+    uint32_t superframe = (uint32_t)(cycle / cycles);
+
+    return (uint32_t)(cycle % cycles) == tdma_hash(t->node_id ^ tdma_hash(superframe)) % cycles;
+}
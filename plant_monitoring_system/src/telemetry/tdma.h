@@ -0,0 +1,93 @@
+/**
+ * @file tdma.h
+ * @brief Uplink slots derived from GPS time, for dense deployments.
+ *
+ * Nodes that sample on their own timers transmit at random instants with
+ * respect to each other (pure ALOHA): a frame is lost if another one starts
+ * within one time on air before or after it. Nodes that share UTC from
+ * their GPS can instead transmit at slot boundaries, which shrinks that
+ * window from two times on air to one slot, and can spread their
+ * transmissions over the slots without any coordination by deriving them
+ * from their node ID:
+ *
+ * - every measurement cycle of @c cycle_ms (aligned on UTC multiples of
+ *   it) holds @c cycle_ms / @c slot_ms slots; a node always uses the same
+ *   one, picked by a hash of its ID;
+ * - routine reports are sent once per superframe of N cycles, in a cycle
+ *   picked by a hash of the node ID and the superframe number, so two nodes
+ *   sharing a slot only meet in one superframe out of N on average instead
+ *   of in all of them.
+ *
+ * The measurement cycle starts @c lead_ms before the slot, so the data is
+ * acquired just before it is sent.
+ *
+ * The time error of every node (the latency of the NMEA sentence that
+ * carries the UTC second, the drift of the MCU clock since the last fix)
+ * must fit in the guard time the slot leaves after the frame. The sentence
+ * latency is the same for identical GPS modules and cancels out.
+ *
+ * Pure computation: no hardware access, no locking.
+ */
+
+#ifndef TDMA_H
+#define TDMA_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Slot structure, the same on every node.
+ */
+struct tdma_config {
+    uint32_t cycle_ms;  /**< Measurement cycle, a multiple of @c slot_ms. */
+    uint32_t slot_ms;   /**< Slot length: time on air of a frame plus the guard time. */
+    uint32_t lead_ms;   /**< Acquisition time, between the start of a cycle and its slot. */
+};
+
+/**
+ * @brief Slot of one node.
+ */
+struct tdma {
+    const struct tdma_config *cfg;  /**< Configuration. */
+    uint32_t node_id;               /**< Node identifier. */
+    uint32_t offset_ms;             /**< Start of the node's slot within each cycle. */
+};
+
+/**
+ * @brief Pick the slot of a node.
+ *
+ * @param t Slot state to initialize.
+ * @param cfg Configuration; must stay valid.
+ * @param node_id Node identifier.
+ */
+void tdma_init(struct tdma *t, const struct tdma_config *cfg, uint32_t node_id);
+
+/**
+ * @brief Time until the next measurement cycle starts.
+ *
+ * @param t Slot state.
+ * @param utc_ms Current UTC time (ms since 1970-01-01).
+ * @return Delay in ms, less than one cycle.
+ */
+uint32_t tdma_until_cycle(const struct tdma *t, int64_t utc_ms);
+
+/**
+ * @brief Time until the slot of the cycle in progress.
+ *
+ * @param t Slot state.
+ * @param utc_ms Current UTC time (ms since 1970-01-01).
+ * @return Delay in ms, at most @c lead_ms; negative if the slot has passed
+ *         (the cycle started late or was not aligned yet).
+ */
+int32_t tdma_until_slot(const struct tdma *t, int64_t utc_ms);
+
+/**
+ * @brief Whether a cycle carries the node's routine report.
+ *
+ * @param t Slot state.
+ * @param slot_utc_ms UTC time of the cycle's slot.
+ * @param cycles Cycles per superframe (one routine report each).
+ */
+bool tdma_report_cycle(const struct tdma *t, int64_t slot_utc_ms, uint32_t cycles);
+
+#endif /* TDMA_H */
@@ -0,0 +1,237 @@
+/**
+ * @file telemetry_frame.h
+ * @brief Binary telemetry frame shared by the firmware and the host tools.
+ *
+ * A frame is a fixed-size, little-endian snapshot of @ref system_measurement
+ * plus node identity, a sequence number and a CRC-16/CCITT-FALSE trailer.
+ * Values keep the scaled integer representation used by the firmware, so
+ * no floating point is involved on either side.
+ *
+ * The header only depends on the C standard library so that it can be
+ * included unchanged by the Zephyr application and by the Linux tools in
+ * @c tools/.
+ *
+ * | Offset | Size | Field        | Unit / scale              |
+ * |-------:|-----:|--------------|---------------------------|
+ * |      0 |    2 | magic        | @ref TELEMETRY_MAGIC      |
+ * |      2 |    1 | version      | @ref TELEMETRY_VERSION    |
+ * |      3 |    1 | mode         | system_mode_t             |
+ * |      4 |    4 | node_id      |                           |
+ * |      8 |    4 | seq          | increments per frame      |
+ * |     12 |    4 | uptime_ms    | ms since boot             |
+ * |     16 |    2 | brightness   | % ×10                     |
+ * |     18 |    2 | moisture     | % ×10                     |
+ * |     20 |    2 | temp         | °C ×100                   |
+ * |     22 |    2 | hum          | %RH ×100                  |
+ * |     24 |    8 | red..clear   | raw counts                |
+ * |     32 |    6 | accel x/y/z  | m/s² ×100                 |
+ * |     38 |    4 | gps_lat      | degrees ×1e6              |
+ * |     42 |    4 | gps_lon      | degrees ×1e6              |
+ * |     46 |    4 | gps_alt      | m ×100                    |
+ * |     50 |    4 | gps_time     | UTC hhmmss, -1 if unknown |
+ * |     54 |    1 | gps_sats     |                           |
+ * |     55 |    1 | health       | plant_health_t            |
+ * |     56 |    1 | health_conf  | %                         |
+ * |     57 |    1 | reserved     | 0                         |
+ * |     58 |    2 | anomaly      | ANOMALY_* flags           |
+ * |     60 |    2 | crc          | CRC-16 of bytes 0..59     |
+ */
+
+#ifndef TELEMETRY_FRAME_H
+#define TELEMETRY_FRAME_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <errno.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TELEMETRY_MAGIC       0x5450  /**< "PT" in little-endian order. */
+#define TELEMETRY_VERSION     1       /**< Frame layout version. */
+#define TELEMETRY_FRAME_SIZE  62      /**< Encoded frame size in bytes. */
+#define TELEMETRY_CRC_OFFSET  (TELEMETRY_FRAME_SIZE - 2) /**< Offset of the CRC trailer. */
+
+/**
+ * @brief Decoded telemetry frame.
+ */
+struct telemetry_frame {
+    uint8_t  mode;         /**< Operating mode when the frame was built. */
+    uint32_t node_id;      /**< Node identifier. */
+    uint32_t seq;          /**< Frame sequence number. */
+    uint32_t uptime_ms;    /**< Node uptime (ms). */
+
+    int16_t  brightness;   /**< Ambient brightness (% ×10). */
+    int16_t  moisture;     /**< Soil moisture (% ×10). */
+    int16_t  temp;         /**< Temperature (°C ×100). */
+    int16_t  hum;          /**< Relative humidity (%RH ×100). */
+
+    uint16_t red;          /**< Red channel (raw). */
+    uint16_t green;        /**< Green channel (raw). */
+    uint16_t blue;         /**< Blue channel (raw). */
+    uint16_t clear;        /**< Clear channel (raw). */
+
+    int16_t  accel_x;      /**< X-axis acceleration (m/s² ×100). */
+    int16_t  accel_y;      /**< Y-axis acceleration (m/s² ×100). */
+    int16_t  accel_z;      /**< Z-axis acceleration (m/s² ×100). */
+
+    int32_t  gps_lat;      /**< Latitude (degrees ×1e6). */
+    int32_t  gps_lon;      /**< Longitude (degrees ×1e6). */
+    int32_t  gps_alt;      /**< Altitude (m ×100). */
+    int32_t  gps_time;     /**< UTC time of day as hhmmss (last fix plus uptime), -1 if unknown. */
+    uint8_t  gps_sats;     /**< Satellites in use. */
+
+    uint8_t  health;       /**< Plant health class. */
+    uint8_t  health_conf;  /**< Plant health confidence (%). */
+    uint16_t anomaly;      /**< Anomaly flags. */
+};
+
+/**
+ * @brief Compute CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF).
+ *
+ * Bitwise implementation, so no lookup table is needed in flash.
+ *
+ * @param data Input bytes.
+ * @param len Number of bytes.
+ * @return CRC value.
+ */
+static inline uint16_t telemetry_crc16(const uint8_t *data, size_t len)
+{
+    uint16_t crc = 0xFFFF;
+
+    for (size_t i = 0; i < len; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int b = 0; b < 8; b++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+static inline void telemetry_put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static inline void telemetry_put_u32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static inline uint16_t telemetry_get_u16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t telemetry_get_u32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/**
+ * @brief Extract the node identifier without decoding the whole frame.
+ *
+ * Used by receivers to shard frames before validation.
+ *
+ * @param buf Encoded frame (at least 8 bytes).
+ * @return Node identifier.
+ */
+static inline uint32_t telemetry_peek_node(const uint8_t *buf)
+{
+    return telemetry_get_u32(&buf[4]);
+}
+
+/**
+ * @brief Encode a frame and append its CRC.
+ *
+ * @param f Frame to encode.
+ * @param buf Output buffer of @ref TELEMETRY_FRAME_SIZE bytes.
+ */
+static inline void telemetry_encode(const struct telemetry_frame *f, uint8_t *buf)
+{
+    telemetry_put_u16(&buf[0], TELEMETRY_MAGIC);
+    buf[2] = TELEMETRY_VERSION;
+    buf[3] = f->mode;
+    telemetry_put_u32(&buf[4], f->node_id);
+    telemetry_put_u32(&buf[8], f->seq);
+    telemetry_put_u32(&buf[12], f->uptime_ms);
+    telemetry_put_u16(&buf[16], (uint16_t)f->brightness);
+    telemetry_put_u16(&buf[18], (uint16_t)f->moisture);
+    telemetry_put_u16(&buf[20], (uint16_t)f->temp);
+    telemetry_put_u16(&buf[22], (uint16_t)f->hum);
+    telemetry_put_u16(&buf[24], f->red);
+    telemetry_put_u16(&buf[26], f->green);
+    telemetry_put_u16(&buf[28], f->blue);
+    telemetry_put_u16(&buf[30], f->clear);
+    telemetry_put_u16(&buf[32], (uint16_t)f->accel_x);
+    telemetry_put_u16(&buf[34], (uint16_t)f->accel_y);
+    telemetry_put_u16(&buf[36], (uint16_t)f->accel_z);
+    telemetry_put_u32(&buf[38], (uint32_t)f->gps_lat);
+    telemetry_put_u32(&buf[42], (uint32_t)f->gps_lon);
+    telemetry_put_u32(&buf[46], (uint32_t)f->gps_alt);
+    telemetry_put_u32(&buf[50], (uint32_t)f->gps_time);
+    buf[54] = f->gps_sats;
+    buf[55] = f->health;
+    buf[56] = f->health_conf;
+    buf[57] = 0;
+    telemetry_put_u16(&buf[58], f->anomaly);
+    telemetry_put_u16(&buf[TELEMETRY_CRC_OFFSET], telemetry_crc16(buf, TELEMETRY_CRC_OFFSET));
+}
+
+/**
+ * @brief Validate and decode a frame.
+ *
+ * @param buf Encoded frame.
+ * @param len Number of bytes in @p buf.
+ * @param f Output frame.
+ * @retval 0 On success.
+ * @retval -EINVAL Wrong length, magic or version.
+ * @retval -EBADMSG CRC mismatch.
+ */
+static inline int telemetry_decode(const uint8_t *buf, size_t len, struct telemetry_frame *f)
+{
+    if (len != TELEMETRY_FRAME_SIZE ||
+        telemetry_get_u16(&buf[0]) != TELEMETRY_MAGIC ||
+        buf[2] != TELEMETRY_VERSION) {
+        return -EINVAL;
+    }
+    if (telemetry_get_u16(&buf[TELEMETRY_CRC_OFFSET]) != telemetry_crc16(buf, TELEMETRY_CRC_OFFSET)) {
+        return -EBADMSG;
+    }
+
+    f->mode        = buf[3];
+    f->node_id     = telemetry_get_u32(&buf[4]);
+    f->seq         = telemetry_get_u32(&buf[8]);
+    f->uptime_ms   = telemetry_get_u32(&buf[12]);
+    f->brightness  = (int16_t)telemetry_get_u16(&buf[16]);
+    f->moisture    = (int16_t)telemetry_get_u16(&buf[18]);
+    f->temp        = (int16_t)telemetry_get_u16(&buf[20]);
+    f->hum         = (int16_t)telemetry_get_u16(&buf[22]);
+    f->red         = telemetry_get_u16(&buf[24]);
+    f->green       = telemetry_get_u16(&buf[26]);
+    f->blue        = telemetry_get_u16(&buf[28]);
+    f->clear       = telemetry_get_u16(&buf[30]);
+    f->accel_x     = (int16_t)telemetry_get_u16(&buf[32]);
+    f->accel_y     = (int16_t)telemetry_get_u16(&buf[34]);
+    f->accel_z     = (int16_t)telemetry_get_u16(&buf[36]);
+    f->gps_lat     = (int32_t)telemetry_get_u32(&buf[38]);
+    f->gps_lon     = (int32_t)telemetry_get_u32(&buf[42]);
+    f->gps_alt     = (int32_t)telemetry_get_u32(&buf[46]);
+    f->gps_time    = (int32_t)telemetry_get_u32(&buf[50]);
+    f->gps_sats    = buf[54];
+    f->health      = buf[55];
+    f->health_conf = buf[56];
+    f->anomaly     = telemetry_get_u16(&buf[58]);
+    return 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TELEMETRY_FRAME_H */
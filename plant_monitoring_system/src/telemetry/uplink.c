@@ -0,0 +1,89 @@
+/**
+ * @file uplink.c
+ * @brief Telemetry uplink implementation.
+ *
+ * The frame is hex-encoded into a single buffer and printed with one
+ * printk call, so lines from other threads cannot interleave with it.
+ */
+
+#include "uplink.h"
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+
+#if defined(CONFIG_HWINFO)
+#include <zephyr/drivers/hwinfo.h>
+#endif
+
+void uplink_init(struct uplink *up, uint32_t node_id)
+{
+    up->node_id = node_id;
+    up->seq = 0;
+
+    printk("[UPLINK] - Node ID 0x%08X\n", (unsigned int)node_id);
+}
+
+uint32_t uplink_hw_node_id(void)
+{
+#if defined(CONFIG_HWINFO)
+    uint8_t id[16];
+    ssize_t len = hwinfo_get_device_id(id, sizeof(id));
+
+    if (len > 0) {
+        /* FNV-1a over the unique ID bytes */
+        uint32_t hash = 2166136261u;
+        for (ssize_t i = 0; i < len; i++) {
+            hash = (hash ^ id[i]) * 16777619u;
+        }
+        return hash;
+    }
+#endif
+    return 0;
+}
+
+void uplink_build(struct uplink *up, struct system_measurement *measure, uint8_t mode,
+                  const struct plant_result *health, uint32_t anomaly, struct telemetry_frame *f)
+{
+    *f = (struct telemetry_frame){
+        .mode = mode,
+        .node_id = up->node_id,
+        .seq = up->seq++,
+        .uptime_ms = k_uptime_get_32(),
+        .brightness = (int16_t)atomic_get(&measure->brightness),
+        .moisture = (int16_t)atomic_get(&measure->moisture),
+        .temp = (int16_t)atomic_get(&measure->temp),
+        .hum = (int16_t)atomic_get(&measure->hum),
+        .red = (uint16_t)atomic_get(&measure->red),
+        .green = (uint16_t)atomic_get(&measure->green),
+        .blue = (uint16_t)atomic_get(&measure->blue),
+        .clear = (uint16_t)atomic_get(&measure->clear),
+        .accel_x = (int16_t)atomic_get(&measure->accel_x_g),
+        .accel_y = (int16_t)atomic_get(&measure->accel_y_g),
+        .accel_z = (int16_t)atomic_get(&measure->accel_z_g),
+        .gps_lat = (int32_t)atomic_get(&measure->gps_lat),
+        .gps_lon = (int32_t)atomic_get(&measure->gps_lon),
+        .gps_alt = (int32_t)atomic_get(&measure->gps_alt),
+        .gps_time = (int32_t)atomic_get(&measure->gps_time),
+        .gps_sats = (uint8_t)atomic_get(&measure->gps_sats),
+        .health = (uint8_t)health->health,
+        .health_conf = health->confidence,
+        .anomaly = (uint16_t)anomaly,
+    };
+}
+
+int uplink_transmit(const struct telemetry_frame *f)
+{
+    static const char digits[] = "0123456789abcdef";
+    uint8_t buf[TELEMETRY_FRAME_SIZE];
+    char hex[2 * TELEMETRY_FRAME_SIZE + 1];
+
+    telemetry_encode(f, buf);
+
+    for (size_t i = 0; i < sizeof(buf); i++) {
+        hex[2 * i] = digits[buf[i] >> 4];
+        hex[2 * i + 1] = digits[buf[i] & 0x0F];
+    }
+    hex[sizeof(hex) - 1] = '\0';
+
+    printk(UPLINK_PREFIX "%s\n", hex);
+    return 0;
+}
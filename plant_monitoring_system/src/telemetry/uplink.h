@@ -0,0 +1,68 @@
+/**
+ * @file uplink.h
+ * @brief Telemetry uplink of the Plant Monitoring System.
+ *
+ * Packs the shared measurements into a @ref telemetry_frame and emits it
+ * on the console as a `@TLM <hex>` line, the format consumed by the
+ * gateway's serial source and by the fleet simulator.
+ */
+
+#ifndef UPLINK_H
+#define UPLINK_H
+
+#include <stdint.h>
+#include "main.h"
+#include "analysis/plant_model.h"
+#include "telemetry/telemetry_frame.h"
+
+#define UPLINK_PREFIX "@TLM "  /**< Console line prefix of an uplink frame. */
+
+/**
+ * @struct uplink
+ * @brief Uplink state.
+ */
+struct uplink {
+    uint32_t node_id;  /**< Node identifier stamped into every frame. */
+    uint32_t seq;      /**< Sequence number of the next frame. */
+};
+
+/**
+ * @brief Initialize the uplink.
+ *
+ * @param up Pointer to the uplink state.
+ * @param node_id Node identifier.
+ */
+void uplink_init(struct uplink *up, uint32_t node_id);
+
+/**
+ * @brief Derive a node identifier from the MCU unique device ID.
+ *
+ * @return 32-bit hash of the device ID, or 0 if it is not available.
+ */
+uint32_t uplink_hw_node_id(void);
+
+/**
+ * @brief Build one telemetry frame from the shared measurements.
+ *
+ * Stamps the node ID, the next sequence number and the current uptime, so
+ * the frame describes the moment of acquisition even if it is sent later.
+ *
+ * @param up Pointer to the uplink state.
+ * @param measure Pointer to the shared measurements.
+ * @param mode Current operating mode.
+ * @param health Latest plant health classification.
+ * @param anomaly Bitmask of @c ANOMALY_* flags raised by this sample.
+ * @param f Output frame.
+ */
+void uplink_build(struct uplink *up, struct system_measurement *measure, uint8_t mode,
+                  const struct plant_result *health, uint32_t anomaly, struct telemetry_frame *f);
+
+/**
+ * @brief Encode and send one telemetry frame.
+ *
+ * @param f Frame built by @ref uplink_build.
+ * @return 0 on success.
+ */
+int uplink_transmit(const struct telemetry_frame *f);
+
+#endif /* UPLINK_H */
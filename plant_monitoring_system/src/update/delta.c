@@ -0,0 +1,290 @@
+/**
+ * @file delta.c
+ * @brief Streaming decoder of firmware delta patches.
+ */
+
+#include "delta.h"
+#include <zephyr/sys/crc.h>
+#include <zephyr/sys/util.h>
+#include <errno.h>
+#include <string.h>
+
+/** @brief What the next decompressed byte is. */
+enum delta_state {
+    DELTA_DIFF_LEN,     /**< Varint: length of the diff data. */
+    DELTA_EXTRA_LEN,    /**< Varint: length of the extra data. */
+    DELTA_SEEK,         /**< Zigzag varint: move of the source position. */
+    DELTA_DIFF,         /**< Diff data. */
+    DELTA_EXTRA,        /**< Extra data. */
+    DELTA_DONE,         /**< Target complete. */
+};
+
+#define DELTA_LZ_LONG 31  /**< Length field of a match with a third byte. */
+
+static uint32_t get_u32(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/**
+ * @brief Record the first error; every later call returns it.
+ */
+static int delta_fail(struct delta *d, int err)
+{
+    if (d->error == 0) {
+        d->error = err;
+    }
+    return d->error;
+}
+
+/**
+ * @brief Parse the header and let the caller check it.
+ */
+static int delta_parse_header(struct delta *d)
+{
+    if (get_u32(&d->head[0]) != DELTA_MAGIC || d->head[4] != DELTA_VERSION) {
+        return -EINVAL;
+    }
+    d->hdr.source_size = get_u32(&d->head[8]);
+    d->hdr.source_crc = get_u32(&d->head[12]);
+    d->hdr.target_size = get_u32(&d->head[16]);
+    d->hdr.target_crc = get_u32(&d->head[20]);
+    if (d->hdr.target_size == 0) {
+        return -EINVAL;
+    }
+    return d->io->begin != NULL ? d->io->begin(d->io->user, &d->hdr) : 0;
+}
+
+/**
+ * @brief Write the buffered target bytes.
+ */
+static int delta_flush(struct delta *d)
+{
+    int ret = 0;
+
+    if (d->out_len > 0) {
+        d->out_crc = crc32_ieee_update(d->out_crc, d->out_buf, d->out_len);
+        ret = d->io->write(d->io->user, d->out_buf, d->out_len);
+        d->out_len = 0;
+    }
+    return ret;
+}
+
+/**
+ * @brief Append one target byte.
+ */
+static int delta_output(struct delta *d, uint8_t c)
+{
+    if (d->out_pos >= d->hdr.target_size) {
+        return -EBADMSG;
+    }
+    d->out_buf[d->out_len++] = c;
+    d->out_pos++;
+    if (d->out_pos == d->hdr.target_size) {
+        d->state = DELTA_DONE;
+    }
+    return d->out_len == sizeof(d->out_buf) ? delta_flush(d) : 0;
+}
+
+/**
+ * @brief Source byte at the current source position.
+ */
+static int delta_source(struct delta *d, uint8_t *c)
+{
+    if (d->src_pos < 0 || d->src_pos >= d->hdr.source_size) {
+        return -EBADMSG;
+    }
+
+    uint32_t pos = (uint32_t)d->src_pos;
+
+    if (pos < d->src_buf_off || pos >= d->src_buf_off + d->src_buf_len) {
+        uint32_t len = MIN(sizeof(d->src_buf), d->hdr.source_size - pos);
+        int ret = d->io->read(d->io->user, pos, d->src_buf, len);
+
+        if (ret < 0) {
+            return ret;
+        }
+        d->src_buf_off = pos;
+        d->src_buf_len = len;
+    }
+    *c = d->src_buf[pos - d->src_buf_off];
+    return 0;
+}
+
+/**
+ * @brief Move to the data of the entry whose fields were just decoded, or
+ *        to the next entry.
+ */
+static void delta_next_data(struct delta *d)
+{
+    if (d->state == DELTA_DONE) {
+        return;
+    }
+    if (d->diff_left > 0) {
+        d->state = DELTA_DIFF;
+    } else if (d->extra_left > 0) {
+        d->state = DELTA_EXTRA;
+    } else {
+        d->src_pos += d->seek;
+        d->state = DELTA_DIFF_LEN;
+    }
+}
+
+/**
+ * @brief Decode one byte of the decompressed body.
+ */
+static int delta_entry_byte(struct delta *d, uint8_t c)
+{
+    uint8_t s;
+    int ret;
+
+    switch (d->state) {
+    case DELTA_DIFF_LEN:
+    case DELTA_EXTRA_LEN:
+    case DELTA_SEEK:
+        d->value |= (uint32_t)(c & 0x7F) << d->shift;
+        if (c & 0x80) {
+            d->shift += 7;
+            return d->shift > 28 ? -EBADMSG : 0;
+        }
+        if (d->state == DELTA_DIFF_LEN) {
+            d->diff_left = d->value;
+            d->state = DELTA_EXTRA_LEN;
+        } else if (d->state == DELTA_EXTRA_LEN) {
+            d->extra_left = d->value;
+            d->state = DELTA_SEEK;
+        } else {
+            d->seek = (int32_t)(d->value >> 1) ^ -(int32_t)(d->value & 1);
+            delta_next_data(d);
+        }
+        d->value = 0;
+        d->shift = 0;
+        return 0;
+
+    case DELTA_DIFF:
+        ret = delta_source(d, &s);
+        if (ret < 0) {
+            return ret;
+        }
+        d->src_pos++;
+        d->diff_left--;
+        ret = delta_output(d, (uint8_t)(s + c));
+        delta_next_data(d);
+        return ret;
+
+    case DELTA_EXTRA:
+        d->extra_left--;
+        ret = delta_output(d, c);
+        delta_next_data(d);
+        return ret;
+
+    default:
+        return 0;
+    }
+}
+
+/**
+ * @brief Decompress one patch byte, decoding what it yields.
+ */
+static int delta_lz_byte(struct delta *d, uint8_t c)
+{
+    if (d->match_len > 0) {
+        d->match[d->match_len++] = c;
+
+        uint16_t token = d->match[0] | (d->match[1] << 8);
+        uint32_t offset = (token & (DELTA_LZ_WINDOW - 1)) + 1;
+        uint32_t len = (token >> 11) + DELTA_LZ_MIN;
+
+        if (d->match_len == 2 && (token >> 11) == DELTA_LZ_LONG) {
+            return 0;
+        }
+        if (d->match_len == 3) {
+            len += d->match[2];
+        }
+        d->match_len = 0;
+        if (offset > d->lz_out) {
+            return -EBADMSG;
+        }
+        for (uint32_t i = 0; i < len; i++) {
+            uint8_t b = d->window[(d->wpos - offset) & (DELTA_LZ_WINDOW - 1)];
+            int ret;
+
+            d->window[d->wpos] = b;
+            d->wpos = (d->wpos + 1) & (DELTA_LZ_WINDOW - 1);
+            d->lz_out++;
+            ret = delta_entry_byte(d, b);
+            if (ret < 0) {
+                return ret;
+            }
+        }
+        return 0;
+    }
+
+    if (d->flag_count == 0) {
+        d->flags = c;
+        d->flag_count = 8;
+        return 0;
+    }
+
+    bool literal = d->flags & 1;
+
+    d->flags >>= 1;
+    d->flag_count--;
+    if (!literal) {
+        d->match[0] = c;
+        d->match_len = 1;
+        return 0;
+    }
+    d->window[d->wpos] = c;
+    d->wpos = (d->wpos + 1) & (DELTA_LZ_WINDOW - 1);
+    d->lz_out++;
+    return delta_entry_byte(d, c);
+}
+
+void delta_init(struct delta *d, const struct delta_io *io)
+{
+    memset(d, 0, sizeof(*d));
+    d->io = io;
+    d->state = DELTA_DIFF_LEN;
+}
+
+int delta_write(struct delta *d, const uint8_t *data, size_t len)
+{
+    for (size_t i = 0; i < len && d->error == 0 && d->state != DELTA_DONE; i++) {
+        int ret;
+
+        if (d->patch_bytes < DELTA_HEADER_SIZE) {
+            d->head[d->patch_bytes++] = data[i];
+            ret = d->patch_bytes == DELTA_HEADER_SIZE ? delta_parse_header(d) : 0;
+        } else {
+            d->patch_bytes++;
+            ret = delta_lz_byte(d, data[i]);
+        }
+        if (ret < 0) {
+            delta_fail(d, ret);
+        }
+    }
+    return d->error;
+}
+
+bool delta_done(const struct delta *d)
+{
+    return d->state == DELTA_DONE;
+}
+
+int delta_finish(struct delta *d)
+{
+    if (d->error != 0) {
+        return d->error;
+    }
+    if (d->state != DELTA_DONE) {
+        return delta_fail(d, -EBADMSG);
+    }
+
+    int ret = delta_flush(d);
+
+    if (ret < 0) {
+        return delta_fail(d, ret);
+    }
+    return d->out_crc == d->hdr.target_crc ? 0 : delta_fail(d, -EBADMSG);
+}
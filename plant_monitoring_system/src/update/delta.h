@@ -0,0 +1,157 @@
+/**
+ * @file delta.h
+ * @brief Streaming decoder of firmware delta patches.
+ *
+ * A patch rebuilds the new image (target) from the running one (source).
+ * It is produced on the host by tools/delta/delta_patch.py and is made of
+ * a 24-byte header followed by an LZSS-compressed body:
+ *
+ * | Offset | Size | Field       | Notes                                |
+ * |-------:|-----:|-------------|--------------------------------------|
+ * |      0 |    4 | magic       | "PDLT"                               |
+ * |      4 |    1 | version     | @ref DELTA_VERSION                   |
+ * |      5 |    3 | reserved    | 0                                    |
+ * |      8 |    4 | source_size | bytes of the source image used       |
+ * |     12 |    4 | source_crc  | CRC-32 (IEEE) of those bytes         |
+ * |     16 |    4 | target_size | bytes of the target image            |
+ * |     20 |    4 | target_crc  | CRC-32 (IEEE) of the target image    |
+ *
+ * The decompressed body is a sequence of bsdiff-style entries, until
+ * @c target_size bytes have been produced:
+ *
+ * - @c diff_len (varint): target bytes that are the source bytes at the
+ *   source position plus the next @c diff_len body bytes (modulo 256);
+ *   the source position advances by @c diff_len;
+ * - @c extra_len (varint): target bytes copied from the body;
+ * - @c seek (zigzag varint): signed move of the source position.
+ *
+ * Code that moved keeps the same bytes except for the addresses it
+ * contains, so the diff bytes are mostly zeros and compress well.
+ *
+ * LZSS body: a flag byte precedes each group of 8 items, bit 0 first; a
+ * set bit is a literal byte, a clear one a match of @ref DELTA_LZ_MIN to
+ * @ref DELTA_LZ_MAX bytes at 1 to @ref DELTA_LZ_WINDOW bytes back: a 16-bit
+ * little-endian token with offset - 1 in bits 0-10 and length - 3 in bits
+ * 11-15, where 31 means that a third byte follows and the length is 34
+ * plus that byte. Long matches at offset 1 keep the runs of zero diff
+ * bytes down to 3 bytes per 289.
+ *
+ * The decoder takes the patch in chunks of any size and only keeps the
+ * LZSS window and small read and write buffers; the source is read and
+ * the target written through callbacks. Pure computation: no hardware
+ * access, no locking.
+ */
+
+#ifndef DELTA_H
+#define DELTA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define DELTA_MAGIC       0x544C4450u  /**< "PDLT", little-endian. */
+#define DELTA_VERSION     1            /**< Patch format version. */
+#define DELTA_HEADER_SIZE 24           /**< Bytes before the compressed body. */
+#define DELTA_LZ_WINDOW   2048         /**< LZSS window (bytes). */
+#define DELTA_LZ_MIN      3            /**< Shortest LZSS match. */
+#define DELTA_LZ_MAX      289          /**< Longest LZSS match. */
+#define DELTA_SOURCE_BUF  64           /**< Source bytes read at once. */
+#define DELTA_TARGET_BUF  256          /**< Target bytes written at once; a multiple of the flash write block. */
+
+/** @brief Patch header. */
+struct delta_header {
+    uint32_t source_size;   /**< Bytes of the source image used. */
+    uint32_t source_crc;    /**< CRC-32 of those bytes. */
+    uint32_t target_size;   /**< Bytes of the target image. */
+    uint32_t target_crc;    /**< CRC-32 of the target image. */
+};
+
+/** @brief Access to the images. */
+struct delta_io {
+    /**
+     * @brief Check the header before anything is written (source CRC,
+     *        room for the target).
+     * @return 0 to go on, or a negative error code returned by @ref delta_write.
+     */
+    int (*begin)(void *user, const struct delta_header *h);
+    /** @brief Read @p len source bytes at @p off; 0 or a negative error code. */
+    int (*read)(void *user, uint32_t off, uint8_t *buf, size_t len);
+    /** @brief Append @p len target bytes; 0 or a negative error code. */
+    int (*write)(void *user, const uint8_t *buf, size_t len);
+    void *user;             /**< Passed to the callbacks. */
+};
+
+/** @brief Decoder state. */
+struct delta {
+    const struct delta_io *io;
+    struct delta_header hdr;
+    uint8_t head[DELTA_HEADER_SIZE];    /**< Header being received. */
+    uint32_t patch_bytes;               /**< Patch bytes consumed. */
+    int error;                          /**< First error, then every call fails with it. */
+
+    /* LZSS */
+    uint8_t window[DELTA_LZ_WINDOW];
+    uint16_t wpos;                      /**< Next write position in @c window. */
+    uint8_t flags;                      /**< Flag byte of the current group. */
+    uint8_t flag_count;                 /**< Items left in the group. */
+    uint8_t match[3];                   /**< Match token being received. */
+    uint8_t match_len;                  /**< Bytes of @c match received. */
+    uint32_t lz_out;                    /**< Bytes decompressed. */
+
+    /* Entries */
+    uint8_t state;                      /**< Field or data being decoded. */
+    uint8_t shift;                      /**< Bit position in the varint. */
+    uint32_t value;                     /**< Varint being decoded. */
+    uint32_t diff_left;                 /**< Diff bytes left in the entry. */
+    uint32_t extra_left;                /**< Extra bytes left in the entry. */
+    int32_t seek;                       /**< Source move at the end of the entry. */
+    int64_t src_pos;                    /**< Source position. */
+
+    /* Buffers */
+    uint8_t src_buf[DELTA_SOURCE_BUF];
+    uint32_t src_buf_off;               /**< Source offset of @c src_buf. */
+    uint32_t src_buf_len;               /**< Valid bytes in @c src_buf. */
+    uint8_t out_buf[DELTA_TARGET_BUF];
+    uint32_t out_len;                   /**< Bytes in @c out_buf. */
+    uint32_t out_pos;                   /**< Target bytes produced. */
+    uint32_t out_crc;                   /**< CRC-32 of the target so far. */
+};
+
+/**
+ * @brief Start decoding a patch.
+ *
+ * @param d Decoder.
+ * @param io Image access; must stay valid.
+ */
+void delta_init(struct delta *d, const struct delta_io *io);
+
+/**
+ * @brief Decode the next chunk of the patch.
+ *
+ * Bytes after the end of the target are ignored.
+ *
+ * @param d Decoder.
+ * @param data Patch bytes.
+ * @param len Bytes in @p data.
+ * @retval 0 On success.
+ * @retval -EINVAL If the header is not a supported patch.
+ * @retval -EBADMSG If the body is malformed (e.g. reads outside the source).
+ * @retval <0 Error of a callback.
+ */
+int delta_write(struct delta *d, const uint8_t *data, size_t len);
+
+/**
+ * @brief Whether the whole target has been produced.
+ */
+bool delta_done(const struct delta *d);
+
+/**
+ * @brief Write the last target bytes and check the target.
+ *
+ * @retval 0 If the target is complete and its CRC matches.
+ * @retval -EBADMSG If it is incomplete or its CRC does not match.
+ * @retval <0 Error of a callback or of an earlier @ref delta_write.
+ */
+int delta_finish(struct delta *d);
+
+#endif /* DELTA_H */
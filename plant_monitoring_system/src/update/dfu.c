@@ -0,0 +1,342 @@
+/**
+ * @file dfu.c
+ * @brief Delta patch application into the update slot.
+ */
+
+#include "dfu.h"
+#include "delta.h"
+#include <zephyr/kernel.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/flash.h>
+#include <zephyr/storage/flash_map.h>
+#include <zephyr/sys/crc.h>
+#include <zephyr/sys/printk.h>
+#include <zephyr/sys/util.h>
+#include <errno.h>
+#include <string.h>
+
+#if defined(CONFIG_MCUBOOT_IMG_MANAGER)
+#include <zephyr/dfu/mcuboot.h>
+#endif
+#if defined(CONFIG_MCUBOOT_IMG_MANAGER) && defined(CONFIG_REBOOT)
+#include <zephyr/sys/reboot.h>
+#define DFU_REBOOT_DELAY_MS 100  /**< Lets the last console line out. */
+#endif
+
+/* Without MCUboot the image is linked at the start of the flash, over the slots */
+#if FIXED_PARTITION_EXISTS(slot0_partition) && FIXED_PARTITION_EXISTS(slot1_partition) && \
+    (defined(CONFIG_BOOTLOADER_MCUBOOT) || defined(CONFIG_BOARD_NATIVE_SIM))
+
+#define DFU_WRITE_BLOCK_MAX 16   /**< Largest flash write block supported. */
+
+static const struct flash_area *source_fa;   /**< Running image. */
+static const struct flash_area *target_fa;   /**< Update slot. */
+static uint32_t page_size;      /**< Erase page of the update slot. */
+static uint32_t write_block;    /**< Write block of the update slot. */
+
+static struct delta patch;
+static uint8_t read_buf[DELTA_SOURCE_BUF];  /**< CRC passes over the slots. */
+static uint32_t patch_next;     /**< Next patch offset wanted. */
+static int patch_status;        /**< DFU_PATCH_MORE, DFU_PATCH_COMPLETE or the error. */
+static uint32_t target_written; /**< Target bytes written, padding included. */
+static uint32_t target_erased;  /**< Target bytes erased from the start of the slot. */
+static int64_t apply_ms;        /**< Time spent in the current patch. */
+
+/** @brief Counters since boot. */
+static struct {
+    uint32_t patches;       /**< Patches started. */
+    uint32_t completed;     /**< Images written and checked. */
+    uint32_t bytes;         /**< Patch bytes applied. */
+    uint32_t pages_erased;
+    uint32_t bytes_written;
+} dfu_stats;
+
+/**
+ * @brief CRC-32 of the first @p len bytes of a slot.
+ */
+static int dfu_slot_crc(const struct flash_area *fa, uint32_t len, uint32_t *crc)
+{
+    *crc = 0;
+    for (uint32_t off = 0; off < len; off += sizeof(read_buf)) {
+        uint32_t n = MIN(sizeof(read_buf), len - off);
+        int ret = flash_area_read(fa, off, read_buf, n);
+
+        if (ret < 0) {
+            return ret;
+        }
+        *crc = crc32_ieee_update(*crc, read_buf, n);
+    }
+    return 0;
+}
+
+/**
+ * @brief Erase the update slot up to @p end (exclusive), page by page.
+ */
+static int dfu_erase_to(uint32_t end)
+{
+    while (target_erased < end) {
+        int ret = flash_area_erase(target_fa, target_erased, page_size);
+
+        if (ret < 0) {
+            return ret;
+        }
+        target_erased += page_size;
+        dfu_stats.pages_erased++;
+    }
+    return 0;
+}
+
+/**
+ * @brief Check a patch header against the slots.
+ */
+static int dfu_begin(void *user, const struct delta_header *h)
+{
+    uint32_t crc;
+    int ret;
+
+    ARG_UNUSED(user);
+    if (h->source_size > source_fa->fa_size) {
+        return -ENOEXEC;
+    }
+    /* The last page is kept for the bootloader's trailer */
+    if (h->target_size > target_fa->fa_size - page_size) {
+        return -EFBIG;
+    }
+    ret = dfu_slot_crc(source_fa, h->source_size, &crc);
+    if (ret < 0) {
+        return ret;
+    }
+    if (crc != h->source_crc) {
+        return -ENOEXEC;
+    }
+
+    /* A stale trailer could make the bootloader act on a half-written image */
+    ret = flash_area_erase(target_fa, target_fa->fa_size - page_size, page_size);
+    if (ret == 0) {
+        dfu_stats.pages_erased++;
+    }
+    return ret;
+}
+
+/**
+ * @brief Source bytes, from the running image.
+ */
+static int dfu_read(void *user, uint32_t off, uint8_t *buf, size_t len)
+{
+    ARG_UNUSED(user);
+    return flash_area_read(source_fa, off, buf, len);
+}
+
+/**
+ * @brief Append target bytes; only the last write may be a partial block,
+ *        which is padded with the erased value.
+ */
+static int dfu_write(void *user, const uint8_t *buf, size_t len)
+{
+    size_t whole = ROUND_DOWN(len, write_block);
+    int ret;
+
+    ARG_UNUSED(user);
+    ret = dfu_erase_to(target_written + ROUND_UP(len, write_block));
+    if (ret == 0 && whole > 0) {
+        ret = flash_area_write(target_fa, target_written, buf, whole);
+    }
+    if (ret == 0 && whole < len) {
+        uint8_t block[DFU_WRITE_BLOCK_MAX];
+
+        memset(block, flash_area_erased_val(target_fa), write_block);
+        memcpy(block, &buf[whole], len - whole);
+        ret = flash_area_write(target_fa, target_written + whole, block, write_block);
+    }
+    if (ret < 0) {
+        return ret;
+    }
+    target_written += ROUND_UP(len, write_block);
+    dfu_stats.bytes_written += ROUND_UP(len, write_block);
+    return 0;
+}
+
+static const struct delta_io dfu_io = {
+    .begin = dfu_begin,
+    .read = dfu_read,
+    .write = dfu_write,
+};
+
+/**
+ * @brief Check the image written and hand it to the bootloader.
+ */
+static int dfu_complete(void)
+{
+    uint32_t crc;
+    int ret = delta_finish(&patch);
+
+    if (ret == 0) {
+        ret = dfu_slot_crc(target_fa, patch.hdr.target_size, &crc);
+    }
+    if (ret == 0 && crc != patch.hdr.target_crc) {
+        ret = -EIO;
+    }
+#if defined(CONFIG_MCUBOOT_IMG_MANAGER)
+    if (ret == 0) {
+        ret = boot_request_upgrade(BOOT_UPGRADE_TEST);
+    }
+#endif
+    return ret;
+}
+
+int dfu_init(void)
+{
+    struct flash_pages_info info;
+    int ret = flash_area_open(FIXED_PARTITION_ID(slot0_partition), &source_fa);
+
+    if (ret == 0) {
+        ret = flash_area_open(FIXED_PARTITION_ID(slot1_partition), &target_fa);
+    }
+    if (ret == 0) {
+        ret = flash_get_page_info_by_offs(flash_area_get_device(target_fa), target_fa->fa_off, &info);
+    }
+    if (ret < 0) {
+        source_fa = target_fa = NULL;
+        return ret;
+    }
+    page_size = info.size;
+    write_block = flash_area_align(target_fa);
+    if (write_block == 0 || write_block > DFU_WRITE_BLOCK_MAX || DELTA_TARGET_BUF % write_block) {
+        source_fa = target_fa = NULL;
+        return -ENOTSUP;
+    }
+
+    printk("[DFU] - Image slot %u KiB, update slot %u KiB, %u-byte pages\n",
+           (unsigned int)(source_fa->fa_size / 1024), (unsigned int)(target_fa->fa_size / 1024), page_size);
+    return 0;
+}
+
+int dfu_confirm(void)
+{
+#if defined(CONFIG_MCUBOOT_IMG_MANAGER)
+    static bool confirmed;
+    int ret;
+
+    if (confirmed) {
+        return 0;
+    }
+    if (!boot_is_img_confirmed()) {
+        ret = boot_write_img_confirmed();
+        if (ret < 0) {
+            printk("[DFU] - Image not confirmed (%d)\n", ret);
+            return ret;
+        }
+        printk("[DFU] - New image confirmed\n");
+    }
+    confirmed = true;
+#endif
+    return 0;
+}
+
+int dfu_patch_write(uint32_t offset, const uint8_t *data, size_t len)
+{
+    if (target_fa == NULL) {
+        return -ENODEV;
+    }
+
+    if (offset == 0 && len > 0) {
+        delta_init(&patch, &dfu_io);
+        patch_next = 0;
+        patch_status = DFU_PATCH_MORE;
+        target_written = 0;
+        target_erased = 0;
+        apply_ms = 0;
+        dfu_stats.patches++;
+    }
+    if (offset != patch_next || patch_status != DFU_PATCH_MORE) {
+        return patch_status;
+    }
+
+    int64_t start = k_uptime_get();
+    int ret = delta_write(&patch, data, len);
+
+    patch_next += len;
+    dfu_stats.bytes += len;
+    if (ret == 0 && delta_done(&patch)) {
+        ret = dfu_complete();
+        ret = (ret == 0) ? DFU_PATCH_COMPLETE : ret;
+        dfu_stats.completed += (ret == DFU_PATCH_COMPLETE);
+    }
+    patch_status = ret;
+    apply_ms += k_uptime_get() - start;
+    return patch_status;
+}
+
+uint32_t dfu_patch_next(void)
+{
+    return patch_next;
+}
+
+uint32_t dfu_apply_ms(void)
+{
+    return (uint32_t)apply_ms;
+}
+
+void dfu_reboot(void)
+{
+#if defined(CONFIG_MCUBOOT_IMG_MANAGER) && defined(CONFIG_REBOOT)
+    if (patch_status == DFU_PATCH_COMPLETE) {
+        printk("[DFU] - Rebooting into the new image\n");
+        k_msleep(DFU_REBOOT_DELAY_MS);
+        sys_reboot(SYS_REBOOT_COLD);
+    }
+#endif
+}
+
+void dfu_print(void)
+{
+    if (target_fa == NULL) {
+        printk("[DFU] - Not available\n");
+        return;
+    }
+    printk("[DFU] - %u patch(es), %u complete, %u bytes applied, %u pages erased, %u bytes written, "
+           "last %d in %u ms\n",
+           dfu_stats.patches, dfu_stats.completed, dfu_stats.bytes, dfu_stats.pages_erased,
+           dfu_stats.bytes_written, patch_status, (unsigned int)apply_ms);
+}
+
+#else /* no image slots */
+
+int dfu_init(void)
+{
+    return -ENOTSUP;
+}
+
+int dfu_confirm(void)
+{
+    return 0;
+}
+
+int dfu_patch_write(uint32_t offset, const uint8_t *data, size_t len)
+{
+    ARG_UNUSED(offset);
+    ARG_UNUSED(data);
+    ARG_UNUSED(len);
+    return -ENODEV;
+}
+
+uint32_t dfu_patch_next(void)
+{
+    return 0;
+}
+
+uint32_t dfu_apply_ms(void)
+{
+    return 0;
+}
+
+void dfu_reboot(void)
+{
+}
+
+void dfu_print(void)
+{
+    printk("[DFU] - Not available\n");
+}
+
+#endif /* image slots */
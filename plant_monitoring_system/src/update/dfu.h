@@ -0,0 +1,91 @@
+/**
+ * @file dfu.h
+ * @brief Firmware update from a delta patch (delta.h).
+ *
+ * The patch rebuilds the new image from the running one: the source is
+ * read from @c slot0_partition and the target written to
+ * @c slot1_partition, a page at a time as it grows, then read back and
+ * checked. On boards built with MCUboot (sysbuild) the new image is then
+ * marked for a test swap and the node reboots into it once the session
+ * that carried the patch is over; MCUboot swaps the old image back at the
+ * next reset unless the new one confirms itself with @ref dfu_confirm. On
+ * native_sim the image is only checked in the flash simulator. Hardware
+ * builds without MCUboot have no updates: their image is linked at the
+ * start of the flash, over the slots.
+ *
+ * Patches arrive over the export link (history_export.h) and are made on
+ * the host with tools/delta/delta_patch.py.
+ */
+
+#ifndef DFU_H
+#define DFU_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define DFU_PATCH_MORE     0   /**< @ref dfu_patch_write: the image is not complete yet. */
+#define DFU_PATCH_COMPLETE 1   /**< @ref dfu_patch_write: the image is written and checked. */
+
+/**
+ * @brief Open the image slots.
+ *
+ * @retval 0 On success.
+ * @retval -ENOTSUP If the board has no image slots.
+ * @retval <0 If a slot cannot be opened.
+ */
+int dfu_init(void);
+
+/**
+ * @brief Confirm the running image.
+ *
+ * Called once the node has measured and reported a full cycle: a test
+ * image that got this far is kept. Only the first call writes the flag.
+ *
+ * @retval 0 On success, or without MCUboot.
+ * @retval <0 If the image could not be confirmed (retried at the next call).
+ */
+int dfu_confirm(void);
+
+/**
+ * @brief Apply the next part of a patch.
+ *
+ * A chunk at offset 0 starts a new patch; any chunk other than the one at
+ * @ref dfu_patch_next is ignored, so chunks sent again are harmless.
+ *
+ * @param offset Offset of @p data in the patch.
+ * @param data Patch bytes.
+ * @param len Bytes in @p data.
+ * @retval DFU_PATCH_MORE If more of the patch is needed.
+ * @retval DFU_PATCH_COMPLETE If the new image is in the update slot.
+ * @retval -ENOEXEC If the patch was made for another image.
+ * @retval -EFBIG If the new image does not fit in the update slot.
+ * @retval -EINVAL If the data is not a patch.
+ * @retval -EBADMSG If the patch is corrupt.
+ * @retval -EIO If the image read back does not match.
+ * @retval <0 Flash error; the result stays until a new patch starts.
+ */
+int dfu_patch_write(uint32_t offset, const uint8_t *data, size_t len);
+
+/**
+ * @brief Offset of the next chunk wanted.
+ */
+uint32_t dfu_patch_next(void);
+
+/**
+ * @brief Time spent applying the current patch (ms), flash included.
+ */
+uint32_t dfu_apply_ms(void);
+
+/**
+ * @brief Reboot into the new image if a patch has completed.
+ *
+ * Does nothing without MCUboot.
+ */
+void dfu_reboot(void);
+
+/**
+ * @brief Print the update counters on one line.
+ */
+void dfu_print(void);
+
+#endif /* DFU_H */
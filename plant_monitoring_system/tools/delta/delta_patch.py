@@ -0,0 +1,459 @@
+#!/usr/bin/env python3
+"""
+Make and check firmware delta patches (src/update/delta.h).
+
+A patch rebuilds the new image from the one running on the node, so only
+what changed crosses the radio or serial link. The images are the signed
+binaries that MCUboot boots (build/zephyr/zephyr.signed.bin) on the Nucleo,
+or any pair of files for native_sim. The body is bsdiff's: the new image is
+cut into entries of "diff" bytes (new minus old, mostly zero where code
+only moved) and "extra" bytes (new code), found with a suffix array of the
+old image; the entries are then LZSS-compressed in the format the node
+decodes with a 2 KiB window.
+
+Commands:
+
+- create OLD NEW -o PATCH: write the patch and print its size against the
+  full image, with the modelled transfer times over the serial link and
+  LoRa
+- apply OLD PATCH -o NEW: rebuild the new image on the host, as the node
+  does (checks a patch before it is sent)
+- info PATCH: print the header
+- flash-image OLD --flash FILE: write OLD as the running image (slot0,
+  --offset) of a native_sim flash file, created erased with --flash-size if
+  missing; run the node with `zephyr.exe -flash=FILE`
+- check-flash NEW --flash FILE: compare the update slot (slot1, --offset)
+  of a native_sim flash file with NEW after an update
+
+The patch is sent with `plant_tsdb update --port PORT PATCH` (tools/tsdb).
+
+Usage:
+    python3 delta_patch.py create v1.signed.bin v2.signed.bin -o v1-v2.pdlt
+    python3 delta_patch.py flash-image v1.bin --flash flash.bin --offset 0xc000 --flash-size 0x140000
+    python3 delta_patch.py check-flash v2.bin --flash flash.bin --offset 0x75000
+
+Only the Python standard library is required.
+"""
+
+import argparse
+import os
+import struct
+import sys
+import time
+import zlib
+
+MAGIC = b"PDLT"
+VERSION = 1
+HEADER = struct.Struct("<4sB3xIIII")
+LZ_WINDOW = 2048
+LZ_MIN = 3
+LZ_LONG = 31                     # length field of a match with a third byte
+LZ_MAX = LZ_MIN + LZ_LONG + 255
+LZ_CHAIN = 64                    # candidates tried per position
+SEARCH_CMP = 256                 # bytes compared per suffix array probe
+FUZZ = 8                         # bsdiff: mismatches that end an approximate match
+
+# Transfer model: UPDATE chunks over the serial link, or LoRa packets
+SERIAL_BAUD = 115200
+LORA_RATE = 5470 / 8             # SF7, 125 kHz
+LORA_PAYLOAD = 222               # largest payload at SF7
+LORA_GAP = 1.0                   # per packet: duty cycle and acknowledgement
+CHUNK = 128                      # EXPORT_UPDATE_CHUNK
+CHUNK_OVERHEAD = 1 + 4 + 2 + 2   # type, offset, CRC, COBS and delimiter
+
+
+def suffix_array(data):
+    """Suffix array of data by prefix doubling."""
+    n = len(data)
+    sa = list(range(n))
+    rank = list(data)
+    k = 1
+    while True:
+        key = [rank[i] * (n + 1) + (rank[i + k] + 1 if i + k < n else 0) for i in range(n)]
+        sa.sort(key=key.__getitem__)
+        new = [0] * n
+        r = 0
+        for j in range(1, n):
+            if key[sa[j]] != key[sa[j - 1]]:
+                r += 1
+            new[sa[j]] = r
+        rank = new
+        if r == n - 1 or k >= n:
+            return sa
+        k *= 2
+
+
+def match_len(a, ai, b, bi, limit=None):
+    """Length of the common prefix of a[ai:] and b[bi:], up to limit."""
+    n = min(len(a) - ai, len(b) - bi, len(a) if limit is None else limit)
+    length = 0
+    while length < n:
+        step = min(64, n - length)
+        if a[ai + length:ai + length + step] == b[bi + length:bi + length + step]:
+            length += step
+            continue
+        while a[ai + length] == b[bi + length]:
+            length += 1
+        break
+    return length
+
+
+def search(sa, old, new, pos):
+    """Longest match of new[pos:] in old: (length, old position)."""
+    lo, hi = 0, len(sa) - 1
+    probe = new[pos:pos + SEARCH_CMP]
+    while hi - lo > 1:
+        mid = (lo + hi) // 2
+        if old[sa[mid]:sa[mid] + SEARCH_CMP] < probe:
+            lo = mid
+        else:
+            hi = mid
+    x = match_len(old, sa[lo], new, pos)
+    y = match_len(old, sa[hi], new, pos)
+    return (x, sa[lo]) if x > y else (y, sa[hi])
+
+
+def diff_entries(old, new):
+    """bsdiff's entries: (diff bytes, extra bytes, seek)."""
+    sa = suffix_array(old)
+    entries = []
+    scan = length = pos = 0
+    last_scan = last_pos = last_offset = 0
+    old_size, new_size = len(old), len(new)
+
+    while scan < new_size:
+        old_score = 0
+        scan += length
+        scsc = scan
+        while scan < new_size:
+            length, pos = search(sa, old, new, scan)
+            while scsc < scan + length:
+                if scsc + last_offset < old_size and old[scsc + last_offset] == new[scsc]:
+                    old_score += 1
+                scsc += 1
+            if (length == old_score and length != 0) or length > old_score + FUZZ:
+                break
+            if scan + last_offset < old_size and old[scan + last_offset] == new[scan]:
+                old_score -= 1
+            scan += 1
+
+        if length == old_score and scan != new_size:
+            continue
+
+        # Extend the previous match forwards and this one backwards
+        s = best = len_f = i = 0
+        while last_scan + i < scan and last_pos + i < old_size:
+            if old[last_pos + i] == new[last_scan + i]:
+                s += 1
+            i += 1
+            if s * 2 - i > best * 2 - len_f:
+                best, len_f = s, i
+
+        len_b = 0
+        if scan < new_size:
+            s = best = 0
+            i = 1
+            while scan >= last_scan + i and pos >= i:
+                if old[pos - i] == new[scan - i]:
+                    s += 1
+                if s * 2 - i > best * 2 - len_b:
+                    best, len_b = s, i
+                i += 1
+
+        if last_scan + len_f > scan - len_b:
+            overlap = (last_scan + len_f) - (scan - len_b)
+            s = best = len_s = 0
+            for i in range(overlap):
+                if new[last_scan + len_f - overlap + i] == old[last_pos + len_f - overlap + i]:
+                    s += 1
+                if new[scan - len_b + i] == old[pos - len_b + i]:
+                    s -= 1
+                if s > best:
+                    best, len_s = s, i + 1
+            len_f += len_s - overlap
+            len_b -= len_s
+
+        diff = bytes((new[last_scan + i] - old[last_pos + i]) & 0xFF for i in range(len_f))
+        extra = new[last_scan + len_f:scan - len_b]
+        seek = (pos - len_b) - (last_pos + len_f)
+        entries.append((diff, extra, seek))
+
+        last_scan, last_pos = scan - len_b, pos - len_b
+        last_offset = pos - scan
+    return entries
+
+
+def varint(value):
+    out = bytearray()
+    while value >= 0x80:
+        out.append(value & 0x7F | 0x80)
+        value >>= 7
+    out.append(value)
+    return bytes(out)
+
+
+def serialize(entries):
+    """Decompressed body: diff_len, extra_len, zigzag seek, diff, extra."""
+    out = bytearray()
+    for diff, extra, seek in entries:
+        out += varint(len(diff)) + varint(len(extra)) + varint(seek << 1 if seek >= 0 else (-seek << 1) - 1)
+        out += diff + extra
+    return bytes(out)
+
+
+def lzss_compress(data):
+    """LZSS with hash chains over 3-byte keys."""
+    out = bytearray()
+    head = {}
+    prev = [0] * len(data)
+    items = []
+
+    def flush():
+        flags = 0
+        for bit, (literal, _) in enumerate(items):
+            flags |= literal << bit
+        out.append(flags)
+        for _, raw in items:
+            out.extend(raw)
+        items.clear()
+
+    def insert(p):
+        if p + LZ_MIN <= len(data):
+            key = data[p:p + LZ_MIN]
+            prev[p] = head.get(key, -1)
+            head[key] = p
+
+    i = 0
+    while i < len(data):
+        best_len, best_off = 0, 0
+        if i + LZ_MIN <= len(data):
+            cand = head.get(data[i:i + LZ_MIN], -1)
+            limit = min(LZ_MAX, len(data) - i)
+            for _ in range(LZ_CHAIN):
+                if cand < 0 or i - cand > LZ_WINDOW:
+                    break
+                n = match_len(data, cand, data, i, limit)
+                if n > best_len:
+                    best_len, best_off = n, i - cand
+                    if n == limit:
+                        break
+                cand = prev[cand]
+
+        if best_len >= LZ_MIN:
+            field = min(best_len - LZ_MIN, LZ_LONG)
+            token = struct.pack("<H", (best_off - 1) | field << 11)
+            if field == LZ_LONG:
+                token += bytes([best_len - LZ_MIN - LZ_LONG])
+            items.append((0, token))
+            for p in range(i, i + best_len):
+                insert(p)
+            i += best_len
+        else:
+            items.append((1, data[i:i + 1]))
+            insert(i)
+            i += 1
+        if len(items) == 8:
+            flush()
+    if items:
+        flush()
+    return bytes(out)
+
+
+def lzss_decompress(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        flags = data[i]
+        i += 1
+        for bit in range(8):
+            if i >= len(data):
+                break
+            if flags >> bit & 1:
+                out.append(data[i])
+                i += 1
+                continue
+            token = data[i] | data[i + 1] << 8
+            i += 2
+            offset, length = (token & (LZ_WINDOW - 1)) + 1, (token >> 11) + LZ_MIN
+            if token >> 11 == LZ_LONG:
+                length += data[i]
+                i += 1
+            if offset > len(out):
+                raise ValueError("match before the start of the body")
+            for _ in range(length):
+                out.append(out[-offset])
+    return bytes(out)
+
+
+def create(old, new):
+    body = lzss_compress(serialize(diff_entries(old, new)))
+    header = HEADER.pack(MAGIC, VERSION, len(old), zlib.crc32(old), len(new), zlib.crc32(new))
+    return header + body
+
+
+def apply(old, patch):
+    """Rebuild the new image, as src/update/delta.c does."""
+    magic, version, source_size, source_crc, target_size, target_crc = HEADER.unpack_from(patch)
+    if magic != MAGIC or version != VERSION:
+        raise ValueError("not a patch")
+    if len(old) < source_size or zlib.crc32(old[:source_size]) != source_crc:
+        raise ValueError("patch made for another image")
+    body = lzss_decompress(patch[HEADER.size:])
+    out = bytearray()
+    pos = src = 0
+
+    def read_varint():
+        nonlocal pos
+        value = shift = 0
+        while True:
+            c = body[pos]
+            pos += 1
+            value |= (c & 0x7F) << shift
+            shift += 7
+            if not c & 0x80:
+                return value
+
+    while len(out) < target_size:
+        diff_len, extra_len, seek = read_varint(), read_varint(), read_varint()
+        seek = seek >> 1 ^ -(seek & 1)
+        if src < 0 or src + diff_len > source_size:
+            raise ValueError("diff outside the source")
+        out += bytes((body[pos + i] + old[src + i]) & 0xFF for i in range(diff_len))
+        pos += diff_len
+        out += body[pos:pos + extra_len]
+        pos += extra_len
+        src += diff_len + seek
+    out = bytes(out[:target_size])
+    if zlib.crc32(out) != target_crc:
+        raise ValueError("target CRC mismatch")
+    return out
+
+
+def transfer_model(size):
+    """Seconds to send size bytes of patch in UPDATE chunks: serial, LoRa."""
+    chunks = -(-size // CHUNK)
+    serial = (size + chunks * CHUNK_OVERHEAD) * 10 / SERIAL_BAUD
+    packets = -(-size // (LORA_PAYLOAD - CHUNK_OVERHEAD))
+    lora = (size + packets * CHUNK_OVERHEAD) / LORA_RATE + packets * LORA_GAP
+    return serial, lora
+
+
+def read(path):
+    with open(path, "rb") as f:
+        return f.read()
+
+
+def cmd_create(args):
+    old, new = read(args.old), read(args.new)
+    start = time.monotonic()
+    patch = create(old, new)
+    elapsed = time.monotonic() - start
+    if apply(old, patch) != new:
+        print("internal error: the patch does not rebuild the new image", file=sys.stderr)
+        return 1
+    with open(args.output, "wb") as f:
+        f.write(patch)
+
+    print(f"{args.output}: {len(patch)} bytes for a {len(new)}-byte image "
+          f"({100 * len(patch) / len(new):.1f}%), made in {elapsed:.1f} s")
+    for name, size in (("patch", len(patch)), ("full image", len(new))):
+        serial, lora = transfer_model(size)
+        print(f"  {name:10}: {serial:6.1f} s at {SERIAL_BAUD} baud, {lora / 60:6.1f} min over LoRa SF7")
+    return 0
+
+
+def cmd_apply(args):
+    new = apply(read(args.old), read(args.patch))
+    with open(args.output, "wb") as f:
+        f.write(new)
+    print(f"{args.output}: {len(new)} bytes")
+    return 0
+
+
+def cmd_info(args):
+    patch = read(args.patch)
+    magic, version, source_size, source_crc, target_size, target_crc = HEADER.unpack_from(patch)
+    if magic != MAGIC:
+        print(f"{args.patch}: not a patch", file=sys.stderr)
+        return 1
+    print(f"version {version}, {len(patch)} bytes\n"
+          f"  source: {source_size} bytes, CRC-32 {source_crc:08x}\n"
+          f"  target: {target_size} bytes, CRC-32 {target_crc:08x}")
+    return 0
+
+
+def cmd_flash_image(args):
+    image = read(args.image)
+    if not os.path.exists(args.flash):
+        if args.flash_size is None:
+            print(f"{args.flash} does not exist: give --flash-size", file=sys.stderr)
+            return 1
+        with open(args.flash, "wb") as f:
+            f.write(b"\xff" * args.flash_size)
+    if args.offset + len(image) > os.path.getsize(args.flash):
+        print("image does not fit in the flash file", file=sys.stderr)
+        return 1
+    with open(args.flash, "r+b") as f:
+        f.seek(args.offset)
+        f.write(image)
+    print(f"{len(image)} bytes at {args.offset:#x} of {args.flash}")
+    return 0
+
+
+def cmd_check_flash(args):
+    image = read(args.image)
+    with open(args.flash, "rb") as f:
+        f.seek(args.offset)
+        slot = f.read(len(image))
+    if slot != image:
+        same = next((i for i in range(len(slot)) if slot[i] != image[i]), len(slot))
+        print(f"update slot differs from {args.image} at byte {same}", file=sys.stderr)
+        return 1
+    print(f"update slot holds {args.image} ({len(image)} bytes)")
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    sub = parser.add_subparsers(dest="command", required=True)
+    hexint = lambda x: int(x, 0)
+
+    p = sub.add_parser("create", help="make a patch")
+    p.add_argument("old")
+    p.add_argument("new")
+    p.add_argument("-o", "--output", required=True)
+    p.set_defaults(fn=cmd_create)
+
+    p = sub.add_parser("apply", help="rebuild the new image from a patch")
+    p.add_argument("old")
+    p.add_argument("patch")
+    p.add_argument("-o", "--output", required=True)
+    p.set_defaults(fn=cmd_apply)
+
+    p = sub.add_parser("info", help="print a patch header")
+    p.add_argument("patch")
+    p.set_defaults(fn=cmd_info)
+
+    p = sub.add_parser("flash-image", help="write the running image into a native_sim flash file")
+    p.add_argument("image")
+    p.add_argument("--flash", required=True, help="flash simulator file")
+    p.add_argument("--offset", type=hexint, default=0xC000, help="slot0 offset (default 0xc000)")
+    p.add_argument("--flash-size", type=hexint, help="size of a new flash file")
+    p.set_defaults(fn=cmd_flash_image)
+
+    p = sub.add_parser("check-flash", help="compare the update slot of a native_sim flash file")
+    p.add_argument("image")
+    p.add_argument("--flash", required=True, help="flash simulator file")
+    p.add_argument("--offset", type=hexint, default=0x75000, help="slot1 offset (default 0x75000)")
+    p.set_defaults(fn=cmd_check_flash)
+
+    args = parser.parse_args()
+    try:
+        return args.fn(args)
+    except (OSError, ValueError, struct.error, IndexError) as e:
+        print(f"error: {e}", file=sys.stderr)
+        return 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,157 @@
+#!/usr/bin/env python3
+"""
+Prepare the EPO partition of the firmware (src/sensors/gps/gps_epo.c).
+
+EPO (Extended Prediction Orbit) files hold sets of 32 satellite records of
+60 bytes; each set is valid for 6 hours from the GPS hour stored in the first
+3 bytes (little-endian) of its records. The firmware reads the file as-is
+from the flash partition chosen as `plant,epo-partition` and stops at the
+first erased set, so the image is the EPO data padded with 0xFF.
+
+The data comes from an EPO file downloaded for the module (e.g. MTK7d.EPO),
+or is generated with --synthetic for native_sim tests: the emulated module
+only checks the packet framing, not the orbits.
+
+Outputs:
+
+- --hex: Intel HEX file to program at --address (flash base plus partition
+  offset, see build/zephyr/zephyr.dts), e.g. with `west flash --hex-file`
+- --flash-image: flash simulator file of native_sim, written at --offset
+  (the storage partition offset in zephyr.dts) and given to the firmware
+  with `zephyr.exe -flash=FILE`; created erased with --flash-size if missing
+
+Usage:
+    python3 epo_image.py --epo MTK7d.EPO --hex epo.hex --address 0x0803e000
+    python3 epo_image.py --synthetic 8 --flash-image flash.bin --offset 0xfc000 --flash-size 0x100000
+
+Only the Python standard library is required.
+"""
+
+import argparse
+import datetime
+import os
+import struct
+import sys
+
+SAT_SIZE = 60
+SATS = 32
+SET_SIZE = SAT_SIZE * SATS
+SET_HOURS = 6
+GPS_EPOCH = datetime.datetime(1980, 1, 6, tzinfo=datetime.timezone.utc)
+LEAP_SECONDS = 18
+HEX_RECORD = 16
+
+
+def gps_hour(when):
+    """GPS hours since the GPS epoch of a UTC datetime."""
+    return int(((when - GPS_EPOCH).total_seconds() + LEAP_SECONDS) // 3600)
+
+
+def set_hour(data, index):
+    off = index * SET_SIZE
+    return data[off] | data[off + 1] << 8 | data[off + 2] << 16
+
+
+def synthetic(count, start):
+    """Sets of placeholder records starting at the 6-hour boundary before start."""
+    first = gps_hour(start) // SET_HOURS * SET_HOURS
+    out = bytearray()
+    for s in range(count):
+        hour = first + s * SET_HOURS
+        for sat in range(SATS):
+            record = bytearray(SAT_SIZE)
+            record[0:3] = hour.to_bytes(3, "little")
+            record[3] = sat + 1
+            out += record
+    return bytes(out)
+
+
+def intel_hex(data, address):
+    """Intel HEX records of data at address (extended linear addressing)."""
+    def record(kind, offset, payload):
+        raw = struct.pack(">BHB", len(payload), offset, kind) + payload
+        return f":{raw.hex().upper()}{(-sum(raw)) & 0xFF:02X}\n"
+
+    lines, upper = [], None
+    for pos in range(0, len(data), HEX_RECORD):
+        addr = address + pos
+        if addr >> 16 != upper:
+            upper = addr >> 16
+            lines.append(record(4, 0, struct.pack(">H", upper)))
+        lines.append(record(0, addr & 0xFFFF, data[pos:pos + HEX_RECORD]))
+    lines.append(record(1, 0, b""))
+    return "".join(lines)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    src = parser.add_mutually_exclusive_group(required=True)
+    src.add_argument("--epo", metavar="FILE", help="EPO file for the module")
+    src.add_argument("--synthetic", metavar="SETS", type=int, help="generate SETS placeholder sets")
+    parser.add_argument("--start", metavar="ISO", help="UTC time of the first synthetic set / sets expired "
+                        "before it are dropped (default now)")
+    parser.add_argument("--size", type=lambda x: int(x, 0), default=0x4000, help="partition size (default 16 KiB)")
+    parser.add_argument("--hex", metavar="FILE", help="write an Intel HEX file")
+    parser.add_argument("--address", type=lambda x: int(x, 0), help="flash address of the partition (--hex)")
+    parser.add_argument("--flash-image", metavar="FILE", help="write into a native_sim flash file")
+    parser.add_argument("--offset", type=lambda x: int(x, 0), help="partition offset in the flash file")
+    parser.add_argument("--flash-size", type=lambda x: int(x, 0), help="size of a new flash file")
+    args = parser.parse_args()
+
+    if args.hex and args.address is None:
+        parser.error("--hex needs --address")
+    if args.flash_image and args.offset is None:
+        parser.error("--flash-image needs --offset")
+    if not args.hex and not args.flash_image:
+        parser.error("nothing to write: give --hex or --flash-image")
+
+    start = datetime.datetime.now(datetime.timezone.utc)
+    if args.start:
+        start = datetime.datetime.fromisoformat(args.start)
+        if start.tzinfo is None:
+            start = start.replace(tzinfo=datetime.timezone.utc)
+
+    if args.epo:
+        with open(args.epo, "rb") as f:
+            data = f.read()
+        if len(data) % SET_SIZE:
+            print(f"{args.epo}: {len(data)} bytes is not a whole number of {SET_SIZE}-byte sets", file=sys.stderr)
+            return 1
+    else:
+        data = synthetic(args.synthetic, start)
+
+    # Drop expired sets, then keep what fits
+    now = gps_hour(start)
+    sets = len(data) // SET_SIZE
+    first = next((i for i in range(sets) if set_hour(data, i) + SET_HOURS > now), sets)
+    keep = min(sets - first, args.size // SET_SIZE)
+    data = data[first * SET_SIZE:(first + keep) * SET_SIZE]
+    if keep == 0:
+        print("no current EPO sets", file=sys.stderr)
+        return 1
+
+    image = data + b"\xff" * (args.size - len(data))
+    hours = [set_hour(data, i) for i in range(keep)]
+    begin = GPS_EPOCH + datetime.timedelta(hours=hours[0], seconds=-LEAP_SECONDS)
+    print(f"{keep} set(s) from {begin:%Y-%m-%d %H:%M:%S} UTC, {keep * SET_HOURS} h of orbits "
+          f"({first} expired set(s) dropped, {sets - first - keep} did not fit)")
+
+    if args.hex:
+        with open(args.hex, "w") as f:
+            f.write(intel_hex(image, args.address))
+    if args.flash_image:
+        if not os.path.exists(args.flash_image):
+            if args.flash_size is None:
+                parser.error(f"{args.flash_image} does not exist: give --flash-size")
+            with open(args.flash_image, "wb") as f:
+                f.write(b"\xff" * args.flash_size)
+        if args.offset + len(image) > os.path.getsize(args.flash_image):
+            parser.error("partition does not fit in the flash file")
+        with open(args.flash_image, "r+b") as f:
+            f.seek(args.offset)
+            f.write(image)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
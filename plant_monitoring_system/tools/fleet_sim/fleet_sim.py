@@ -0,0 +1,501 @@
+#!/usr/bin/env python3
+"""
+Multi-node fleet simulation on native_sim with a shared radio medium.
+
+Launches one native_sim instance of the firmware per node. Each instance gets
+its own node ID (which seeds its emulated sensors), boot time and initial mode,
+and prints a `@TLM <hex>` line for every telemetry frame it sends. The frames
+of all nodes are then played through a model of a single shared radio channel:
+
+- LoRa time on air (Semtech AN1200.13) for the frame size and modulation
+- optional regulatory duty-cycle limit per node (transmitter off-time)
+- pure ALOHA, or listen-before-talk with random exponential backoff (--mac csma);
+  transmissions that started less than --cca ago are not sensed
+- a frame is lost if another transmission on the same channel overlaps it,
+  unless it is at least --capture-db stronger than every interferer
+
+Nodes do not react to the channel (there are no ACKs or retries in the
+firmware), so the traffic each node offers does not depend on the others and
+the medium can be applied to the captured transmissions afterwards. One run
+with the largest fleet is therefore enough: smaller fleets use the first N
+nodes. The report gives, for each fleet size, the delivered frame rate,
+delivery ratio, collision rate, latency (generation to end of reception,
+including duty-cycle and backoff queueing) and channel utilization.
+
+The fleet runs with either uplink timing of the firmware (--timing), or with
+both to compare their collision rates:
+
+- free: every node reports on its own measurement timer, so the frames of
+  different nodes are spread at random by the power-on times and clock errors;
+- slots: NORMAL_MODE reports are sent in GPS-timed uplink slots derived from
+  the node ID (src/telemetry/tdma.h). The nodes take UTC from their last GPS
+  fix plus their uptime since, so a frame is off its slot by the node's clock
+  error times the age of the fix. The instances share the host clock, so the
+  error is added here: --tier gives the fix interval of the energy tier
+  (FULL every cycle, ECO every 10, SAVER every 60, SURVIVAL never).
+
+Usage:
+    python3 fleet_sim.py --exe build/zephyr/zephyr.exe --nodes 1,2,4,8,16,32,64 \\
+        [--hours 24] [--mode 1] [--timing both] [--jobs 8] [--logs DIR]
+    python3 fleet_sim.py --replay DIR [medium options]
+
+--logs keeps the console output of every node (<timing>/node_<id>.log); --replay
+runs the medium model on such a directory again, e.g. to compare MAC settings.
+With --gateway HOST:PORT the frames delivered to the largest fleet are forwarded
+to plant_gateway over UDP.
+
+Only the Python standard library is required.
+"""
+
+import argparse
+import bisect
+import concurrent.futures
+import csv
+import heapq
+import math
+import os
+import random
+import socket
+import struct
+import subprocess
+import sys
+import tempfile
+
+TLM_PREFIX = "@TLM "
+TIMINGS = ("free", "slots")
+CYCLE_S = 60                     # NORMAL_PERIOD
+TIER_GPS_EVERY = {"FULL": 1, "ECO": 10, "SAVER": 60, "SURVIVAL": 0}   # power_tiers in main.c
+FRAME_SIZE = 62
+FRAME_MAGIC = 0x5450
+FRAME_VERSION = 1
+
+
+def crc16(data):
+    """CRC-16/CCITT-FALSE, as in src/telemetry/telemetry_frame.h."""
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def parse_frame(line):
+    """Return (node_id, seq, uptime_ms, raw bytes) of a valid `@TLM` line, else None."""
+    at = line.find(TLM_PREFIX)
+    if at < 0:
+        return None
+    try:
+        raw = bytes.fromhex(line[at + len(TLM_PREFIX):].strip())
+    except ValueError:
+        return None
+    if len(raw) != FRAME_SIZE:
+        return None
+    magic, version = struct.unpack_from("<HB", raw, 0)
+    if magic != FRAME_MAGIC or version != FRAME_VERSION:
+        return None
+    if struct.unpack_from("<H", raw, FRAME_SIZE - 2)[0] != crc16(raw[:FRAME_SIZE - 2]):
+        return None
+    node_id, seq, uptime_ms = struct.unpack_from("<III", raw, 4)
+    return node_id, seq, uptime_ms, raw
+
+
+def read_log(path):
+    """Parse the frames of one node's console log."""
+    frames = []
+    with open(path, errors="replace") as f:
+        for line in f:
+            frame = parse_frame(line)
+            if frame is not None:
+                frames.append(frame)
+    return frames
+
+
+# --- Node launch --------------------------------------------------------------
+
+def node_schedule(node_ids, seed, stagger_s, ppm):
+    """
+    Per-node power-on offset (s), clock error and time resync period (s),
+    reproducible from the seed. Free-running nodes never resync (None).
+    """
+    rng = random.Random(seed)
+    return {n: (rng.uniform(0, stagger_s), rng.uniform(-ppm, ppm) * 1e-6, None) for n in node_ids}
+
+
+def boot_time_of_day(args, start):
+    """UTC time of day (whole seconds) a node powered on `start` s after the first boots."""
+    return int(args.start_hour * 3600 + start) % 86400
+
+
+def slot_schedule(args, schedule):
+    """
+    Schedule of nodes timed by their GPS: frame generation times follow the
+    simulated UTC (boot time of day plus uptime), off by the node's clock
+    error over the time since its last fix. Fixes are taken every
+    gps_every cycles counted from boot; in SURVIVAL only the first one.
+    """
+    every = TIER_GPS_EVERY[args.tier]
+    period = every * CYCLE_S if every else None
+    return {n: (int(args.start_hour * 3600 + start) - args.start_hour * 3600, drift, period)
+            for n, (start, drift, _) in schedule.items()}
+
+
+def send_time(start, drift, period, uptime_s):
+    """Time of a frame on the common time line: the clock error accumulates since the last resync."""
+    age = uptime_s % period if period else uptime_s
+    return start + uptime_s + drift * age
+
+
+def run_node(exe, node_id, boot_time, mode, slots, seconds, log_path):
+    """Run one native_sim instance to completion, writing its console to log_path."""
+    cmd = [exe, f"-node_id={node_id}", f"-boot_time={boot_time}", f"-mode={mode}",
+           f"-tdma={int(slots)}", f"-stop_at={seconds}", "-no-rt"]
+    with open(log_path, "w") as log:
+        proc = subprocess.run(cmd, stdout=log, stderr=subprocess.STDOUT, stdin=subprocess.DEVNULL)
+    return node_id, proc.returncode
+
+
+def launch_fleet(args, node_ids, schedule, timing, log_dir):
+    """Run every node in parallel; returns {node_id: log path}."""
+    paths = {}
+    seconds = int(args.hours * 3600 + args.stagger)
+    with concurrent.futures.ThreadPoolExecutor(max_workers=args.jobs) as pool:
+        futures = []
+        for n in node_ids:
+            start, _, _ = schedule[n]
+            boot_time = boot_time_of_day(args, start)
+            paths[n] = os.path.join(log_dir, f"node_{n}.log")
+            futures.append(pool.submit(run_node, args.exe, n, boot_time, args.mode, timing == "slots",
+                                       seconds, paths[n]))
+        for fut in concurrent.futures.as_completed(futures):
+            n, rc = fut.result()
+            if rc != 0:
+                print(f"node {n}: exited with status {rc} (see {paths[n]})", file=sys.stderr)
+    return paths
+
+
+# --- Radio medium -------------------------------------------------------------
+
+def lora_airtime(payload, sf, bw_hz, cr, preamble, explicit_header=True, crc=True):
+    """LoRa time on air in seconds (Semtech AN1200.13)."""
+    t_sym = (2 ** sf) / bw_hz
+    de = 1 if t_sym > 0.016 else 0
+    ih = 0 if explicit_header else 1
+    num = 8 * payload - 4 * sf + 28 + 16 * (1 if crc else 0) - 20 * ih
+    n_payload = 8 + max(math.ceil(num / (4 * (sf - 2 * de))) * (cr + 4), 0)
+    return (preamble + 4.25 + n_payload) * t_sym
+
+
+class Medium:
+    """Medium and MAC parameters."""
+
+    def __init__(self, args):
+        self.airtime = lora_airtime(FRAME_SIZE + args.overhead, args.sf, args.bw * 1000, args.cr,
+                                    args.preamble)
+        self.off_time = self.airtime * (1.0 / args.duty_cycle - 1.0) if args.duty_cycle > 0 else 0.0
+        self.mac = args.mac
+        self.channels = args.channels
+        self.cca = args.cca / 1000.0
+        self.backoff_slot = args.backoff_slot / 1000.0
+        self.max_backoffs = args.max_backoffs
+        self.capture_db = None if args.no_capture else args.capture_db
+        self.seed = args.seed
+
+
+def simulate(medium, traces, schedule, rssi, window):
+    """
+    Play the frames of a set of nodes through the shared medium.
+
+    traces: {node_id: [(uptime_ms, raw), ...]} sorted by uptime
+    Returns a dict of statistics and the delivered frames in reception order.
+    """
+    rng = random.Random(medium.seed)
+    t0, t1 = window
+    air = medium.airtime
+
+    # Attempts are processed in time order; each node sends one frame at a time.
+    queue = []
+    pending = {}
+    for n, frames in traces.items():
+        start, drift, period = schedule[n]
+        gen = [send_time(start, drift, period, up / 1000.0) for up, _ in frames]
+        pending[n] = (gen, frames)
+        if frames:
+            heapq.heappush(queue, (gen[0], n, 0, gen[0], 0))
+
+    busy = [[] for _ in range(medium.channels)]   # (end, start) of transmissions in progress
+    txs = []                                      # (start, end, channel, node, gen, raw)
+    dropped = []                                  # generation times of frames dropped by LBT
+
+    def schedule_next(n, idx, ready):
+        gen, _ = pending[n]
+        if idx + 1 < len(gen):
+            t = max(gen[idx + 1], ready)
+            heapq.heappush(queue, (t, n, idx + 1, gen[idx + 1], 0))
+
+    while queue:
+        t, n, idx, g, attempts = heapq.heappop(queue)
+        ch = n % medium.channels
+        active = busy[ch]
+        while active and active[0][0] <= t:
+            heapq.heappop(active)
+
+        # A transmission is only sensed once it has been on air for the CCA time
+        if medium.mac == "csma" and any(s <= t - medium.cca for _, s in active):
+            if attempts >= medium.max_backoffs:
+                dropped.append(g)
+                schedule_next(n, idx, t)
+                continue
+            delay = rng.randint(1, 2 ** (attempts + 1)) * medium.backoff_slot
+            heapq.heappush(queue, (t + delay, n, idx, g, attempts + 1))
+            continue
+
+        end = t + air
+        heapq.heappush(active, (end, t))
+        txs.append((t, end, ch, n, g, pending[n][1][idx][1]))
+        schedule_next(n, idx, end + medium.off_time)
+
+    # A frame survives if it overlaps nothing, or captures the receiver.
+    txs.sort()
+    starts = [tx[0] for tx in txs]
+    lost = [False] * len(txs)
+    for i, (s, e, ch, n, _, _) in enumerate(txs):
+        j = bisect.bisect_left(starts, e)
+        for k in range(i + 1, j):
+            if txs[k][2] != ch:
+                continue
+            m = txs[k][3]
+            if medium.capture_db is None:
+                lost[i] = lost[k] = True
+                continue
+            if rssi[n] - rssi[m] < medium.capture_db:
+                lost[i] = True
+            if rssi[m] - rssi[n] < medium.capture_db:
+                lost[k] = True
+
+    in_window = [t0 <= tx[4] < t1 for tx in txs]
+    offered = sum(in_window) + sum(1 for g in dropped if t0 <= g < t1)
+    delivered = [tx for tx, w, l in zip(txs, in_window, lost) if w and not l]
+    collided = sum(1 for w, l in zip(in_window, lost) if w and l)
+    latencies = sorted(tx[1] - tx[4] for tx in delivered)
+
+    # Channel busy time (union of overlapping transmissions) inside the window
+    busy_time = 0.0
+    per_node = {}
+    for ch in range(medium.channels):
+        cur_s = cur_e = None
+        for s, e, c, n, _, _ in txs:
+            if c != ch:
+                continue
+            s, e = max(s, t0), min(e, t1)
+            if e <= s:
+                continue
+            per_node[n] = per_node.get(n, 0.0) + (e - s)
+            if cur_e is None or s > cur_e:
+                if cur_e is not None:
+                    busy_time += cur_e - cur_s
+                cur_s, cur_e = s, e
+            else:
+                cur_e = max(cur_e, e)
+        if cur_e is not None:
+            busy_time += cur_e - cur_s
+
+    span = t1 - t0
+
+    def pct(p):
+        return latencies[min(len(latencies) - 1, int(p * len(latencies)))] if latencies else float("nan")
+
+    stats = {
+        "nodes": len(traces),
+        "offered": offered,
+        "delivered": len(delivered),
+        "collided": collided,
+        "lbt_dropped": sum(1 for g in dropped if t0 <= g < t1),
+        "pdr": len(delivered) / offered if offered else float("nan"),
+        "collision_rate": collided / sum(in_window) if any(in_window) else float("nan"),
+        "delivered_per_min": len(delivered) / span * 60.0,
+        "load_g": sum(1 for w in in_window if w) * air / (span * medium.channels),
+        "utilization": busy_time / (span * medium.channels),
+        "max_node_duty": max(per_node.values()) / span if per_node else 0.0,
+        "lat_mean": sum(latencies) / len(latencies) if latencies else float("nan"),
+        "lat_p50": pct(0.50),
+        "lat_p95": pct(0.95),
+        "lat_max": latencies[-1] if latencies else float("nan"),
+    }
+    delivered.sort(key=lambda tx: tx[1])
+    return stats, [tx[5] for tx in delivered]
+
+
+# --- Report -------------------------------------------------------------------
+
+COLUMNS = [
+    # key,                header,     format
+    ("nodes",             "nodes",    "{:>5d}"),
+    ("offered",           "offered",  "{:>8d}"),
+    ("delivered",         "rx",       "{:>8d}"),
+    ("collided",          "collided", "{:>8d}"),
+    ("lbt_dropped",       "lbt_drop", "{:>8d}"),
+    ("pdr",               "PDR",      "{:>6.3f}"),
+    ("collision_rate",    "coll",     "{:>6.3f}"),
+    ("delivered_per_min", "rx/min",   "{:>8.2f}"),
+    ("load_g",            "G",        "{:>7.4f}"),
+    ("utilization",       "util",     "{:>7.4f}"),
+    ("max_node_duty",     "node_dc",  "{:>8.5f}"),
+    ("lat_mean",          "lat_mean", "{:>8.3f}"),
+    ("lat_p50",           "lat_p50",  "{:>8.3f}"),
+    ("lat_p95",           "lat_p95",  "{:>8.3f}"),
+    ("lat_max",           "lat_max",  "{:>8.3f}"),
+]
+
+
+def print_report(medium, args, reports):
+    """reports: {timing: [stats per fleet size]}"""
+    duty = "off" if args.duty_cycle <= 0 else f"{args.duty_cycle * 100:g}%"
+    capture = "off" if medium.capture_db is None else f"{medium.capture_db:g} dB"
+    every = TIER_GPS_EVERY[args.tier]
+    fixes = f"every {every} cycle(s)" if every else "at boot only"
+    print(f"clock error up to {args.ppm:g} ppm, slot timing from a GPS fix {fixes} ({args.tier})")
+    print(f"time on air {medium.airtime * 1000:.1f} ms (SF{args.sf}, {args.bw:g} kHz, CR 4/{args.cr + 4}, "
+          f"{FRAME_SIZE + args.overhead} B), MAC {args.mac}, {args.channels} channel(s), "
+          f"duty cycle {duty}, capture {capture}")
+    for timing, rows in reports.items():
+        print(f"\nuplink timing: {timing}")
+        print(" ".join(header.rjust(len(fmt.format(0))) for _, header, fmt in COLUMNS))
+        for row in rows:
+            print(" ".join(fmt.format(row[key]) for key, _, fmt in COLUMNS))
+    print("\nlatencies in s (generation to end of reception); coll = fraction of the frames sent that "
+          "collided; G = offered airtime per channel-second; util = busy fraction of the channel; "
+          "node_dc = highest per-node duty cycle")
+
+    if len(reports) == len(TIMINGS):
+        free, slots = (reports[t] for t in TIMINGS)
+        print("\ncollision rate, free-running vs slots:")
+        print("nodes     free    slots")
+        for a, b in zip(free, slots):
+            print(f"{a['nodes']:>5d} {a['collision_rate']:>8.4f} {b['collision_rate']:>8.4f}")
+
+
+def forward_to_gateway(target, frames):
+    host, port = target.rsplit(":", 1)
+    with socket.socket(socket.AF_INET, socket.SOCK_DGRAM) as sock:
+        for raw in frames:
+            sock.sendto(raw, (host, int(port)))
+    print(f"forwarded {len(frames)} delivered frames to {target}")
+
+
+def parse_sizes(text):
+    sizes = sorted({int(x) for x in text.split(",") if x.strip()})
+    if not sizes or sizes[0] < 1:
+        raise argparse.ArgumentTypeError("fleet sizes must be positive integers")
+    return sizes
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    src = parser.add_mutually_exclusive_group(required=True)
+    src.add_argument("--exe", help="native_sim build of the firmware (build/zephyr/zephyr.exe)")
+    src.add_argument("--replay", metavar="DIR", help="reuse node_<id>.log files from an earlier run")
+    parser.add_argument("--nodes", type=parse_sizes, default=parse_sizes("1,2,4,8,16,32,64"),
+                        help="comma-separated fleet sizes")
+    parser.add_argument("--hours", type=float, default=24.0, help="simulated time per node")
+    parser.add_argument("--mode", type=int, default=1, choices=(0, 1, 2), help="0 TEST, 1 NORMAL, 2 ADVANCED")
+    parser.add_argument("--timing", choices=TIMINGS + ("both",), default="both",
+                        help="uplink timing of the nodes (slots only apply to NORMAL_MODE)")
+    parser.add_argument("--start-hour", type=float, default=0.0, help="UTC time of day when the first node boots")
+    parser.add_argument("--stagger", type=float, default=900.0, help="nodes power on within this many seconds")
+    parser.add_argument("--ppm", type=float, default=20.0, help="node clock error bound (ppm)")
+    parser.add_argument("--tier", choices=tuple(TIER_GPS_EVERY), default="FULL",
+                        help="energy tier whose GPS fix interval bounds the slot timing error")
+    parser.add_argument("--jobs", type=int, default=os.cpu_count() or 1, help="instances run in parallel")
+    parser.add_argument("--logs", metavar="DIR", help="keep node console logs in DIR")
+    parser.add_argument("--seed", type=int, default=1)
+
+    radio = parser.add_argument_group("radio medium")
+    radio.add_argument("--sf", type=int, default=9, choices=range(6, 13), help="LoRa spreading factor")
+    radio.add_argument("--bw", type=float, default=125.0, help="bandwidth (kHz)")
+    radio.add_argument("--cr", type=int, default=1, choices=range(1, 5), help="coding rate 4/(4+CR)")
+    radio.add_argument("--preamble", type=int, default=8, help="preamble symbols")
+    radio.add_argument("--overhead", type=int, default=0, help="link-layer bytes added to each frame")
+    radio.add_argument("--duty-cycle", type=float, default=0.01, help="per-node duty-cycle limit (0 = none)")
+    radio.add_argument("--channels", type=int, default=1, help="channels; node n uses channel n %% channels")
+    radio.add_argument("--mac", choices=("aloha", "csma"), default="aloha")
+    radio.add_argument("--cca", type=float, default=1.0,
+                       help="CSMA clear-channel assessment time (ms); later starts are not sensed")
+    radio.add_argument("--backoff-slot", type=float, default=50.0, help="CSMA backoff slot (ms)")
+    radio.add_argument("--max-backoffs", type=int, default=6, help="CSMA attempts before a frame is dropped")
+    radio.add_argument("--capture-db", type=float, default=6.0, help="power margin for capture")
+    radio.add_argument("--no-capture", action="store_true", help="any overlap destroys both frames")
+    radio.add_argument("--rssi-spread", type=float, default=20.0, help="spread of node received power (dB)")
+
+    parser.add_argument("--csv", metavar="FILE", help="also write the report as CSV")
+    parser.add_argument("--gateway", metavar="HOST:PORT", help="forward frames delivered to the largest fleet")
+    args = parser.parse_args()
+
+    if args.channels < 1:
+        parser.error("--channels must be at least 1")
+
+    max_nodes = args.nodes[-1]
+    node_ids = list(range(1, max_nodes + 1))
+    schedule = node_schedule(node_ids, args.seed, args.stagger, args.ppm)
+
+    timings = TIMINGS if args.timing == "both" else (args.timing,)
+    if args.replay:
+        base = args.replay
+    else:
+        base = args.logs or tempfile.mkdtemp(prefix="fleet_sim_")
+        print(f"running {max_nodes} nodes for {args.hours:g} h each ({args.jobs} in parallel), "
+              f"timing {'/'.join(timings)}, logs in {base}", file=sys.stderr)
+
+    rng = random.Random(args.seed + 1)
+    rssi = {n: -80.0 - rng.uniform(0, args.rssi_spread) for n in node_ids}
+    medium = Medium(args)
+    window = (args.stagger, args.hours * 3600.0)
+    if window[1] <= window[0]:
+        parser.error("--hours must cover more than the power-on --stagger")
+
+    reports = {}
+    delivered = []
+    for timing in timings:
+        log_dir = os.path.join(base, timing)
+        if args.replay:
+            # A single-timing directory may also hold the logs directly
+            if not os.path.isdir(log_dir) and len(timings) == 1:
+                log_dir = base
+            paths = {n: os.path.join(log_dir, f"node_{n}.log") for n in node_ids}
+            missing = [n for n, p in paths.items() if not os.path.exists(p)]
+            if missing:
+                parser.error(f"{log_dir}: no log for node(s) {missing[:5]}")
+        else:
+            os.makedirs(log_dir, exist_ok=True)
+            paths = launch_fleet(args, node_ids, schedule, timing, log_dir)
+
+        traces = {}
+        for n in node_ids:
+            frames = [f for f in read_log(paths[n]) if f[0] == n]
+            frames.sort(key=lambda f: f[2])
+            traces[n] = [(f[2], f[3]) for f in frames]
+        print(f"{timing}: {sum(len(t) for t in traces.values())} frames captured", file=sys.stderr)
+
+        timeline = slot_schedule(args, schedule) if timing == "slots" else schedule
+        rows = []
+        for size in args.nodes:
+            stats, delivered = simulate(medium, {n: traces[n] for n in node_ids[:size]}, timeline, rssi, window)
+            rows.append(stats)
+        reports[timing] = rows
+
+    print_report(medium, args, reports)
+
+    if args.csv:
+        with open(args.csv, "w", newline="") as f:
+            writer = csv.DictWriter(f, fieldnames=["timing"] + [key for key, _, _ in COLUMNS])
+            writer.writeheader()
+            for timing, rows in reports.items():
+                writer.writerows(dict({k: round(v, 6) if isinstance(v, float) else v for k, v in row.items()},
+                                      timing=timing) for row in rows)
+    if args.gateway:
+        forward_to_gateway(args.gateway, delivered)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,261 @@
+/**
+ * @file column_store.cpp
+ * @brief Append-only columnar store for decoded telemetry.
+ */
+
+#include "column_store.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__,
+              "Column files are written in host order, which must be little-endian");
+
+namespace gateway {
+
+const std::array<ColumnDef, kColumnCount> kColumns = {{
+    {"rx_us",       ColumnType::I64},
+    {"node_id",     ColumnType::U32},
+    {"seq",         ColumnType::U32},
+    {"uptime_ms",   ColumnType::U32},
+    {"mode",        ColumnType::U8},
+    {"brightness",  ColumnType::I16},
+    {"moisture",    ColumnType::I16},
+    {"temp",        ColumnType::I16},
+    {"hum",         ColumnType::I16},
+    {"red",         ColumnType::U16},
+    {"green",       ColumnType::U16},
+    {"blue",        ColumnType::U16},
+    {"clear",       ColumnType::U16},
+    {"accel_x",     ColumnType::I16},
+    {"accel_y",     ColumnType::I16},
+    {"accel_z",     ColumnType::I16},
+    {"gps_lat",     ColumnType::I32},
+    {"gps_lon",     ColumnType::I32},
+    {"gps_alt",     ColumnType::I32},
+    {"gps_time",    ColumnType::I32},
+    {"gps_sats",    ColumnType::U8},
+    {"health",      ColumnType::U8},
+    {"health_conf", ColumnType::U8},
+    {"anomaly",     ColumnType::U16},
+}};
+
+std::size_t column_type_size(ColumnType type)
+{
+    switch (type) {
+    case ColumnType::U8:  return 1;
+    case ColumnType::I16:
+    case ColumnType::U16: return 2;
+    case ColumnType::I32:
+    case ColumnType::U32: return 4;
+    case ColumnType::I64: return 8;
+    }
+    return 0;
+}
+
+const char *column_type_name(ColumnType type)
+{
+    switch (type) {
+    case ColumnType::U8:  return "u8";
+    case ColumnType::I16: return "i16";
+    case ColumnType::U16: return "u16";
+    case ColumnType::I32: return "i32";
+    case ColumnType::U32: return "u32";
+    case ColumnType::I64: return "i64";
+    }
+    return "?";
+}
+
+/**
+ * @brief Throw a runtime_error carrying strerror(errno).
+ */
+[[noreturn]] static void throw_errno(const std::string &what)
+{
+    throw std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+/**
+ * @brief Write the whole buffer, retrying on short writes.
+ */
+static void write_all(int fd, const uint8_t *data, std::size_t len, const std::string &what)
+{
+    while (len > 0) {
+        ssize_t n = ::write(fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw_errno("write " + what);
+        }
+        data += n;
+        len -= static_cast<std::size_t>(n);
+    }
+}
+
+ColumnStore::ColumnStore(const std::string &dir, bool sync) : dir_(dir), sync_(sync)
+{
+    fds_.fill(-1);
+
+    if (::mkdir(dir_.c_str(), 0755) < 0 && errno != EEXIST) {
+        throw_errno("mkdir " + dir_);
+    }
+
+    const std::string rows_path = dir_ + "/rows";
+    rows_fd_ = ::open(rows_path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (rows_fd_ < 0) {
+        throw_errno("open " + rows_path);
+    }
+
+    uint64_t committed = 0;
+    ssize_t n = ::pread(rows_fd_, &committed, sizeof(committed), 0);
+    if (n == static_cast<ssize_t>(sizeof(committed))) {
+        rows_ = committed;
+        check_schema();
+    } else {
+        rows_ = 0;
+        write_schema();
+    }
+
+    open_columns();
+}
+
+ColumnStore::~ColumnStore()
+{
+    try {
+        flush();
+    } catch (const std::exception &) {
+        /* Destructors must not throw; uncommitted rows are lost. */
+    }
+    for (int fd : fds_) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+    if (rows_fd_ >= 0) {
+        ::close(rows_fd_);
+    }
+}
+
+void ColumnStore::write_schema()
+{
+    std::ofstream out(dir_ + "/schema", std::ios::trunc);
+    for (const ColumnDef &col : kColumns) {
+        out << col.name << ' ' << column_type_name(col.type) << '\n';
+    }
+    if (!out) {
+        throw std::runtime_error("cannot write " + dir_ + "/schema");
+    }
+}
+
+void ColumnStore::check_schema()
+{
+    std::ifstream in(dir_ + "/schema");
+    std::ostringstream expected;
+    for (const ColumnDef &col : kColumns) {
+        expected << col.name << ' ' << column_type_name(col.type) << '\n';
+    }
+    std::ostringstream actual;
+    actual << in.rdbuf();
+    if (actual.str() != expected.str()) {
+        throw std::runtime_error(dir_ + ": schema does not match this gateway version");
+    }
+}
+
+void ColumnStore::open_columns()
+{
+    for (std::size_t i = 0; i < kColumnCount; i++) {
+        const std::string path = dir_ + "/" + kColumns[i].name + ".col";
+        fds_[i] = ::open(path.c_str(), O_WRONLY | O_CREAT, 0644);
+        if (fds_[i] < 0) {
+            throw_errno("open " + path);
+        }
+
+        /* Drop bytes of a batch that was written but never committed. */
+        const off_t committed = static_cast<off_t>(rows_ * column_type_size(kColumns[i].type));
+        if (::ftruncate(fds_[i], committed) < 0) {
+            throw_errno("truncate " + path);
+        }
+        if (::lseek(fds_[i], committed, SEEK_SET) < 0) {
+            throw_errno("seek " + path);
+        }
+    }
+}
+
+/**
+ * @brief Append one value in host (little-endian) order.
+ */
+template <typename T>
+static inline void put(std::vector<uint8_t> &buf, T value)
+{
+    const std::size_t at = buf.size();
+    buf.resize(at + sizeof(T));
+    std::memcpy(&buf[at], &value, sizeof(T));
+}
+
+void ColumnStore::append(const Record &rec)
+{
+    const telemetry_frame &f = rec.frame;
+    std::size_t c = 0;
+
+    put<int64_t>(buffers_[c++], rec.rx_us);
+    put<uint32_t>(buffers_[c++], f.node_id);
+    put<uint32_t>(buffers_[c++], f.seq);
+    put<uint32_t>(buffers_[c++], f.uptime_ms);
+    put<uint8_t>(buffers_[c++], f.mode);
+    put<int16_t>(buffers_[c++], f.brightness);
+    put<int16_t>(buffers_[c++], f.moisture);
+    put<int16_t>(buffers_[c++], f.temp);
+    put<int16_t>(buffers_[c++], f.hum);
+    put<uint16_t>(buffers_[c++], f.red);
+    put<uint16_t>(buffers_[c++], f.green);
+    put<uint16_t>(buffers_[c++], f.blue);
+    put<uint16_t>(buffers_[c++], f.clear);
+    put<int16_t>(buffers_[c++], f.accel_x);
+    put<int16_t>(buffers_[c++], f.accel_y);
+    put<int16_t>(buffers_[c++], f.accel_z);
+    put<int32_t>(buffers_[c++], f.gps_lat);
+    put<int32_t>(buffers_[c++], f.gps_lon);
+    put<int32_t>(buffers_[c++], f.gps_alt);
+    put<int32_t>(buffers_[c++], f.gps_time);
+    put<uint8_t>(buffers_[c++], f.gps_sats);
+    put<uint8_t>(buffers_[c++], f.health);
+    put<uint8_t>(buffers_[c++], f.health_conf);
+    put<uint16_t>(buffers_[c++], f.anomaly);
+
+    pending_++;
+}
+
+void ColumnStore::flush()
+{
+    if (pending_ == 0) {
+        return;
+    }
+
+    for (std::size_t i = 0; i < kColumnCount; i++) {
+        write_all(fds_[i], buffers_[i].data(), buffers_[i].size(), kColumns[i].name);
+        if (sync_ && ::fdatasync(fds_[i]) < 0) {
+            throw_errno(std::string("sync ") + kColumns[i].name);
+        }
+        buffers_[i].clear();
+    }
+
+    const uint64_t committed = rows_ + pending_;
+    if (::pwrite(rows_fd_, &committed, sizeof(committed), 0) != static_cast<ssize_t>(sizeof(committed))) {
+        throw_errno("commit rows");
+    }
+    if (sync_ && ::fdatasync(rows_fd_) < 0) {
+        throw_errno("sync rows");
+    }
+
+    rows_ = committed;
+    pending_ = 0;
+}
+
+} // namespace gateway
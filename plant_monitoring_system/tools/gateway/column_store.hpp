@@ -0,0 +1,103 @@
+/**
+ * @file column_store.hpp
+ * @brief Append-only columnar store for decoded telemetry.
+ *
+ * A store is a directory with one raw little-endian file per column
+ * (@c <name>.col), a @c schema file listing "name type" per line, and a
+ * @c rows file holding the committed row count as a uint64.
+ *
+ * Rows are appended in batches: every column file is extended first and the
+ * row count is updated last, so a crash can only leave uncommitted bytes at
+ * the end of some columns. Those are truncated when the store is reopened.
+ */
+
+#ifndef GATEWAY_COLUMN_STORE_HPP
+#define GATEWAY_COLUMN_STORE_HPP
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "telemetry_frame.h"
+
+namespace gateway {
+
+/** @brief Storage type of a column. */
+enum class ColumnType : uint8_t { U8, I16, U16, I32, U32, I64 };
+
+/** @brief Column descriptor. */
+struct ColumnDef {
+    const char *name;
+    ColumnType type;
+};
+
+/** @brief One decoded frame with its gateway receive time. */
+struct Record {
+    int64_t rx_us;                 /**< Gateway receive time (µs since the Unix epoch). */
+    struct telemetry_frame frame;  /**< Decoded frame. */
+};
+
+constexpr std::size_t kColumnCount = 24;
+
+/** @brief Column layout, in file order. */
+extern const std::array<ColumnDef, kColumnCount> kColumns;
+
+/** @brief Size in bytes of one value of @p type. */
+std::size_t column_type_size(ColumnType type);
+
+/** @brief Name of @p type as written in the schema file. */
+const char *column_type_name(ColumnType type);
+
+/**
+ * @brief Append-only writer for a column store directory.
+ *
+ * Not thread-safe: the gateway uses a single writer thread.
+ */
+class ColumnStore {
+public:
+    /**
+     * @brief Open or create a store.
+     *
+     * @param dir Store directory (created if missing).
+     * @param sync Call fdatasync() after every committed batch.
+     * @throws std::runtime_error on I/O errors or schema mismatch.
+     */
+    explicit ColumnStore(const std::string &dir, bool sync = false);
+    ~ColumnStore();
+
+    ColumnStore(const ColumnStore &) = delete;
+    ColumnStore &operator=(const ColumnStore &) = delete;
+
+    /** @brief Buffer one row; nothing is written until flush(). */
+    void append(const Record &rec);
+
+    /**
+     * @brief Write all buffered rows and commit the new row count.
+     * @throws std::runtime_error on I/O errors.
+     */
+    void flush();
+
+    /** @brief Number of buffered, uncommitted rows. */
+    std::size_t pending() const { return pending_; }
+
+    /** @brief Number of committed rows. */
+    uint64_t rows() const { return rows_; }
+
+private:
+    void open_columns();
+    void write_schema();
+    void check_schema();
+
+    std::string dir_;
+    bool sync_;
+    int rows_fd_ = -1;
+    uint64_t rows_ = 0;
+    std::size_t pending_ = 0;
+    std::array<int, kColumnCount> fds_{};
+    std::array<std::vector<uint8_t>, kColumnCount> buffers_;
+};
+
+} // namespace gateway
+
+#endif // GATEWAY_COLUMN_STORE_HPP
@@ -0,0 +1,145 @@
+/**
+ * @file gateway_main.cpp
+ * @brief Telemetry ingest daemon for a fleet of plant monitoring nodes.
+ *
+ * Receives @ref telemetry_frame packets, decodes them on a pool of decoder
+ * threads and appends them in batches to a column store.
+ *
+ * Usage:
+ * @verbatim
+ *   plant_gateway --store DIR (--udp PORT | --unix PATH | --serial DEV|-)
+ *                 [--baud N] [--decoders N] [--batch ROWS] [--flush-ms MS] [--sync]
+ * @endverbatim
+ *
+ * The daemon runs until SIGINT/SIGTERM (or end of input for --serial) and
+ * prints the pipeline counters on exit.
+ */
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <string>
+#include <thread>
+
+#include <getopt.h>
+
+#include "column_store.hpp"
+#include "pipeline.hpp"
+#include "sources.hpp"
+
+using namespace gateway;
+
+static std::atomic<bool> stop_requested{false};
+
+static void handle_signal(int)
+{
+    stop_requested.store(true);
+}
+
+static void usage(const char *argv0)
+{
+    std::fprintf(stderr,
+        "Usage: %s --store DIR (--udp PORT | --unix PATH | --serial DEV|-)\n"
+        "          [--baud N] [--decoders N] [--batch ROWS] [--flush-ms MS] [--sync]\n",
+        argv0);
+}
+
+static void print_stats(const PipelineStats &s, double seconds)
+{
+    const uint64_t written = s.written.load();
+    std::fprintf(stderr,
+        "[GATEWAY] - received %llu, decoded %llu, written %llu in %llu batches "
+        "(%.0f rows/s)\n"
+        "[GATEWAY] - malformed %llu, crc errors %llu, lost %llu, duplicates %llu\n",
+        (unsigned long long)s.received.load(), (unsigned long long)s.decoded.load(),
+        (unsigned long long)written, (unsigned long long)s.batches.load(),
+        seconds > 0 ? written / seconds : 0.0,
+        (unsigned long long)s.malformed.load(), (unsigned long long)s.crc_errors.load(),
+        (unsigned long long)s.lost.load(), (unsigned long long)s.duplicates.load());
+}
+
+int main(int argc, char **argv)
+{
+    std::string store_dir, unix_path, serial_path;
+    unsigned udp_port = 0, baud = 115200;
+    bool sync = false;
+    PipelineConfig cfg;
+    cfg.decoders = std::thread::hardware_concurrency() > 1 ? std::thread::hardware_concurrency() - 1 : 1;
+
+    static const struct option options[] = {
+        {"store",    required_argument, nullptr, 's'},
+        {"udp",      required_argument, nullptr, 'u'},
+        {"unix",     required_argument, nullptr, 'x'},
+        {"serial",   required_argument, nullptr, 'S'},
+        {"baud",     required_argument, nullptr, 'b'},
+        {"decoders", required_argument, nullptr, 'd'},
+        {"batch",    required_argument, nullptr, 'B'},
+        {"flush-ms", required_argument, nullptr, 'f'},
+        {"sync",     no_argument,       nullptr, 'y'},
+        {"help",     no_argument,       nullptr, 'h'},
+        {nullptr, 0, nullptr, 0},
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "s:u:x:S:b:d:B:f:yh", options, nullptr)) != -1) {
+        switch (opt) {
+        case 's': store_dir = optarg; break;
+        case 'u': udp_port = static_cast<unsigned>(std::strtoul(optarg, nullptr, 10)); break;
+        case 'x': unix_path = optarg; break;
+        case 'S': serial_path = optarg; break;
+        case 'b': baud = static_cast<unsigned>(std::strtoul(optarg, nullptr, 10)); break;
+        case 'd': cfg.decoders = static_cast<unsigned>(std::strtoul(optarg, nullptr, 10)); break;
+        case 'B': cfg.batch_rows = std::strtoul(optarg, nullptr, 10); break;
+        case 'f': cfg.flush_ms = static_cast<unsigned>(std::strtoul(optarg, nullptr, 10)); break;
+        case 'y': sync = true; break;
+        default:
+            usage(argv[0]);
+            return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    const int sources = (udp_port != 0) + !unix_path.empty() + !serial_path.empty();
+    if (store_dir.empty() || sources != 1 || udp_port > 65535) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::signal(SIGINT, handle_signal);
+    std::signal(SIGTERM, handle_signal);
+
+    try {
+        ColumnStore store(store_dir, sync);
+        Pipeline pipeline(&store, cfg);
+
+        std::fprintf(stderr, "[GATEWAY] - Store %s (%llu rows), %u decoder(s), batch %zu\n",
+                     store_dir.c_str(), (unsigned long long)store.rows(), cfg.decoders,
+                     cfg.batch_rows);
+
+        const int64_t start = now_us();
+        pipeline.start();
+
+        int ret;
+        if (udp_port != 0) {
+            ret = run_udp_source(static_cast<uint16_t>(udp_port), pipeline, stop_requested);
+        } else if (!unix_path.empty()) {
+            ret = run_unix_source(unix_path, pipeline, stop_requested);
+        } else {
+            ret = run_serial_source(serial_path, baud, pipeline, stop_requested);
+        }
+
+        pipeline.stop();
+        print_stats(pipeline.stats(), (now_us() - start) / 1e6);
+
+        if (ret < 0) {
+            std::fprintf(stderr, "[GATEWAY] - Source error: %s\n", std::strerror(-ret));
+            return EXIT_FAILURE;
+        }
+    } catch (const std::exception &e) {
+        std::fprintf(stderr, "[GATEWAY] - %s\n", e.what());
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,296 @@
+/**
+ * @file loadgen_main.cpp
+ * @brief Synthetic fleet traffic generator for the ingest gateway.
+ *
+ * Every simulated node produces frames that follow a daily light and
+ * temperature cycle, a slowly drying soil with periodic watering, and
+ * node-specific offsets, so the data is plausible enough to exercise the
+ * store and the query tools.
+ *
+ * Usage:
+ * @verbatim
+ *   plant_loadgen --udp HOST:PORT | --unix PATH   [--nodes N] [--frames N] [--rate FPS]
+ *   plant_loadgen --bench [--nodes N] [--frames N] [--max-decoders N] [--store DIR]
+ * @endverbatim
+ *
+ * --bench replays the frames through the pipeline in-process with 1, 2, 4 …
+ * decoder threads and prints the throughput for each, which shows how the
+ * decode stage scales across cores without the kernel socket path in the way.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <getopt.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "column_store.hpp"
+#include "pipeline.hpp"
+#include "telemetry_frame.h"
+
+using namespace gateway;
+
+constexpr uint32_t kSamplePeriodMs = 60000;  /**< Simulated NORMAL_MODE period. */
+constexpr double kPi = 3.14159265358979323846;
+
+/**
+ * @brief Deterministic per-node pseudo-random generator (xorshift32).
+ */
+static uint32_t next_random(uint32_t &state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+/**
+ * @brief Build the frame of @p node at sample @p seq.
+ */
+static void make_frame(uint32_t node, uint32_t seq, uint8_t *buf)
+{
+    uint32_t rng = (node + 1) * 2654435761u ^ seq * 40503u;
+    next_random(rng);
+
+    const uint32_t uptime = seq * kSamplePeriodMs;
+    const double day_fraction = std::fmod(uptime / 86400000.0 + (node % 24) / 24.0, 1.0);
+    const double sun = std::max(0.0, std::sin(2 * kPi * (day_fraction - 0.25)));
+    const double noise = (next_random(rng) % 1000) / 1000.0 - 0.5;
+    /* Soil dries linearly and is watered every ~3 days. */
+    const double dryness = std::fmod(uptime / (3 * 86400000.0) + (node % 7) / 7.0, 1.0);
+
+    struct telemetry_frame f = {};
+    f.mode = 1;
+    f.node_id = node;
+    f.seq = seq;
+    f.uptime_ms = uptime;
+    f.brightness = static_cast<int16_t>(10 * (5 + 90 * sun + 2 * noise));
+    f.moisture = static_cast<int16_t>(10 * (80 - 55 * dryness + noise));
+    f.temp = static_cast<int16_t>(100 * (14 + (node % 5) + 10 * sun + noise));
+    f.hum = static_cast<int16_t>(100 * (70 - 25 * sun + 2 * noise));
+    f.red = static_cast<uint16_t>(200 + 1800 * sun);
+    f.green = static_cast<uint16_t>(300 + 2600 * sun);
+    f.blue = static_cast<uint16_t>(150 + 1200 * sun);
+    f.clear = static_cast<uint16_t>(f.red + f.green + f.blue);
+    f.accel_x = static_cast<int16_t>(5 * noise);
+    f.accel_y = static_cast<int16_t>(-5 * noise);
+    f.accel_z = 981;
+    f.gps_lat = 40416775 + static_cast<int32_t>(node * 1000);
+    f.gps_lon = -3703790 + static_cast<int32_t>(node * 1000);
+    f.gps_alt = 65000;
+    const uint32_t secs = (uptime / 1000) % 86400;
+    f.gps_time = static_cast<int32_t>((secs / 3600) * 10000 + ((secs / 60) % 60) * 100 + secs % 60);
+    f.gps_sats = static_cast<uint8_t>(6 + node % 5);
+    f.health = 0;
+    f.health_conf = 90;
+    f.anomaly = 0;
+
+    telemetry_encode(&f, buf);
+}
+
+/**
+ * @brief Pre-generate @p frames frames interleaved across @p nodes nodes.
+ */
+static std::vector<uint8_t> generate(uint32_t nodes, uint64_t frames)
+{
+    std::vector<uint8_t> data(frames * TELEMETRY_FRAME_SIZE);
+    for (uint64_t i = 0; i < frames; i++) {
+        make_frame(static_cast<uint32_t>(i % nodes), static_cast<uint32_t>(i / nodes),
+                   &data[i * TELEMETRY_FRAME_SIZE]);
+    }
+    return data;
+}
+
+static int run_bench(uint32_t nodes, uint64_t frames, unsigned max_decoders,
+                     const std::string &store_dir)
+{
+    const std::vector<uint8_t> data = generate(nodes, frames);
+
+    if (!store_dir.empty() && ::mkdir(store_dir.c_str(), 0755) < 0 && errno != EEXIST) {
+        std::fprintf(stderr, "[LOADGEN] - Cannot create %s: %s\n", store_dir.c_str(), std::strerror(errno));
+        return EXIT_FAILURE;
+    }
+
+    std::printf("decoders  frames/s     ns/frame  written\n");
+    for (unsigned d = 1; d <= max_decoders; d *= 2) {
+        std::unique_ptr<ColumnStore> store;
+        if (!store_dir.empty()) {
+            store = std::make_unique<ColumnStore>(store_dir + "/bench_d" + std::to_string(d));
+        }
+
+        PipelineConfig cfg;
+        cfg.decoders = d;
+        Pipeline pipeline(store.get(), cfg);
+
+        const int64_t start = now_us();
+        pipeline.start();
+        for (uint64_t i = 0; i < frames; i++) {
+            pipeline.submit(&data[i * TELEMETRY_FRAME_SIZE], TELEMETRY_FRAME_SIZE, start);
+        }
+        pipeline.stop();
+        const double seconds = (now_us() - start) / 1e6;
+
+        std::printf("%8u  %10.0f  %9.1f  %llu\n", d, frames / seconds, seconds * 1e9 / frames,
+                    (unsigned long long)pipeline.stats().written.load());
+    }
+    std::printf("(%u hardware threads)\n", std::thread::hardware_concurrency());
+    return EXIT_SUCCESS;
+}
+
+static int open_udp(const std::string &target, struct sockaddr_storage *addr, socklen_t *len)
+{
+    const std::size_t colon = target.rfind(':');
+    if (colon == std::string::npos) {
+        return -EINVAL;
+    }
+    auto *in = reinterpret_cast<struct sockaddr_in *>(addr);
+    in->sin_family = AF_INET;
+    in->sin_port = htons(static_cast<uint16_t>(std::atoi(target.c_str() + colon + 1)));
+    if (inet_pton(AF_INET, target.substr(0, colon).c_str(), &in->sin_addr) != 1) {
+        return -EINVAL;
+    }
+    *len = sizeof(*in);
+    return ::socket(AF_INET, SOCK_DGRAM, 0);
+}
+
+static int open_unix(const std::string &path, struct sockaddr_storage *addr, socklen_t *len)
+{
+    auto *un = reinterpret_cast<struct sockaddr_un *>(addr);
+    if (path.size() >= sizeof(un->sun_path)) {
+        return -ENAMETOOLONG;
+    }
+    un->sun_family = AF_UNIX;
+    std::memcpy(un->sun_path, path.c_str(), path.size() + 1);
+    *len = sizeof(*un);
+    return ::socket(AF_UNIX, SOCK_DGRAM, 0);
+}
+
+static int run_send(int fd, const struct sockaddr_storage &addr, socklen_t addr_len,
+                    uint32_t nodes, uint64_t frames, double rate)
+{
+    uint8_t buf[TELEMETRY_FRAME_SIZE];
+    const int64_t start = now_us();
+    uint64_t sent = 0, failed = 0;
+
+    for (uint64_t i = 0; i < frames; i++) {
+        make_frame(static_cast<uint32_t>(i % nodes), static_cast<uint32_t>(i / nodes), buf);
+
+        if (rate > 0) {
+            const int64_t due = start + static_cast<int64_t>(i * 1e6 / rate);
+            const int64_t wait = due - now_us();
+            if (wait > 0) {
+                std::this_thread::sleep_for(std::chrono::microseconds(wait));
+            }
+        }
+
+        if (::sendto(fd, buf, sizeof(buf), 0, reinterpret_cast<const struct sockaddr *>(&addr),
+                     addr_len) == static_cast<ssize_t>(sizeof(buf))) {
+            sent++;
+        } else {
+            failed++;
+        }
+    }
+
+    const double seconds = (now_us() - start) / 1e6;
+    std::printf("sent %llu frames from %u nodes in %.2f s (%.0f frames/s), %llu send errors\n",
+                (unsigned long long)sent, nodes, seconds, sent / seconds,
+                (unsigned long long)failed);
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static void usage(const char *argv0)
+{
+    std::fprintf(stderr,
+        "Usage: %s --udp HOST:PORT | --unix PATH  [--nodes N] [--frames N] [--rate FPS]\n"
+        "       %s --bench [--nodes N] [--frames N] [--max-decoders N] [--store DIR]\n",
+        argv0, argv0);
+}
+
+int main(int argc, char **argv)
+{
+    std::string udp, unix_path, store_dir;
+    uint32_t nodes = 64;
+    uint64_t frames = 1000000;
+    double rate = 0;
+    bool bench = false;
+    unsigned max_decoders = std::max(1u, std::thread::hardware_concurrency());
+
+    static const struct option options[] = {
+        {"udp",          required_argument, nullptr, 'u'},
+        {"unix",         required_argument, nullptr, 'x'},
+        {"nodes",        required_argument, nullptr, 'n'},
+        {"frames",       required_argument, nullptr, 'f'},
+        {"rate",         required_argument, nullptr, 'r'},
+        {"bench",        no_argument,       nullptr, 'b'},
+        {"max-decoders", required_argument, nullptr, 'd'},
+        {"store",        required_argument, nullptr, 's'},
+        {"help",         no_argument,       nullptr, 'h'},
+        {nullptr, 0, nullptr, 0},
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "u:x:n:f:r:bd:s:h", options, nullptr)) != -1) {
+        switch (opt) {
+        case 'u': udp = optarg; break;
+        case 'x': unix_path = optarg; break;
+        case 'n': nodes = static_cast<uint32_t>(std::strtoul(optarg, nullptr, 10)); break;
+        case 'f': frames = std::strtoull(optarg, nullptr, 10); break;
+        case 'r': rate = std::strtod(optarg, nullptr); break;
+        case 'b': bench = true; break;
+        case 'd': max_decoders = static_cast<unsigned>(std::strtoul(optarg, nullptr, 10)); break;
+        case 's': store_dir = optarg; break;
+        default:
+            usage(argv[0]);
+            return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    if (nodes == 0 || frames == 0) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (bench) {
+        try {
+            return run_bench(nodes, frames, std::max(1u, max_decoders), store_dir);
+        } catch (const std::exception &e) {
+            std::fprintf(stderr, "[LOADGEN] - %s\n", e.what());
+            return EXIT_FAILURE;
+        }
+    }
+
+    struct sockaddr_storage addr = {};
+    socklen_t addr_len = 0;
+    int fd;
+    if (!udp.empty()) {
+        fd = open_udp(udp, &addr, &addr_len);
+    } else if (!unix_path.empty()) {
+        fd = open_unix(unix_path, &addr, &addr_len);
+    } else {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (fd < 0) {
+        std::fprintf(stderr, "[LOADGEN] - Cannot open target: %s\n",
+                     std::strerror(fd == -1 ? errno : -fd));
+        return EXIT_FAILURE;
+    }
+
+    int ret = run_send(fd, addr, addr_len, nodes, frames, rate);
+    ::close(fd);
+    return ret;
+}
@@ -0,0 +1,220 @@
+/**
+ * @file pipeline.cpp
+ * @brief Multi-threaded telemetry decode pipeline.
+ */
+
+#include "pipeline.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace gateway {
+
+int64_t now_us()
+{
+    using namespace std::chrono;
+    return duration_cast<microseconds>(system_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief Back-off used while a queue is full or empty.
+ *
+ * Yields for the first iterations so short stalls stay cheap, then sleeps
+ * so idle threads do not burn a core.
+ */
+static void backoff(unsigned &spins)
+{
+    if (++spins < 64) {
+        std::this_thread::yield();
+    } else {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+}
+
+Pipeline::Pipeline(ColumnStore *store, const PipelineConfig &cfg) : store_(store), cfg_(cfg)
+{
+    if (cfg_.decoders == 0) {
+        cfg_.decoders = 1;
+    }
+    if (cfg_.batch_rows == 0) {
+        cfg_.batch_rows = 1;
+    }
+    for (unsigned i = 0; i < cfg_.decoders; i++) {
+        in_.push_back(std::make_unique<InQueue>());
+        out_.push_back(std::make_unique<OutQueue>());
+    }
+}
+
+Pipeline::~Pipeline()
+{
+    stop();
+}
+
+void Pipeline::start()
+{
+    for (unsigned i = 0; i < cfg_.decoders; i++) {
+        decoders_.emplace_back(&Pipeline::decoder_loop, this, i);
+    }
+    writer_ = std::thread(&Pipeline::writer_loop, this);
+}
+
+void Pipeline::submit(const uint8_t *data, std::size_t len, int64_t rx_us)
+{
+    stats_.received.fetch_add(1, std::memory_order_relaxed);
+
+    if (len < 8 || len > TELEMETRY_FRAME_SIZE) {
+        stats_.malformed.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    RawFrame raw;
+    raw.rx_us = rx_us;
+    raw.len = static_cast<uint16_t>(len);
+    std::memcpy(raw.data, data, len);
+
+    InQueue &q = *in_[telemetry_peek_node(data) % cfg_.decoders];
+    unsigned spins = 0;
+    while (!q.try_push(raw)) {
+        backoff(spins);
+    }
+}
+
+void Pipeline::stop()
+{
+    if (sources_done_.exchange(true)) {
+        return;
+    }
+    for (std::thread &t : decoders_) {
+        t.join();
+    }
+    if (writer_.joinable()) {
+        writer_.join();
+    }
+}
+
+void Pipeline::decoder_loop(unsigned index)
+{
+    InQueue &in = *in_[index];
+    OutQueue &out = *out_[index];
+    RawFrame raw;
+    unsigned spins = 0;
+
+    for (;;) {
+        /* Read the flag before popping: once it is set, an empty queue stays empty. */
+        const bool done = sources_done_.load(std::memory_order_acquire);
+        if (!in.try_pop(raw)) {
+            if (done) {
+                break;
+            }
+            backoff(spins);
+            continue;
+        }
+        spins = 0;
+
+        Record rec;
+        rec.rx_us = raw.rx_us;
+        int ret = telemetry_decode(raw.data, raw.len, &rec.frame);
+        if (ret == -EBADMSG) {
+            stats_.crc_errors.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        } else if (ret != 0) {
+            stats_.malformed.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        stats_.decoded.fetch_add(1, std::memory_order_relaxed);
+
+        unsigned out_spins = 0;
+        while (!out.try_push(rec)) {
+            backoff(out_spins);
+        }
+    }
+
+    decoders_done_.fetch_add(1, std::memory_order_release);
+}
+
+void Pipeline::account(const Record &rec)
+{
+    auto it = last_seq_.find(rec.frame.node_id);
+    if (it == last_seq_.end()) {
+        last_seq_.emplace(rec.frame.node_id, rec.frame.seq);
+        return;
+    }
+
+    const uint32_t delta = rec.frame.seq - it->second;
+    if (delta == 0 || delta > 0x80000000u) {
+        /* Replayed or reordered frame; a reboot restarts at 0 and is not a duplicate. */
+        if (rec.frame.seq != 0) {
+            stats_.duplicates.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    } else if (delta > 1) {
+        stats_.lost.fetch_add(delta - 1, std::memory_order_relaxed);
+    }
+    it->second = rec.frame.seq;
+}
+
+void Pipeline::writer_loop()
+{
+    using clock = std::chrono::steady_clock;
+    auto last_flush = clock::now();
+    std::size_t batch = 0;
+    unsigned spins = 0;
+    Record rec;
+
+    auto commit = [&]() {
+        if (batch == 0) {
+            return;
+        }
+        if (store_ != nullptr) {
+            try {
+                store_->flush();
+            } catch (const std::exception &e) {
+                /* Losing the store is unrecoverable; fail loudly instead of silently dropping. */
+                std::fprintf(stderr, "[GATEWAY] - Store write failed: %s\n", e.what());
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        stats_.written.fetch_add(batch, std::memory_order_relaxed);
+        stats_.batches.fetch_add(1, std::memory_order_relaxed);
+        batch = 0;
+        last_flush = clock::now();
+    };
+
+    for (;;) {
+        const bool decoders_finished =
+            decoders_done_.load(std::memory_order_acquire) == cfg_.decoders;
+        bool any = false;
+
+        for (auto &q : out_) {
+            /* Bounded drain per queue keeps the shards fair. */
+            for (unsigned n = 0; n < 256 && q->try_pop(rec); n++) {
+                any = true;
+                account(rec);
+                if (store_ != nullptr) {
+                    store_->append(rec);
+                }
+                if (++batch >= cfg_.batch_rows) {
+                    commit();
+                }
+            }
+        }
+
+        if (any) {
+            spins = 0;
+            continue;
+        }
+        if (decoders_finished) {
+            break;
+        }
+        if (batch > 0 && clock::now() - last_flush >= std::chrono::milliseconds(cfg_.flush_ms)) {
+            commit();
+        }
+        backoff(spins);
+    }
+
+    commit();
+}
+
+} // namespace gateway
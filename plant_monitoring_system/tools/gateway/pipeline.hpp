@@ -0,0 +1,120 @@
+/**
+ * @file pipeline.hpp
+ * @brief Multi-threaded telemetry decode pipeline.
+ *
+ * @verbatim
+ *               shard by node_id          decoded records
+ *   source ──► [SPSC] ──► decoder 0 ──► [SPSC] ──┐
+ *          ──► [SPSC] ──► decoder 1 ──► [SPSC] ──┼──► writer ──► ColumnStore
+ *          ──► [SPSC] ──► decoder N ──► [SPSC] ──┘    (batched)
+ * @endverbatim
+ *
+ * Frames are sharded by node identifier so that each node's frames keep
+ * their order and sequence gaps can be counted per node. All queues are
+ * lock-free SPSC rings; a full queue makes the producer spin and yield, so
+ * backpressure ends up in the socket receive buffer.
+ */
+
+#ifndef GATEWAY_PIPELINE_HPP
+#define GATEWAY_PIPELINE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "column_store.hpp"
+#include "spsc_queue.hpp"
+#include "telemetry_frame.h"
+
+namespace gateway {
+
+/** @brief Raw frame as received by a source. */
+struct RawFrame {
+    int64_t rx_us;                            /**< Receive time (µs since the Unix epoch). */
+    uint16_t len;                             /**< Number of valid bytes. */
+    uint8_t data[TELEMETRY_FRAME_SIZE];       /**< Frame bytes. */
+};
+
+/** @brief Pipeline counters, readable from any thread. */
+struct PipelineStats {
+    std::atomic<uint64_t> received{0};   /**< Frames submitted by the source. */
+    std::atomic<uint64_t> malformed{0};  /**< Wrong length, magic or version. */
+    std::atomic<uint64_t> crc_errors{0}; /**< CRC mismatches. */
+    std::atomic<uint64_t> decoded{0};    /**< Frames decoded successfully. */
+    std::atomic<uint64_t> written{0};    /**< Rows committed to the store. */
+    std::atomic<uint64_t> lost{0};       /**< Frames missing according to sequence gaps. */
+    std::atomic<uint64_t> duplicates{0}; /**< Frames whose sequence was already seen. */
+    std::atomic<uint64_t> batches{0};    /**< Batches committed to the store. */
+};
+
+/** @brief Pipeline tuning parameters. */
+struct PipelineConfig {
+    unsigned decoders = 1;          /**< Number of decoder threads. */
+    std::size_t batch_rows = 4096;  /**< Rows per committed batch. */
+    unsigned flush_ms = 200;        /**< Commit a partial batch after this idle time. */
+};
+
+class Pipeline {
+public:
+    /**
+     * @brief Create the pipeline.
+     *
+     * @param store Destination store, or nullptr to decode and discard
+     *              (used for throughput measurements).
+     * @param cfg Tuning parameters.
+     */
+    Pipeline(ColumnStore *store, const PipelineConfig &cfg);
+    ~Pipeline();
+
+    Pipeline(const Pipeline &) = delete;
+    Pipeline &operator=(const Pipeline &) = delete;
+
+    /** @brief Start decoder and writer threads. */
+    void start();
+
+    /**
+     * @brief Hand a received frame to the pipeline.
+     *
+     * Must always be called from the same (source) thread. Oversized input
+     * is counted as malformed and dropped.
+     */
+    void submit(const uint8_t *data, std::size_t len, int64_t rx_us);
+
+    /** @brief Drain all queues, commit the last batch and join the threads. */
+    void stop();
+
+    const PipelineStats &stats() const { return stats_; }
+
+    static constexpr std::size_t kQueueSize = 4096;
+
+private:
+    using InQueue = SpscQueue<RawFrame, kQueueSize>;
+    using OutQueue = SpscQueue<Record, kQueueSize>;
+
+    void decoder_loop(unsigned index);
+    void writer_loop();
+    void account(const Record &rec);
+
+    ColumnStore *store_;
+    PipelineConfig cfg_;
+    PipelineStats stats_;
+
+    std::vector<std::unique_ptr<InQueue>> in_;
+    std::vector<std::unique_ptr<OutQueue>> out_;
+    std::vector<std::thread> decoders_;
+    std::thread writer_;
+
+    std::atomic<bool> sources_done_{false};
+    std::atomic<unsigned> decoders_done_{0};
+    std::unordered_map<uint32_t, uint32_t> last_seq_; /**< Writer-owned: last sequence per node. */
+};
+
+/** @brief Current wall-clock time in µs since the Unix epoch. */
+int64_t now_us();
+
+} // namespace gateway
+
+#endif // GATEWAY_PIPELINE_HPP
@@ -0,0 +1,252 @@
+/**
+ * @file sources.cpp
+ * @brief Frame sources feeding the decode pipeline.
+ */
+
+#include "sources.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace gateway {
+
+constexpr int kPollMs = 200;             /**< Stop-flag polling interval. */
+constexpr int kRecvBufferBytes = 8 << 20; /**< Requested socket receive buffer. */
+constexpr std::size_t kMaxLineBytes = 1024; /**< Longest console line kept. */
+
+static int hex_value(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+bool parse_tlm_line(const std::string &line, uint8_t *out, std::size_t *out_len)
+{
+    const std::size_t at = line.find(kTlmPrefix);
+    if (at == std::string::npos) {
+        return false;
+    }
+
+    std::size_t i = at + std::strlen(kTlmPrefix);
+    std::size_t n = 0;
+    while (i + 1 < line.size() && n < TELEMETRY_FRAME_SIZE) {
+        const int hi = hex_value(line[i]);
+        const int lo = hex_value(line[i + 1]);
+        if (hi < 0 || lo < 0) {
+            break;
+        }
+        out[n++] = static_cast<uint8_t>((hi << 4) | lo);
+        i += 2;
+    }
+
+    *out_len = n;
+    return n >= 8;
+}
+
+std::string format_tlm_line(const uint8_t *data, std::size_t len)
+{
+    static const char digits[] = "0123456789abcdef";
+    std::string line(kTlmPrefix);
+    line.reserve(line.size() + 2 * len);
+    for (std::size_t i = 0; i < len; i++) {
+        line.push_back(digits[data[i] >> 4]);
+        line.push_back(digits[data[i] & 0x0F]);
+    }
+    return line;
+}
+
+/**
+ * @brief Receive loop shared by the datagram sources.
+ */
+static int run_datagram_loop(int fd, Pipeline &pipeline, const std::atomic<bool> &stop)
+{
+    /* One byte larger than a frame so oversized datagrams are detected. */
+    uint8_t buf[TELEMETRY_FRAME_SIZE + 1];
+    struct pollfd pfd = {fd, POLLIN, 0};
+
+    while (!stop.load(std::memory_order_relaxed)) {
+        int ready = ::poll(&pfd, 1, kPollMs);
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -errno;
+        }
+        if (ready == 0) {
+            continue;
+        }
+
+        /* Drain everything that is queued before polling again. */
+        for (;;) {
+            ssize_t n = ::recv(fd, buf, sizeof(buf), MSG_DONTWAIT);
+            if (n < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+                    break;
+                }
+                return -errno;
+            }
+            pipeline.submit(buf, static_cast<std::size_t>(n), now_us());
+        }
+    }
+    return 0;
+}
+
+int run_udp_source(uint16_t port, Pipeline &pipeline, const std::atomic<bool> &stop)
+{
+    int fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        return -errno;
+    }
+
+    int rcvbuf = kRecvBufferBytes;
+    ::setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (::bind(fd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) < 0) {
+        int ret = -errno;
+        ::close(fd);
+        return ret;
+    }
+
+    std::fprintf(stderr, "[GATEWAY] - Listening on UDP port %u\n", port);
+    int ret = run_datagram_loop(fd, pipeline, stop);
+    ::close(fd);
+    return ret;
+}
+
+int run_unix_source(const std::string &path, Pipeline &pipeline, const std::atomic<bool> &stop)
+{
+    struct sockaddr_un addr = {};
+    if (path.size() >= sizeof(addr.sun_path)) {
+        return -ENAMETOOLONG;
+    }
+
+    int fd = ::socket(AF_UNIX, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        return -errno;
+    }
+
+    int rcvbuf = kRecvBufferBytes;
+    ::setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    ::unlink(path.c_str());
+    if (::bind(fd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) < 0) {
+        int ret = -errno;
+        ::close(fd);
+        return ret;
+    }
+
+    std::fprintf(stderr, "[GATEWAY] - Listening on unix socket %s\n", path.c_str());
+    int ret = run_datagram_loop(fd, pipeline, stop);
+    ::close(fd);
+    ::unlink(path.c_str());
+    return ret;
+}
+
+/**
+ * @brief Map a numeric baud rate to its termios constant.
+ */
+static speed_t baud_constant(unsigned baud)
+{
+    switch (baud) {
+    case 9600:   return B9600;
+    case 19200:  return B19200;
+    case 38400:  return B38400;
+    case 57600:  return B57600;
+    case 230400: return B230400;
+    case 460800: return B460800;
+    case 921600: return B921600;
+    default:     return B115200;
+    }
+}
+
+int run_serial_source(const std::string &path, unsigned baud, Pipeline &pipeline,
+                      const std::atomic<bool> &stop)
+{
+    int fd = (path == "-") ? STDIN_FILENO : ::open(path.c_str(), O_RDONLY | O_NOCTTY);
+    if (fd < 0) {
+        return -errno;
+    }
+
+    if (::isatty(fd) && fd != STDIN_FILENO) {
+        struct termios tio;
+        if (::tcgetattr(fd, &tio) == 0) {
+            ::cfmakeraw(&tio);
+            ::cfsetispeed(&tio, baud_constant(baud));
+            ::cfsetospeed(&tio, baud_constant(baud));
+            tio.c_cflag |= CLOCAL | CREAD;
+            ::tcsetattr(fd, TCSANOW, &tio);
+        }
+    }
+
+    std::string line;
+    uint8_t frame[TELEMETRY_FRAME_SIZE];
+    char buf[4096];
+    struct pollfd pfd = {fd, POLLIN, 0};
+    int ret = 0;
+
+    while (!stop.load(std::memory_order_relaxed)) {
+        int ready = ::poll(&pfd, 1, kPollMs);
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ret = -errno;
+            break;
+        }
+        if (ready == 0) {
+            continue;
+        }
+
+        ssize_t n = ::read(fd, buf, sizeof(buf));
+        if (n < 0) {
+            if (errno == EINTR || errno == EAGAIN) {
+                continue;
+            }
+            ret = -errno;
+            break;
+        }
+        if (n == 0) {
+            break;  /* End of file or hang-up. */
+        }
+
+        for (ssize_t i = 0; i < n; i++) {
+            if (buf[i] != '\n') {
+                /* Runaway lines (binary noise, wrong baud rate) are discarded. */
+                if (line.size() < kMaxLineBytes) {
+                    line.push_back(buf[i]);
+                }
+                continue;
+            }
+            std::size_t len = 0;
+            if (parse_tlm_line(line, frame, &len)) {
+                pipeline.submit(frame, len, now_us());
+            }
+            line.clear();
+        }
+    }
+
+    if (fd != STDIN_FILENO) {
+        ::close(fd);
+    }
+    return ret;
+}
+
+} // namespace gateway
@@ -0,0 +1,68 @@
+/**
+ * @file sources.hpp
+ * @brief Frame sources feeding the decode pipeline.
+ *
+ * - **UDP:** one frame per datagram.
+ * - **Unix datagram socket:** same as UDP, for local testing without a network.
+ * - **Serial / console capture:** text lines of the form
+ *   `@TLM <hex>` as printed by the firmware uplink; all other console output
+ *   is ignored. A path of @c - reads standard input, which also replays
+ *   captured logs.
+ */
+
+#ifndef GATEWAY_SOURCES_HPP
+#define GATEWAY_SOURCES_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "pipeline.hpp"
+
+namespace gateway {
+
+/** @brief Line prefix of a hex-encoded frame on a serial console. */
+constexpr const char *kTlmPrefix = "@TLM ";
+
+/**
+ * @brief Parse a `@TLM <hex>` console line.
+ *
+ * Leading console noise before the prefix and trailing whitespace are
+ * tolerated.
+ *
+ * @param line Line without the terminating newline.
+ * @param out Output buffer of at least @ref TELEMETRY_FRAME_SIZE bytes.
+ * @param out_len Number of decoded bytes.
+ * @return true if the line carried a hex payload of valid length.
+ */
+bool parse_tlm_line(const std::string &line, uint8_t *out, std::size_t *out_len);
+
+/** @brief Format a frame as a `@TLM <hex>` line (without newline). */
+std::string format_tlm_line(const uint8_t *data, std::size_t len);
+
+/**
+ * @brief Receive UDP datagrams until @p stop is set.
+ * @return 0 on clean shutdown, negative errno code on failure.
+ */
+int run_udp_source(uint16_t port, Pipeline &pipeline, const std::atomic<bool> &stop);
+
+/**
+ * @brief Receive datagrams on a Unix socket until @p stop is set.
+ * @return 0 on clean shutdown, negative errno code on failure.
+ */
+int run_unix_source(const std::string &path, Pipeline &pipeline, const std::atomic<bool> &stop);
+
+/**
+ * @brief Read `@TLM` lines from a serial device, file or stdin (@c -).
+ *
+ * Terminal devices are switched to raw mode at @p baud.
+ *
+ * @return 0 at end of input or on shutdown, negative errno code on failure.
+ */
+int run_serial_source(const std::string &path, unsigned baud, Pipeline &pipeline,
+                      const std::atomic<bool> &stop);
+
+} // namespace gateway
+
+#endif // GATEWAY_SOURCES_HPP
@@ -0,0 +1,85 @@
+/**
+ * @file spsc_queue.hpp
+ * @brief Bounded lock-free single-producer/single-consumer ring buffer.
+ *
+ * Head and tail live on separate cache lines and each side keeps a cached
+ * copy of the other side's index, so the common case touches no shared
+ * cache line at all.
+ */
+
+#ifndef GATEWAY_SPSC_QUEUE_HPP
+#define GATEWAY_SPSC_QUEUE_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace gateway {
+
+constexpr std::size_t kCacheLine = 64;
+
+/**
+ * @brief Fixed-capacity SPSC queue.
+ *
+ * @tparam T Element type (copied in and out).
+ * @tparam Capacity Number of slots, must be a power of two.
+ */
+template <typename T, std::size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                  "Capacity must be a power of two");
+
+public:
+    /**
+     * @brief Push an element (producer thread only).
+     * @return false if the queue is full.
+     */
+    bool try_push(const T &value)
+    {
+        const std::size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_cache_ == Capacity) {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            if (tail - head_cache_ == Capacity) {
+                return false;
+            }
+        }
+        slots_[tail & (Capacity - 1)] = value;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Pop an element (consumer thread only).
+     * @return false if the queue is empty.
+     */
+    bool try_pop(T &value)
+    {
+        const std::size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_cache_) {
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            if (head == tail_cache_) {
+                return false;
+            }
+        }
+        value = slots_[head & (Capacity - 1)];
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** @brief Approximate number of queued elements (any thread). */
+    std::size_t size() const
+    {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+    }
+
+private:
+    alignas(kCacheLine) std::atomic<std::size_t> head_{0}; /**< Next slot to pop. */
+    std::size_t tail_cache_ = 0;                           /**< Consumer's view of tail_. */
+    alignas(kCacheLine) std::atomic<std::size_t> tail_{0}; /**< Next slot to push. */
+    std::size_t head_cache_ = 0;                           /**< Producer's view of head_. */
+    alignas(kCacheLine) std::array<T, Capacity> slots_{};
+};
+
+} // namespace gateway
+
+#endif // GATEWAY_SPSC_QUEUE_HPP
@@ -0,0 +1,258 @@
+#!/usr/bin/env python3
+"""
+Train and quantize the plant-health classifier used by src/analysis/plant_model.c.
+
+The network is a small fully connected model (8 -> 16 -> 4) trained with plain
+SGD, then quantized to int8 weights / int32 biases with TFLite-style
+fixed-point requantization multipliers. The result is written as a C source
+file with const tables that live in flash.
+
+Usage:
+    python3 train.py [--csv labelled.csv] [--out ../../src/analysis/plant_model_data.c]
+
+With --csv, rows must be: r,g,b,clear,light,temp,hum,moisture,label (label is
+the class index). Without it, a synthetic dataset generated from agronomic
+rules of thumb is used, which is enough to exercise the pipeline until a
+field dataset is collected.
+
+Only the Python standard library is required.
+"""
+
+import argparse
+import csv
+import math
+import random
+
+CLASSES = ["HEALTHY", "CHLOROSIS", "WATER_STRESS", "LOW_LIGHT"]
+
+# Feature normalization: x_norm = (x - offset) / half_range, clamped to [-1, 1]
+FEATURES = [
+    # name,           offset,  half_range
+    ("red_ratio",     0.33,    0.20),
+    ("green_ratio",   0.33,    0.20),
+    ("blue_ratio",    0.33,    0.20),
+    ("clear",         32768.0, 32768.0),
+    ("light",         50.0,    50.0),
+    ("temp",          20.0,    30.0),
+    ("hum",           50.0,    50.0),
+    ("moisture",      50.0,    50.0),
+]
+
+HIDDEN = 16
+
+
+def synth_sample(rng, label):
+    """Generate one synthetic raw sample for the given class."""
+    light = rng.uniform(25, 95)
+    temp = rng.uniform(15, 30)
+    hum = rng.uniform(40, 70)
+    moisture = rng.uniform(35, 85)
+    rc, gc, bc = rng.uniform(0.25, 0.32), rng.uniform(0.38, 0.48), rng.uniform(0.20, 0.28)
+
+    if label == 1:  # chlorosis: yellowing leaves, red+green up, blue down
+        rc, gc, bc = rng.uniform(0.36, 0.45), rng.uniform(0.36, 0.44), rng.uniform(0.10, 0.19)
+    elif label == 2:  # water stress: dry soil, hot and dry air
+        moisture = rng.uniform(0, 25)
+        temp = rng.uniform(26, 40)
+        hum = rng.uniform(15, 40)
+        gc -= rng.uniform(0.0, 0.05)
+    elif label == 3:  # low light
+        light = rng.uniform(0, 15)
+
+    clear = light / 100.0 * rng.uniform(40000, 60000)
+    noise = lambda v, s: v + rng.gauss(0, s)
+    return [noise(rc, 0.01) * clear, noise(gc, 0.01) * clear, noise(bc, 0.01) * clear, clear,
+            noise(light, 2), noise(temp, 0.5), noise(hum, 2), noise(moisture, 2)]
+
+
+def features(raw):
+    """Convert a raw sample (r, g, b, clear, light, temp, hum, moisture) to normalized features."""
+    r, g, b, c, light, temp, hum, moisture = raw
+    c = max(c, 1.0)
+    values = [r / c, g / c, b / c, c, light, temp, hum, moisture]
+    out = []
+    for v, (_, off, half) in zip(values, FEATURES):
+        out.append(max(-1.0, min(1.0, (v - off) / half)))
+    return out
+
+
+def load_dataset(args, rng):
+    if args.csv:
+        data = []
+        with open(args.csv) as f:
+            for row in csv.reader(f):
+                if not row or row[0].startswith("#"):
+                    continue
+                data.append((features([float(x) for x in row[:8]]), int(row[8])))
+        return data
+    return [(features(synth_sample(rng, i % len(CLASSES))), i % len(CLASSES))
+            for i in range(args.samples)]
+
+
+def train(data, rng, epochs, lr):
+    n_in, n_out = len(FEATURES), len(CLASSES)
+    w1 = [[rng.gauss(0, math.sqrt(2.0 / n_in)) for _ in range(n_in)] for _ in range(HIDDEN)]
+    b1 = [0.0] * HIDDEN
+    w2 = [[rng.gauss(0, math.sqrt(2.0 / HIDDEN)) for _ in range(HIDDEN)] for _ in range(n_out)]
+    b2 = [0.0] * n_out
+
+    for epoch in range(epochs):
+        rng.shuffle(data)
+        loss = 0.0
+        for x, y in data:
+            h = [max(0.0, sum(wi * xi for wi, xi in zip(w, x)) + b) for w, b in zip(w1, b1)]
+            z = [sum(wi * hi for wi, hi in zip(w, h)) + b for w, b in zip(w2, b2)]
+            m = max(z)
+            e = [math.exp(v - m) for v in z]
+            s = sum(e)
+            p = [v / s for v in e]
+            loss -= math.log(max(p[y], 1e-9))
+
+            dz = [pi - (1.0 if i == y else 0.0) for i, pi in enumerate(p)]
+            dh = [sum(dz[k] * w2[k][j] for k in range(n_out)) if h[j] > 0 else 0.0
+                  for j in range(HIDDEN)]
+            for k in range(n_out):
+                for j in range(HIDDEN):
+                    w2[k][j] -= lr * dz[k] * h[j]
+                b2[k] -= lr * dz[k]
+            for j in range(HIDDEN):
+                if dh[j] == 0.0:
+                    continue
+                for i in range(n_in):
+                    w1[j][i] -= lr * dh[j] * x[i]
+                b1[j] -= lr * dh[j]
+        print(f"epoch {epoch + 1:2d}: loss {loss / len(data):.4f}")
+
+    return w1, b1, w2, b2
+
+
+def quantize_multiplier(real):
+    """Express a positive real multiplier as a Q31 mantissa and a right shift."""
+    mantissa, exponent = math.frexp(real)
+    q = int(round(mantissa * (1 << 31)))
+    if q == (1 << 31):
+        q //= 2
+        exponent += 1
+    return q, -exponent
+
+
+def quantize(model, data):
+    w1, b1, w2, b2 = model
+    s_in = 1.0 / 127.0
+    s_w1 = max(abs(v) for row in w1 for v in row) / 127.0
+    s_w2 = max(abs(v) for row in w2 for v in row) / 127.0
+
+    # Calibrate activation ranges on the training set
+    h_max, z_max = 1e-6, 1e-6
+    for x, _ in data:
+        h = [max(0.0, sum(wi * xi for wi, xi in zip(w, x)) + b) for w, b in zip(w1, b1)]
+        z = [sum(wi * hi for wi, hi in zip(w, h)) + b for w, b in zip(w2, b2)]
+        h_max = max(h_max, max(h))
+        z_max = max(z_max, max(abs(v) for v in z))
+    s_h, s_out = h_max / 127.0, z_max / 127.0
+
+    q = {
+        "w1": [[int(round(v / s_w1)) for v in row] for row in w1],
+        "b1": [int(round(v / (s_in * s_w1))) for v in b1],
+        "w2": [[int(round(v / s_w2)) for v in row] for row in w2],
+        "b2": [int(round(v / (s_h * s_w2))) for v in b2],
+        "m1": quantize_multiplier(s_in * s_w1 / s_h),
+        "m2": quantize_multiplier(s_h * s_w2 / s_out),
+        "s_out": s_out,
+    }
+    return q
+
+
+def requantize(acc, mult):
+    m, shift = mult
+    if shift < 0:
+        acc <<= -shift
+        shift = 0
+    v = (acc * m + (1 << 30)) >> 31
+    if shift > 0:
+        v = (v + (1 << (shift - 1))) >> shift
+    return max(-128, min(127, v))
+
+
+def round_half_away(v):
+    """Round half away from zero, as lroundf() in plant_model.c (round() rounds half to even)."""
+    return int(math.copysign(math.floor(abs(v) + 0.5), v))
+
+
+def evaluate(q, data):
+    ok = 0
+    for x, y in data:
+        xi = [max(-128, min(127, round_half_away(v * 127))) for v in x]
+        h = [max(0, requantize(sum(a * b for a, b in zip(w, xi)) + b, q["m1"])) for w, b in zip(q["w1"], q["b1"])]
+        z = [requantize(sum(a * b for a, b in zip(w, h)) + b, q["m2"]) for w, b in zip(q["w2"], q["b2"])]
+        ok += int(z.index(max(z)) == y)
+    return ok / len(data)
+
+
+def cfloat(value):
+    """Format a Python float as a C float literal."""
+    text = f"{value:.6g}"
+    if "." not in text and "e" not in text:
+        text += ".0"
+    return text + "f"
+
+
+def emit(q, path, accuracy):
+    def arr(values):
+        return ", ".join(str(v) for v in values)
+
+    with open(path, "w") as f:
+        f.write("/**\n")
+        f.write(" * @file plant_model_data.c\n")
+        f.write(" * @brief Quantized weights of the plant-health classifier.\n")
+        f.write(" *\n")
+        f.write(" * Generated by tools/plant_model/train.py - do not edit by hand.\n")
+        f.write(f" * Int8 accuracy on the training set: {accuracy * 100:.1f}%.\n")
+        f.write(" */\n\n")
+        f.write('#include "plant_model.h"\n\n')
+        f.write("static const int8_t fc1_weights[PLANT_MODEL_HIDDEN * PLANT_MODEL_INPUTS] = {\n")
+        for row in q["w1"]:
+            f.write(f"    {arr(row)},\n")
+        f.write("};\n\n")
+        f.write(f"static const int32_t fc1_bias[PLANT_MODEL_HIDDEN] = {{ {arr(q['b1'])} }};\n\n")
+        f.write("static const int8_t fc2_weights[PLANT_MODEL_CLASSES * PLANT_MODEL_HIDDEN] = {\n")
+        for row in q["w2"]:
+            f.write(f"    {arr(row)},\n")
+        f.write("};\n\n")
+        f.write(f"static const int32_t fc2_bias[PLANT_MODEL_CLASSES] = {{ {arr(q['b2'])} }};\n\n")
+        f.write("const struct plant_model plant_model = {\n")
+        f.write("    .feature_offset = { " + ", ".join(cfloat(o) for _, o, _ in FEATURES) + " },\n")
+        f.write("    .feature_scale = { " + ", ".join(cfloat(127.0 / h) for _, _, h in FEATURES) + " },\n")
+        f.write("    .fc1_weights = fc1_weights,\n")
+        f.write("    .fc1_bias = fc1_bias,\n")
+        f.write(f"    .fc1_multiplier = {q['m1'][0]},\n")
+        f.write(f"    .fc1_shift = {q['m1'][1]},\n")
+        f.write("    .fc2_weights = fc2_weights,\n")
+        f.write("    .fc2_bias = fc2_bias,\n")
+        f.write(f"    .fc2_multiplier = {q['m2'][0]},\n")
+        f.write(f"    .fc2_shift = {q['m2'][1]},\n")
+        f.write(f"    .output_scale = {cfloat(q['s_out'])},\n")
+        f.write("};\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--csv", help="labelled dataset (r,g,b,clear,light,temp,hum,moisture,label)")
+    parser.add_argument("--samples", type=int, default=2000, help="synthetic samples when no CSV is given")
+    parser.add_argument("--epochs", type=int, default=15)
+    parser.add_argument("--lr", type=float, default=0.02)
+    parser.add_argument("--seed", type=int, default=7)
+    parser.add_argument("--out", default="../../src/analysis/plant_model_data.c")
+    args = parser.parse_args()
+
+    rng = random.Random(args.seed)
+    data = load_dataset(args, rng)
+    model = train(data, rng, args.epochs, args.lr)
+    q = quantize(model, data)
+    accuracy = evaluate(q, data)
+    print(f"int8 accuracy: {accuracy * 100:.1f}%")
+    emit(q, args.out, accuracy)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,286 @@
+#!/usr/bin/env python3
+"""
+Accelerated-time soak test of the firmware on native_sim.
+
+Runs the unmodified firmware with `-no-rt`, so simulated time advances as fast
+as the host can execute it, while the emulated sensors follow the diurnal
+curves of src/sim/sim_env.c. A month of operation takes minutes. The firmware
+is started with `-soak_period=86400` and prints one `@SOAK` line per simulated
+day (src/sim/sim_soak.c) listing the stack high-water mark of every thread; the
+native_sim console is line buffered, so the harness samples the CPU time of
+the process (/proc/<pid>/stat) as each line arrives. The daily `@ENERGY` lines
+of the energy estimator (src/power/energy.c) give the estimated mAh/day of
+each operating mode used during the run. The GPS time to first fix printed
+at boot is reported too; with --flash (an EPO image from tools/epo) and
+--gps-ttff it shows the effect of the EPO upload on the emulated module.
+The firmware only uploads EPO data when it knows the time from a retained
+fix, so a run that starts cold reports the upload as skipped.
+
+The run fails (exit status 1) if:
+
+- the firmware prints an assertion failure or a fatal error, or exits with a
+  non-zero status before the end of the run
+- a thread's stack high-water mark exceeds --max-stack percent of its size
+- fewer daily reports than simulated days were received
+- a telemetry frame breaks an invariant: sequence numbers must increase by
+  one, uptime must advance (modulo the 32-bit wrap at 49.7 days), GPS time
+  must be hhmmss or -1 and readings must stay in their physical range
+
+Usage:
+    python3 soak.py --exe build/zephyr/zephyr.exe [--days 30] [--mode 1] [--log soak.log]
+    python3 soak.py --exe build/zephyr/zephyr.exe --days 1 --flash flash.bin
+    python3 soak.py --replay soak.log
+
+--replay checks a saved console log again (no CPU figures). Only the Python
+standard library is required.
+"""
+
+import argparse
+import csv
+import os
+import re
+import struct
+import subprocess
+import sys
+import time
+
+sys.dont_write_bytecode = True
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "fleet_sim"))
+from fleet_sim import parse_frame  # noqa: E402
+
+DAY_S = 86400
+SOAK_PREFIX = "@SOAK "
+ENERGY_PREFIX = "@ENERGY "
+TTFF_RE = re.compile(r"\[GPS\] - First fix after (\d+) ms")
+EPO_RE = re.compile(r"\[EPO\] - (.*)")
+FAILURE_RE = re.compile(r"ASSERTION FAIL|FATAL ERROR|Stack overflow|Segmentation fault")
+UPTIME_WRAP = 1 << 32
+
+# Field, byte offset, struct format and valid range of the frame fields checked.
+RANGES = [
+    ("brightness", 16, "<h", 0, 1000),
+    ("moisture",   18, "<h", 0, 1000),
+    ("temp",       20, "<h", -4000, 8500),
+    ("hum",        22, "<h", 0, 10000),
+    ("gps_sats",   54, "<B", 0, 32),
+]
+
+
+class Day:
+    """What happened during one simulated day."""
+
+    def __init__(self, index):
+        self.index = index
+        self.cpu_s = None
+        self.frames = 0
+        self.anomalies = 0
+        self.worst_stack = ("", 0.0)
+
+
+class Soak:
+    """Console-output checker, fed one line at a time."""
+
+    def __init__(self, max_stack_pct):
+        self.max_stack_pct = max_stack_pct
+        self.days = [Day(1)]
+        self.stacks = {}          # name -> [max used, size, day of the maximum]
+        self.failures = []
+        self.last_frame = None
+        self.frames = 0
+        self.wraps = 0
+        self.energy = {}          # mode -> fields of the latest @ENERGY line
+        self.ttff_ms = None
+        self.epo = None           # outcome of the EPO upload at boot
+
+    def fail(self, text):
+        self.failures.append(text)
+        if len(self.failures) <= 20:
+            print(f"FAIL: {text}", file=sys.stderr)
+
+    def line(self, text, cpu_s=None):
+        if FAILURE_RE.search(text):
+            self.fail(f"day {self.days[-1].index}: {text.strip()}")
+        elif text.startswith(SOAK_PREFIX):
+            self.report(text, cpu_s)
+        elif text.startswith(ENERGY_PREFIX):
+            fields = dict(f.partition("=")[::2] for f in text[len(ENERGY_PREFIX):].split())
+            self.energy[fields.get("mode", "?")] = fields
+        elif TTFF_RE.search(text):
+            self.ttff_ms = int(TTFF_RE.search(text).group(1))
+        elif EPO_RE.search(text):
+            self.epo = EPO_RE.search(text).group(1).strip()
+        else:
+            frame = parse_frame(text)
+            if frame is not None:
+                self.frame(*frame)
+
+    def report(self, text, cpu_s):
+        day = self.days[-1]
+        day.cpu_s = cpu_s
+        for field in text[len(SOAK_PREFIX):].split():
+            name, _, value = field.partition("=")
+            if "/" not in value:
+                continue
+            used, size = (int(x) for x in value.split("/"))
+            pct = 100.0 * used / size if size else 0.0
+            entry = self.stacks.setdefault(name, [0, size, day.index])
+            if used > entry[0]:
+                entry[0], entry[2] = used, day.index
+            if pct > day.worst_stack[1]:
+                day.worst_stack = (name, pct)
+            if pct > self.max_stack_pct:
+                self.fail(f"day {day.index}: {name} stack at {used}/{size} bytes ({pct:.0f}%)")
+        self.days.append(Day(day.index + 1))
+
+    def frame(self, node_id, seq, uptime_ms, raw):
+        day = self.days[-1]
+        day.frames += 1
+        self.frames += 1
+        if struct.unpack_from("<H", raw, 58)[0]:
+            day.anomalies += 1
+
+        for name, offset, fmt, lo, hi in RANGES:
+            value = struct.unpack_from(fmt, raw, offset)[0]
+            if not lo <= value <= hi:
+                self.fail(f"seq {seq}: {name} {value} outside [{lo}, {hi}]")
+
+        gps_time = struct.unpack_from("<i", raw, 50)[0]
+        if gps_time != -1 and not (0 <= gps_time // 10000 < 24 and 0 <= gps_time // 100 % 100 < 60
+                                   and 0 <= gps_time % 100 < 60):
+            self.fail(f"seq {seq}: gps_time {gps_time} is not hhmmss")
+
+        if self.last_frame is not None:
+            last_seq, last_uptime = self.last_frame
+            if seq != (last_seq + 1) & 0xFFFFFFFF:
+                self.fail(f"seq {seq} follows {last_seq}")
+            step = (uptime_ms - last_uptime) % UPTIME_WRAP
+            if uptime_ms < last_uptime:
+                self.wraps += 1
+            if step == 0 or step > DAY_S * 1000:
+                self.fail(f"seq {seq}: uptime {uptime_ms} ms after {last_uptime} ms")
+        self.last_frame = (seq, uptime_ms)
+
+
+def process_cpu_s(pid):
+    """User plus system CPU time of a running process, in seconds."""
+    with open(f"/proc/{pid}/stat") as f:
+        fields = f.read().rsplit(")", 1)[1].split()
+    return (int(fields[11]) + int(fields[12])) / os.sysconf("SC_CLK_TCK")
+
+
+def run(args, soak):
+    cmd = [args.exe, f"-node_id={args.node_id}", f"-boot_time={args.boot_time}", f"-mode={args.mode}",
+           f"-gps_period={args.gps_period}", f"-soak_period={DAY_S}", f"-stop_at={args.days * DAY_S}",
+           "-no-rt"]
+    if args.gps_ttff is not None:
+        cmd.append(f"-gps_ttff={args.gps_ttff}")
+    if args.flash:
+        cmd.append(f"-flash={args.flash}")
+    log = open(args.log, "w") if args.log else None
+    start = time.monotonic()
+    last_cpu = 0.0
+    proc = subprocess.Popen(cmd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                            stdin=subprocess.DEVNULL, text=True, errors="replace", bufsize=1)
+    for text in proc.stdout:
+        if log:
+            log.write(text)
+        cpu = None
+        if text.startswith(SOAK_PREFIX):
+            try:
+                total = process_cpu_s(proc.pid)
+                cpu, last_cpu = total - last_cpu, total
+            except OSError:
+                pass
+            print(f"simulated day {len(soak.days)} done", file=sys.stderr)
+        soak.line(text, cpu)
+    status = proc.wait()
+    if log:
+        log.close()
+    if status != 0:
+        soak.fail(f"firmware exited with status {status}")
+    return time.monotonic() - start
+
+
+def print_report(args, soak, wall_s):
+    days = [d for d in soak.days if d.cpu_s is not None or d.frames]
+    print(f"{'day':>4} {'cpu_s':>8} {'frames':>7} {'anomalous':>9}  worst stack")
+    for d in days:
+        cpu = f"{d.cpu_s:8.3f}" if d.cpu_s is not None else f"{'-':>8}"
+        name, pct = d.worst_stack
+        stack = f"{name} {pct:.0f}%" if name else "-"
+        print(f"{d.index:>4} {cpu} {d.frames:>7} {d.anomalies:>9}  {stack}")
+
+    print()
+    print(f"{'thread':<20} {'used':>6} {'size':>6} {'peak':>5}  reached on day")
+    for name, (used, size, day) in sorted(soak.stacks.items()):
+        print(f"{name:<20} {used:>6} {size:>6} {100.0 * used / max(size, 1):>4.0f}%  {day}")
+
+    if soak.energy:
+        print()
+        print(f"{'mode':>4} {'hours':>7} {'avg_uA':>7} {'mAh/day':>8}  longest-active rails")
+        for mode, fields in sorted(soak.energy.items()):
+            rails = sorted(((int(v), k[:-3]) for k, v in fields.items() if k.endswith("_ms")), reverse=True)
+            top = ", ".join(f"{name} {ms / 3.6e6:.1f} h" for ms, name in rails[:3] if ms)
+            print(f"{mode:>4} {int(fields['elapsed_s']) / 3600:>7.1f} {fields['avg_ua']:>7} "
+                  f"{fields['mah_day']:>8}  {top}")
+
+    print()
+    ttff = f"{soak.ttff_ms / 1000:.1f} s" if soak.ttff_ms is not None else "no fix"
+    print(f"GPS time to first fix: {ttff} (EPO: {soak.epo or 'not attempted'})")
+    reports = len(soak.days) - 1
+    cpu = [d.cpu_s for d in soak.days if d.cpu_s is not None]
+    print(f"{reports} daily reports, {soak.frames} frames, {soak.wraps} uptime wrap(s)")
+    if cpu:
+        print(f"CPU per simulated day: mean {sum(cpu) / len(cpu):.3f} s, max {max(cpu):.3f} s")
+    if wall_s:
+        print(f"wall time {wall_s:.1f} s, {reports * DAY_S / wall_s:.0f}x real time")
+    print(f"{len(soak.failures)} failure(s)")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    src = parser.add_mutually_exclusive_group(required=True)
+    src.add_argument("--exe", help="native_sim build of the firmware (build/zephyr/zephyr.exe)")
+    src.add_argument("--replay", metavar="LOG", help="check a console log saved with --log")
+    parser.add_argument("--days", type=int, default=30, help="simulated days")
+    parser.add_argument("--mode", type=int, default=1, choices=(0, 1, 2), help="0 TEST, 1 NORMAL, 2 ADVANCED")
+    parser.add_argument("--node-id", type=int, default=1, help="node ID (seeds the environment)")
+    parser.add_argument("--boot-time", type=int, default=0, help="UTC time of day at boot (s)")
+    parser.add_argument("--gps-period", type=int, default=1000, help="GGA sentence interval (ms)")
+    parser.add_argument("--gps-ttff", type=int, help="GPS TTFF without assistance (ms, default 35000)")
+    parser.add_argument("--flash", metavar="FILE", help="flash simulator file holding the EPO partition")
+    parser.add_argument("--max-stack", type=float, default=90.0, help="stack high-water limit (%% of size)")
+    parser.add_argument("--log", metavar="FILE", help="keep the console output")
+    parser.add_argument("--csv", metavar="FILE", help="also write the per-day table as CSV")
+    args = parser.parse_args()
+
+    if args.days < 1:
+        parser.error("--days must be at least 1")
+
+    soak = Soak(args.max_stack)
+    wall_s = None
+    if args.replay:
+        with open(args.replay, errors="replace") as f:
+            for text in f:
+                soak.line(text)
+    else:
+        wall_s = run(args, soak)
+        if len(soak.days) - 1 < args.days:
+            soak.fail(f"{len(soak.days) - 1} daily reports for {args.days} simulated days")
+
+    print_report(args, soak, wall_s)
+
+    if args.csv:
+        with open(args.csv, "w", newline="") as f:
+            writer = csv.writer(f)
+            writer.writerow(["day", "cpu_s", "frames", "anomalous", "worst_stack", "worst_stack_pct"])
+            for d in soak.days:
+                if d.cpu_s is not None or d.frames:
+                    writer.writerow([d.index, "" if d.cpu_s is None else round(d.cpu_s, 6), d.frames,
+                                     d.anomalies, d.worst_stack[0], round(d.worst_stack[1], 1)])
+
+    return 1 if soak.failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
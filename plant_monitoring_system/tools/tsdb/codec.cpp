@@ -0,0 +1,252 @@
+/**
+ * @file codec.cpp
+ * @brief Integer column chunk compression.
+ *
+ * The first value of a chunk is stored as a zigzag varint. Every following
+ * value is reduced to a residual against its predecessor (@ref Encoding) and
+ * the residuals are laid out as varints with zero-run compression or as a
+ * fixed-width bit stream (@ref Packing). Sensor readings change slowly
+ * between samples, so residuals are small: constant columns cost almost
+ * nothing and noisy ones a few bits per value.
+ */
+
+#include "codec.hpp"
+
+namespace tsdb {
+
+static inline uint64_t zigzag(int64_t v)
+{
+    return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+}
+
+static inline int64_t unzigzag(uint64_t v)
+{
+    return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+}
+
+static inline void put_varint(std::vector<uint8_t> &out, uint64_t v)
+{
+    while (v >= 0x80) {
+        out.push_back(static_cast<uint8_t>(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+static inline bool get_varint(const uint8_t *&p, const uint8_t *end, uint64_t &v)
+{
+    v = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+        if (p == end) {
+            return false;
+        }
+        const uint8_t byte = *p++;
+        v |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Compute the residual of every value after the first.
+ *
+ * Arithmetic wraps, so residuals of extreme values round-trip exactly.
+ */
+static void residuals(const int64_t *values, std::size_t count, Encoding encoding,
+                      std::vector<uint64_t> &out)
+{
+    out.clear();
+    uint64_t prev_delta = 0;
+    for (std::size_t i = 1; i < count; i++) {
+        const uint64_t cur = static_cast<uint64_t>(values[i]);
+        const uint64_t prev = static_cast<uint64_t>(values[i - 1]);
+        switch (encoding) {
+        case Encoding::Delta:
+            out.push_back(zigzag(static_cast<int64_t>(cur - prev)));
+            break;
+        case Encoding::DeltaOfDelta:
+            out.push_back(zigzag(static_cast<int64_t>((cur - prev) - prev_delta)));
+            prev_delta = cur - prev;
+            break;
+        case Encoding::Xor:
+            out.push_back(cur ^ prev);
+            break;
+        }
+    }
+}
+
+static void pack_varint(const std::vector<uint64_t> &res, std::vector<uint8_t> &out)
+{
+    for (std::size_t i = 0; i < res.size();) {
+        put_varint(out, res[i]);
+        if (res[i] != 0) {
+            i++;
+            continue;
+        }
+        std::size_t run = 1;
+        while (i + run < res.size() && res[i + run] == 0) {
+            run++;
+        }
+        put_varint(out, run - 1);
+        i += run;
+    }
+}
+
+static void pack_bits(const std::vector<uint64_t> &res, std::vector<uint8_t> &out)
+{
+    uint64_t all = 0;
+    for (uint64_t r : res) {
+        all |= r;
+    }
+    unsigned width = 0;
+    while (width < 64 && (all >> width) != 0) {
+        width++;
+    }
+    out.push_back(static_cast<uint8_t>(width));
+
+    uint64_t acc = 0;
+    unsigned bits = 0;
+    for (uint64_t r : res) {
+        for (unsigned done = 0; done < width;) {
+            const unsigned take = (width - done < 64 - bits) ? width - done : 64 - bits;
+            const uint64_t mask = take == 64 ? ~0ull : ((1ull << take) - 1);
+            acc |= ((r >> done) & mask) << bits;
+            bits += take;
+            done += take;
+            if (bits == 64) {
+                for (int b = 0; b < 8; b++) {
+                    out.push_back(static_cast<uint8_t>(acc >> (8 * b)));
+                }
+                acc = 0;
+                bits = 0;
+            }
+        }
+    }
+    for (unsigned b = 0; b < bits; b += 8) {
+        out.push_back(static_cast<uint8_t>(acc >> b));
+    }
+}
+
+void encode_chunk(const int64_t *values, std::size_t count, ChunkFormat format,
+                  std::vector<uint8_t> &out)
+{
+    if (count == 0) {
+        return;
+    }
+    put_varint(out, zigzag(values[0]));
+
+    std::vector<uint64_t> res;
+    residuals(values, count, format.encoding, res);
+    if (format.packing == Packing::BitPacked) {
+        pack_bits(res, out);
+    } else {
+        pack_varint(res, out);
+    }
+}
+
+ChunkFormat encode_chunk_best(const int64_t *values, std::size_t count, std::vector<uint8_t> &out)
+{
+    static const Encoding encodings[] = {Encoding::Delta, Encoding::DeltaOfDelta, Encoding::Xor};
+    static const Packing packings[] = {Packing::Varint, Packing::BitPacked};
+    std::vector<uint8_t> best, trial;
+    ChunkFormat best_format = {Encoding::Delta, Packing::Varint};
+
+    for (Encoding e : encodings) {
+        for (Packing p : packings) {
+            trial.clear();
+            encode_chunk(values, count, {e, p}, trial);
+            if (best.empty() || trial.size() < best.size()) {
+                best.swap(trial);
+                best_format = {e, p};
+            }
+        }
+    }
+
+    out.insert(out.end(), best.begin(), best.end());
+    return best_format;
+}
+
+/**
+ * @brief Rebuild a value from its predecessor and residual.
+ */
+static inline int64_t apply(Encoding encoding, int64_t prev_value, uint64_t r, uint64_t &prev_delta)
+{
+    const uint64_t prev = static_cast<uint64_t>(prev_value);
+    switch (encoding) {
+    case Encoding::Delta:
+        return static_cast<int64_t>(prev + static_cast<uint64_t>(unzigzag(r)));
+    case Encoding::DeltaOfDelta:
+        prev_delta += static_cast<uint64_t>(unzigzag(r));
+        return static_cast<int64_t>(prev + prev_delta);
+    case Encoding::Xor:
+        return static_cast<int64_t>(prev ^ r);
+    }
+    return prev_value;
+}
+
+bool decode_chunk(const uint8_t *data, std::size_t size, ChunkFormat format,
+                  std::size_t count, int64_t *out)
+{
+    if (count == 0) {
+        return true;
+    }
+    if (format.encoding > Encoding::Xor || format.packing > Packing::BitPacked) {
+        return false;
+    }
+
+    const uint8_t *p = data;
+    const uint8_t *end = data + size;
+    uint64_t raw;
+    uint64_t prev_delta = 0;
+
+    if (!get_varint(p, end, raw)) {
+        return false;
+    }
+    out[0] = unzigzag(raw);
+
+    if (format.packing == Packing::Varint) {
+        for (std::size_t i = 1; i < count;) {
+            if (!get_varint(p, end, raw)) {
+                return false;
+            }
+            uint64_t run = 1;
+            if (raw == 0) {
+                if (!get_varint(p, end, run) || run >= count - i) {
+                    return false;
+                }
+                run++;
+            }
+            for (uint64_t k = 0; k < run; k++, i++) {
+                out[i] = apply(format.encoding, out[i - 1], raw, prev_delta);
+            }
+        }
+        return true;
+    }
+
+    if (p == end) {
+        return false;
+    }
+    const unsigned width = *p++;
+    if (width > 64 || static_cast<uint64_t>(end - p) * 8 < (count - 1) * static_cast<uint64_t>(width)) {
+        return false;
+    }
+
+    uint64_t bitpos = 0;
+    for (std::size_t i = 1; i < count; i++) {
+        uint64_t r = 0;
+        for (unsigned done = 0; done < width;) {
+            const uint64_t byte = p[bitpos >> 3];
+            const unsigned offset = bitpos & 7;
+            const unsigned take = (8 - offset < width - done) ? 8 - offset : width - done;
+            r |= ((byte >> offset) & ((1u << take) - 1)) << done;
+            done += take;
+            bitpos += take;
+        }
+        out[i] = apply(format.encoding, out[i - 1], r, prev_delta);
+    }
+    return true;
+}
+
+} // namespace tsdb
@@ -0,0 +1,50 @@
+/**
+ * @file codec.hpp
+ * @brief Integer column chunk compression.
+ */
+
+#ifndef TSDB_CODEC_HPP
+#define TSDB_CODEC_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "tsdb_format.hpp"
+
+namespace tsdb {
+
+/** @brief Residual transform and layout of one chunk. */
+struct ChunkFormat {
+    Encoding encoding;
+    Packing packing;
+};
+
+/**
+ * @brief Encode @p count values with a given format, appending to @p out.
+ */
+void encode_chunk(const int64_t *values, std::size_t count, ChunkFormat format,
+                  std::vector<uint8_t> &out);
+
+/**
+ * @brief Encode @p count values with whichever format is smallest.
+ * @return The format that was used.
+ */
+ChunkFormat encode_chunk_best(const int64_t *values, std::size_t count, std::vector<uint8_t> &out);
+
+/**
+ * @brief Decode a chunk.
+ *
+ * @param data Encoded bytes (e.g. pointing into the mapped file).
+ * @param size Number of encoded bytes.
+ * @param format Format used when encoding.
+ * @param count Number of values to decode.
+ * @param out Output array of @p count values.
+ * @return false if the chunk is truncated or malformed.
+ */
+bool decode_chunk(const uint8_t *data, std::size_t size, ChunkFormat format,
+                  std::size_t count, int64_t *out);
+
+} // namespace tsdb
+
+#endif // TSDB_CODEC_HPP
@@ -0,0 +1,444 @@
+/**
+ * @file export_client.cpp
+ * @brief Host side of the history export protocol (export_protocol.h).
+ */
+
+#include "export_client.hpp"
+
+#include <cerrno>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "export_protocol.h"
+
+namespace tsdb {
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr int kHelloAttempts = 5;        /**< HELLOs sent before giving up. */
+static constexpr int kHelloTimeoutMs = 1000;    /**< Wait for INFO after each HELLO. */
+static constexpr int kEndAttempts = 3;          /**< ENDs sent before closing anyway. */
+static constexpr int kUpdateFirstTimeoutMs = 2000;  /**< Wait for the first UPDATE_ACK of a patch. */
+
+[[noreturn]] static void throw_errno(const std::string &what)
+{
+    throw std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+static int ms_left(Clock::time_point deadline)
+{
+    const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now());
+    return left.count() > 0 ? static_cast<int>(left.count()) : 0;
+}
+
+static speed_t speed_from_baud(uint32_t baud)
+{
+    static const struct { uint32_t baud; speed_t speed; } speeds[] = {
+        { 9600, B9600 }, { 19200, B19200 }, { 38400, B38400 }, { 57600, B57600 },
+        { 115200, B115200 }, { 230400, B230400 }, { 460800, B460800 }, { 500000, B500000 },
+        { 576000, B576000 }, { 921600, B921600 }, { 1000000, B1000000 }, { 1152000, B1152000 },
+        { 1500000, B1500000 }, { 2000000, B2000000 },
+    };
+    for (const auto &s : speeds) {
+        if (s.baud == baud) {
+            return s.speed;
+        }
+    }
+    throw std::runtime_error("unsupported baud rate " + std::to_string(baud));
+}
+
+/**
+ * @brief Raw serial port exchanging COBS packets.
+ */
+class SerialPort {
+public:
+    SerialPort(const std::string &path, uint32_t baud) : path_(path)
+    {
+        fd_ = ::open(path.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK);
+        if (fd_ < 0) {
+            throw_errno("open " + path);
+        }
+        set_baud(baud);
+        tcflush(fd_, TCIOFLUSH);
+    }
+    ~SerialPort() { ::close(fd_); }
+
+    SerialPort(const SerialPort &) = delete;
+    SerialPort &operator=(const SerialPort &) = delete;
+
+    /** @brief Switch the line to 8N1 at @p baud, once pending output is sent. */
+    void set_baud(uint32_t baud)
+    {
+        struct termios tio;
+        if (tcgetattr(fd_, &tio) < 0) {
+            throw_errno("tcgetattr " + path_);
+        }
+        cfmakeraw(&tio);
+        tio.c_cflag |= CLOCAL | CREAD;
+        tio.c_cflag &= ~(CSTOPB | CRTSCTS);
+        cfsetispeed(&tio, speed_from_baud(baud));
+        cfsetospeed(&tio, speed_from_baud(baud));
+        if (tcsetattr(fd_, TCSADRAIN, &tio) < 0) {
+            throw_errno("tcsetattr " + path_);
+        }
+    }
+
+    /** @brief Seal, encode and send a packet of @p len bytes. */
+    void send(const uint8_t *pkt, std::size_t len)
+    {
+        uint8_t sealed[EXPORT_MAX_PACKET];
+        uint8_t encoded[EXPORT_COBS_MAX(EXPORT_MAX_PACKET) + 1];
+
+        std::memcpy(sealed, pkt, len);
+        std::size_t n = export_cobs_encode(sealed, export_packet_seal(sealed, len), encoded);
+        encoded[n++] = 0;
+        for (std::size_t done = 0; done < n;) {
+            const ssize_t w = ::write(fd_, encoded + done, n - done);
+            if (w < 0 && errno != EAGAIN && errno != EINTR) {
+                throw_errno("write " + path_);
+            }
+            done += w > 0 ? static_cast<std::size_t>(w) : 0;
+        }
+    }
+
+    /** @brief Acknowledge the records before @p next, after a DATA packet of @p round. */
+    void send_ack(uint32_t next, uint8_t round)
+    {
+        uint8_t pkt[6] = { EXPORT_ACK };
+        telemetry_put_u32(&pkt[1], next);
+        pkt[5] = round;
+        send(pkt, sizeof(pkt));
+    }
+
+    /** @brief Send a packet made of its type and one 32-bit field. */
+    void send_u32(uint8_t type, uint32_t value)
+    {
+        uint8_t pkt[5] = { type };
+        telemetry_put_u32(&pkt[1], value);
+        send(pkt, sizeof(pkt));
+    }
+
+    /**
+     * @brief Wait for the next valid packet.
+     *
+     * @param pkt Output, @ref EXPORT_MAX_PACKET bytes.
+     * @param timeout_ms How long to wait.
+     * @return Packet length without the CRC, 0 on timeout.
+     */
+    int receive(uint8_t *pkt, int timeout_ms)
+    {
+        const auto deadline = Clock::now() + std::chrono::milliseconds(timeout_ms);
+
+        for (;;) {
+            while (pos_ < len_) {
+                const uint8_t c = buf_[pos_++];
+                wire_bytes++;
+                if (c != 0) {
+                    if (frame_.size() < EXPORT_COBS_MAX(EXPORT_MAX_PACKET)) {
+                        frame_.push_back(c);
+                    } else {
+                        overflow_ = true;
+                    }
+                    continue;
+                }
+                int n = overflow_ || frame_.empty() ? -EBADMSG
+                        : export_cobs_decode(frame_.data(), frame_.size(), pkt, EXPORT_MAX_PACKET);
+                n = n < 0 ? n : export_packet_check(pkt, static_cast<std::size_t>(n));
+                const bool empty = frame_.empty() && !overflow_;
+                frame_.clear();
+                overflow_ = false;
+                if (n > 0) {
+                    return n;
+                }
+                bad_packets += !empty;
+            }
+
+            struct pollfd pfd = { fd_, POLLIN, 0 };
+            const int left = ms_left(deadline);
+            if (left == 0 || ::poll(&pfd, 1, left) <= 0) {
+                return 0;
+            }
+            const ssize_t r = ::read(fd_, buf_, sizeof(buf_));
+            if (r < 0 && errno != EAGAIN && errno != EINTR) {
+                throw_errno("read " + path_);
+            }
+            pos_ = 0;
+            len_ = r > 0 ? static_cast<std::size_t>(r) : 0;
+        }
+    }
+
+    /** @brief Wait until everything written has left the port. */
+    void drain() { tcdrain(fd_); }
+
+    uint64_t wire_bytes = 0;    /**< Bytes received. */
+    uint64_t bad_packets = 0;   /**< Packets with a bad encoding or CRC. */
+
+private:
+    std::string path_;
+    int fd_;
+    uint8_t buf_[4096];
+    std::size_t pos_ = 0, len_ = 0;
+    std::vector<uint8_t> frame_;
+    bool overflow_ = false;
+};
+
+/**
+ * @brief Open the spool for appending and find the record to resume from.
+ *
+ * A partial record left by an interrupted write is cut off. Records are
+ * spooled in index order, so reading again from @p from drops the spooled
+ * records from that index on rather than spooling them twice.
+ *
+ * @param from First record to read, or -1 to resume after the last one spooled.
+ */
+static FILE *open_spool(const std::string &path, int64_t from, uint32_t *resume)
+{
+    FILE *f = std::fopen(path.c_str(), "a+b");
+    struct stat st;
+    if (f == nullptr || fstat(fileno(f), &st) < 0) {
+        throw_errno("open " + path);
+    }
+    off_t whole = st.st_size - st.st_size % HISTORY_RECORD_SIZE;
+
+    uint8_t rec[HISTORY_RECORD_SIZE];
+    *resume = 0;
+    while (whole > 0 && std::fseek(f, whole - HISTORY_RECORD_SIZE, SEEK_SET) == 0 &&
+           std::fread(rec, sizeof(rec), 1, f) == 1) {
+        const uint32_t index = telemetry_get_u32(&rec[HISTORY_RECORD_INDEX]);
+        if (from < 0 || index < from) {
+            *resume = index + 1;
+            break;
+        }
+        whole -= HISTORY_RECORD_SIZE;
+    }
+    if (whole != st.st_size && ftruncate(fileno(f), whole) < 0) {
+        throw_errno("truncate " + path);
+    }
+    std::fseek(f, 0, SEEK_END);
+    return f;
+}
+
+/**
+ * @brief Start a session: HELLO until INFO, then switch to its baud rate.
+ *
+ * @param pkt Output, holding INFO.
+ * @return Baud rate of the session.
+ */
+static uint32_t open_session(SerialPort &port, const ExportOptions &opts, uint8_t *pkt)
+{
+    /* HELLO until INFO; the node may be printing between packets */
+    int n = 0;
+    for (int attempt = 0; attempt < kHelloAttempts && n == 0; attempt++) {
+        port.send_u32(EXPORT_HELLO, opts.fast_baud);
+        const auto deadline = Clock::now() + std::chrono::milliseconds(kHelloTimeoutMs);
+        while ((n = port.receive(pkt, ms_left(deadline))) > 0 &&
+               (pkt[0] != EXPORT_INFO || n < EXPORT_INFO_SIZE)) {
+        }
+    }
+    if (n == 0) {
+        throw std::runtime_error("no answer from the node on " + opts.port);
+    }
+    if (telemetry_get_u16(&pkt[9]) != HISTORY_RECORD_SIZE) {
+        throw std::runtime_error("unsupported history record size " + std::to_string(telemetry_get_u16(&pkt[9])));
+    }
+    const uint32_t baud = telemetry_get_u32(&pkt[13]);
+
+    /* The node switches EXPORT_SWITCH_MS after INFO */
+    if (baud != opts.baud) {
+        port.set_baud(baud);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(2 * EXPORT_SWITCH_MS));
+    return baud;
+}
+
+/**
+ * @brief End a session: END until BYE, then back to the default baud rate.
+ */
+static void close_session(SerialPort &port, const ExportOptions &opts, uint32_t baud)
+{
+    uint8_t pkt[EXPORT_MAX_PACKET];
+    int n;
+
+    for (int attempt = 0; attempt < kEndAttempts; attempt++) {
+        const uint8_t end = EXPORT_END;
+        port.send(&end, 1);
+        while ((n = port.receive(pkt, EXPORT_RTO_MS)) > 0 && pkt[0] != EXPORT_BYE) {
+        }
+        if (n > 0) {
+            break;
+        }
+    }
+    port.drain();
+    if (baud != opts.baud) {
+        port.set_baud(opts.baud);
+    }
+}
+
+ExportStats export_history(const ExportOptions &opts, const std::string &spool_path)
+{
+    ExportStats st;
+    uint8_t pkt[EXPORT_MAX_PACKET];
+    uint32_t expected;
+    std::unique_ptr<FILE, int (*)(FILE *)> spool(open_spool(spool_path, opts.from, &expected), std::fclose);
+    if (opts.from >= 0) {
+        expected = static_cast<uint32_t>(opts.from);
+    }
+
+    SerialPort port(opts.port, opts.baud);
+    st.baud = open_session(port, opts, pkt);
+    uint32_t first = telemetry_get_u32(&pkt[1]);
+    std::fprintf(stderr, "node: records %u..%u, %u baud; reading from %u\n",
+                 first, telemetry_get_u32(&pkt[5]), st.baud, expected);
+
+    int n;
+    const auto start = Clock::now();
+    const uint64_t wire_start = port.wire_bytes;
+    auto rx_at = start;
+    bool done = false;
+
+    while (!done) {
+        if (expected < first) {
+            st.lost += first - expected;
+            expected = first;
+        }
+        port.send_u32(EXPORT_READ, expected);
+
+        /* Go-back-N: only the expected record is taken, anything else is acknowledged */
+        while ((n = port.receive(pkt, EXPORT_RTO_MS)) > 0) {
+            rx_at = Clock::now();
+            if (pkt[0] == EXPORT_DATA && n >= EXPORT_DATA_HEADER &&
+                n == EXPORT_DATA_HEADER + pkt[5] * HISTORY_RECORD_SIZE) {
+                if (telemetry_get_u32(&pkt[1]) != expected) {
+                    st.out_of_order++;
+                    port.send_ack(expected, pkt[6]);
+                    continue;
+                }
+                for (int i = 0; i < pkt[5]; i++) {
+                    const uint8_t *rec = &pkt[EXPORT_DATA_HEADER + i * HISTORY_RECORD_SIZE];
+                    /* A record torn on the node is skipped, it will never be valid */
+                    if (history_record_check(rec) == 0 &&
+                        telemetry_get_u32(&rec[HISTORY_RECORD_INDEX]) == expected + i) {
+                        if (std::fwrite(rec, HISTORY_RECORD_SIZE, 1, spool.get()) != 1) {
+                            throw_errno("write " + spool_path);
+                        }
+                        st.records++;
+                    } else {
+                        st.lost++;
+                    }
+                }
+                std::fflush(spool.get());
+                expected += pkt[5];
+                port.send_ack(expected, pkt[6]);
+            } else if (pkt[0] == EXPORT_DONE && n >= 5 && telemetry_get_u32(&pkt[1]) == expected) {
+                done = true;
+                break;
+            } else if (pkt[0] == EXPORT_INFO && n >= EXPORT_INFO_SIZE) {
+                /* Records were overwritten during the transfer */
+                first = telemetry_get_u32(&pkt[1]);
+                break;
+            }
+        }
+        if (!done && n == 0) {
+            if (Clock::now() - rx_at > std::chrono::milliseconds(EXPORT_IDLE_MS)) {
+                throw std::runtime_error("the node stopped answering; " + std::to_string(st.records) +
+                                         " records spooled, run again to resume");
+            }
+            st.timeouts++;
+        }
+    }
+    st.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    st.wire_bytes = port.wire_bytes - wire_start;
+    st.bad_packets = port.bad_packets;
+    spool.reset();
+
+    close_session(port, opts, st.baud);
+    return st;
+}
+
+/**
+ * @brief Name of an error status of UPDATE_ACK (the node's errno values).
+ */
+static std::string update_error(int status)
+{
+    switch (-status) {
+    case 5: return "image read back does not match (EIO)";
+    case 8: return "patch made for another image (ENOEXEC)";
+    case 19: return "node has no update slot (ENODEV)";
+    case 22: return "not a patch (EINVAL)";
+    case 27: return "image too large for the update slot (EFBIG)";
+    case 77: return "corrupt patch (EBADMSG)";
+    default: return "error " + std::to_string(status);
+    }
+}
+
+UpdateStats send_update(const ExportOptions &opts, const std::vector<uint8_t> &patch)
+{
+    UpdateStats st;
+    uint8_t pkt[EXPORT_MAX_PACKET];
+
+    if (patch.empty()) {
+        throw std::runtime_error("empty patch");
+    }
+    SerialPort port(opts.port, opts.baud);
+    st.baud = open_session(port, opts, pkt);
+    std::fprintf(stderr, "node: %u baud; sending a %zu-byte patch\n", st.baud, patch.size());
+
+    const auto start = Clock::now();
+    auto progress_at = start;
+    uint32_t next = 0;
+    int status = 0;
+
+    /* Stop-and-wait: the chunk at the offset the node last asked for */
+    while (status == 0) {
+        if (next >= patch.size()) {
+            throw std::runtime_error("the node wants more than the whole patch");
+        }
+        const std::size_t len = std::min<std::size_t>(EXPORT_UPDATE_CHUNK, patch.size() - next);
+        pkt[0] = EXPORT_UPDATE;
+        telemetry_put_u32(&pkt[1], next);
+        std::memcpy(&pkt[EXPORT_UPDATE_HEADER], &patch[next], len);
+        port.send(pkt, EXPORT_UPDATE_HEADER + len);
+        st.chunks++;
+
+        /* The first chunk checks the running image and erases a page */
+        int n;
+        const int timeout = next == 0 ? kUpdateFirstTimeoutMs : EXPORT_RTO_MS;
+        while ((n = port.receive(pkt, timeout)) > 0 && (pkt[0] != EXPORT_UPDATE_ACK || n < EXPORT_UPDATE_ACK_SIZE)) {
+        }
+        if (n == 0) {
+            if (Clock::now() - progress_at > std::chrono::milliseconds(EXPORT_IDLE_MS)) {
+                throw std::runtime_error("the node stopped answering at patch byte " + std::to_string(next));
+            }
+            st.timeouts++;
+            continue;
+        }
+        if (telemetry_get_u32(&pkt[1]) != next) {
+            progress_at = Clock::now();
+        }
+        next = telemetry_get_u32(&pkt[1]);
+        status = static_cast<int8_t>(pkt[5]);
+        st.apply_ms = telemetry_get_u32(&pkt[6]);
+    }
+    st.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    st.bad_packets = port.bad_packets;
+
+    close_session(port, opts, st.baud);
+    if (status < 0) {
+        throw std::runtime_error("the node rejected the patch: " + update_error(status));
+    }
+    return st;
+}
+
+} // namespace tsdb
@@ -0,0 +1,72 @@
+/**
+ * @file export_client.hpp
+ * @brief Host side of the history export protocol (export_protocol.h).
+ */
+
+#ifndef TSDB_EXPORT_CLIENT_HPP
+#define TSDB_EXPORT_CLIENT_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace tsdb {
+
+/** @brief Options of an export session. */
+struct ExportOptions {
+    std::string port;               /**< Serial device of the node's console. */
+    uint32_t baud = 115200;         /**< Baud rate of the console. */
+    uint32_t fast_baud = 921600;    /**< Baud rate asked for the transfer, 0 to keep @c baud. */
+    int64_t from = -1;              /**< First record wanted, -1 to resume after the spool. */
+};
+
+/** @brief Outcome of an export session. */
+struct ExportStats {
+    uint64_t records = 0;           /**< Records received and spooled. */
+    uint64_t lost = 0;              /**< Records overwritten or torn on the node, never received. */
+    uint64_t wire_bytes = 0;        /**< Bytes received during the transfer, delimiters included. */
+    uint64_t out_of_order = 0;      /**< DATA packets discarded (go-back-N). */
+    uint64_t bad_packets = 0;       /**< Packets with a bad encoding or CRC. */
+    uint64_t timeouts = 0;          /**< Times READ was sent again. */
+    uint32_t baud = 0;              /**< Baud rate of the transfer. */
+    double seconds = 0;             /**< From the first READ to DONE. */
+};
+
+/** @brief Outcome of a firmware update. */
+struct UpdateStats {
+    uint64_t chunks = 0;            /**< UPDATE packets sent, resends included. */
+    uint64_t timeouts = 0;          /**< Chunks sent again after no answer. */
+    uint64_t bad_packets = 0;       /**< Packets with a bad encoding or CRC. */
+    uint32_t apply_ms = 0;          /**< Time the node spent applying the patch. */
+    uint32_t baud = 0;              /**< Baud rate of the transfer. */
+    double seconds = 0;             /**< From the first chunk to the image check. */
+};
+
+/**
+ * @brief Read the node's history into a spool file.
+ *
+ * Records are appended to @p spool_path as they arrive, in order, so an
+ * interrupted session loses nothing and the next one resumes after the
+ * last spooled record. With @c from set, spooled records from that index
+ * on are dropped first, so reading again never duplicates them.
+ *
+ * @throws std::runtime_error if the port cannot be used or the node does
+ *         not answer.
+ */
+ExportStats export_history(const ExportOptions &opts, const std::string &spool_path);
+
+/**
+ * @brief Send a firmware patch (tools/delta/delta_patch.py) to the node.
+ *
+ * Returns once the node has written and checked the new image; it reboots
+ * into it when the session ends, if it has a bootloader. @c from of
+ * @p opts is not used.
+ *
+ * @throws std::runtime_error if the port cannot be used, the node does not
+ *         answer or it rejects the patch.
+ */
+UpdateStats send_update(const ExportOptions &opts, const std::vector<uint8_t> &patch);
+
+} // namespace tsdb
+
+#endif // TSDB_EXPORT_CLIENT_HPP
@@ -0,0 +1,458 @@
+/**
+ * @file importers.cpp
+ * @brief Converters from captured telemetry to @ref tsdb::Row.
+ */
+
+#include "importers.hpp"
+
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <stdexcept>
+
+#include "export_protocol.h"
+#include "telemetry_frame.h"
+
+namespace tsdb {
+
+/* ---------------------------------------------------------------------------
+ * Time parsing
+ * ---------------------------------------------------------------------------*/
+
+/**
+ * @brief Parse a date/time at @p s.
+ *
+ * @param s Input text.
+ * @param ms Output time (ms since the epoch, UTC).
+ * @return Number of characters consumed, 0 if @p s does not start with a date.
+ */
+static std::size_t parse_time_prefix(const char *s, int64_t *ms)
+{
+    int year, mon, day, hh = 0, mm = 0, ss = 0, frac = 0, n = 0;
+
+    if (std::sscanf(s, "%4d-%2d-%2d%n", &year, &mon, &day, &n) != 3 || n != 10) {
+        return 0;
+    }
+    std::size_t used = static_cast<std::size_t>(n);
+
+    if ((s[used] == 'T' || s[used] == ' ') && std::isdigit(static_cast<unsigned char>(s[used + 1]))) {
+        int m = 0;
+        if (std::sscanf(s + used + 1, "%2d:%2d%n", &hh, &mm, &m) == 2) {
+            used += 1 + static_cast<std::size_t>(m);
+            if (s[used] == ':' && std::sscanf(s + used + 1, "%2d%n", &ss, &m) == 1) {
+                used += 1 + static_cast<std::size_t>(m);
+                if (s[used] == '.' && std::sscanf(s + used + 1, "%3d%n", &frac, &m) == 1) {
+                    for (int d = m; d < 3; d++) {
+                        frac *= 10;
+                    }
+                    used += 1 + static_cast<std::size_t>(m);
+                    while (std::isdigit(static_cast<unsigned char>(s[used]))) {
+                        used++;
+                    }
+                }
+            }
+        }
+    }
+    if (s[used] == 'Z') {
+        used++;
+    }
+
+    struct tm tm = {};
+    tm.tm_year = year - 1900;
+    tm.tm_mon = mon - 1;
+    tm.tm_mday = day;
+    tm.tm_hour = hh;
+    tm.tm_min = mm;
+    tm.tm_sec = ss;
+    *ms = static_cast<int64_t>(timegm(&tm)) * 1000 + frac;
+    return used;
+}
+
+bool parse_time(const std::string &text, int64_t *ms)
+{
+    if (parse_time_prefix(text.c_str(), ms) == text.size()) {
+        return true;
+    }
+    char *end = nullptr;
+    const long long v = std::strtoll(text.c_str(), &end, 10);
+    if (!text.empty() && *end == '\0') {
+        *ms = v;
+        return true;
+    }
+    return false;
+}
+
+std::string format_time(int64_t ms)
+{
+    const time_t secs = static_cast<time_t>(ms >= 0 ? ms / 1000 : (ms - 999) / 1000);
+    struct tm tm;
+    gmtime_r(&secs, &tm);
+    char buf[32];
+    std::strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%SZ", &tm);
+    return buf;
+}
+
+/* ---------------------------------------------------------------------------
+ * Console log import
+ * ---------------------------------------------------------------------------*/
+
+/**
+ * @brief Value following @p label on @p line, NaN if absent.
+ */
+static double field(const std::string &line, const char *label)
+{
+    const std::size_t at = line.find(label);
+    if (at == std::string::npos) {
+        return NAN;
+    }
+    const char *start = line.c_str() + at + std::strlen(label);
+    char *end = nullptr;
+    const double v = std::strtod(start, &end);
+    return end == start ? NAN : v;
+}
+
+/**
+ * @brief Store @p value × @p scale in @p row if it was present.
+ */
+static void set_scaled(Row &row, Column col, double value)
+{
+    if (!std::isnan(value)) {
+        row[col] = std::llround(value * kColumnSpecs[col].scale);
+    }
+}
+
+static int health_from_name(const std::string &line)
+{
+    static const char *names[] = {"HEALTHY", "CHLOROSIS", "WATER STRESS", "LOW LIGHT"};
+    const std::size_t at = line.find("PLANT HEALTH:");
+    for (int i = 0; i < 4; i++) {
+        if (line.find(names[i], at) != std::string::npos) {
+            return i;
+        }
+    }
+    return 0;
+}
+
+static uint32_t anomaly_from_line(const std::string &line)
+{
+    static const struct {
+        const char *text;
+        uint32_t flag;
+    } kinds[] = {
+        {"Temperature out of daily profile", 1u << 0},
+        {"Humidity deviates", 1u << 1},
+        {"Light out of daily profile", 1u << 2},
+        {"soil moisture drop", 1u << 3},
+        {"Watering event", 1u << 4},
+    };
+    for (const auto &k : kinds) {
+        if (line.find(k.text) != std::string::npos) {
+            return k.flag;
+        }
+    }
+    return 0;
+}
+
+static Row row_from_frame(const struct telemetry_frame &f, int64_t ts_ms)
+{
+    Row row = {};
+    row[COL_TS_MS] = ts_ms;
+    row[COL_NODE] = f.node_id;
+    row[COL_MOISTURE] = f.moisture;
+    row[COL_LIGHT] = f.brightness;
+    row[COL_TEMP] = f.temp;
+    row[COL_HUM] = f.hum;
+    row[COL_RED] = f.red;
+    row[COL_GREEN] = f.green;
+    row[COL_BLUE] = f.blue;
+    row[COL_CLEAR] = f.clear;
+    row[COL_ACCEL_X] = f.accel_x;
+    row[COL_ACCEL_Y] = f.accel_y;
+    row[COL_ACCEL_Z] = f.accel_z;
+    row[COL_LAT] = f.gps_lat;
+    row[COL_LON] = f.gps_lon;
+    row[COL_ALT] = f.gps_alt;
+    row[COL_SATS] = f.gps_sats;
+    row[COL_HEALTH] = f.health;
+    row[COL_ANOMALY] = f.anomaly;
+    return row;
+}
+
+static int hex_value(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+/**
+ * @brief Decode the payload of a "@TLM <hex>" line.
+ */
+static bool frame_from_line(const std::string &line, std::size_t at, struct telemetry_frame *f)
+{
+    uint8_t buf[TELEMETRY_FRAME_SIZE];
+    std::size_t n = 0;
+    for (std::size_t i = at + 5; i + 1 < line.size() && n < sizeof(buf); i += 2) {
+        const int hi = hex_value(line[i]);
+        const int lo = hex_value(line[i + 1]);
+        if (hi < 0 || lo < 0) {
+            break;
+        }
+        buf[n++] = static_cast<uint8_t>((hi << 4) | lo);
+    }
+    return telemetry_decode(buf, n, f) == 0;
+}
+
+std::size_t import_log(std::istream &in, const LogImportOptions &opts, std::vector<Row> &rows)
+{
+    const std::size_t before = rows.size();
+    std::string line;
+    Row cur = {};
+    bool open = false;
+    uint32_t pending_anomaly = 0;
+    int64_t line_ts = 0;
+    uint64_t untimed = 0;
+
+    auto emit = [&]() {
+        if (open) {
+            rows.push_back(cur);
+            open = false;
+        }
+    };
+
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+
+        const char *text = line.c_str();
+        while (*text == '[' || *text == ' ') {
+            text++;
+        }
+        const bool has_ts = parse_time_prefix(text, &line_ts) > 0;
+
+        const std::size_t tlm = line.find("@TLM ");
+        if (tlm != std::string::npos) {
+            struct telemetry_frame f;
+            if (frame_from_line(line, tlm, &f)) {
+                rows.push_back(row_from_frame(f, has_ts ? line_ts : opts.start_ms + f.uptime_ms));
+            }
+            continue;
+        }
+
+        if (line.find("[ANOMALY]") != std::string::npos) {
+            pending_anomaly |= anomaly_from_line(line);
+        } else if (line.find("SOIL MOISTURE:") != std::string::npos) {
+            emit();
+            cur = Row{};
+            open = true;
+            cur[COL_NODE] = opts.node;
+            cur[COL_TS_MS] = has_ts ? line_ts : opts.start_ms + static_cast<int64_t>(untimed) * opts.period_ms;
+            untimed++;
+            cur[COL_ANOMALY] = pending_anomaly;
+            pending_anomaly = 0;
+            set_scaled(cur, COL_MOISTURE, field(line, "SOIL MOISTURE:"));
+        } else if (!open) {
+            continue;
+        } else if (line.find("LIGHT:") != std::string::npos) {
+            set_scaled(cur, COL_LIGHT, field(line, "LIGHT:"));
+        } else if (line.find("GPS:") != std::string::npos) {
+            set_scaled(cur, COL_SATS, field(line, "#Sats:"));
+            double lat = field(line, "Lat(UTC):");
+            double lon = field(line, "Long(UTC):");
+            if (line.find(" S ") != std::string::npos) lat = -lat;
+            if (line.find(" W ") != std::string::npos) lon = -lon;
+            set_scaled(cur, COL_LAT, lat);
+            set_scaled(cur, COL_LON, lon);
+            set_scaled(cur, COL_ALT, field(line, "Altitude:"));
+        } else if (line.find("COLOR SENSOR:") != std::string::npos) {
+            set_scaled(cur, COL_CLEAR, field(line, "Clear:"));
+            set_scaled(cur, COL_RED, field(line, "Red:"));
+            set_scaled(cur, COL_GREEN, field(line, "Green:"));
+            set_scaled(cur, COL_BLUE, field(line, "Blue:"));
+        } else if (line.find("ACCELEROMETER:") != std::string::npos) {
+            set_scaled(cur, COL_ACCEL_X, field(line, "X_axis:"));
+            set_scaled(cur, COL_ACCEL_Y, field(line, "Y_axis:"));
+            set_scaled(cur, COL_ACCEL_Z, field(line, "Z_axis:"));
+        } else if (line.find("TEMP/HUM:") != std::string::npos) {
+            set_scaled(cur, COL_TEMP, field(line, "Temperature:"));
+            set_scaled(cur, COL_HUM, field(line, "Relative Humidity:"));
+        } else if (line.find("PLANT HEALTH:") != std::string::npos) {
+            cur[COL_HEALTH] = health_from_name(line);
+            emit();
+        }
+    }
+    emit();
+
+    return rows.size() - before;
+}
+
+/* ---------------------------------------------------------------------------
+ * History import
+ * ---------------------------------------------------------------------------*/
+
+std::size_t import_history(std::istream &in, std::vector<Row> &rows, std::size_t *unplaced)
+{
+    struct Record {
+        struct telemetry_frame f;
+        uint32_t utc;
+    };
+    std::vector<Record> recs;
+    uint8_t rec[HISTORY_RECORD_SIZE];
+
+    while (in.read(reinterpret_cast<char *>(rec), sizeof(rec))) {
+        Record r;
+        if (history_record_check(rec) != 0 ||
+            telemetry_decode(&rec[HISTORY_RECORD_FRAME], TELEMETRY_FRAME_SIZE, &r.f) != 0) {
+            continue;
+        }
+        r.utc = telemetry_get_u32(&rec[HISTORY_RECORD_UTC]);
+        recs.push_back(r);
+    }
+
+    /* A boot is a run of records of one node with a growing uptime. Records
+     * taken before its first fix are placed by their uptime relative to the
+     * first stamped record of the same boot, any later one relative to the
+     * last stamped record before it. */
+    const std::size_t before = rows.size();
+    std::size_t skipped = 0;
+    for (std::size_t start = 0, end; start < recs.size(); start = end) {
+        end = start + 1;
+        while (end < recs.size() && recs[end].f.node_id == recs[start].f.node_id &&
+               recs[end].f.uptime_ms >= recs[end - 1].f.uptime_ms) {
+            end++;
+        }
+
+        std::size_t ref = end;
+        for (std::size_t i = end; i-- > start;) {
+            if (recs[i].utc != 0) {
+                ref = i;
+            }
+        }
+        for (std::size_t i = start; i < end; i++) {
+            if (recs[i].utc != 0) {
+                ref = i;
+            }
+            if (ref == end) {
+                skipped++;
+                continue;
+            }
+            const int64_t ts = int64_t(recs[ref].utc) * 1000 +
+                               (int64_t(recs[i].f.uptime_ms) - int64_t(recs[ref].f.uptime_ms));
+            rows.push_back(row_from_frame(recs[i].f, ts));
+        }
+    }
+    if (unplaced != nullptr) {
+        *unplaced = skipped;
+    }
+    return rows.size() - before;
+}
+
+/* ---------------------------------------------------------------------------
+ * Gateway store import
+ * ---------------------------------------------------------------------------*/
+
+/**
+ * @brief A column file of the gateway store loaded into memory.
+ */
+struct StoreColumn {
+    std::string type;
+    std::vector<uint8_t> data;
+
+    int64_t at(uint64_t row) const
+    {
+        const uint8_t *p;
+        if (type == "u8") {
+            return data[row];
+        } else if (type == "i16") {
+            int16_t v; p = &data[row * 2]; std::memcpy(&v, p, 2); return v;
+        } else if (type == "u16") {
+            uint16_t v; p = &data[row * 2]; std::memcpy(&v, p, 2); return v;
+        } else if (type == "i32") {
+            int32_t v; p = &data[row * 4]; std::memcpy(&v, p, 4); return v;
+        } else if (type == "u32") {
+            uint32_t v; p = &data[row * 4]; std::memcpy(&v, p, 4); return v;
+        }
+        int64_t v; p = &data[row * 8]; std::memcpy(&v, p, 8); return v;
+    }
+};
+
+static std::size_t type_size(const std::string &type)
+{
+    if (type == "u8") return 1;
+    if (type == "i16" || type == "u16") return 2;
+    if (type == "i32" || type == "u32") return 4;
+    return 8;
+}
+
+std::size_t import_store(const std::string &dir, std::vector<Row> &rows)
+{
+    static const struct {
+        const char *store_name;
+        Column col;
+    } mapping[] = {
+        {"rx_us", COL_TS_MS},     {"node_id", COL_NODE},   {"moisture", COL_MOISTURE},
+        {"brightness", COL_LIGHT}, {"temp", COL_TEMP},     {"hum", COL_HUM},
+        {"red", COL_RED},         {"green", COL_GREEN},    {"blue", COL_BLUE},
+        {"clear", COL_CLEAR},     {"accel_x", COL_ACCEL_X}, {"accel_y", COL_ACCEL_Y},
+        {"accel_z", COL_ACCEL_Z}, {"gps_lat", COL_LAT},    {"gps_lon", COL_LON},
+        {"gps_alt", COL_ALT},     {"gps_sats", COL_SATS},  {"health", COL_HEALTH},
+        {"anomaly", COL_ANOMALY},
+    };
+
+    uint64_t count = 0;
+    {
+        std::ifstream rf(dir + "/rows", std::ios::binary);
+        if (!rf.read(reinterpret_cast<char *>(&count), sizeof(count))) {
+            throw std::runtime_error(dir + ": not a gateway store (no rows file)");
+        }
+    }
+
+    std::vector<std::pair<std::string, std::string>> schema;
+    {
+        std::ifstream sf(dir + "/schema");
+        std::string name, type;
+        while (sf >> name >> type) {
+            schema.emplace_back(name, type);
+        }
+    }
+
+    std::vector<StoreColumn> columns(COL_COUNT);
+    for (const auto &m : mapping) {
+        std::string type;
+        for (const auto &s : schema) {
+            if (s.first == m.store_name) {
+                type = s.second;
+            }
+        }
+        if (type.empty()) {
+            throw std::runtime_error(dir + ": schema has no column " + m.store_name);
+        }
+
+        StoreColumn &col = columns[m.col];
+        col.type = type;
+        col.data.resize(count * type_size(type));
+        std::ifstream cf(dir + "/" + m.store_name + ".col", std::ios::binary);
+        if (!cf.read(reinterpret_cast<char *>(col.data.data()), static_cast<std::streamsize>(col.data.size()))) {
+            throw std::runtime_error(dir + ": column " + m.store_name + " is shorter than the row count");
+        }
+    }
+
+    rows.reserve(rows.size() + count);
+    for (uint64_t r = 0; r < count; r++) {
+        Row row;
+        for (uint32_t c = 0; c < COL_COUNT; c++) {
+            row[c] = columns[c].at(r);
+        }
+        row[COL_TS_MS] /= 1000;  /* Store keeps µs. */
+        rows.push_back(row);
+    }
+    return count;
+}
+
+} // namespace tsdb
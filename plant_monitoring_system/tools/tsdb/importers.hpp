@@ -0,0 +1,75 @@
+/**
+ * @file importers.hpp
+ * @brief Converters from captured telemetry to @ref tsdb::Row.
+ */
+
+#ifndef TSDB_IMPORTERS_HPP
+#define TSDB_IMPORTERS_HPP
+
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+
+#include "tsdb_format.hpp"
+
+namespace tsdb {
+
+/** @brief Options for console log import. */
+struct LogImportOptions {
+    uint32_t node = 0;          /**< Node identifier assigned to text records. */
+    int64_t start_ms = 0;       /**< Time of the first record when lines carry no timestamp. */
+    int64_t period_ms = 60000;  /**< Spacing of untimestamped records. */
+};
+
+/**
+ * @brief Parse a UTC date/time.
+ *
+ * Accepts @c YYYY-MM-DD, @c YYYY-MM-DD[T ]hh:mm[:ss[.fff]] and a plain
+ * number of ms since the epoch.
+ *
+ * @return true on success.
+ */
+bool parse_time(const std::string &text, int64_t *ms);
+
+/** @brief Format ms since the epoch as @c YYYY-MM-DDThh:mm:ssZ. */
+std::string format_time(int64_t ms);
+
+/**
+ * @brief Import a serial console capture.
+ *
+ * Understands the multi-line block printed by @c display_measurements()
+ * (starting at "SOIL MOISTURE:" and ending at "PLANT HEALTH:"), the
+ * preceding "[ANOMALY]" lines, and "@TLM" frame lines. A timestamp at the
+ * start of a line, as added by most terminal loggers (e.g.
+ * "[2026-03-01 12:00:00.123] "), is used when present.
+ *
+ * @return Number of rows appended to @p rows.
+ */
+std::size_t import_log(std::istream &in, const LogImportOptions &opts, std::vector<Row> &rows);
+
+/**
+ * @brief Import history records (export_protocol.h), as spooled by the
+ *        export client.
+ *
+ * Records with a bad CRC are skipped. The time of a record is its UTC
+ * time. A record taken before the node had the GPS time is placed by its
+ * uptime relative to a stamped record of the same boot; if that boot has
+ * none, the record is skipped rather than given a 1970 time.
+ *
+ * @param unplaced If not null, set to the number of records skipped for lack of a time.
+ * @return Number of rows appended to @p rows.
+ */
+std::size_t import_history(std::istream &in, std::vector<Row> &rows, std::size_t *unplaced = nullptr);
+
+/**
+ * @brief Import a gateway column store directory.
+ *
+ * @return Number of rows appended to @p rows.
+ * @throws std::runtime_error if the store cannot be read.
+ */
+std::size_t import_store(const std::string &dir, std::vector<Row> &rows);
+
+} // namespace tsdb
+
+#endif // TSDB_IMPORTERS_HPP
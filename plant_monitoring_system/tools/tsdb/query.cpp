@@ -0,0 +1,111 @@
+/**
+ * @file query.cpp
+ * @brief Range and aggregate queries over .ptsdb files.
+ *
+ * For every block the index is consulted first:
+ * - blocks outside the time range or node filter are skipped;
+ * - blocks entirely inside the range that fall in a single group are merged
+ *   from the stored count/sum/min/max without decoding anything;
+ * - only the remaining blocks decode the timestamp, node and value columns.
+ */
+
+#include "query.hpp"
+
+namespace tsdb {
+
+static inline int64_t bucket_of(int64_t ts, int64_t width)
+{
+    if (width <= 0) {
+        return INT64_MIN;
+    }
+    int64_t b = ts / width;
+    if (ts % width != 0 && ts < 0) {
+        b--;
+    }
+    return b * width;
+}
+
+static inline bool row_selected(int64_t ts, int64_t node, const Query &q)
+{
+    return ts >= q.from_ms && ts < q.to_ms && (!q.has_node || node == q.node);
+}
+
+static inline GroupKey key_of(int64_t ts, int64_t node, const Query &q)
+{
+    return {q.per_node ? node : -1, bucket_of(ts, q.bucket_ms)};
+}
+
+QueryResult run_query(const MappedFile &file, const Query &q)
+{
+    QueryResult res;
+    res.blocks_total = file.blocks();
+
+    std::vector<int64_t> ts(kBlockRows), node(kBlockRows), value(kBlockRows);
+
+    for (uint64_t b = 0; b < file.blocks(); b++) {
+        const BlockIndex &blk = file.block(b);
+        const ChunkIndex &t = blk.chunks[COL_TS_MS];
+        const ChunkIndex &n = blk.chunks[COL_NODE];
+
+        if (t.max < q.from_ms || t.min >= q.to_ms ||
+            (q.has_node && (q.node < n.min || q.node > n.max))) {
+            res.blocks_pruned++;
+            continue;
+        }
+
+        const bool inside = t.min >= q.from_ms && t.max < q.to_ms &&
+                            (!q.has_node || (n.min == q.node && n.max == q.node));
+        const bool one_group = (!q.per_node || n.min == n.max) &&
+                               bucket_of(t.min, q.bucket_ms) == bucket_of(t.max, q.bucket_ms);
+        if (inside && one_group) {
+            const ChunkIndex &v = blk.chunks[q.column];
+            Cell &cell = res.cells[key_of(t.min, n.min, q)];
+            cell.count += blk.rows;
+            cell.sum += v.sum;
+            cell.min = v.min < cell.min ? v.min : cell.min;
+            cell.max = v.max > cell.max ? v.max : cell.max;
+            res.blocks_index_only++;
+            continue;
+        }
+
+        file.decode(b, COL_TS_MS, ts.data());
+        file.decode(b, COL_NODE, node.data());
+        file.decode(b, q.column, value.data());
+        res.blocks_decoded++;
+        res.rows_scanned += blk.rows;
+
+        for (uint32_t i = 0; i < blk.rows; i++) {
+            if (row_selected(ts[i], node[i], q)) {
+                res.cells[key_of(ts[i], node[i], q)].add(value[i]);
+            }
+        }
+    }
+    return res;
+}
+
+QueryResult run_query(const std::vector<Row> &rows, const Query &q)
+{
+    QueryResult res;
+    res.rows_scanned = rows.size();
+    for (const Row &row : rows) {
+        if (row_selected(row[COL_TS_MS], row[COL_NODE], q)) {
+            res.cells[key_of(row[COL_TS_MS], row[COL_NODE], q)].add(row[q.column]);
+        }
+    }
+    return res;
+}
+
+double cell_value(const Cell &cell, const Query &q)
+{
+    const double scale = kColumnSpecs[q.column].scale;
+    switch (q.agg) {
+    case Agg::Count: return static_cast<double>(cell.count);
+    case Agg::Sum:   return cell.sum / scale;
+    case Agg::Mean:  return cell.count ? cell.sum / scale / cell.count : 0.0;
+    case Agg::Min:   return cell.min / scale;
+    case Agg::Max:   return cell.max / scale;
+    }
+    return 0.0;
+}
+
+} // namespace tsdb
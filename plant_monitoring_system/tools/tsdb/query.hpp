@@ -0,0 +1,71 @@
+/**
+ * @file query.hpp
+ * @brief Range and aggregate queries over .ptsdb files.
+ */
+
+#ifndef TSDB_QUERY_HPP
+#define TSDB_QUERY_HPP
+
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "tsdb_file.hpp"
+#include "tsdb_format.hpp"
+
+namespace tsdb {
+
+enum class Agg { Count, Sum, Mean, Min, Max };
+
+struct Query {
+    Column column = COL_MOISTURE;
+    Agg agg = Agg::Mean;
+    int64_t bucket_ms = 0;          /**< Time bucket width, 0 for a single bucket. */
+    int64_t from_ms = INT64_MIN;    /**< Inclusive start. */
+    int64_t to_ms = INT64_MAX;      /**< Exclusive end. */
+    bool has_node = false;          /**< Restrict to @ref node. */
+    uint32_t node = 0;
+    bool per_node = false;          /**< Group results by node. */
+};
+
+/** @brief Running aggregate of one (node, bucket) group. */
+struct Cell {
+    int64_t count = 0;
+    int64_t sum = 0;
+    int64_t min = INT64_MAX;
+    int64_t max = INT64_MIN;
+
+    void add(int64_t v)
+    {
+        count++;
+        sum += v;
+        min = v < min ? v : min;
+        max = v > max ? v : max;
+    }
+};
+
+/** @brief Group key: node (-1 when not grouped) and bucket start (INT64_MIN when not bucketed). */
+using GroupKey = std::pair<int64_t, int64_t>;
+
+struct QueryResult {
+    std::map<GroupKey, Cell> cells;
+    uint64_t blocks_total = 0;
+    uint64_t blocks_pruned = 0;      /**< Skipped using the block min/max index. */
+    uint64_t blocks_index_only = 0;  /**< Answered from the index without decoding. */
+    uint64_t blocks_decoded = 0;
+    uint64_t rows_scanned = 0;
+};
+
+/** @brief Run @p q against a mapped file using the block index. */
+QueryResult run_query(const MappedFile &file, const Query &q);
+
+/** @brief Run @p q by scanning parsed rows (baseline for text logs). */
+QueryResult run_query(const std::vector<Row> &rows, const Query &q);
+
+/** @brief Final value of a group in display units. */
+double cell_value(const Cell &cell, const Query &q);
+
+} // namespace tsdb
+
+#endif // TSDB_QUERY_HPP
@@ -0,0 +1,156 @@
+/**
+ * @file tsdb_file.cpp
+ * @brief Writing and memory-mapped reading of .ptsdb files.
+ */
+
+#include "tsdb_file.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "codec.hpp"
+
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__,
+              "The header and index are mapped in place and must be little-endian");
+
+namespace tsdb {
+
+[[noreturn]] static void throw_errno(const std::string &what)
+{
+    throw std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+void write_file(const std::string &path, std::vector<Row> &rows)
+{
+    std::sort(rows.begin(), rows.end(), [](const Row &a, const Row &b) {
+        return a[COL_NODE] != b[COL_NODE] ? a[COL_NODE] < b[COL_NODE] : a[COL_TS_MS] < b[COL_TS_MS];
+    });
+
+    std::vector<uint8_t> data(sizeof(FileHeader));
+    std::vector<BlockIndex> index;
+    std::vector<int64_t> column(kBlockRows);
+
+    for (std::size_t start = 0; start < rows.size(); start += kBlockRows) {
+        const std::size_t n = std::min<std::size_t>(kBlockRows, rows.size() - start);
+        BlockIndex block = {};
+        block.rows = static_cast<uint32_t>(n);
+
+        for (uint32_t c = 0; c < COL_COUNT; c++) {
+            ChunkIndex &chunk = block.chunks[c];
+            chunk.min = INT64_MAX;
+            chunk.max = INT64_MIN;
+            for (std::size_t i = 0; i < n; i++) {
+                const int64_t v = rows[start + i][c];
+                column[i] = v;
+                chunk.min = std::min(chunk.min, v);
+                chunk.max = std::max(chunk.max, v);
+                chunk.sum += v;
+            }
+            chunk.offset = data.size();
+            const ChunkFormat format = encode_chunk_best(column.data(), n, data);
+            chunk.encoding = static_cast<uint8_t>(format.encoding);
+            chunk.packing = static_cast<uint8_t>(format.packing);
+            chunk.size = static_cast<uint32_t>(data.size() - chunk.offset);
+        }
+        index.push_back(block);
+    }
+
+    data.resize((data.size() + 7) & ~static_cast<std::size_t>(7), 0);
+
+    FileHeader header = {};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.columns = COL_COUNT;
+    header.rows = rows.size();
+    header.blocks = index.size();
+    header.index_offset = data.size();
+    std::memcpy(data.data(), &header, sizeof(header));
+
+    /* Write to a temporary name and rename, so readers never see a partial file. */
+    const std::string tmp = path + ".tmp";
+    FILE *f = std::fopen(tmp.c_str(), "wb");
+    if (f == nullptr) {
+        throw_errno("open " + tmp);
+    }
+    const bool ok = std::fwrite(data.data(), 1, data.size(), f) == data.size() &&
+                    std::fwrite(index.data(), sizeof(BlockIndex), index.size(), f) == index.size();
+    if (std::fclose(f) != 0 || !ok) {
+        std::remove(tmp.c_str());
+        throw_errno("write " + tmp);
+    }
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        throw_errno("rename " + tmp);
+    }
+}
+
+MappedFile::MappedFile(const std::string &path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw_errno("open " + path);
+    }
+    struct stat st;
+    if (::fstat(fd, &st) < 0) {
+        ::close(fd);
+        throw_errno("stat " + path);
+    }
+    size_ = static_cast<std::size_t>(st.st_size);
+    if (size_ < sizeof(FileHeader)) {
+        ::close(fd);
+        throw std::runtime_error(path + ": not a ptsdb file");
+    }
+
+    void *map = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        throw_errno("mmap " + path);
+    }
+    base_ = static_cast<const uint8_t *>(map);
+    header_ = reinterpret_cast<const FileHeader *>(base_);
+
+    const bool valid =
+        std::memcmp(header_->magic, kMagic, sizeof(kMagic)) == 0 &&
+        header_->version == kVersion && header_->columns == COL_COUNT &&
+        header_->index_offset % 8 == 0 &&
+        header_->index_offset <= size_ &&
+        header_->blocks <= (size_ - header_->index_offset) / sizeof(BlockIndex);
+    if (!valid) {
+        ::munmap(map, size_);
+        throw std::runtime_error(path + ": not a ptsdb file or unsupported version");
+    }
+    index_ = reinterpret_cast<const BlockIndex *>(base_ + header_->index_offset);
+
+    /* Queries scan blocks front to back. */
+    ::madvise(map, size_, MADV_SEQUENTIAL);
+}
+
+MappedFile::~MappedFile()
+{
+    if (base_ != nullptr) {
+        ::munmap(const_cast<uint8_t *>(base_), size_);
+    }
+}
+
+void MappedFile::decode(uint64_t b, Column col, int64_t *out) const
+{
+    const BlockIndex &block = index_[b];
+    const ChunkIndex &chunk = block.chunks[col];
+    if (block.rows > kBlockRows || chunk.offset > header_->index_offset ||
+        chunk.size > header_->index_offset - chunk.offset ||
+        !decode_chunk(base_ + chunk.offset, chunk.size,
+                      {static_cast<Encoding>(chunk.encoding), static_cast<Packing>(chunk.packing)},
+                      block.rows, out)) {
+        throw std::runtime_error("corrupt chunk (block " + std::to_string(b) + ", column " +
+                                 kColumnSpecs[col].name + ")");
+    }
+}
+
+} // namespace tsdb
@@ -0,0 +1,61 @@
+/**
+ * @file tsdb_file.hpp
+ * @brief Writing and memory-mapped reading of .ptsdb files.
+ */
+
+#ifndef TSDB_FILE_HPP
+#define TSDB_FILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "tsdb_format.hpp"
+
+namespace tsdb {
+
+/**
+ * @brief Sort rows by (node, ts_ms) and write them to @p path.
+ * @throws std::runtime_error on I/O errors.
+ */
+void write_file(const std::string &path, std::vector<Row> &rows);
+
+/**
+ * @brief Read-only memory-mapped view of a .ptsdb file.
+ *
+ * The header and the block index are used in place; chunks are decoded
+ * straight from the mapping without copying the file.
+ */
+class MappedFile {
+public:
+    /** @throws std::runtime_error if the file cannot be mapped or is invalid. */
+    explicit MappedFile(const std::string &path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    const FileHeader &header() const { return *header_; }
+    uint64_t blocks() const { return header_->blocks; }
+    const BlockIndex &block(uint64_t i) const { return index_[i]; }
+    std::size_t size() const { return size_; }
+
+    /**
+     * @brief Decode one column of one block.
+     *
+     * @param out Output array of at least block(b).rows values.
+     * @throws std::runtime_error if the chunk is corrupt.
+     */
+    void decode(uint64_t b, Column col, int64_t *out) const;
+
+private:
+    const uint8_t *base_ = nullptr;
+    std::size_t size_ = 0;
+    const FileHeader *header_ = nullptr;
+    const BlockIndex *index_ = nullptr;
+};
+
+} // namespace tsdb
+
+#endif // TSDB_FILE_HPP
@@ -0,0 +1,139 @@
+/**
+ * @file tsdb_format.hpp
+ * @brief On-disk layout of the plant time-series file (.ptsdb).
+ *
+ * @verbatim
+ *   FileHeader
+ *   block 0: chunk(col 0) chunk(col 1) ... chunk(col N-1)
+ *   block 1: ...
+ *   (padding to 8 bytes)
+ *   BlockIndex[blocks]            <- FileHeader::index_offset
+ * @endverbatim
+ *
+ * Rows are sorted by (node, ts_ms) and cut into blocks of at most
+ * @ref kBlockRows rows. Each column of a block is compressed on its own with
+ * the smallest combination of @ref Encoding and @ref Packing. The index stores the min, max
+ * and sum of every chunk, so range pruning and many aggregates never touch
+ * the compressed data.
+ *
+ * All integers are little-endian. The index is 8-byte aligned and is read
+ * in place from the memory-mapped file.
+ */
+
+#ifndef TSDB_FORMAT_HPP
+#define TSDB_FORMAT_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace tsdb {
+
+constexpr char kMagic[8] = {'P', 'T', 'S', 'D', 'B', 0, 0, 1};
+constexpr uint32_t kVersion = 1;
+constexpr uint32_t kBlockRows = 4096;
+
+/** @brief Logical columns. Values are the firmware's scaled integers. */
+enum Column : uint32_t {
+    COL_TS_MS = 0,  /**< Timestamp (ms since the Unix epoch, UTC). */
+    COL_NODE,       /**< Node identifier. */
+    COL_MOISTURE,   /**< Soil moisture (% ×10). */
+    COL_LIGHT,      /**< Brightness (% ×10). */
+    COL_TEMP,       /**< Temperature (°C ×100). */
+    COL_HUM,        /**< Relative humidity (%RH ×100). */
+    COL_RED,        /**< Red channel (raw). */
+    COL_GREEN,      /**< Green channel (raw). */
+    COL_BLUE,       /**< Blue channel (raw). */
+    COL_CLEAR,      /**< Clear channel (raw). */
+    COL_ACCEL_X,    /**< X acceleration (m/s² ×100). */
+    COL_ACCEL_Y,    /**< Y acceleration (m/s² ×100). */
+    COL_ACCEL_Z,    /**< Z acceleration (m/s² ×100). */
+    COL_LAT,        /**< Latitude (degrees ×1e6). */
+    COL_LON,        /**< Longitude (degrees ×1e6). */
+    COL_ALT,        /**< Altitude (m ×100). */
+    COL_SATS,       /**< Satellites in use. */
+    COL_HEALTH,     /**< Plant health class. */
+    COL_ANOMALY,    /**< Anomaly flags. */
+    COL_COUNT
+};
+
+/** @brief Name and display scale of a column. */
+struct ColumnSpec {
+    const char *name;
+    double scale;   /**< Stored value / scale = value in display units. */
+};
+
+constexpr std::array<ColumnSpec, COL_COUNT> kColumnSpecs = {{
+    {"ts_ms", 1},      {"node", 1},
+    {"moisture", 10},  {"light", 10},
+    {"temp", 100},     {"hum", 100},
+    {"red", 1},        {"green", 1},   {"blue", 1},  {"clear", 1},
+    {"accel_x", 100},  {"accel_y", 100}, {"accel_z", 100},
+    {"lat", 1e6},      {"lon", 1e6},   {"alt", 100},
+    {"sats", 1},       {"health", 1},  {"anomaly", 1},
+}};
+
+/** @brief How each value is turned into a residual against its predecessor. */
+enum class Encoding : uint8_t {
+    Delta = 0,        /**< zigzag(v[i] - v[i-1]). */
+    DeltaOfDelta = 1, /**< zigzag of the change of the delta; best for regular timestamps. */
+    Xor = 2,          /**< v[i] ^ v[i-1]; best for flags and enums. */
+};
+
+/** @brief How the residuals are laid out. */
+enum class Packing : uint8_t {
+    Varint = 0,     /**< LEB128 varints; a zero residual is followed by the length of the zero run. */
+    BitPacked = 1,  /**< One width byte, then every residual in that many bits. */
+};
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t columns;       /**< Always @ref COL_COUNT for this version. */
+    uint64_t rows;
+    uint64_t blocks;
+    uint64_t index_offset;  /**< Byte offset of the BlockIndex array. */
+};
+static_assert(sizeof(FileHeader) == 40, "FileHeader layout");
+
+struct ChunkIndex {
+    uint64_t offset;     /**< Byte offset of the encoded chunk. */
+    uint32_t size;       /**< Encoded size in bytes. */
+    uint8_t encoding;    /**< @ref Encoding. */
+    uint8_t packing;     /**< @ref Packing. */
+    uint8_t reserved[2];
+    int64_t min;
+    int64_t max;
+    int64_t sum;
+};
+static_assert(sizeof(ChunkIndex) == 40, "ChunkIndex layout");
+
+struct BlockIndex {
+    uint32_t rows;
+    uint32_t reserved;
+    ChunkIndex chunks[COL_COUNT];
+};
+
+/** @brief One row with every column, in @ref Column order. */
+using Row = std::array<int64_t, COL_COUNT>;
+
+/** @brief Look up a column by name; returns COL_COUNT if unknown. */
+inline Column column_by_name(const char *name)
+{
+    for (uint32_t i = 0; i < COL_COUNT; i++) {
+        const char *a = kColumnSpecs[i].name;
+        const char *b = name;
+        while (*a != '\0' && *a == *b) {
+            a++;
+            b++;
+        }
+        if (*a == '\0' && *b == '\0') {
+            return static_cast<Column>(i);
+        }
+    }
+    return COL_COUNT;
+}
+
+} // namespace tsdb
+
+#endif // TSDB_FORMAT_HPP
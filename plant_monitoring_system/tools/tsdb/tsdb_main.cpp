@@ -0,0 +1,394 @@
+/**
+ * @file tsdb_main.cpp
+ * @brief Command-line front end of the plant time-series file format.
+ *
+ * Usage:
+ * @verbatim
+ *   plant_tsdb convert OUT.ptsdb [--store DIR]... [--log-node N] [--start T] [--period S] [--log FILE]...
+ *   plant_tsdb info FILE.ptsdb
+ *   plant_tsdb query FILE.ptsdb --column NAME [--agg mean|min|max|sum|count]
+ *                    [--bucket minute|hour|day|SECONDS] [--from T] [--to T]
+ *                    [--node N] [--per-node] [--stats]
+ *   plant_tsdb query [--log-node N] [--start T] [--period S] --log FILE ...   (text-scan baseline)
+ *   plant_tsdb export OUT.ptsdb --port DEV [--baud B] [--fast B] [--from N]
+ *   plant_tsdb update PATCH --port DEV [--baud B] [--fast B]
+ * @endverbatim
+ *
+ * Times (T) are UTC: YYYY-MM-DD, YYYY-MM-DDThh:mm[:ss] or ms since the epoch.
+ * --log-node, --start and --period apply to the --log files that follow them;
+ * --node filters the query results.
+ *
+ * export reads the flash history of a node over its console UART (see
+ * export_protocol.h), switching the link to --fast (default 921600) baud
+ * for the transfer. Records are spooled to OUT.ptsdb.spool as they arrive;
+ * a later export resumes after the last spooled record (or at --from N,
+ * dropping the spooled records from N on), and OUT.ptsdb is rewritten
+ * from the whole spool. Rows are timed by the node's GPS time; records
+ * taken before a fix are placed by their uptime relative to a stamped
+ * record of the same boot, or skipped if it has none.
+ *
+ * update sends a firmware delta patch made by tools/delta/delta_patch.py
+ * over the same link; the node writes the new image into its update slot,
+ * checks it and, with MCUboot, reboots into it.
+ *
+ * Example, hourly mean moisture per node in March:
+ * @verbatim
+ *   plant_tsdb query fleet.ptsdb --column moisture --agg mean --bucket hour \
+ *       --from 2026-03-01 --to 2026-04-01 --per-node
+ * @endverbatim
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "export_client.hpp"
+#include "export_protocol.h"
+#include "importers.hpp"
+#include "query.hpp"
+#include "tsdb_file.hpp"
+
+using namespace tsdb;
+
+static double elapsed_ms(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static int usage()
+{
+    std::fprintf(stderr,
+        "Usage: plant_tsdb convert OUT.ptsdb [--store DIR]... [--log-node N] [--start T] [--period S] [--log FILE]...\n"
+        "       plant_tsdb info FILE.ptsdb\n"
+        "       plant_tsdb query (FILE.ptsdb | [--log-node N] [--start T] [--period S] --log FILE)\n"
+        "                  --column NAME [--agg mean|min|max|sum|count] [--bucket minute|hour|day|SECONDS]\n"
+        "                  [--from T] [--to T] [--node N] [--per-node] [--stats]\n"
+        "       plant_tsdb export OUT.ptsdb --port DEV [--baud B] [--fast B] [--from N]\n"
+        "       plant_tsdb update PATCH --port DEV [--baud B] [--fast B]\n");
+    return EXIT_FAILURE;
+}
+
+static void require_time(const char *arg, int64_t *ms)
+{
+    if (!parse_time(arg, ms)) {
+        throw std::runtime_error(std::string("invalid time: ") + arg);
+    }
+}
+
+/**
+ * @brief Parse the import options that precede a --log argument.
+ * @return true if @p argv[*i] was an import option (and consumed it).
+ */
+static bool parse_log_option(int argc, char **argv, int *i, LogImportOptions *opts)
+{
+    const std::string arg = argv[*i];
+    if (*i + 1 >= argc) {
+        return false;
+    }
+    if (arg == "--log-node") {
+        opts->node = static_cast<uint32_t>(std::strtoul(argv[++*i], nullptr, 10));
+    } else if (arg == "--start") {
+        require_time(argv[++*i], &opts->start_ms);
+    } else if (arg == "--period") {
+        opts->period_ms = static_cast<int64_t>(std::strtod(argv[++*i], nullptr) * 1000);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static void load_log(const char *path, const LogImportOptions &opts, std::vector<Row> &rows)
+{
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error(std::string("cannot open ") + path);
+    }
+    import_log(in, opts, rows);
+}
+
+static int cmd_convert(int argc, char **argv)
+{
+    if (argc < 3) {
+        return usage();
+    }
+    const std::string out = argv[2];
+    std::vector<Row> rows;
+    LogImportOptions opts;
+    const auto start = std::chrono::steady_clock::now();
+
+    for (int i = 3; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (arg == "--store" && i + 1 < argc) {
+            import_store(argv[++i], rows);
+        } else if (arg == "--log" && i + 1 < argc) {
+            load_log(argv[++i], opts, rows);
+        } else if (!parse_log_option(argc, argv, &i, &opts)) {
+            return usage();
+        }
+    }
+    const double parse_ms = elapsed_ms(start);
+
+    write_file(out, rows);
+
+    MappedFile file(out);
+    std::fprintf(stderr, "%zu rows, %llu blocks, %zu bytes (%.1f bytes/row); import %.0f ms, total %.0f ms\n",
+                 rows.size(), (unsigned long long)file.blocks(), file.size(),
+                 rows.empty() ? 0.0 : double(file.size()) / rows.size(), parse_ms, elapsed_ms(start));
+    return EXIT_SUCCESS;
+}
+
+static int cmd_info(int argc, char **argv)
+{
+    if (argc != 3) {
+        return usage();
+    }
+    MappedFile file(argv[2]);
+    const FileHeader &h = file.header();
+
+    std::vector<uint64_t> bytes(COL_COUNT, 0);
+    std::vector<uint64_t> encodings(3 * COL_COUNT, 0);
+    std::vector<uint64_t> packed(COL_COUNT, 0);
+    int64_t ts_min = INT64_MAX, ts_max = INT64_MIN;
+    for (uint64_t b = 0; b < file.blocks(); b++) {
+        const BlockIndex &blk = file.block(b);
+        for (uint32_t c = 0; c < COL_COUNT; c++) {
+            bytes[c] += blk.chunks[c].size;
+            if (blk.chunks[c].encoding < 3) {
+                encodings[c * 3 + blk.chunks[c].encoding]++;
+            }
+            packed[c] += blk.chunks[c].packing == static_cast<uint8_t>(Packing::BitPacked);
+        }
+        ts_min = std::min(ts_min, blk.chunks[COL_TS_MS].min);
+        ts_max = std::max(ts_max, blk.chunks[COL_TS_MS].max);
+    }
+
+    std::printf("rows %llu, blocks %llu, file %zu bytes\n",
+                (unsigned long long)h.rows, (unsigned long long)h.blocks, file.size());
+    if (h.rows > 0) {
+        std::printf("time %s .. %s\n", format_time(ts_min).c_str(), format_time(ts_max).c_str());
+    }
+    std::printf("%-10s %10s %8s  %s\n", "column", "bytes", "bits/val", "blocks delta/dod/xor, bit-packed");
+    for (uint32_t c = 0; c < COL_COUNT; c++) {
+        std::printf("%-10s %10llu %8.2f  %llu/%llu/%llu, %llu\n", kColumnSpecs[c].name,
+                    (unsigned long long)bytes[c], h.rows ? 8.0 * bytes[c] / h.rows : 0.0,
+                    (unsigned long long)encodings[c * 3], (unsigned long long)encodings[c * 3 + 1],
+                    (unsigned long long)encodings[c * 3 + 2], (unsigned long long)packed[c]);
+    }
+    return EXIT_SUCCESS;
+}
+
+static int cmd_query(int argc, char **argv)
+{
+    const auto t0 = std::chrono::steady_clock::now();
+    Query q;
+    std::string file_path;
+    std::vector<Row> log_rows;
+    LogImportOptions opts;
+    bool from_log = false, stats = false;
+
+    for (int i = 2; i < argc; i++) {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+
+        if (arg == "--log" && has_value) {
+            from_log = true;
+            load_log(argv[++i], opts, log_rows);
+        } else if ((arg == "--log-node" || arg == "--start" || arg == "--period") &&
+                   parse_log_option(argc, argv, &i, &opts)) {
+            continue;
+        } else if (arg == "--column" && has_value) {
+            q.column = column_by_name(argv[++i]);
+            if (q.column == COL_COUNT) {
+                throw std::runtime_error(std::string("unknown column: ") + argv[i]);
+            }
+        } else if (arg == "--agg" && has_value) {
+            const std::string a = argv[++i];
+            if (a == "mean") q.agg = Agg::Mean;
+            else if (a == "min") q.agg = Agg::Min;
+            else if (a == "max") q.agg = Agg::Max;
+            else if (a == "sum") q.agg = Agg::Sum;
+            else if (a == "count") q.agg = Agg::Count;
+            else return usage();
+        } else if (arg == "--bucket" && has_value) {
+            const std::string b = argv[++i];
+            if (b == "minute") q.bucket_ms = 60000;
+            else if (b == "hour") q.bucket_ms = 3600000;
+            else if (b == "day") q.bucket_ms = 86400000;
+            else q.bucket_ms = static_cast<int64_t>(std::strtod(b.c_str(), nullptr) * 1000);
+        } else if (arg == "--from" && has_value) {
+            require_time(argv[++i], &q.from_ms);
+        } else if (arg == "--to" && has_value) {
+            require_time(argv[++i], &q.to_ms);
+        } else if (arg == "--node" && has_value) {
+            q.has_node = true;
+            q.node = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--per-node") {
+            q.per_node = true;
+        } else if (arg == "--stats") {
+            stats = true;
+        } else if (arg[0] != '-' && file_path.empty()) {
+            file_path = arg;
+        } else {
+            return usage();
+        }
+    }
+    if (from_log == !file_path.empty()) {
+        return usage();
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    QueryResult res;
+    if (from_log) {
+        res = run_query(log_rows, q);
+    } else {
+        MappedFile file(file_path);
+        res = run_query(file, q);
+    }
+    const double query_ms = elapsed_ms(start);
+
+    std::printf("node,bucket,%s_%s\n", kColumnSpecs[q.column].name,
+                q.agg == Agg::Mean ? "mean" : q.agg == Agg::Min ? "min" : q.agg == Agg::Max ? "max" :
+                q.agg == Agg::Sum ? "sum" : "count");
+    for (const auto &entry : res.cells) {
+        const std::string node = entry.first.first < 0 ? "*" : std::to_string(entry.first.first);
+        const std::string bucket = entry.first.second == INT64_MIN ? "*" : format_time(entry.first.second);
+        std::printf("%s,%s,%.3f\n", node.c_str(), bucket.c_str(), cell_value(entry.second, q));
+    }
+
+    if (stats) {
+        std::fprintf(stderr,
+            "total %.3f ms (query %.3f ms): %zu groups, blocks %llu (pruned %llu, index-only %llu, decoded %llu), "
+            "rows scanned %llu\n",
+            elapsed_ms(t0), query_ms, res.cells.size(), (unsigned long long)res.blocks_total,
+            (unsigned long long)res.blocks_pruned, (unsigned long long)res.blocks_index_only,
+            (unsigned long long)res.blocks_decoded, (unsigned long long)res.rows_scanned);
+    }
+    return EXIT_SUCCESS;
+}
+
+static int cmd_export(int argc, char **argv)
+{
+    if (argc < 3) {
+        return usage();
+    }
+    const std::string out = argv[2];
+    ExportOptions opts;
+
+    for (int i = 3; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            return usage();
+        } else if (arg == "--port") {
+            opts.port = argv[++i];
+        } else if (arg == "--baud") {
+            opts.baud = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--fast") {
+            opts.fast_baud = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--from") {
+            opts.from = std::strtoll(argv[++i], nullptr, 10);
+        } else {
+            return usage();
+        }
+    }
+    if (opts.port.empty()) {
+        return usage();
+    }
+
+    const std::string spool = out + ".spool";
+    const ExportStats st = export_history(opts, spool);
+
+    /* Payload rate of 8N1: 10 bits per byte */
+    const double line_rate = st.baud / 10.0;
+    const double rate = st.seconds > 0 ? st.records * HISTORY_RECORD_SIZE / st.seconds : 0.0;
+    std::fprintf(stderr,
+                 "%llu records (%llu bytes) in %.2f s at %u baud: %.0f B/s, %.1f%% of line rate; "
+                 "%llu wire bytes, %llu lost, %llu out of order, %llu bad packets, %llu timeouts\n",
+                 (unsigned long long)st.records, (unsigned long long)st.records * HISTORY_RECORD_SIZE,
+                 st.seconds, st.baud, rate, line_rate > 0 ? 100.0 * rate / line_rate : 0.0,
+                 (unsigned long long)st.wire_bytes, (unsigned long long)st.lost,
+                 (unsigned long long)st.out_of_order, (unsigned long long)st.bad_packets,
+                 (unsigned long long)st.timeouts);
+
+    std::ifstream in(spool, std::ios::binary);
+    std::vector<Row> rows;
+    std::size_t unplaced = 0;
+    import_history(in, rows, &unplaced);
+    write_file(out, rows);
+    std::fprintf(stderr, "%zu rows written to %s (%zu records without a time skipped)\n", rows.size(),
+                 out.c_str(), unplaced);
+    return EXIT_SUCCESS;
+}
+
+static int cmd_update(int argc, char **argv)
+{
+    if (argc < 3) {
+        return usage();
+    }
+    ExportOptions opts;
+
+    for (int i = 3; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            return usage();
+        } else if (arg == "--port") {
+            opts.port = argv[++i];
+        } else if (arg == "--baud") {
+            opts.baud = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--fast") {
+            opts.fast_baud = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else {
+            return usage();
+        }
+    }
+    if (opts.port.empty()) {
+        return usage();
+    }
+
+    std::ifstream in(argv[2], std::ios::binary);
+    if (!in) {
+        throw std::runtime_error(std::string("cannot open ") + argv[2]);
+    }
+    const std::vector<uint8_t> patch((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    const UpdateStats st = send_update(opts, patch);
+
+    std::fprintf(stderr,
+                 "%zu-byte patch applied in %.2f s at %u baud (node: %u ms applying); "
+                 "%llu chunks, %llu timeouts, %llu bad packets\n",
+                 patch.size(), st.seconds, st.baud, st.apply_ms, (unsigned long long)st.chunks,
+                 (unsigned long long)st.timeouts, (unsigned long long)st.bad_packets);
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        return usage();
+    }
+
+    try {
+        const std::string cmd = argv[1];
+        if (cmd == "convert") {
+            return cmd_convert(argc, argv);
+        } else if (cmd == "info") {
+            return cmd_info(argc, argv);
+        } else if (cmd == "query") {
+            return cmd_query(argc, argv);
+        } else if (cmd == "export") {
+            return cmd_export(argc, argv);
+        } else if (cmd == "update") {
+            return cmd_update(argc, argv);
+        }
+    } catch (const std::exception &e) {
+        std::fprintf(stderr, "plant_tsdb: %s\n", e.what());
+        return EXIT_FAILURE;
+    }
+    return usage();
+}